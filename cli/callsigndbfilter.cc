@@ -0,0 +1,57 @@
+#include "callsigndbfilter.hh"
+#include "logger.hh"
+
+
+bool parseCallsignDBFilters(QCommandLineParser &parser, CallsignDB::Selection &selection) {
+  if (parser.isSet("country")) {
+    QStringList countries = parser.value("country").split(",");
+    for (int i=0; i<countries.size(); i++)
+      countries[i] = countries[i].trimmed();
+    countries.removeAll("");
+    logDebug() << "Select call-signs in countries {" << countries.join(", ") << "}.";
+    selection.setCountries(countries);
+  }
+
+  if (parser.isSet("state")) {
+    QStringList states = parser.value("state").split(",");
+    for (int i=0; i<states.size(); i++)
+      states[i] = states[i].trimmed();
+    states.removeAll("");
+    logDebug() << "Select call-signs in states {" << states.join(", ") << "}.";
+    selection.setStates(states);
+  }
+
+  if (parser.isSet("id-range")) {
+    QList<CallsignDB::Selection::IDRange> ranges;
+    ErrorStack err;
+    if (! CallsignDB::Selection::parseIDRanges(parser.value("id-range"), ranges, err)) {
+      logError() << "Please specify valid DMR ID ranges for --id-range option: " << err.format();
+      return false;
+    }
+    selection.setIDRanges(ranges);
+  }
+
+  if (parser.isSet("call-pattern")) {
+    QRegularExpression pattern(parser.value("call-pattern"),
+                               QRegularExpression::CaseInsensitiveOption);
+    if (! pattern.isValid()) {
+      logError() << "Invalid call-sign pattern '" << parser.value("call-pattern") << "': "
+                 << pattern.errorString() << ".";
+      return false;
+    }
+    selection.setCallsignPattern(pattern);
+  }
+
+  if (parser.isSet("heard")) {
+    QSet<unsigned> heard;
+    ErrorStack err;
+    if (! CallsignDB::Selection::readHeard(parser.value("heard"), heard, err)) {
+      logError() << "Cannot read heard list: " << err.format();
+      return false;
+    }
+    logDebug() << "Select call-signs within " << heard.count() << " recently heard IDs.";
+    selection.setHeard(heard);
+  }
+
+  return true;
+}
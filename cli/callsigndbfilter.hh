@@ -0,0 +1,9 @@
+#ifndef CALLSIGNDBFILTER_HH
+#define CALLSIGNDBFILTER_HH
+
+#include <QCommandLineParser>
+#include "callsigndb.hh"
+
+bool parseCallsignDBFilters(QCommandLineParser &parser, CallsignDB::Selection &selection);
+
+#endif // CALLSIGNDBFILTER_HH
@@ -14,6 +14,7 @@
 #include "d868uv_callsigndb.hh"
 #include "d878uv2_callsigndb.hh"
 #include "crc32.hh"
+#include "callsigndbfilter.hh"
 
 
 int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
@@ -37,6 +38,7 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
     }
   }
 
+  CallsignDB::Selection selection;
   if (parser.isSet("id")) {
     QStringList prefixes_text = parser.value("id").split(",");
     QSet<unsigned> prefixes;
@@ -54,8 +56,8 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
     foreach (unsigned prefix, prefixes) {
       prefixes_text.append(QString::number(prefix));
     }
-    logDebug() << "Sort call-sign DB w.r.t. DMR ID(s) {" << prefixes_text.join(", ") << "}.";
-    userdb.sortUsers(prefixes);
+    logDebug() << "Select call-signs w.r.t. DMR ID(s) {" << prefixes_text.join(", ") << "}.";
+    selection.setPrefixes(prefixes);
   } else {
     logWarn() << "No ID is specified, a more or less random set of call-signs will be used "
               << "if the radio cannot hold the entire call-sign DB of " << userdb.count()
@@ -63,7 +65,6 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
               << "select those entries 'closest' to you. I.e., DMR IDs with the same prefix.";
   }
 
-  CallsignDB::Selection selection;
   if (parser.isSet("limit")) {
     bool ok=true;
     selection.setCountLimit(parser.value("limit").toUInt(&ok));
@@ -72,6 +73,8 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
   }
+  if (! parseCallsignDBFilters(parser, selection))
+    return -1;
 
   if (! parser.isSet("radio")) {
     logError() << "You have to specify the radio using the --radio option.";
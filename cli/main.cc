@@ -85,6 +85,34 @@ int main(int argc, char *argv[])
                      "maximum number of callsigns to encode."),
                      QCoreApplication::translate("main", "N")
                    });
+  parser.addOption(QCommandLineOption(
+                     "country",
+                     QCoreApplication::translate("main", "When encoding/writing the callsign db, "
+                     "selects only those callsigns located in one of the given comma separated "
+                     "countries."),
+                     QCoreApplication::translate("main", "COUNTRIES")));
+  parser.addOption(QCommandLineOption(
+                     "state",
+                     QCoreApplication::translate("main", "When encoding/writing the callsign db, "
+                     "selects only those callsigns located in one of the given comma separated "
+                     "states."),
+                     QCoreApplication::translate("main", "STATES")));
+  parser.addOption(QCommandLineOption(
+                     "id-range",
+                     QCoreApplication::translate("main", "When encoding/writing the callsign db, "
+                     "selects only those callsigns within one of the given comma separated DMR ID "
+                     "ranges (e.g., 2620000-2659999)."),
+                     QCoreApplication::translate("main", "RANGES")));
+  parser.addOption(QCommandLineOption(
+                     "call-pattern",
+                     QCoreApplication::translate("main", "When encoding/writing the callsign db, "
+                     "selects only those callsigns starting with the given regular expression."),
+                     QCoreApplication::translate("main", "REGEX")));
+  parser.addOption(QCommandLineOption(
+                     "heard",
+                     QCoreApplication::translate("main", "When encoding/writing the callsign db, "
+                     "selects only those DMR IDs listed in the given file of recently heard IDs."),
+                     QCoreApplication::translate("main", "FILE")));
   parser.addOption(QCommandLineOption(
                      "init-codeplug",
                      QCoreApplication::translate(
@@ -98,6 +126,24 @@ int main(int argc, char *argv[])
                      "auto-enable-roaming",
                      QCoreApplication::translate("main", "Automatically enables roaming if there is a "
                                                          "roaming zone used by any channel.")));
+  parser.addOption(QCommandLineOption(
+                     "diff-upload",
+                     QCoreApplication::translate("main", "Writes only those parts of the codeplug "
+                                                         "or call-sign DB to the radio, that differ "
+                                                         "from the one currently stored in the radio.")));
+  parser.addOption(QCommandLineOption(
+                     "image-cache",
+                     QCoreApplication::translate("main", "Caches the codeplug written to the radio. "
+                                                         "If the radio still holds this codeplug, the "
+                                                         "next upload skips reading it back.")));
+  parser.addOption(QCommandLineOption(
+                     "parallel-encode",
+                     QCoreApplication::translate("main", "Encodes independent parts of the codeplug "
+                                                         "in parallel.")));
+  parser.addOption(QCommandLineOption(
+                     "stats",
+                     QCoreApplication::translate("main", "Prints some statistics about the transfers "
+                                                         "to and from the radio.")));
   parser.addOption(QCommandLineOption(
                      "ignore-limits",
                      QCoreApplication::translate("main", "Disables some limit checks.")));
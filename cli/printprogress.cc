@@ -1,6 +1,8 @@
 #include "printprogress.hh"
 
 #include <QTextStream>
+#include <QCommandLineParser>
+#include "radio.hh"
 
 
 void print_progress(int prog) {
@@ -19,3 +21,10 @@ void print_progress(int prog) {
   out << "]";
 }
 
+void print_metrics(QCommandLineParser &parser, Radio *radio) {
+  if ((! parser.isSet("stats")) || (nullptr == radio) || (nullptr == radio->metrics()))
+    return;
+  QTextStream out(stdout);
+  out << "\n";
+  radio->metrics()->dump(out);
+}
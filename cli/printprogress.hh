@@ -1,7 +1,11 @@
 #ifndef PRINTPROGRESS_HH
 #define PRINTPROGRESS_HH
 
+class QCommandLineParser;
+class Radio;
 
 void print_progress(int prog);
+/** Prints the transfer statistics of the given radio, if the --stats option is set. */
+void print_metrics(QCommandLineParser &parser, Radio *radio);
 
 #endif // PRINTPROGRESS_HH
@@ -35,7 +35,9 @@ int readCodeplug(QCommandLineParser &parser, QCoreApplication &app)
   QObject::connect(radio, &Radio::downloadProgress, updateProgress);
 
   Config config;
-  if (! radio->startDownload(true, err)) {
+  bool ok = radio->startDownload(true, err);
+  print_metrics(parser, radio);
+  if (! ok) {
     logError() << "Codeplug download error: " << err.format();
     return -1;
   }
@@ -7,8 +7,10 @@
 #include "radio.hh"
 #include "userdatabase.hh"
 #include "progressbar.hh"
+#include "printprogress.hh"
 #include "callsigndb.hh"
 #include "autodetect.hh"
+#include "callsigndbfilter.hh"
 
 
 int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
@@ -27,6 +29,7 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
     }
   }
 
+  CallsignDB::Selection selection;
   if (parser.isSet("id")) {
     QStringList prefixes_text = parser.value("id").split(",");
     QSet<unsigned> prefixes;
@@ -44,8 +47,8 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
     foreach (unsigned prefix, prefixes) {
       prefixes_text.append(QString::number(prefix));
     }
-    logDebug() << "Sort call-sign DB w.r.t. DMR ID(s) {" << prefixes_text.join(", ") << "}.";
-    userdb.sortUsers(prefixes);
+    logDebug() << "Select call-signs w.r.t. DMR ID(s) {" << prefixes_text.join(", ") << "}.";
+    selection.setPrefixes(prefixes);
   } else {
     logWarn() << "No ID is specified, a more or less random set of call-signs will be used "
               << "if the radio cannot hold the entire call-sign DB of " << userdb.count()
@@ -53,7 +56,6 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
               << "select those entries 'closest' to you. I.e., DMR IDs with the same prefix.";
   }
 
-  CallsignDB::Selection selection;
   if (parser.isSet("limit")) {
     bool ok=true;
     selection.setCountLimit(parser.value("limit").toUInt(&ok));
@@ -62,6 +64,10 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
   }
+  if (! parseCallsignDBFilters(parser, selection))
+    return -1;
+  if (parser.isSet("diff-upload"))
+    selection.setIncrementalUpload(true);
 
   ErrorStack err;
   Radio *radio = autoDetect(parser, app, err);
@@ -73,7 +79,9 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
   showProgress();
   QObject::connect(radio, &Radio::uploadProgress, updateProgress);
 
-  if (! radio->startUploadCallsignDB(&userdb, true, selection, err)) {
+  bool ok = radio->startUploadCallsignDB(&userdb, true, selection, err);
+  print_metrics(parser, radio);
+  if (! ok) {
     logError() << "Could not upload call-sign DB to radio: " << err.format();
     return -1;
   }
@@ -8,6 +8,7 @@
 #include "radio.hh"
 #include "config.hh"
 #include "progressbar.hh"
+#include "printprogress.hh"
 #include "autodetect.hh"
 #include "radiolimits.hh"
 
@@ -76,9 +77,17 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
     flags.autoEnableGPS = true;
   if (parser.isSet("auto-enable-roaming"))
     flags.autoEnableRoaming = true;
+  if (parser.isSet("diff-upload"))
+    flags.diffUpload = true;
+  if (parser.isSet("image-cache"))
+    flags.useImageCache = true;
+  if (parser.isSet("parallel-encode"))
+    flags.parallelEncode = true;
 
   logDebug() << "Start upload to " << radio->name() << ".";
-  if (! radio->startUpload(&config, true, flags, err)) {
+  bool ok = radio->startUpload(&config, true, flags, err);
+  print_metrics(parser, radio);
+  if (! ok) {
     logError() << "Codeplug upload error: " << err.format();
     return -1;
   }
@@ -25,31 +25,68 @@ AddressMap::clear() {
   _items.clear();
 }
 
+bool
+AddressMap::build(const std::vector<Region> &regions) {
+  _items.clear();
+  _items.reserve(regions.size());
+  for (size_t i=0; i<regions.size(); i++)
+    _items.push_back(AddrMapItem(regions[i].first, regions[i].second, i));
+  std::stable_sort(_items.begin(), _items.end());
+
+  // Remove overlapping regions, the first one (w.r.t. address) wins
+  bool ok = true;
+  size_t n = 0;
+  uint64_t end = 0;
+  for (size_t i=0; i<_items.size(); i++) {
+    if ((0 < n) && (_items[i].address < end)) {
+      ok = false;
+      continue;
+    }
+    _items[n++] = _items[i];
+    end = _items[i].end();
+  }
+  _items.erase(_items.begin()+n, _items.end());
+
+  return ok;
+}
+
 bool
 AddressMap::add(uint32_t addr, uint32_t len, int idx) {
   if (0 > idx)
     idx = _items.size();
-  AddrMapItem item(addr, len, idx);
+  else
+    shift(idx, 1);
 
-  std::vector<AddrMapItem>::iterator at = std::lower_bound(_items.begin(), _items.end(), item);
-  if (_items.end() == at)
+  if (overlaps(addr, len))
+    return false;
+
+  AddrMapItem item(addr, len, idx);
+  // Fast path for regions added in ascending order
+  if (_items.empty() || (_items.back().address <= addr)) {
     _items.push_back(item);
-  else
-    _items.insert(at, item);
+    return true;
+  }
+
+  std::vector<AddrMapItem>::iterator at = std::upper_bound(_items.begin(), _items.end(), item);
+  _items.insert(at, item);
   return true;
 }
 
 bool
-AddressMap::rem(uint32_t idx) {
-  std::vector<AddrMapItem>::iterator at = _items.begin();
-  for (; at!=_items.end(); at++) {
+AddressMap::rem(uint32_t addr, uint32_t idx) {
+  // Search all items at the given address
+  std::vector<AddrMapItem>::iterator at = std::lower_bound(
+        _items.begin(), _items.end(), AddrMapItem(addr, 0, 0));
+  for (; (_items.end() != at) && (addr == at->address); at++) {
     if (at->index == idx)
       break;
   }
-  if (_items.end() == at)
-    return false;
-  _items.erase(at);
-  return true;
+
+  bool found = (_items.end() != at) && (addr == at->address);
+  if (found)
+    _items.erase(at);
+  shift(idx+1, -1);
+  return found;
 }
 
 bool
@@ -57,15 +94,45 @@ AddressMap::contains(uint32_t addr) const {
   return 0 <= find(addr);
 }
 
+bool
+AddressMap::overlaps(uint32_t addr, uint32_t len) const {
+  if (0 == len)
+    return false;
+  std::vector<AddrMapItem>::const_iterator at = upper(addr);
+  // Check the region starting after addr
+  if ((_items.end() != at) && (at->address < (uint64_t(addr)+len)))
+    return true;
+  // Check the region starting at or before addr
+  if (_items.begin() == at)
+    return false;
+  --at;
+  return at->end() > addr;
+}
+
 int
 AddressMap::find(uint32_t addr) const {
-  std::vector<AddrMapItem>::const_iterator at = std::lower_bound(_items.begin(), _items.end(), addr);
-  if (_items.end() == at)
-    return _items.back().contains(addr) ? _items.back().index : -1;
-  if (at->contains(addr))
-    return at->index;
+  std::vector<AddrMapItem>::const_iterator at = upper(addr);
   if (_items.begin() == at)
     return -1;
   --at;
-  return at->contains(addr) ? at->index : -1;
+  return at->contains(addr) ? int(at->index) : -1;
+}
+
+size_t
+AddressMap::size() const {
+  return _items.size();
+}
+
+std::vector<AddressMap::AddrMapItem>::const_iterator
+AddressMap::upper(uint32_t addr) const {
+  return std::upper_bound(_items.begin(), _items.end(), addr,
+                          [](uint32_t a, const AddrMapItem &item) { return a < item.address; });
+}
+
+void
+AddressMap::shift(uint32_t idx, int delta) {
+  for (std::vector<AddrMapItem>::iterator it=_items.begin(); it!=_items.end(); it++) {
+    if (it->index >= idx)
+      it->index += delta;
+  }
 }
@@ -3,15 +3,29 @@
 
 #include <inttypes.h>
 #include <vector>
+#include <utility>
+#include <stddef.h>
 
 /** This class represents a memory map.
- * That is, it maintains a vector of memory regions (address and length) that can be searched
- * efficiently. This should speedup the generation of codeplugs consisting of many small memory
- * sections.
+ * That is, it maintains a vector of non-overlapping memory regions (address and length) that can
+ * be searched efficiently. This should speedup the generation of codeplugs consisting of many small
+ * memory sections.
+ *
+ * The regions are kept sorted by address, hence a lookup is a single binary search. Regions added
+ * in ascending order are appended in constant time. Many regions can be added at once using
+ * @c build, which sorts them only once.
+ *
+ * Each region is associated with an index (usually the index of an element). The indices are kept
+ * consistent, when regions are inserted or removed by index. That is, all indices following an
+ * inserted or removed one get shifted.
  *
  * @ingroup util */
 class AddressMap
 {
+public:
+  /** A region, that is its address and length. */
+  typedef std::pair<uint32_t, uint32_t> Region;
+
 public:
   /** Empty constructor. */
   AddressMap();
@@ -23,15 +37,28 @@ public:
 
   /** Clears the address map. */
   void clear();
-  /** Adds an item to the address map. */
+  /** Rebuilds the address map from the given regions. The index of each region is its position
+   * in the vector. Regions overlapping a preceding one (w.r.t. address) are skipped.
+   * @returns @c false if any region was skipped. */
+  bool build(const std::vector<Region> &regions);
+  /** Adds an item to the address map. If the index is negative, the number of items is used.
+   * Otherwise, all items with an index greater or equal to the given one get shifted.
+   * @returns @c false if the region overlaps with an existing one. In this case, the region is not
+   * added but the indices are shifted nevertheless. */
   bool add(uint32_t addr, uint32_t len, int idx=-1);
-  /** Removes an item from the address map associated with the given index. */
-  bool rem(uint32_t idx);
+  /** Removes the item associated with the given address and index. All items with a greater index
+   * get shifted.
+   * @returns @c false if there is no such item. */
+  bool rem(uint32_t addr, uint32_t idx);
   /** Returns @c true if the given address is contained in any of the memory regions. */
   bool contains(uint32_t addr) const;
+  /** Returns @c true if the given region overlaps with any of the memory regions. */
+  bool overlaps(uint32_t addr, uint32_t len) const;
   /** Finds the index of the memory region containing the given address. If no such region is found,
    * -1 is returned. */
   int find(uint32_t addr) const;
+  /** Returns the number of regions. */
+  size_t size() const;
 
 protected:
   /** Memory map item.
@@ -50,18 +77,23 @@ protected:
     inline bool operator<(const AddrMapItem &other) const {
       return address < other.address;
     }
-    /** Comparison operator. */
-    inline bool operator<(uint32_t addr) const {
-      return address < addr;
-    }
     /** Returns @c true if the given address is contained within this memory region. */
     inline bool contains(uint32_t addr) const {
-      return (address <= addr) && ((address+length) > addr);
+      return (address <= addr) && ((uint64_t(address)+length) > addr);
+    }
+    /** Returns the address following this region. */
+    inline uint64_t end() const {
+      return uint64_t(address)+length;
     }
   };
 
+  /** Returns the position of the first item with an address greater than the given one. */
+  std::vector<AddrMapItem>::const_iterator upper(uint32_t addr) const;
+  /** Shifts all indices greater or equal to @c idx by @c delta. */
+  void shift(uint32_t idx, int delta);
+
 protected:
-  /** Holds the vector of memory items, the order of these items is maintained. */
+  /** Holds the vector of memory items, ordered by address. */
   std::vector<AddrMapItem> _items;
 };
 
@@ -83,25 +83,25 @@ AnytoneCodeplug::ChannelElement::clear() {
   setBandwidth(AnalogChannel::Bandwidth::Narrow);
   setRXTone(Signaling::SIGNALING_NONE);
   setTXTone(Signaling::SIGNALING_NONE);
-  setBit(0x0008, 5, false); // Unused set to 0
+  Layout::Bit<0x0008, 5>::set(_data, false); // Unused set to 0
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::rxFrequency() const {
-  return ((unsigned)getBCD8_be(0x0000))*10;
+  return ((unsigned)Layout::BCD8_be<0x0000>::get(_data))*10;
 }
 void
 AnytoneCodeplug::ChannelElement::setRXFrequency(unsigned hz) {
-  setBCD8_be(0x0000, hz/10);
+  Layout::BCD8_be<0x0000>::set(_data, hz/10);
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::txOffset() const {
-  return ((unsigned)getBCD8_be(0x0004))*10;
+  return ((unsigned)Layout::BCD8_be<0x0004>::get(_data))*10;
 }
 void
 AnytoneCodeplug::ChannelElement::setTXOffset(unsigned hz) {
-  setBCD8_be(0x0004, hz/10);
+  Layout::BCD8_be<0x0004>::set(_data, hz/10);
 }
 
 unsigned
@@ -127,16 +127,16 @@ AnytoneCodeplug::ChannelElement::setTXFrequency(unsigned hz) {
 
 AnytoneCodeplug::ChannelElement::Mode
 AnytoneCodeplug::ChannelElement::mode() const {
-  return (Mode) getUInt2(0x0008, 0);
+  return (Mode) Layout::UInt2<0x0008, 0>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setMode(Mode mode) {
-  setUInt2(0x0008, 0, (unsigned)mode);
+  Layout::UInt2<0x0008, 0>::set(_data, (unsigned)mode);
 }
 
 Channel::Power
 AnytoneCodeplug::ChannelElement::power() const {
-  switch ((Power)getUInt2(0x0008, 2)) {
+  switch ((Power)Layout::UInt2<0x0008, 2>::get(_data)) {
   case POWER_LOW: return Channel::Power::Low;
   case POWER_MIDDLE: return Channel::Power::Mid;
   case POWER_HIGH: return Channel::Power::High;
@@ -149,50 +149,50 @@ AnytoneCodeplug::ChannelElement::setPower(Channel::Power power) {
   switch (power) {
   case Channel::Power::Min:
   case Channel::Power::Low:
-    setUInt2(0x0008, 2, (unsigned)POWER_LOW);
+    Layout::UInt2<0x0008, 2>::set(_data, (unsigned)POWER_LOW);
     break;
   case Channel::Power::Mid:
-    setUInt2(0x0008, 2, (unsigned)POWER_MIDDLE);
+    Layout::UInt2<0x0008, 2>::set(_data, (unsigned)POWER_MIDDLE);
     break;
   case Channel::Power::High:
-    setUInt2(0x0008, 2, (unsigned)POWER_HIGH);
+    Layout::UInt2<0x0008, 2>::set(_data, (unsigned)POWER_HIGH);
     break;
   case Channel::Power::Max:
-    setUInt2(0x0008, 2, (unsigned)POWER_TURBO);
+    Layout::UInt2<0x0008, 2>::set(_data, (unsigned)POWER_TURBO);
     break;
   }
 }
 
 AnalogChannel::Bandwidth
 AnytoneCodeplug::ChannelElement::bandwidth() const {
-  if (getBit(0x0008, 4))
+  if (Layout::Bit<0x0008, 4>::get(_data))
     return AnalogChannel::Bandwidth::Wide;
   return AnalogChannel::Bandwidth::Narrow;
 }
 void
 AnytoneCodeplug::ChannelElement::setBandwidth(AnalogChannel::Bandwidth bw) {
   switch (bw) {
-  case AnalogChannel::Bandwidth::Narrow: setBit(0x0008, 4, false); break;
-  case AnalogChannel::Bandwidth::Wide: setBit(0x0008, 4, true); break;
+  case AnalogChannel::Bandwidth::Narrow: Layout::Bit<0x0008, 4>::set(_data, false); break;
+  case AnalogChannel::Bandwidth::Wide: Layout::Bit<0x0008, 4>::set(_data, true); break;
   }
 }
 
 AnytoneCodeplug::ChannelElement::RepeaterMode
 AnytoneCodeplug::ChannelElement::repeaterMode() const {
-  return (RepeaterMode)getUInt2(0x0008, 6);
+  return (RepeaterMode)Layout::UInt2<0x0008, 6>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setRepeaterMode(RepeaterMode mode) {
-  setUInt2(0x0008, 6, (unsigned)mode);
+  Layout::UInt2<0x0008, 6>::set(_data, (unsigned)mode);
 }
 
 AnytoneCodeplug::ChannelElement::SignalingMode
 AnytoneCodeplug::ChannelElement::rxSignalingMode() const {
-  return (SignalingMode)getUInt2(0x0009, 0);
+  return (SignalingMode)Layout::UInt2<0x0009, 0>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setRXSignalingMode(SignalingMode mode) {
-  setUInt2(0x0009, 0, (unsigned)mode);
+  Layout::UInt2<0x0009, 0>::set(_data, (unsigned)mode);
 }
 
 Signaling::Code
@@ -220,11 +220,11 @@ AnytoneCodeplug::ChannelElement::setRXTone(Code code) {
 
 AnytoneCodeplug::ChannelElement::SignalingMode
 AnytoneCodeplug::ChannelElement::txSignalingMode() const {
-  return (SignalingMode)getUInt2(0x0009, 2);
+  return (SignalingMode)Layout::UInt2<0x0009, 2>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setTXSignalingMode(SignalingMode mode) {
-  setUInt2(0x0009, 2, (unsigned)mode);
+  Layout::UInt2<0x0009, 2>::set(_data, (unsigned)mode);
 }
 
 Signaling::Code
@@ -252,56 +252,56 @@ AnytoneCodeplug::ChannelElement::setTXTone(Code code) {
 
 bool
 AnytoneCodeplug::ChannelElement::ctcssPhaseReversal() const {
-  return getBit(0x0009, 4);
+  return Layout::Bit<0x0009, 4>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableCTCSSPhaseReversal(bool enable) {
-  setBit(0x0009, 4, enable);
+  Layout::Bit<0x0009, 4>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::rxOnly() const {
-  return getBit(0x0009, 5);
+  return Layout::Bit<0x0009, 5>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableRXOnly(bool enable) {
-  setBit(0x0009, 5, enable);
+  Layout::Bit<0x0009, 5>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::callConfirm() const {
-  return getBit(0x0009, 6);
+  return Layout::Bit<0x0009, 6>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableCallConfirm(bool enable) {
-  setBit(0x0009, 6, enable);
+  Layout::Bit<0x0009, 6>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::talkaround() const {
-  return getBit(0x0009, 7);
+  return Layout::Bit<0x0009, 7>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableTalkaround(bool enable) {
-  setBit(0x0009, 7, enable);
+  Layout::Bit<0x0009, 7>::set(_data, enable);
 }
 
 Signaling::Code
 AnytoneCodeplug::ChannelElement::txCTCSS() const {
-  return ctcss_num2code(getUInt8(0x000a));
+  return ctcss_num2code(Layout::UInt8<0x000a>::get(_data));
 }
 void
 AnytoneCodeplug::ChannelElement::setTXCTCSS(Code tone) {
-  setUInt8(0x000a, ctcss_code2num(tone));
+  Layout::UInt8<0x000a>::set(_data, ctcss_code2num(tone));
 }
 Signaling::Code
 AnytoneCodeplug::ChannelElement::rxCTCSS() const {
-  return ctcss_num2code(getUInt8(0x000b));
+  return ctcss_num2code(Layout::UInt8<0x000b>::get(_data));
 }
 void
 AnytoneCodeplug::ChannelElement::setRXCTCSS(Code tone) {
-  setUInt8(0x000b, ctcss_code2num(tone));
+  Layout::UInt8<0x000b>::set(_data, ctcss_code2num(tone));
 }
 Signaling::Code
 AnytoneCodeplug::ChannelElement::txDCS() const {
-  uint16_t code = getUInt16_le(0x000c);
+  uint16_t code = Layout::UInt16_le<0x000c>::get(_data);
   if (512 > code)
     return Signaling::fromDCSNumber(dec_to_oct(code), false);
   return Signaling::fromDCSNumber(dec_to_oct(code-512), true);
@@ -309,16 +309,16 @@ AnytoneCodeplug::ChannelElement::txDCS() const {
 void
 AnytoneCodeplug::ChannelElement::setTXDCS(Code code) {
   if (Signaling::isDCSNormal(code))
-    setUInt16_le(0x000c, oct_to_dec(Signaling::toDCSNumber(code)));
+    Layout::UInt16_le<0x000c>::set(_data, oct_to_dec(Signaling::toDCSNumber(code)));
   else if (Signaling::isDCSInverted(code))
-    setUInt16_le(0x000c, oct_to_dec(Signaling::toDCSNumber(code))+512);
+    Layout::UInt16_le<0x000c>::set(_data, oct_to_dec(Signaling::toDCSNumber(code))+512);
   else
-    setUInt16_le(0x000c, 0);
+    Layout::UInt16_le<0x000c>::set(_data, 0);
 }
 
 Signaling::Code
 AnytoneCodeplug::ChannelElement::rxDCS() const {
-  uint16_t code = getUInt16_le(0x000e);
+  uint16_t code = Layout::UInt16_le<0x000e>::get(_data);
   if (512 > code)
     return Signaling::fromDCSNumber(dec_to_oct(code), false);
   return Signaling::fromDCSNumber(dec_to_oct(code-512), true);
@@ -326,74 +326,74 @@ AnytoneCodeplug::ChannelElement::rxDCS() const {
 void
 AnytoneCodeplug::ChannelElement::setRXDCS(Code code) {
   if (Signaling::isDCSNormal(code))
-    setUInt16_le(0x000e, oct_to_dec(Signaling::toDCSNumber(code)));
+    Layout::UInt16_le<0x000e>::set(_data, oct_to_dec(Signaling::toDCSNumber(code)));
   else if (Signaling::isDCSInverted(code))
-    setUInt16_le(0x000e, oct_to_dec(Signaling::toDCSNumber(code))+512);
+    Layout::UInt16_le<0x000e>::set(_data, oct_to_dec(Signaling::toDCSNumber(code))+512);
   else
-    setUInt16_le(0x000e, 0);
+    Layout::UInt16_le<0x000e>::set(_data, 0);
 }
 
 double
 AnytoneCodeplug::ChannelElement::customCTCSSFrequency() const {
-  return ((double) getUInt16_le(0x0010))/10;
+  return ((double) Layout::UInt16_le<0x0010>::get(_data))/10;
 }
 void
 AnytoneCodeplug::ChannelElement::setCustomCTCSSFrequency(double hz) {
-  setUInt16_le(0x0010, hz*10);
+  Layout::UInt16_le<0x0010>::set(_data, hz*10);
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::twoToneDecodeIndex() const {
-  return getUInt16_le(0x0012);
+  return Layout::UInt16_le<0x0012>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setTwoToneDecodeIndex(unsigned idx) {
-  setUInt16_le(0x0012, idx);
+  Layout::UInt16_le<0x0012>::set(_data, idx);
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::contactIndex() const {
-  return getUInt32_le(0x0014);
+  return Layout::UInt32_le<0x0014>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setContactIndex(unsigned idx) {
-  return setUInt32_le(0x0014, idx);
+  return Layout::UInt32_le<0x0014>::set(_data, idx);
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::radioIDIndex() const {
-  return getUInt8(0x0018);
+  return Layout::UInt8<0x0018>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setRadioIDIndex(unsigned idx) {
-  return setUInt8(0x0018, idx);
+  return Layout::UInt8<0x0018>::set(_data, idx);
 }
 
 AnytoneAnalogChannelExtension::SquelchMode
 AnytoneCodeplug::ChannelElement::squelchMode() const {
-  return (AnytoneAnalogChannelExtension::SquelchMode)getUInt3(0x0019, 4);
+  return (AnytoneAnalogChannelExtension::SquelchMode)Layout::UInt3<0x0019, 4>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setSquelchMode(AnytoneAnalogChannelExtension::SquelchMode mode) {
-  setUInt3(0x0019, 4, (unsigned)mode);
+  Layout::UInt3<0x0019, 4>::set(_data, (unsigned)mode);
 }
 
 AnytoneCodeplug::ChannelElement::Admit
 AnytoneCodeplug::ChannelElement::admit() const {
-  return (Admit)getUInt2(0x001a, 0);
+  return (Admit)Layout::UInt2<0x001a, 0>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setAdmit(Admit admit) {
-  setUInt2(0x001a, 0, (unsigned)admit);
+  Layout::UInt2<0x001a, 0>::set(_data, (unsigned)admit);
 }
 
 AnytoneCodeplug::ChannelElement::OptSignaling
 AnytoneCodeplug::ChannelElement::optionalSignaling() const {
-  return (OptSignaling)getUInt2(0x001a, 4);
+  return (OptSignaling)Layout::UInt2<0x001a, 4>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setOptionalSignaling(OptSignaling sig) {
-  setUInt2(0x001a, 4, (unsigned)sig);
+  Layout::UInt2<0x001a, 4>::set(_data, (unsigned)sig);
 }
 
 bool
@@ -402,11 +402,11 @@ AnytoneCodeplug::ChannelElement::hasScanListIndex() const {
 }
 unsigned
 AnytoneCodeplug::ChannelElement::scanListIndex() const {
-  return getUInt8(0x001b);
+  return Layout::UInt8<0x001b>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setScanListIndex(unsigned idx) {
-  setUInt8(0x001b, idx);
+  Layout::UInt8<0x001b>::set(_data, idx);
 }
 void
 AnytoneCodeplug::ChannelElement::clearScanListIndex() {
@@ -419,11 +419,11 @@ AnytoneCodeplug::ChannelElement::hasGroupListIndex() const {
 }
 unsigned
 AnytoneCodeplug::ChannelElement::groupListIndex() const {
-  return getUInt8(0x001c);
+  return Layout::UInt8<0x001c>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setGroupListIndex(unsigned idx) {
-  setUInt8(0x001c, idx);
+  Layout::UInt8<0x001c>::set(_data, idx);
 }
 void
 AnytoneCodeplug::ChannelElement::clearGroupListIndex() {
@@ -432,99 +432,99 @@ AnytoneCodeplug::ChannelElement::clearGroupListIndex() {
 
 unsigned
 AnytoneCodeplug::ChannelElement::twoToneIDIndex() const {
-  return getUInt8(0x001d);
+  return Layout::UInt8<0x001d>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setTwoToneIDIndex(unsigned idx) {
-  setUInt8(0x001d, idx);
+  Layout::UInt8<0x001d>::set(_data, idx);
 }
 unsigned
 AnytoneCodeplug::ChannelElement::fiveToneIDIndex() const {
-  return getUInt8(0x001e);
+  return Layout::UInt8<0x001e>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setFiveToneIDIndex(unsigned idx) {
-  setUInt8(0x001e, idx);
+  Layout::UInt8<0x001e>::set(_data, idx);
 }
 unsigned
 AnytoneCodeplug::ChannelElement::dtmfIDIndex() const {
-  return getUInt8(0x001f);
+  return Layout::UInt8<0x001f>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setDTMFIDIndex(unsigned idx) {
-  setUInt8(0x001f, idx);
+  Layout::UInt8<0x001f>::set(_data, idx);
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::colorCode() const {
-  return getUInt8(0x0020);
+  return Layout::UInt8<0x0020>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setColorCode(unsigned code) {
-  setUInt8(0x0020, code);
+  Layout::UInt8<0x0020>::set(_data, code);
 }
 
 DigitalChannel::TimeSlot
 AnytoneCodeplug::ChannelElement::timeSlot() const {
-  if (false == getBit(0x0021, 0))
+  if (false == Layout::Bit<0x0021, 0>::get(_data))
     return DigitalChannel::TimeSlot::TS1;
   return DigitalChannel::TimeSlot::TS2;
 }
 void
 AnytoneCodeplug::ChannelElement::setTimeSlot(DigitalChannel::TimeSlot ts) {
   if (DigitalChannel::TimeSlot::TS1 == ts)
-    setBit(0x0021, 0, false);
+    Layout::Bit<0x0021, 0>::set(_data, false);
   else
-    setBit(0x0021, 0, true);
+    Layout::Bit<0x0021, 0>::set(_data, true);
 }
 
 bool
 AnytoneCodeplug::ChannelElement::smsConfirm() const {
-  return getBit(0x0021, 1);
+  return Layout::Bit<0x0021, 1>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableSMSConfirm(bool enable) {
-  setBit(0x0021, 1, enable);
+  Layout::Bit<0x0021, 1>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::simplexTDMA() const {
-  return getBit(0x0021, 2);
+  return Layout::Bit<0x0021, 2>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableSimplexTDMA(bool enable) {
-  setBit(0x0021, 2, enable);
+  Layout::Bit<0x0021, 2>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::adaptiveTDMA() const {
-  return getBit(0x0021, 4);
+  return Layout::Bit<0x0021, 4>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableAdaptiveTDMA(bool enable) {
-  setBit(0x0021, 4, enable);
+  Layout::Bit<0x0021, 4>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::rxAPRS() const {
-  return getBit(0x0021, 5);
+  return Layout::Bit<0x0021, 5>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableRXAPRS(bool enable) {
-  setBit(0x0021, 5, enable);
+  Layout::Bit<0x0021, 5>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::enhancedEncryption() const {
-  return getBit(0x0021, 6);
+  return Layout::Bit<0x0021, 6>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableEnhancedEncryption(bool enable) {
-  setBit(0x0021, 6, enable);
+  Layout::Bit<0x0021, 6>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::loneWorker() const {
-  return getBit(0x0021, 7);
+  return Layout::Bit<0x0021, 7>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableLoneWorker(bool enable) {
-  setBit(0x0021, 7, enable);
+  Layout::Bit<0x0021, 7>::set(_data, enable);
 }
 
 bool
@@ -533,11 +533,11 @@ AnytoneCodeplug::ChannelElement::hasEncryptionKeyIndex() const {
 }
 unsigned
 AnytoneCodeplug::ChannelElement::encryptionKeyIndex() const {
-  return getUInt8(0x0022);
+  return Layout::UInt8<0x0022>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setEncryptionKeyIndex(unsigned idx) {
-  setUInt8(0x0022, idx);
+  Layout::UInt8<0x0022>::set(_data, idx);
 }
 void
 AnytoneCodeplug::ChannelElement::clearEncryptionKeyIndex() {
@@ -546,120 +546,138 @@ AnytoneCodeplug::ChannelElement::clearEncryptionKeyIndex() {
 
 QString
 AnytoneCodeplug::ChannelElement::name() const {
-  return readASCII(0x0023, 16, 0x00);
+  return Layout::ASCII<0x0023, 16, 0x00>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setName(const QString &name) {
-  writeASCII(0x0023, name, 16, 0x00);
+  Layout::ASCII<0x0023, 16, 0x00>::set(_data, name);
 }
 
 bool
 AnytoneCodeplug::ChannelElement::ranging() const {
-  return getBit(0x0034, 0);
+  return Layout::Bit<0x0034, 0>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableRanging(bool enable) {
-  setBit(0x0034, 0, enable);
+  Layout::Bit<0x0034, 0>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::throughMode() const {
-  return getBit(0x0034, 1);
+  return Layout::Bit<0x0034, 1>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableThroughMode(bool enable) {
-  setBit(0x0034, 1, enable);
+  Layout::Bit<0x0034, 1>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::dataACK() const {
-  return !getBit(0x0034, 2);
+  return !Layout::Bit<0x0034, 2>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableDataACK(bool enable) {
-  setBit(0x0034, 2, !enable);
+  Layout::Bit<0x0034, 2>::set(_data, !enable);
 }
 
 bool
 AnytoneCodeplug::ChannelElement::txDigitalAPRS() const {
-  return getBit(0x0035, 0);
+  return Layout::Bit<0x0035, 0>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableTXDigitalAPRS(bool enable) {
-  setBit(0x0035, 0, enable);
+  Layout::Bit<0x0035, 0>::set(_data, enable);
 }
 unsigned
 AnytoneCodeplug::ChannelElement::digitalAPRSSystemIndex() const {
-  return getUInt8(0x0036);
+  return Layout::UInt8<0x0036>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setDigitalAPRSSystemIndex(unsigned idx) {
-  setUInt8(0x0036, idx);
+  Layout::UInt8<0x0036>::set(_data, idx);
 }
 
 unsigned
 AnytoneCodeplug::ChannelElement::dmrEncryptionKeyIndex() const {
-  return getUInt8(0x003a);
+  return Layout::UInt8<0x003a>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::setDMREncryptionKeyIndex(unsigned idx) {
-  setUInt8(0x003a, idx);
+  Layout::UInt8<0x003a>::set(_data, idx);
 }
 
 bool
 AnytoneCodeplug::ChannelElement::multipleKeyEncryption() const {
-  return getBit(0x003b, 0);
+  return Layout::Bit<0x003b, 0>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableMultipleKeyEncryption(bool enable) {
-  setBit(0x003b, 0, enable);
+  Layout::Bit<0x003b, 0>::set(_data, enable);
 }
 
 bool
 AnytoneCodeplug::ChannelElement::randomKey() const {
-  return getBit(0x003b, 1);
+  return Layout::Bit<0x003b, 1>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableRandomKey(bool enable) {
-  setBit(0x003b, 1, enable);
+  Layout::Bit<0x003b, 1>::set(_data, enable);
 }
 bool
 AnytoneCodeplug::ChannelElement::sms() const {
-  return !getBit(0x003b, 2);
+  return !Layout::Bit<0x003b, 2>::get(_data);
 }
 void
 AnytoneCodeplug::ChannelElement::enableSMS(bool enable) {
-  setBit(0x003b, 0, !enable);
+  Layout::Bit<0x003b, 0>::set(_data, !enable);
 }
 
 
+AnytoneCodeplug::ChannelElement::Record
+AnytoneCodeplug::ChannelElement::toRecord() const {
+  Record rec;
+  rec.mode = mode();
+  rec.admit = admit();
+  rec.rxTone = rxTone();
+  rec.txTone = txTone();
+  rec.bandwidth = bandwidth();
+  rec.colorCode = colorCode();
+  rec.timeSlot = timeSlot();
+  rec.name = name();
+  rec.rxFrequency = rxFrequency();
+  rec.txFrequency = txFrequency();
+  rec.power = power();
+  rec.rxOnly = rxOnly();
+  return rec;
+}
+
 Channel *
-AnytoneCodeplug::ChannelElement::toChannelObj(Context &ctx) const {
+AnytoneCodeplug::ChannelElement::createChannelObj(const Record &rec, Context &ctx) const {
   Q_UNUSED(ctx)
 
   Channel *ch;
 
-  if ((Mode::Analog == mode()) || (Mode::MixedAnalog == mode())) {
-    if (Mode::MixedAnalog == mode())
+  if ((Mode::Analog == rec.mode) || (Mode::MixedAnalog == rec.mode)) {
+    if (Mode::MixedAnalog == rec.mode)
       logWarn() << "Mixed mode channels are not supported (for now). Treat ch '"
-                << name() <<"' as analog channel.";
+                << rec.name <<"' as analog channel.";
     AnalogChannel *ach = new AnalogChannel();
-    switch(this->admit()) {
+    switch(rec.admit) {
     case Admit::Always: ach->setAdmit(AnalogChannel::Admit::Always); break;
     case Admit::Busy: ach->setAdmit(AnalogChannel::Admit::Free); break;
     case Admit::Tone: ach->setAdmit(AnalogChannel::Admit::Tone); break;
     default: ach->setAdmit(AnalogChannel::Admit::Always); break;
     }
-    ach->setRXTone(rxTone());
-    ach->setTXTone(txTone());
-    ach->setBandwidth(bandwidth());
+    ach->setRXTone(rec.rxTone);
+    ach->setTXTone(rec.txTone);
+    ach->setBandwidth(rec.bandwidth);
     // no per channel squelch settings
     ach->setSquelchDefault();
     ch = ach;
-  } else if ((Mode::Digital == mode()) || (Mode::MixedDigital == mode())) {
-    if (Mode::MixedDigital == mode())
+  } else if ((Mode::Digital == rec.mode) || (Mode::MixedDigital == rec.mode)) {
+    if (Mode::MixedDigital == rec.mode)
       logWarn() << "Mixed mode channels are not supported (for now). Treat ch '"
-                << name() <<"' as digital channel.";
+                << rec.name <<"' as digital channel.";
     DigitalChannel *dch = new DigitalChannel();
-    switch (this->admit()) {
+    switch (rec.admit) {
     case Admit::Always: dch->setAdmit(DigitalChannel::Admit::Always); break;
     case Admit::Free: dch->setAdmit(DigitalChannel::Admit::Free); break;
     case Admit::ColorCode: dch->setAdmit(DigitalChannel::Admit::ColorCode); break;
@@ -668,20 +686,20 @@ AnytoneCodeplug::ChannelElement::toChannelObj(Context &ctx) const {
       dch->setAdmit(DigitalChannel::Admit::ColorCode);
       break;
     }
-    dch->setColorCode(colorCode());
-    dch->setTimeSlot(timeSlot());
+    dch->setColorCode(rec.colorCode);
+    dch->setTimeSlot(rec.timeSlot);
     ch = dch;
   } else {
-    logError() << "Cannot create channel '" << name()
-               << "': Channel type " << (unsigned)mode() << "not supported.";
+    logError() << "Cannot create channel '" << rec.name
+               << "': Channel type " << (unsigned)rec.mode << "not supported.";
     return nullptr;
   }
 
-  ch->setName(name());
-  ch->setRXFrequency(rxFrequency()/1e6);
-  ch->setTXFrequency(txFrequency()/1e6);
-  ch->setPower(power());
-  ch->setRXOnly(rxOnly());
+  ch->setName(rec.name);
+  ch->setRXFrequency(rec.rxFrequency/1e6);
+  ch->setTXFrequency(rec.txFrequency/1e6);
+  ch->setPower(rec.power);
+  ch->setRXOnly(rec.rxOnly);
 
   // No per channel vox & tot setting
   ch->setVOXDefault();
@@ -690,6 +708,11 @@ AnytoneCodeplug::ChannelElement::toChannelObj(Context &ctx) const {
   return ch;
 }
 
+Channel *
+AnytoneCodeplug::ChannelElement::toChannelObj(Context &ctx) const {
+  return createChannelObj(toRecord(), ctx);
+}
+
 bool
 AnytoneCodeplug::ChannelElement::linkChannelObj(Channel *c, Context &ctx) const {
   if (Mode::Digital == mode()) {
@@ -903,25 +926,40 @@ AnytoneCodeplug::ContactElement::setAlertType(AnytoneContactExtension::AlertType
   setUInt8(0x0027, (unsigned)type);
 }
 
+AnytoneCodeplug::ContactElement::Record
+AnytoneCodeplug::ContactElement::toRecord() const {
+  Record rec;
+  rec.type = type();
+  rec.name = name();
+  rec.number = number();
+  rec.alertType = alertType();
+  return rec;
+}
+
 DigitalContact *
-AnytoneCodeplug::ContactElement::toContactObj(Context &ctx) const {
+AnytoneCodeplug::ContactElement::createContactObj(const Record &rec, Context &ctx) const {
   Q_UNUSED(ctx);
 
   // Common settings
   DigitalContact *cont = new DigitalContact();
-  cont->setType(type());
-  cont->setName(name());
-  cont->setNumber(number());
-  cont->setRing(AnytoneContactExtension::AlertType::None != alertType());
+  cont->setType(rec.type);
+  cont->setName(rec.name);
+  cont->setNumber(rec.number);
+  cont->setRing(AnytoneContactExtension::AlertType::None != rec.alertType);
 
   // Create AnyTone specific extension
   AnytoneContactExtension *ext = new AnytoneContactExtension();
   cont->setAnytoneExtension(ext);
-  ext->setAlertType(alertType());
+  ext->setAlertType(rec.alertType);
 
   return cont;
 }
 
+DigitalContact *
+AnytoneCodeplug::ContactElement::toContactObj(Context &ctx) const {
+  return createContactObj(toRecord(), ctx);
+}
+
 bool
 AnytoneCodeplug::ContactElement::fromContactObj(const DigitalContact *contact, Context &ctx) {
   Q_UNUSED(ctx)
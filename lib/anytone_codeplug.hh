@@ -72,6 +72,23 @@ public:
       FiveTone = 3                ///< Use 5-tone.
     };
 
+    /** The settings of the channel element needed to construct a channel object. In contrast to
+     * the channel object, a record can be decoded by any thread. */
+    struct Record {
+      Mode mode;                          ///< The channel mode.
+      Admit admit;                        ///< The admit criterion.
+      Signaling::Code rxTone;             ///< The RX subtone.
+      Signaling::Code txTone;             ///< The TX subtone.
+      AnalogChannel::Bandwidth bandwidth; ///< The bandwidth.
+      unsigned colorCode;                 ///< The color code.
+      DigitalChannel::TimeSlot timeSlot;  ///< The time slot.
+      QString name;                       ///< The channel name.
+      unsigned rxFrequency;               ///< The RX frequency in Hz.
+      unsigned txFrequency;               ///< The TX frequency in Hz.
+      Channel::Power power;               ///< The power setting.
+      bool rxOnly;                        ///< The RX only flag.
+    };
+
   protected:
     /** Hidden constructor. */
     ChannelElement(uint8_t *ptr, unsigned size);
@@ -331,12 +348,21 @@ public:
     /** Enables/disables SMS. */
     virtual void enableSMS(bool enable);
 
+    /** Decodes the settings needed to construct a channel object. */
+    virtual Record toRecord() const;
+    /** Constructs a generic @c Channel object from the given record, decoded from this codeplug
+     * channel. */
+    virtual Channel *createChannelObj(const Record &rec, Context &ctx) const;
     /** Constructs a generic @c Channel object from the codeplug channel. */
     virtual Channel *toChannelObj(Context &ctx) const;
     /** Links a previously constructed channel to the rest of the configuration. */
     virtual bool linkChannelObj(Channel *c, Context &ctx) const;
     /** Initializes this codeplug channel from the given generic configuration. */
     virtual bool fromChannelObj(const Channel *c, Context &ctx);
+
+  protected:
+    /** Compile-time layout of the channel element. */
+    typedef ElementLayout<0x0040> Layout;
   };
 
   /** Represents the base class for conacts in all AnyTone codeplugs.
@@ -346,6 +372,16 @@ public:
    */
   class ContactElement: public Element
   {
+  public:
+    /** The settings of the contact element needed to construct a contact object. In contrast to
+     * the contact object, a record can be decoded by any thread. */
+    struct Record {
+      DigitalContact::Type type;                    ///< The contact type.
+      QString name;                                 ///< The contact name.
+      unsigned number;                              ///< The contact number.
+      AnytoneContactExtension::AlertType alertType; ///< The alert type.
+    };
+
   protected:
     /** Hidden constructor. */
     ContactElement(uint8_t *ptr, unsigned size);
@@ -381,6 +417,10 @@ public:
     /** Sets the alert type. */
     virtual void setAlertType(AnytoneContactExtension::AlertType type);
 
+    /** Decodes the settings needed to construct a contact object. */
+    virtual Record toRecord() const;
+    /** Assembles a @c DigitalContact from the given record, decoded from this contact. */
+    virtual DigitalContact *createContactObj(const Record &rec, Context &ctx) const;
     /** Assembles a @c DigitalContact from this contact. */
     virtual DigitalContact *toContactObj(Context &ctx) const;
     /** Constructs this contact from the give @c DigitalContact. */
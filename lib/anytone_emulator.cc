@@ -0,0 +1,118 @@
+#include "anytone_emulator.hh"
+#include "anytone_interface.hh"
+#include "logger.hh"
+#include <QtEndian>
+
+#define RBSIZE 16
+#define ACK 0x06
+#define NAK 0x15
+
+/* ********************************************************************************************* *
+ * Implementation of AnytoneEmulator
+ * ********************************************************************************************* */
+AnytoneEmulator::AnytoneEmulator(const QString &model, const QString &version, QObject *parent)
+  : SerialEmulator(AnytoneInterface::interfaceInfo(), parent), _model(model), _version(version),
+    _program(false)
+{
+  start();
+}
+
+AnytoneEmulator::~AnytoneEmulator() {
+  stop();
+}
+
+bool
+AnytoneEmulator::inProgramMode() const {
+  return _program;
+}
+
+int
+AnytoneEmulator::handle(const QByteArray &data) {
+  switch (data.at(0)) {
+  case 'P':
+    // Enter program mode
+    if (7 > data.size())
+      return 0;
+    if (! data.startsWith("PROGRAM"))
+      return -1;
+    _program = true;
+    respond(QByteArray("QX\x06", 3));
+    return 7;
+
+  case 0x02: {
+    // Identify (in program mode)
+    if (! _program)
+      return 1;
+    QByteArray resp(16, 0);
+    resp[0] = 'I';
+    QByteArray model = _model.toLocal8Bit().left(7);
+    resp.replace(1, model.size(), model);
+    resp[8] = 0x00;
+    QByteArray version = _version.toLocal8Bit().left(6);
+    resp.replace(9, version.size(), version);
+    resp[15] = ACK;
+    respond(resp);
+    return 1;
+  }
+
+  case 'R': {
+    // Read request: 'R', address (big endian), size
+    if (6 > data.size())
+      return 0;
+    if (! _program)
+      return 6;
+    uint32_t addr = qFromBigEndian<quint32>((const uchar *)data.constData()+1);
+    uint8_t size = data.at(5);
+    QByteArray resp(size+8, 0);
+    resp[0] = 'W';
+    resp.replace(1, 5, data.mid(1, 5));
+    read(0, addr, (uint8_t *)resp.data()+6, size);
+    uint8_t sum = 0;
+    for (int i=1; i<(size+6); i++)
+      sum += uint8_t(resp.at(i));
+    resp[size+6] = sum;
+    resp[size+7] = ACK;
+    respond(resp);
+    return 6;
+  }
+
+  case 'W': {
+    // Write request: 'W', address (big endian), size, data, sum, ACK
+    if (6 > data.size())
+      return 0;
+    uint8_t size = data.at(5);
+    if ((size+8) > data.size())
+      return 0;
+    if (! _program)
+      return size+8;
+    uint32_t addr = qFromBigEndian<quint32>((const uchar *)data.constData()+1);
+    uint8_t sum = 0;
+    for (int i=1; i<(size+6); i++)
+      sum += uint8_t(data.at(i));
+    if (sum != uint8_t(data.at(size+6))) {
+      logDebug() << "Emulated AnyTone: Invalid checksum in write request at 0x"
+                 << QString::number(addr, 16) << ".";
+      respond(QByteArray(1, NAK));
+      return size+8;
+    }
+    write(0, addr, (const uint8_t *)data.constData()+6, size);
+    respond(QByteArray(1, ACK));
+    return size+8;
+  }
+
+  case 'E':
+    // Leave program mode
+    if (3 > data.size())
+      return 0;
+    if (! data.startsWith("END"))
+      return -1;
+    _program = false;
+    respond(QByteArray(1, ACK));
+    return 3;
+
+  default:
+    break;
+  }
+
+  return -1;
+}
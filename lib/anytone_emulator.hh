@@ -0,0 +1,43 @@
+#ifndef ANYTONEEMULATOR_HH
+#define ANYTONEEMULATOR_HH
+
+#include "radioemulator.hh"
+
+/** Emulates the serial interface of AnyTone radios.
+ *
+ * Implements the PROGRAM, identify, R(ead), W(rite) and END commands of the AnyTone protocol on
+ * top of a pseudo terminal. The emulated radio reports the model and version passed to the
+ * constructor.
+ *
+ * @code
+ * AnytoneEmulator emulator("D878UV");
+ * emulator.setLatency(1000);
+ * Radio *radio = Radio::detect(emulator.descriptor());
+ * @endcode
+ *
+ * @ingroup emulator */
+class AnytoneEmulator: public SerialEmulator
+{
+public:
+  /** Constructs an emulator for the specified model (e.g., "D878UV") and version. */
+  explicit AnytoneEmulator(const QString &model="D878UV", const QString &version="V100",
+                           QObject *parent=nullptr);
+  /** Destructor. */
+  virtual ~AnytoneEmulator();
+
+  /** Returns @c true if the emulated radio is in program mode. */
+  bool inProgramMode() const;
+
+protected:
+  int handle(const QByteArray &data);
+
+protected:
+  /** The model name. */
+  QString _model;
+  /** The version string. */
+  QString _version;
+  /** If @c true, the emulated radio is in program mode. */
+  volatile bool _program;
+};
+
+#endif // ANYTONEEMULATOR_HH
@@ -1,10 +1,18 @@
 #include "anytone_interface.hh"
 #include "logger.hh"
 #include <QtEndian>
+#include <vector>
+#include <algorithm>
 
 #define USB_VID 0x28e9
 #define USB_PID 0x018a
 
+#define RBSIZE 16
+#define WBSIZE 16
+#define DEFAULT_READ_WINDOW 8
+#define DEFAULT_WRITE_WINDOW 8
+#define DRAIN_TIMEOUT 100
+
 /* ********************************************************************************************* *
  * Implementation of AnytoneInterface::ReadRequest
  * ********************************************************************************************* */
@@ -86,7 +94,8 @@ AnytoneInterface::RadioVariant::isValid() const {
  * Implementation of AnytoneInterface
  * ********************************************************************************************* */
 AnytoneInterface::AnytoneInterface(const USBDeviceDescriptor &descriptor, const ErrorStack &err, QObject *parent)
-  : USBSerial(descriptor, err, parent), _state(STATE_INITIALIZED), _info()
+  : USBSerial(descriptor, err, parent), _state(STATE_INITIALIZED), _info(),
+    _readWindow(DEFAULT_READ_WINDOW), _writeWindow(DEFAULT_WRITE_WINDOW)
 {
   if (isOpen()) {
     _state = STATE_OPEN;
@@ -166,6 +175,26 @@ AnytoneInterface::getInfo(RadioVariant &info) {
   return false;
 }
 
+unsigned
+AnytoneInterface::readWindow() const {
+  return _readWindow;
+}
+
+void
+AnytoneInterface::setReadWindow(unsigned window) {
+  _readWindow = std::max(1U, window);
+}
+
+unsigned
+AnytoneInterface::writeWindow() const {
+  return _writeWindow;
+}
+
+void
+AnytoneInterface::setWriteWindow(unsigned window) {
+  _writeWindow = std::max(1U, window);
+}
+
 bool
 AnytoneInterface::write_start(uint32_t bank, uint32_t addr, const ErrorStack &err)
 {
@@ -179,6 +208,8 @@ AnytoneInterface::write_start(uint32_t bank, uint32_t addr, const ErrorStack &er
 bool
 AnytoneInterface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err)
 {
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Write, nbytes);
+
   if (0 != bank) {
     errMsg(err) << "Anytone: Cannot write to bank " << bank << ". There is only one (idx=0).";
     return false;
@@ -191,18 +222,85 @@ AnytoneInterface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
 
   //logDebug() << "Anytone: Write " << nbytes << "b to addr 0x" << QString::number(addr, 16) << "...";
 
-  for (int i=0; i<nbytes; i+=16) {
-    uint8_t ack;
-    WriteRequest req(addr+i, (const char *)(data+i));
-    if (! send_receive((const char *)&req, sizeof(WriteRequest),(char *)&ack, 1, err)) {
-      errMsg(err) << "Anytone: Cannot write data to device.";
+  if ((1 < _writeWindow) && (WBSIZE < nbytes))
+    return write_pipelined(addr, data, nbytes, err);
+
+  for (int i=0; i<nbytes; i+=WBSIZE) {
+    if (! write_block(addr+i, data+i, err))
       return false;
+  }
+
+  return true;
+}
+
+bool
+AnytoneInterface::write_block(uint32_t addr, const uint8_t *data, const ErrorStack &err) {
+  uint8_t ack;
+  WriteRequest req(addr, (const char *)data);
+  if (! send_receive((const char *)&req, sizeof(WriteRequest),(char *)&ack, 1, err)) {
+    errMsg(err) << "Anytone: Cannot write data to device.";
+    return false;
+  }
+  if (0x06 != ack) {
+    errMsg(err) << "Anytone: Cannot write data to device: Unexpected response "
+                << (int)ack << ", expected 6.";
+    return false;
+  }
+  return true;
+}
+
+bool
+AnytoneInterface::write_pipelined(uint32_t addr, const uint8_t *data, int nbytes, const ErrorStack &err) {
+  unsigned nblocks = nbytes/WBSIZE;
+  unsigned sent = 0, acked = 0;
+  bool insync = true;
+
+  while (acked < nblocks) {
+    // Keep the window of outstanding requests filled
+    while ((sent < nblocks) && ((sent-acked) < _writeWindow)) {
+      WriteRequest req(addr + sent*WBSIZE, (const char *)(data + sent*WBSIZE));
+      if (sizeof(WriteRequest) != QSerialPort::write((const char *)&req, sizeof(WriteRequest))) {
+        errMsg(err) << "Cannot send command to device.";
+        close();
+        _state = STATE_ERROR;
+        return false;
+      }
+      sent++;
+    }
+
+    // Acknowledgements arrive in the order of the requests
+    uint8_t ack;
+    if (! receive((char *)&ack, 1, 1000)) {
+      _metrics.addTimeout(TransferMetrics::Write);
+      logDebug() << "Anytone: Timeout in pipelined write at 0x"
+                 << QString::number(addr + acked*WBSIZE, 16)
+                 << ", fall back to single-block writes.";
+      insync = false;
+      break;
     }
     if (0x06 != ack) {
-      errMsg(err) << "Anytone: Cannot write data to device: Unexpected response "
-                  << (int)ack << ", expected 6.";
-      return false;
+      logDebug() << "Anytone: Unexpected response " << (int)ack << " in pipelined write at 0x"
+                 << QString::number(addr + acked*WBSIZE, 16)
+                 << ", fall back to single-block writes.";
+      insync = false;
+      break;
     }
+    acked++;
+  }
+
+  if (! insync) {
+    // Drain pending acknowledgements and shrink window for the rest of the session
+    while (waitForReadyRead(DRAIN_TIMEOUT))
+      QSerialPort::readAll();
+    QSerialPort::clear(QSerialPort::Input);
+    _writeWindow = std::max(1U, _writeWindow/2);
+  }
+
+  // Write all blocks again, that were not acknowledged
+  for (unsigned i=acked; i<nblocks; i++) {
+    _metrics.addRetry(TransferMetrics::Write);
+    if (! write_block(addr+i*WBSIZE, data+i*WBSIZE, err))
+      return false;
   }
 
   return true;
@@ -226,6 +324,8 @@ AnytoneInterface::read_start(uint32_t bank, uint32_t addr, const ErrorStack &err
 
 bool
 AnytoneInterface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err) {
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Read, nbytes);
+
   if (0 != bank) {
     errMsg(err) << "Anytone: Cannot read from bank " << bank << ". There is only one (idx=0).";
     return false;
@@ -238,20 +338,97 @@ AnytoneInterface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
 
   //logDebug() << "Anytone: Read " << nbytes << "b from addr 0x" << QString::number(addr, 16) << "...";
 
-  for (int i=0; i<nbytes; i+=16) {
-    ReadRequest req(addr + i);
-    ReadResponse resp;
-    if (! send_receive((const char *)&req, sizeof(ReadRequest),
-                       (char *)&resp, sizeof(ReadResponse), err)) {
-      errMsg(err) << "Anytone: Cannot read data from device.";
+  if ((1 < _readWindow) && (RBSIZE < nbytes))
+    return read_pipelined(addr, data, nbytes, err);
+
+  for (int i=0; i<nbytes; i+=RBSIZE) {
+    if (! read_block(addr+i, data+i, err))
       return false;
+  }
+
+  return true;
+}
+
+bool
+AnytoneInterface::read_block(uint32_t addr, uint8_t *data, const ErrorStack &err) {
+  ReadRequest req(addr);
+  ReadResponse resp;
+  if (! send_receive((const char *)&req, sizeof(ReadRequest),
+                     (char *)&resp, sizeof(ReadResponse), err)) {
+    errMsg(err) << "Anytone: Cannot read data from device.";
+    return false;
+  }
+  QString error_message;
+  if (! resp.check(addr, error_message)) {
+    errMsg(err) << "Anytone: Cannot read data from device: " << error_message << ".";
+    return false;
+  }
+  memcpy(data, resp.data, RBSIZE);
+  return true;
+}
+
+bool
+AnytoneInterface::read_pipelined(uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err) {
+  unsigned nblocks = nbytes/RBSIZE;
+  std::vector<bool> received(nblocks, false);
+  unsigned sent = 0, pending = 0;
+  bool insync = true;
+
+  while (insync && ((sent < nblocks) || (0 < pending))) {
+    // Keep the window of outstanding requests filled
+    while ((sent < nblocks) && (pending < _readWindow)) {
+      ReadRequest req(addr + sent*RBSIZE);
+      if (sizeof(ReadRequest) != QSerialPort::write((const char *)&req, sizeof(ReadRequest))) {
+        errMsg(err) << "Cannot send command to device.";
+        close();
+        _state = STATE_ERROR;
+        return false;
+      }
+      sent++; pending++;
+    }
+
+    // Wait for the next response
+    ReadResponse resp;
+    if (! receive((char *)&resp, sizeof(ReadResponse), 1000)) {
+      _metrics.addTimeout(TransferMetrics::Read);
+      logDebug() << "Anytone: Timeout in pipelined read at 0x"
+                 << QString::number(addr + (sent-pending)*RBSIZE, 16)
+                 << ", fall back to single-block reads.";
+      insync = false;
+      break;
     }
+    pending--;
+
+    // Match response by address and verify checksum
+    uint32_t raddr = qFromBigEndian(resp.addr);
     QString error_message;
-    if (! resp.check(addr+i, error_message)) {
-      errMsg(err) << "Anytone: Cannot read data from device: " << error_message << ".";
-      return false;
+    if ((raddr < addr) || (raddr >= (addr+nblocks*RBSIZE)) || (0 != ((raddr-addr)%RBSIZE))
+        || (! resp.check(raddr, error_message))) {
+      logDebug() << "Anytone: Invalid response in pipelined read: " << error_message
+                 << " Fall back to single-block reads.";
+      insync = false;
+      break;
     }
-    memcpy(data+i, resp.data, 16);
+    unsigned idx = (raddr-addr)/RBSIZE;
+    memcpy(data+idx*RBSIZE, resp.data, RBSIZE);
+    received[idx] = true;
+  }
+
+  if (! insync) {
+    // Drain pending responses and shrink window for the rest of the session
+    while (waitForReadyRead(DRAIN_TIMEOUT))
+      QSerialPort::readAll();
+    QSerialPort::clear(QSerialPort::Input);
+    _readWindow = std::max(1U, _readWindow/2);
+  }
+
+  // Retry only those blocks, that were not received
+  for (unsigned i=0; i<nblocks; i++) {
+    if (received[i])
+      continue;
+    _metrics.addRetry(TransferMetrics::Read);
+    if (! read_block(addr+i*RBSIZE, data+i*RBSIZE, err))
+      return false;
   }
 
   return true;
@@ -287,6 +464,7 @@ AnytoneInterface::enter_program_mode(const ErrorStack &err) {
     return false;
   }
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::EnterProgramMode);
   char ack[3];
   // send "enter program mode" command
   if (! send_receive("PROGRAM", 7, ack, 3, err)) {
@@ -346,6 +524,7 @@ AnytoneInterface::leave_program_mode(const ErrorStack &err) {
     return false;
   }
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::LeaveProgramMode);
   char ack[1];
   if (! send_receive("END", 3, ack, 1)) {
     errMsg(err) << "Anytone: Cannot leave program mode.";
@@ -392,3 +571,19 @@ AnytoneInterface::send_receive(const char *cmd, int clen, char *resp, int rlen,
   // done
   return true;
 }
+
+bool
+AnytoneInterface::receive(char *resp, int rlen, int timeout) {
+  char *p = resp;
+  int len = rlen;
+  while (len > 0) {
+    if ((0 == bytesAvailable()) && (! waitForReadyRead(timeout)))
+      return false;
+    int r = QSerialPort::read(p, len);
+    if (r < 0)
+      return false;
+    p += r;
+    len -= r;
+  }
+  return true;
+}
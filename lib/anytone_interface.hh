@@ -59,6 +59,19 @@ public:
 
   bool reboot(const ErrorStack &err=ErrorStack());
 
+  /** Returns the number of read requests that may be outstanding at the same time. */
+  unsigned readWindow() const;
+  /** Sets the number of read requests that may be outstanding at the same time.
+   * A window of 1 disables pipelined reads, that is, each read request waits for its response
+   * before the next one gets send. */
+  void setReadWindow(unsigned window);
+  /** Returns the number of write requests that may be outstanding at the same time. */
+  unsigned writeWindow() const;
+  /** Sets the number of write requests that may be outstanding at the same time.
+   * A window of 1 disables pipelined writes, that is, each write request waits for its
+   * acknowledgement before the next one gets send. */
+  void setWriteWindow(unsigned window);
+
 public:
   /** Returns some information about this interface. */
   static USBDeviceInfo interfaceInfo();
@@ -74,6 +87,21 @@ protected:
   bool leave_program_mode(const ErrorStack &err=ErrorStack());
   /** Internal used method to send messages to and receive responses from radio. */
   bool send_receive(const char *cmd, int clen, char *resp, int rlen, const ErrorStack &err=ErrorStack());
+  /** Internal used method to read a single 16b block from the radio. */
+  bool read_block(uint32_t addr, uint8_t *data, const ErrorStack &err=ErrorStack());
+  /** Internal used method to read several consecutive 16b blocks from the radio, keeping up to
+   * @c readWindow() read requests outstanding. Responses are matched by address and checksum,
+   * blocks that failed are read again one-by-one. */
+  bool read_pipelined(uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err=ErrorStack());
+  /** Internal used method to write a single 16b block to the radio. */
+  bool write_block(uint32_t addr, const uint8_t *data, const ErrorStack &err=ErrorStack());
+  /** Internal used method to write several consecutive 16b blocks to the radio, keeping up to
+   * @c writeWindow() write requests outstanding. The acknowledgements are received in order. Once
+   * a block is not acknowledged, this block and all following ones are written again one-by-one. */
+  bool write_pipelined(uint32_t addr, const uint8_t *data, int nbytes, const ErrorStack &err=ErrorStack());
+  /** Internal used method to receive exactly @c rlen bytes without closing the device on a
+   * timeout. */
+  bool receive(char *resp, int rlen, int timeout);
 
 protected:
   /** Binary representation of a read request to the radio. */
@@ -137,6 +165,10 @@ protected:
   State _state;
   /** Holds the radio info. */
   RadioVariant _info;
+  /** Maximum number of outstanding read requests. */
+  unsigned _readWindow;
+  /** Maximum number of outstanding write requests. */
+  unsigned _writeWindow;
 };
 
 #endif // ANYTONEINTERFACE_HH
@@ -3,14 +3,19 @@
 #include "d868uv.hh"
 #include "config.hh"
 #include "logger.hh"
+#include "codeplugcache.hh"
+#include "codeplugsession.hh"
+#include "crc32.hh"
 
 #define RBSIZE 16
 #define WBSIZE 16
+/** Maximum gap in bytes between two elements, that get read at once. */
+#define READ_GAP 0x100
 
 
 AnytoneRadio::AnytoneRadio(const QString &name, AnytoneInterface *device, QObject *parent)
   : Radio(parent), _name(name), _dev(device), _codeplugFlags(), _config(nullptr),
-    _codeplug(nullptr), _callsigns(nullptr)
+    _codeplug(nullptr), _callsigns(nullptr), _callsignSelection()
 {
   // Check if device is open
   if ((nullptr==_dev) || (! _dev->isOpen())) {
@@ -45,6 +50,13 @@ AnytoneRadio::codeplug() {
   return *_codeplug;
 }
 
+const TransferMetrics *
+AnytoneRadio::metrics() const {
+  if (nullptr == _dev)
+    return nullptr;
+  return &_dev->metrics();
+}
+
 bool
 AnytoneRadio::startDownload(bool blocking, const ErrorStack &err) {
   if (StatusIdle != _task)
@@ -99,6 +111,7 @@ AnytoneRadio::startUploadCallsignDB(UserDatabase *db, bool blocking, const Calls
   _callsigns->encode(db, selection);
 
   _task = StatusUploadCallsigns;
+  _callsignSelection = selection;
   _errorStack = err;
 
   if (blocking) {
@@ -192,14 +205,9 @@ AnytoneRadio::download() {
   logDebug() << "Download of " << _codeplug->image(0).numElements() << " bitmaps.";
 
   // Download bitmaps
-  for (int n=0; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot download codeplug.";
-      return false;
-    }
-    emit downloadProgress(float(n*100)/_codeplug->image(0).numElements());
+  if (! readTransfers(_codeplug->image(0), _codeplug->image(0).planTransfers(READ_GAP), 0, 10)) {
+    errMsg(_errorStack) << "Cannot download codeplug.";
+    return false;
   }
 
   // Allocate remaining memory sections
@@ -211,21 +219,17 @@ AnytoneRadio::download() {
     if (! _codeplug->image(0).element(n).isAligned(RBSIZE)) {
       errMsg(_errorStack) << "Cannot download codeplug: Codeplug element " << n
                           << " (addr=" << _codeplug->image(0).element(n).address()
-                          << ", size=" << _codeplug->image(0).element(n).data().size()
+                          << ", size=" << _codeplug->image(0).element(n).memSize()
                           << ") is not aligned with blocksize " << RBSIZE << ".";
       return false;
     }
   }
 
   // Download remaining memory sections
-  for (int n=nstart; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot download codeplug.";
-      return false;
-    }
-    emit downloadProgress(float(n*100)/_codeplug->image(0).numElements());
+  if (! readTransfers(_codeplug->image(0), _codeplug->image(0).planTransfers(READ_GAP, 0, nstart),
+                      10, 100)) {
+    errMsg(_errorStack) << "Cannot download codeplug.";
+    return false;
   }
 
   return true;
@@ -239,55 +243,150 @@ AnytoneRadio::upload() {
   }
 
   // Download bitmaps first
-  size_t nbitmaps = _codeplug->numImages();
-  for (int n=0; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot read codeplug for update.";
-      return false;
-    }
-    emit uploadProgress(float(n*25)/_codeplug->image(0).numElements());
+  size_t nbitmaps = _codeplug->image(0).numElements();
+  if (! readTransfers(_codeplug->image(0), _codeplug->image(0).planTransfers(READ_GAP), 0, 5)) {
+    errMsg(_errorStack) << "Cannot read codeplug for update.";
+    return false;
   }
 
   // Allocate all memory sections that must be read first
   // and written back to the device more or less untouched
   _codeplug->allocateUpdated();
 
-  // Download new memory sections for update
-  for (int n=nbitmaps; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot read codeplug for update.";
-      return false;
+  // Assemble fingerprint from bitmaps and some sampled blocks and try to restore the remaining
+  // memory sections from the cache
+  AnytoneInterface::RadioVariant variant; _dev->getInfo(variant);
+  CodeplugCache cache(_dev->identifier(), variant.version);
+  // Without a known firmware version, a cached image may be stale
+  bool useCache = _codeplugFlags.useImageCache && cache.isEnabled();
+  QVector<uint32_t> samples;
+  bool restored = false;
+  if (useCache) {
+    for (size_t n=0; n<nbitmaps; n++) {
+      unsigned addr = _codeplug->image(0).element(n).address();
+      unsigned size = _codeplug->image(0).element(n).memSize();
+      cache.addFingerprint(addr, _codeplug->data(addr), size);
     }
-    emit uploadProgress(25+float(n*25)/_codeplug->image(0).numElements());
+    samples = CodeplugCache::samples(_codeplug->image(0), RBSIZE, nbitmaps);
+    foreach (uint32_t addr, samples) {
+      if (! _dev->read(0, addr, _codeplug->data(addr), RBSIZE, _errorStack)) {
+        errMsg(_errorStack) << "Cannot read codeplug for update.";
+        return false;
+      }
+      cache.addFingerprint(addr, _codeplug->data(addr), RBSIZE);
+    }
+    if (cache.load() && cache.restore(_codeplug->image(0), nbitmaps)) {
+      logDebug() << "Restored codeplug from cache, skip read-back.";
+      restored = true;
+    }
+  }
+
+  // Download new memory sections for update
+  if ((! restored) && (! readTransfers(_codeplug->image(0),
+                                       _codeplug->image(0).planTransfers(READ_GAP, 0, nbitmaps),
+                                       5, 50))) {
+    errMsg(_errorStack) << "Cannot read codeplug for update.";
+    return false;
   }
 
+  // If only changed blocks are written, keep a copy of the device memory
+  DFUFile::Image device;
+  if (_codeplugFlags.diffUpload)
+    device = _codeplug->image(0);
+  size_t nupdated = _codeplug->image(0).numElements();
+
   // Update bitmaps for all elements representing the common Config
   _codeplug->setBitmaps(_config);
   // Allocate all memory elements representing the common config
   _codeplug->allocateForEncoding();
 
+  // Download the current content of the newly allocated elements into the copy
+  if (_codeplugFlags.diffUpload) {
+    for (int n=nupdated; n<_codeplug->image(0).numElements(); n++)
+      device.addElement(_codeplug->image(0).element(n).address(),
+                        _codeplug->image(0).element(n).memSize());
+    QVector<DFUFile::Image::Transfer> missing;
+    foreach (const DFUFile::Image::Transfer &t, device.planTransfers(READ_GAP, 0, nupdated)) {
+      bool hit = true;
+      foreach (int idx, t.elements) {
+        DFUFile::Element &el = device.element(idx);
+        hit = hit && cache.restore(el.address(), el.data(), el.memSize());
+      }
+      if (! hit)
+        missing.append(t);
+    }
+    if (! readTransfers(device, missing, 50, 50)) {
+      errMsg(_errorStack) << "Cannot read codeplug for update.";
+      return false;
+    }
+  }
+
+  // If the codeplug was restored from the cache and the cached elements representing the config
+  // hold the last encoding of the session, restore them too. Then, only the modified objects
+  // need to be encoded.
+  bool useSession = (nullptr != _session) && (_config == _session->config());
+  bool retained = false;
+  if (useSession && restored && _session->isRetained()) {
+    CRC32 crc; QByteArray buffer; bool hit = true;
+    for (int n=nupdated; hit && (n<_codeplug->image(0).numElements()); n++) {
+      const DFUFile::Element &el = _codeplug->image(0).element(n);
+      buffer.resize(el.memSize());
+      hit = cache.restore(el.address(), (uint8_t *)buffer.data(), el.memSize());
+      crc.update(buffer);
+    }
+    if (hit && (crc.get() == _session->checksum()))
+      retained = cache.restore(_codeplug->image(0), nupdated);
+  }
+
   // Update binary codeplug from config
-  if (! _codeplug->encode(_config, _codeplugFlags, _errorStack)) {
+  bool encoded = useSession ? _session->encode(_codeplug, _codeplugFlags, retained, _errorStack)
+                            : _codeplug->encode(_config, _codeplugFlags, _errorStack);
+  if (! encoded) {
     errMsg(_errorStack) << "Cannot encode codeplug.";
     return false;
   }
 
+  // Remember the checksum of the encoded elements for the next upload
+  if (useSession) {
+    CRC32 crc;
+    for (int n=nupdated; n<_codeplug->image(0).numElements(); n++)
+      crc.update(_codeplug->image(0).element(n).data(), _codeplug->image(0).element(n).memSize());
+    _session->setChecksum(crc.get());
+  }
+
+  // Update fingerprint from the encoded codeplug
+  if (useCache) {
+    cache.clearFingerprint();
+    for (size_t n=0; n<nbitmaps; n++) {
+      unsigned addr = _codeplug->image(0).element(n).address();
+      unsigned size = _codeplug->image(0).element(n).memSize();
+      cache.addFingerprint(addr, _codeplug->data(addr), size);
+    }
+    foreach (uint32_t addr, samples)
+      cache.addFingerprint(addr, _codeplug->data(addr), RBSIZE);
+  }
+
   // Sort all elements before uploading
   _codeplug->image(0).sort();
 
   // Upload all elements back to the device
-  for (int n=0; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->write(0, addr, _codeplug->data(addr), size, _errorStack)) {
+  if (! _codeplugFlags.diffUpload) {
+    if (! writeTransfers(_codeplug->image(0), _codeplug->image(0).planTransfers(), 50, 100)) {
+      errMsg(_errorStack) << "Cannot write codeplug.";
+      return false;
+    }
+  } else {
+    if (! writeChangedBlocks(_codeplug->image(0), device, 50, 100)) {
       errMsg(_errorStack) << "Cannot write codeplug.";
       return false;
     }
-    emit uploadProgress(50+float(n*50)/_codeplug->image(0).numElements());
+  }
+
+  // Store the image written in the cache
+  if (useCache) {
+    ErrorStack cacheErr;
+    if (! cache.store(*_codeplug, cacheErr))
+      logWarn() << "Cannot store codeplug image in cache: " << cacheErr.format();
   }
 
   return true;
@@ -299,23 +398,158 @@ AnytoneRadio::uploadCallsigns() {
   // Sort all elements before uploading
   _callsigns->image(0).sort();
 
-  size_t totalBlocks = _callsigns->memSize()/WBSIZE;
-  size_t blkWritten  = 0;
   // Upload all elements back to the device
-  for (int n=0; n<_callsigns->image(0).numElements(); n++) {
-    unsigned addr = _callsigns->image(0).element(n).address();
-    unsigned size = _callsigns->image(0).element(n).data().size();
-    unsigned nblks = size/WBSIZE;
-    for (unsigned i=0; i<nblks; i++) {
-      if (! _dev->write(0, addr+i*WBSIZE, _callsigns->data(addr)+i*WBSIZE, WBSIZE, _errorStack)) {
-        errMsg(_errorStack) << "Cannot write callsign db.";
-        _task = StatusError;
-        return false;
-      }
-      blkWritten++;
-      emit uploadProgress(float(blkWritten*100)/totalBlocks);
+  if (! _callsignSelection.incrementalUpload()) {
+    if (! writeTransfers(_callsigns->image(0), _callsigns->image(0).planTransfers(), 0, 100)) {
+      errMsg(_errorStack) << "Cannot write callsign db.";
+      _task = StatusError;
+      return false;
     }
+    return true;
+  }
+
+  // Read the limits of the db currently stored in the device
+  DFUFile::Image device;
+  uint32_t laddr = _callsigns->limitsAddress();
+  device.addElement(laddr, D868UVCallsignDB::LimitsElement::size());
+  if (! _dev->read(0, laddr, device.data(laddr), D868UVCallsignDB::LimitsElement::size(), _errorStack)) {
+    errMsg(_errorStack) << "Cannot read callsign db limits.";
+    _task = StatusError;
+    return false;
+  }
+  D868UVCallsignDB::LimitsElement limits(device.data(laddr));
+  unsigned count = limits.count(), size = limits.totalSize();
+  // Entries are at most 100b, anything else is garbage (e.g., erased memory)
+  if ((count > _callsigns->capacity()) || (size > count*0x64)) {
+    logDebug() << "No valid callsign db found in device, write all banks.";
+    count = size = 0;
+  }
+
+  // Read the index of the db currently stored in the device
+  _callsigns->allocateIndex(device, count);
+  if (! readTransfers(device, device.planTransfers(READ_GAP, 0, 1), 0, 10)) {
+    errMsg(_errorStack) << "Cannot read callsign db index.";
+    _task = StatusError;
+    return false;
+  }
+
+  // The entries cannot be derived from the index, as they may change without affecting the index.
+  // Hence, restore them from the cache if limits and index match the last upload to this device.
+  AnytoneInterface::RadioVariant variant; _dev->getInfo(variant);
+  CodeplugCache cache(_dev->identifier(), variant.version);
+  for (int i=0; i<device.numElements(); i++)
+    cache.addFingerprint(device.element(i).address(), device.data(device.element(i).address()),
+                         device.element(i).memSize());
+  DFUFile::Image entries;
+  _callsigns->allocateEntries(entries, size);
+  if (count && cache.load() && cache.restore(entries)) {
+    logDebug() << "Restored callsign db entries from cache.";
+    for (int i=0; i<entries.numElements(); i++)
+      device.addElement(entries.element(i));
+  }
+
+  // Write only those blocks that differ
+  if (! writeChangedBlocks(_callsigns->image(0), device, 10, 100)) {
+    errMsg(_errorStack) << "Cannot write callsign db.";
+    _task = StatusError;
+    return false;
+  }
+
+  // Store the written db in the cache, the fingerprint is taken from the new limits and index
+  if (cache.isEnabled()) {
+    cache.clearFingerprint();
+    DFUFile::Image index;
+    index.addElement(laddr, D868UVCallsignDB::LimitsElement::size());
+    _callsigns->allocateIndex(index, D868UVCallsignDB::LimitsElement(_callsigns->data(laddr)).count());
+    for (int i=0; i<index.numElements(); i++)
+      cache.addFingerprint(index.element(i).address(), _callsigns->data(index.element(i).address()),
+                           index.element(i).memSize());
+    ErrorStack cacheErr;
+    if (! cache.store(*_callsigns, cacheErr))
+      logWarn() << "Cannot store callsign DB image in cache: " << cacheErr.format();
+  }
+
+  return true;
+}
+
+bool
+AnytoneRadio::readTransfers(DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                            float p0, float p1)
+{
+  size_t total = 0, count = 0;
+  foreach (const DFUFile::Image::Transfer &t, transfers)
+    total += t.size;
+
+  QByteArray buffer;
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    buffer.resize(t.size);
+    if (! _dev->read(0, t.address, (uint8_t *)buffer.data(), t.size, _errorStack))
+      return false;
+    image.scatter(t, buffer);
+    count += t.size;
+    if (StatusDownload == _task)
+      emit downloadProgress(p0 + float(count*(p1-p0))/total);
+    else
+      emit uploadProgress(p0 + float(count*(p1-p0))/total);
   }
 
   return true;
 }
+
+bool
+AnytoneRadio::writeTransfers(const DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                             float p0, float p1)
+{
+  size_t total = 0, count = 0;
+  foreach (const DFUFile::Image::Transfer &t, transfers)
+    total += t.size;
+
+  QByteArray buffer;
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    image.gather(t, buffer);
+    if (! _dev->write(0, t.address, (uint8_t *)buffer.data(), t.size, _errorStack))
+      return false;
+    count += t.size;
+    emit uploadProgress(p0 + float(count*(p1-p0))/total);
+  }
+
+  return true;
+}
+
+bool
+AnytoneRadio::writeChangedBlocks(const DFUFile::Image &image, const DFUFile::Image &device,
+                                 float p0, float p1)
+{
+  size_t totalBlocks = 0, skippedBlocks = 0;
+  for (int n=0; n<image.numElements(); n++) {
+    unsigned addr = image.element(n).address();
+    unsigned size = image.element(n).memSize();
+    // Write only runs of blocks that differ from the device memory
+    const unsigned char *ptr = image.element(n).data();
+    unsigned start = 0, count = 0;
+    for (unsigned o=0; o<=size; o+=WBSIZE) {
+      bool changed = false;
+      if (o < size) {
+        const unsigned char *old = device.data(addr+o);
+        changed = (nullptr == old) || (0 != memcmp(old, ptr+o, WBSIZE));
+        totalBlocks++;
+      }
+      if (changed) {
+        if (0 == count)
+          start = o;
+        count++;
+        continue;
+      }
+      if (o < size)
+        skippedBlocks++;
+      if (0 == count)
+        continue;
+      if (! _dev->write(0, addr+start, (uint8_t *)ptr+start, count*WBSIZE, _errorStack))
+        return false;
+      count = 0;
+    }
+    emit uploadProgress(p0 + float(n*(p1-p0))/image.numElements());
+  }
+  logInfo() << "Skipped " << skippedBlocks << " of " << totalBlocks << " unchanged blocks.";
+  return true;
+}
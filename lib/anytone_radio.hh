@@ -13,6 +13,7 @@
 #include "radio.hh"
 #include "anytone_interface.hh"
 #include "anytone_codeplug.hh"
+#include "d868uv_callsigndb.hh"
 
 /** Implements an interface to Anytone radios.
  *
@@ -45,6 +46,7 @@ public:
   const QString &name() const;
   const Codeplug &codeplug() const;
   Codeplug &codeplug();
+  const TransferMetrics *metrics() const;
 
 public slots:
   /** Starts the download of the codeplug and derives the generic configuration from it. */
@@ -70,6 +72,20 @@ private:
    * This method block until the upload is complete. */
   virtual bool uploadCallsigns();
 
+  /** Reads the given transfers from the device into the image. The progress gets reported
+   * linearly from @c p0 to @c p1 percent. */
+  bool readTransfers(DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                     float p0, float p1);
+  /** Writes the given transfers of the image to the device. The progress gets reported
+   * linearly from @c p0 to @c p1 percent. */
+  bool writeTransfers(const DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                      float p0, float p1);
+  /** Writes only those runs of blocks of the image to the device, that differ from the given copy
+   * of the device memory. Blocks not covered by the copy are considered changed. The progress gets
+   * reported linearly from @c p0 to @c p1 percent. */
+  bool writeChangedBlocks(const DFUFile::Image &image, const DFUFile::Image &device,
+                          float p0, float p1);
+
 protected:
   /** The device identifier. */
   QString _name;
@@ -85,7 +101,9 @@ protected:
   /** The actual binary codeplug representation. */
   AnytoneCodeplug *_codeplug;
   /** The actual binary callsign database representation. */
-  CallsignDB *_callsigns;
+  D868UVCallsignDB *_callsigns;
+  /** Selection of the callsign database, also controls the incremental upload. */
+  CallsignDB::Selection _callsignSelection;
 };
 
 #endif // __D868UV_HH__
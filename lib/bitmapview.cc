@@ -0,0 +1,103 @@
+#include "bitmapview.hh"
+#include <QtEndian>
+#include <QtAlgorithms>
+#include <cstring>
+#include <algorithm>
+
+
+BitmapView::BitmapView(uint8_t *data, unsigned size, bool inverted)
+  : _data(data), _size(size), _inverted(inverted)
+{
+  // pass...
+}
+
+unsigned
+BitmapView::size() const {
+  return _size;
+}
+
+bool
+BitmapView::isInverted() const {
+  return _inverted;
+}
+
+bool
+BitmapView::isSet(unsigned i) const {
+  if (i >= _size)
+    return false;
+  return _inverted != bool(_data[i/8] & (1 << (i%8)));
+}
+
+void
+BitmapView::set(unsigned i, bool marked) {
+  if (i >= _size)
+    return;
+  if (_inverted != marked)
+    _data[i/8] |= (1 << (i%8));
+  else
+    _data[i/8] &= ~(1 << (i%8));
+}
+
+void
+BitmapView::setRange(unsigned first, unsigned count, bool marked) {
+  if (first >= _size)
+    return;
+  unsigned last = (count > (_size-first)) ? _size : first+count;
+  // Leading bits up to the next byte boundary
+  for (; (first < last) && (first % 8); first++)
+    set(first, marked);
+  // Complete bytes
+  unsigned bytes = (last-first)/8;
+  memset(_data+first/8, (_inverted != marked) ? 0xff : 0x00, bytes);
+  first += 8*bytes;
+  // Remaining bits
+  for (; first < last; first++)
+    set(first, marked);
+}
+
+void
+BitmapView::clear() {
+  setRange(0, _size, false);
+}
+
+unsigned
+BitmapView::count() const {
+  unsigned n = 0;
+  for (unsigned i=0; i<_size; i+=64) {
+    uint64_t bits = word(i/8);
+    if ((_size-i) < 64)
+      bits &= (uint64_t(1) << (_size-i)) - 1;
+    n += qPopulationCount(quint64(bits));
+  }
+  return n;
+}
+
+unsigned
+BitmapView::first() const {
+  return next(0);
+}
+
+unsigned
+BitmapView::next(unsigned i) const {
+  while (i < _size) {
+    // Bits preceding i are shifted out
+    uint64_t bits = word(i/8) >> (i%8);
+    if (bits) {
+      i += qCountTrailingZeroBits(quint64(bits));
+      return (i < _size) ? i : _size;
+    }
+    i += 64 - (i%8);
+  }
+  return _size;
+}
+
+uint64_t
+BitmapView::word(unsigned byte) const {
+  unsigned bytes = (_size+7)/8;
+  uint8_t buffer[8];
+  memset(buffer, _inverted ? 0xff : 0x00, sizeof(buffer));
+  if (byte < bytes)
+    memcpy(buffer, _data+byte, std::min(8u, bytes-byte));
+  uint64_t bits = qFromLittleEndian<quint64>(buffer);
+  return _inverted ? ~bits : bits;
+}
@@ -0,0 +1,67 @@
+#ifndef BITMAPVIEW_HH
+#define BITMAPVIEW_HH
+
+#include <inttypes.h>
+
+/** A view onto a bitmap within a codeplug, marking the used slots of a table (e.g., channels or
+ * contacts).
+ *
+ * Bit @c i of the bitmap is stored in bit @c i%8 of byte @c i/8. Some codeplugs mark used slots by
+ * cleared bits, in this case the view is @e inverted. The view does not own the memory.
+ *
+ * In contrast to testing each slot individually, the bitmap is scanned 64 bits at a time. Hence
+ * iterating over the marked slots takes time proportional to the number of marked slots rather
+ * than the size of the table:
+ * @code
+ * BitmapView channels(data(CHANNEL_BITMAP), NUM_CHANNELS);
+ * for (unsigned i=channels.first(); i<channels.size(); i=channels.next(i+1)) {
+ *   // handle channel i
+ * }
+ * @endcode
+ *
+ * @ingroup util */
+class BitmapView
+{
+public:
+  /** Constructs a view onto @c size bits at the given memory.
+   * @param data Pointer to the bitmap.
+   * @param size The number of bits (slots).
+   * @param inverted If @c true, marked slots are represented by cleared bits. */
+  BitmapView(uint8_t *data, unsigned size, bool inverted=false);
+
+  /** Returns the number of slots. */
+  unsigned size() const;
+  /** Returns @c true if used slots are represented by cleared bits. */
+  bool isInverted() const;
+
+  /** Returns @c true if the i-th slot is marked. */
+  bool isSet(unsigned i) const;
+  /** Marks or unmarks the i-th slot. */
+  void set(unsigned i, bool marked=true);
+  /** Marks or unmarks @c count slots starting at @c first. */
+  void setRange(unsigned first, unsigned count, bool marked=true);
+  /** Unmarks all slots. */
+  void clear();
+
+  /** Returns the number of marked slots. */
+  unsigned count() const;
+  /** Returns the index of the first marked slot or @c size() if there is none. */
+  unsigned first() const;
+  /** Returns the index of the first marked slot not preceding @c i or @c size() if there is none. */
+  unsigned next(unsigned i) const;
+
+protected:
+  /** Returns the 64 bits starting at the given byte, each set bit represents a marked slot. Bits
+   * beyond the bitmap memory are cleared. */
+  uint64_t word(unsigned byte) const;
+
+protected:
+  /** The bitmap memory. */
+  uint8_t *_data;
+  /** The number of bits. */
+  unsigned _size;
+  /** If @c true, marked slots are represented by cleared bits. */
+  bool _inverted;
+};
+
+#endif // BITMAPVIEW_HH
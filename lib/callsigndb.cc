@@ -1,17 +1,23 @@
 #include "callsigndb.hh"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
 
 
 /* ********************************************************************************************* *
  * Implementation of CallsignDB::Selection
  * ********************************************************************************************* */
 CallsignDB::Selection::Selection(int64_t count)
-  : _count(count)
+  : _count(count), _prefixes(), _countries(), _states(), _idRanges(), _callsignPattern(),
+    _heard(), _incremental(false)
 {
   // pass...
 }
 
 CallsignDB::Selection::Selection(const Selection &other)
-  : _count(other._count)
+  : _count(other._count), _prefixes(other._prefixes), _countries(other._countries),
+    _states(other._states), _idRanges(other._idRanges), _callsignPattern(other._callsignPattern),
+    _heard(other._heard), _incremental(other._incremental)
 {
   // pass...
 }
@@ -38,6 +44,124 @@ CallsignDB::Selection::clearCountLimit() {
   _count = -1;
 }
 
+const QSet<unsigned> &
+CallsignDB::Selection::prefixes() const {
+  return _prefixes;
+}
+
+void
+CallsignDB::Selection::setPrefixes(const QSet<unsigned> &prefixes) {
+  _prefixes = prefixes;
+}
+
+bool
+CallsignDB::Selection::hasFilter() const {
+  return (! _countries.isEmpty()) || (! _states.isEmpty()) || (! _idRanges.isEmpty()) ||
+      (_callsignPattern.isValid() && (! _callsignPattern.pattern().isEmpty())) ||
+      (! _heard.isEmpty());
+}
+
+const QStringList &
+CallsignDB::Selection::countries() const {
+  return _countries;
+}
+void
+CallsignDB::Selection::setCountries(const QStringList &countries) {
+  _countries = countries;
+}
+
+const QStringList &
+CallsignDB::Selection::states() const {
+  return _states;
+}
+void
+CallsignDB::Selection::setStates(const QStringList &states) {
+  _states = states;
+}
+
+const QList<CallsignDB::Selection::IDRange> &
+CallsignDB::Selection::idRanges() const {
+  return _idRanges;
+}
+void
+CallsignDB::Selection::setIDRanges(const QList<IDRange> &ranges) {
+  _idRanges = ranges;
+}
+void
+CallsignDB::Selection::addIDRange(unsigned first, unsigned last) {
+  _idRanges.append(IDRange(std::min(first, last), std::max(first, last)));
+}
+
+const QRegularExpression &
+CallsignDB::Selection::callsignPattern() const {
+  return _callsignPattern;
+}
+void
+CallsignDB::Selection::setCallsignPattern(const QRegularExpression &pattern) {
+  _callsignPattern = pattern;
+}
+
+const QSet<unsigned> &
+CallsignDB::Selection::heard() const {
+  return _heard;
+}
+void
+CallsignDB::Selection::setHeard(const QSet<unsigned> &ids) {
+  _heard = ids;
+}
+
+bool
+CallsignDB::Selection::parseIDRanges(const QString &text, QList<IDRange> &ranges, const ErrorStack &err) {
+  foreach (QString range, text.split(",")) {
+    if (range.trimmed().isEmpty())
+      continue;
+    QStringList bounds = range.split("-");
+    bool ok1 = true, ok2 = true;
+    unsigned first = bounds.first().trimmed().toUInt(&ok1), last = first;
+    if (2 == bounds.size())
+      last = bounds.last().trimmed().toUInt(&ok2);
+    if ((2 < bounds.size()) || (! ok1) || (! ok2)) {
+      errMsg(err) << "Invalid ID range '" << range.trimmed() << "'.";
+      return false;
+    }
+    ranges.append(IDRange(std::min(first, last), std::max(first, last)));
+  }
+  return true;
+}
+
+bool
+CallsignDB::Selection::readHeard(const QString &filename, QSet<unsigned> &ids, const ErrorStack &err) {
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errMsg(err) << "Cannot open heard list '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+
+  QTextStream stream(&file);
+  QRegularExpression separator("[,;\\s]+");
+  while (! stream.atEnd()) {
+    foreach (QString field, stream.readLine().split(separator)) {
+      bool ok=true; unsigned id = field.remove('"').toUInt(&ok);
+      if (ok && (0 < id)) {
+        ids.insert(id);
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool
+CallsignDB::Selection::incrementalUpload() const {
+  return _incremental;
+}
+
+void
+CallsignDB::Selection::setIncrementalUpload(bool enable) {
+  _incremental = enable;
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of CallsignDB
@@ -2,6 +2,10 @@
 #define CALLSIGNDB_HH
 
 #include "dfufile.hh"
+#include <QSet>
+#include <QPair>
+#include <QStringList>
+#include <QRegularExpression>
 
 // Forward decl.
 class UserDatabase;
@@ -16,8 +20,17 @@ class CallsignDB : public DFUFile
 
 public:
   /** Controls the selection of callsigns from the @c UserDatabase to be encoded into the
-   * callsign db. */
+   * callsign db and how the encoded db gets written to the device.
+   *
+   * Besides the count limit and the prefixes, the users may be filtered by their country, state,
+   * DMR ID ranges, a callsign pattern and a list of recently heard IDs. A user is selected if it
+   * matches all specified filters. Within each filter, it is sufficient to match any of the given
+   * values. */
   class Selection {
+  public:
+    /** An inclusive range of DMR IDs. */
+    typedef QPair<unsigned, unsigned> IDRange;
+
   public:
     /** Constructor. */
     Selection(int64_t count=-1);
@@ -33,10 +46,73 @@ public:
     /** Clears the count limit. */
     void clearCountLimit();
 
+    /** Returns the IDs or prefixes, the selected callsigns are closest to. If empty, the first
+     * callsigns of the database are selected. */
+    const QSet<unsigned> &prefixes() const;
+    /** Selects the callsigns closest to any of the given IDs or prefixes. */
+    void setPrefixes(const QSet<unsigned> &prefixes);
+
+    /** Returns @c true if any filter is set. */
+    bool hasFilter() const;
+    /** Returns the countries, the selected users are located in. Matched case-insensitive. */
+    const QStringList &countries() const;
+    /** Sets the countries, the selected users are located in. */
+    void setCountries(const QStringList &countries);
+    /** Returns the states, the selected users are located in. Matched case-insensitive. */
+    const QStringList &states() const;
+    /** Sets the states, the selected users are located in. */
+    void setStates(const QStringList &states);
+    /** Returns the ID ranges, the IDs of the selected users are within. */
+    const QList<IDRange> &idRanges() const;
+    /** Sets the ID ranges, the IDs of the selected users are within. */
+    void setIDRanges(const QList<IDRange> &ranges);
+    /** Adds an inclusive range of IDs. */
+    void addIDRange(unsigned first, unsigned last);
+    /** Returns the pattern, the callsigns of the selected users start with. */
+    const QRegularExpression &callsignPattern() const;
+    /** Sets the pattern, the callsigns of the selected users start with. An invalid or empty
+     * pattern disables the filter. */
+    void setCallsignPattern(const QRegularExpression &pattern);
+    /** Returns the recently heard IDs. If not empty, only these users are selected. */
+    const QSet<unsigned> &heard() const;
+    /** Sets the recently heard IDs. */
+    void setHeard(const QSet<unsigned> &ids);
+
+    /** Parses a comma separated list of ID ranges like "2620000-2629999, 2340000-2349999". A single
+     * ID is a range on its own.
+     * @returns @c false on error. */
+    static bool parseIDRanges(const QString &text, QList<IDRange> &ranges,
+                              const ErrorStack &err=ErrorStack());
+    /** Reads the recently heard IDs from a text file. Each line holds a DMR ID. CSV files are
+     * accepted too, the first integer field of each line is taken then.
+     * @returns @c false on error. */
+    static bool readHeard(const QString &filename, QSet<unsigned> &ids,
+                          const ErrorStack &err=ErrorStack());
+
+    /** Returns @c true if only those parts of the callsign db get written, that differ from the
+     * db currently stored in the device. */
+    bool incrementalUpload() const;
+    /** Enables or disables the incremental upload. */
+    void setIncrementalUpload(bool enable);
+
   protected:
     /** Specifies the maximum amount of callsigns to add. If negative, the device limit should be
      * used. */
     int64_t _count;
+    /** The IDs or prefixes, the selected callsigns are closest to. */
+    QSet<unsigned> _prefixes;
+    /** The countries to select. */
+    QStringList _countries;
+    /** The states to select. */
+    QStringList _states;
+    /** The ID ranges to select. */
+    QList<IDRange> _idRanges;
+    /** The callsign pattern. */
+    QRegularExpression _callsignPattern;
+    /** The recently heard IDs. */
+    QSet<unsigned> _heard;
+    /** If @c true, only changed parts of the db get written. */
+    bool _incremental;
   };
 
 protected:
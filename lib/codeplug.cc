@@ -8,7 +8,8 @@
  * Implementation of CodePlug::Flags
  * ********************************************************************************************* */
 Codeplug::Flags::Flags()
-  : updateCodePlug(true), autoEnableGPS(false), autoEnableRoaming(false)
+  : updateCodePlug(true), autoEnableGPS(false), autoEnableRoaming(false), diffUpload(false),
+    useImageCache(false), parallelEncode(false)
 {
   // pass...
 }
@@ -538,11 +539,88 @@ Codeplug::Element::writeUnicode(unsigned offset, const QString &txt, unsigned ma
 }
 
 
+/* ********************************************************************************************* *
+ * Implementation of CodePlug::Context::Table
+ * ********************************************************************************************* */
+Codeplug::Context::Table::Table()
+  : _objects(), _keys(), _indices(), _count(0), _bits(0)
+{
+  // pass...
+}
+
+ConfigItem *
+Codeplug::Context::Table::obj(unsigned idx) const {
+  if (idx >= _objects.size())
+    return nullptr;
+  return _objects[idx];
+}
+
+int
+Codeplug::Context::Table::index(ConfigItem *obj) const {
+  if (_keys.empty())
+    return -1;
+  size_t i = slot(obj);
+  if (nullptr == _keys[i])
+    return -1;
+  return _indices[i];
+}
+
+bool
+Codeplug::Context::Table::add(ConfigItem *obj, unsigned idx) {
+  if ((nullptr != this->obj(idx)) || (0 <= index(obj)))
+    return false;
+
+  // Keep the object->index map at most half full
+  if (2*(_count+1) > _keys.size())
+    grow();
+  size_t i = slot(obj);
+  _keys[i] = obj; _indices[i] = idx;
+  _count++;
+
+  if (idx >= _objects.size())
+    _objects.resize(idx+1, nullptr);
+  _objects[idx] = obj;
+  return true;
+}
+
+bool
+Codeplug::Context::Table::operator==(const Table &other) const {
+  return _objects == other._objects;
+}
+
+size_t
+Codeplug::Context::Table::slot(ConfigItem *obj) const {
+  // Fibonacci hashing, uses the upper bits of the product as the lower bits of pointers are
+  // usually 0 due to alignment.
+  quint64 h = quint64(quintptr(obj)) * Q_UINT64_C(0x9e3779b97f4a7c15);
+  size_t mask = _keys.size()-1, i = size_t(h >> (64-_bits));
+  // Linear probing, there is always an empty slot
+  while ((nullptr != _keys[i]) && (obj != _keys[i]))
+    i = (i+1) & mask;
+  return i;
+}
+
+void
+Codeplug::Context::Table::grow() {
+  std::vector<ConfigItem *> keys(std::move(_keys));
+  std::vector<unsigned> indices(std::move(_indices));
+  _bits = (0 == _bits) ? 4 : _bits+1;
+  _keys.assign(size_t(1) << _bits, nullptr);
+  _indices.assign(size_t(1) << _bits, 0);
+  for (size_t i=0; i<keys.size(); i++) {
+    if (nullptr == keys[i])
+      continue;
+    size_t j = slot(keys[i]);
+    _keys[j] = keys[i]; _indices[j] = indices[i];
+  }
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of CodePlug::Context
  * ********************************************************************************************* */
 Codeplug::Context::Context(Config *config)
-  : _config(config), _tables()
+  : _config(config), _tables(), _types()
 {
   // Add tables for common elements
   addTable(&DMRRadioID::staticMetaObject);
@@ -562,58 +640,71 @@ Codeplug::Context::config() const {
   return _config;
 }
 
+int
+Codeplug::Context::findTable(const QMetaObject *obj) const {
+  for (; nullptr != obj; obj = obj->superClass()) {
+    QHash<const QMetaObject *, int>::const_iterator type = _types.constFind(obj);
+    if (_types.constEnd() != type)
+      return type.value();
+  }
+  return -1;
+}
+
 bool
 Codeplug::Context::hasTable(const QMetaObject *obj) const {
-  // Find a matching table
-  if (_tables.contains(obj->className()))
-    return true;
-  else if (obj->superClass())
-    return hasTable(obj->superClass());
-  return false;
+  return 0 <= findTable(obj);
 }
 
 Codeplug::Context::Table &
 Codeplug::Context::getTable(const QMetaObject *obj) {
-  if (_tables.contains(obj->className()))
-    return _tables[obj->className()];
-  return getTable(obj->superClass());
+  int idx = findTable(obj);
+  // Cache the resolved table for the type, only the non-const variant modifies the context
+  _types.insert(obj, idx);
+  return _tables[idx];
+}
+
+const Codeplug::Context::Table &
+Codeplug::Context::getTable(const QMetaObject *obj) const {
+  return _tables[findTable(obj)];
 }
 
 bool
 Codeplug::Context::addTable(const QMetaObject *obj) {
   if (hasTable(obj))
     return false;
-  _tables.insert(obj->className(), Table());
+  _types.insert(obj, int(_tables.size()));
+  _tables.push_back(Table());
   return true;
 }
 
 ConfigItem *
-Codeplug::Context::obj(const QMetaObject *elementType, unsigned idx) {
-  if (! hasTable(elementType))
+Codeplug::Context::obj(const QMetaObject *elementType, unsigned idx) const {
+  int table = findTable(elementType);
+  if (0 > table)
     return nullptr;
-  return getTable(elementType).objects.value(idx, nullptr);
+  return _tables[table].obj(idx);
 }
 
 int
-Codeplug::Context::index(ConfigItem *obj) {
+Codeplug::Context::index(ConfigItem *obj) const {
   if (nullptr == obj)
     return -1;
-  if (! hasTable(obj->metaObject()))
+  int table = findTable(obj->metaObject());
+  if (0 > table)
     return -1;
-  return getTable(obj->metaObject()).indices.value(obj, -1);
+  return _tables[table].index(obj);
 }
 
 bool
 Codeplug::Context::add(ConfigItem *obj, unsigned idx) {
-  if (!hasTable(obj->metaObject()))
-    return false;
-  if (getTable(obj->metaObject()).indices.contains(obj))
-    return false;
-  if (getTable(obj->metaObject()).objects.contains(idx))
+  if (! hasTable(obj->metaObject()))
     return false;
-  getTable(obj->metaObject()).objects.insert(idx, obj);
-  getTable(obj->metaObject()).indices.insert(obj, idx);
-  return true;
+  return getTable(obj->metaObject()).add(obj, idx);
+}
+
+bool
+Codeplug::Context::operator==(const Context &other) const {
+  return (_config == other._config) && (_tables == other._tables);
 }
 
 
@@ -629,3 +720,9 @@ Codeplug::Codeplug(QObject *parent)
 Codeplug::~Codeplug() {
 	// pass...
 }
+
+bool
+Codeplug::encodeModified(const QList<ConfigItem *> &items, const Flags &flags, Context &ctx, const ErrorStack &err) {
+  Q_UNUSED(items); Q_UNUSED(flags); Q_UNUSED(ctx); Q_UNUSED(err)
+  return false;
+}
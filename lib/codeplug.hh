@@ -3,8 +3,10 @@
 
 #include <QObject>
 #include "dfufile.hh"
+#include "elementlayout.hh"
 #include "userdatabase.hh"
 #include <QHash>
+#include <vector>
 #include "config.hh"
 
 //class Config;
@@ -34,6 +36,20 @@ public:
     /** If @c true enables automatic roaming when there is a roaming zone defined that is used by any
      * channel. This may cause automatic transmissions, hence the default is @c false. */
     bool autoEnableRoaming;
+    /** If @c true, only those memory blocks get written to the device, that differ from the
+     * current content of the device. This requires to read the complete codeplug memory from the
+     * device first, but usually saves a lot of time as most uploads change only few elements.
+     * Default @c false. */
+    bool diffUpload;
+    /** If @c true, the codeplug image written to the device gets stored in a persistent cache.
+     * On the next upload to a device of the same model and firmware, the cached image gets used
+     * instead of reading the codeplug back from the device, if a cheap fingerprint of the device
+     * memory matches. Default @c false. */
+    bool useImageCache;
+    /** If @c true, independent sections of the codeplug (e.g., channels, contacts, zones) get
+     * encoded in parallel using the global thread pool. Large sections may be split further into
+     * ranges of elements. The result is identical to the sequential encoding. Default @c false. */
+    bool parallelEncode;
 
     /** Default constructor, enables code-plug update and disables automatic GPS/APRS and roaming. */
     Flags();
@@ -193,13 +209,17 @@ public:
 
     /** Resolves the given index for the specifies element type.
      * @returns @c nullptr if the index is not defined or the type is unknown. */
-    ConfigItem *obj(const QMetaObject *elementType, unsigned idx);
+    ConfigItem *obj(const QMetaObject *elementType, unsigned idx) const;
     /** Returns the index for the given object.
      * @returns -1 if no index is associated with the object or its type is unknown. */
-    int index(ConfigItem *obj);
+    int index(ConfigItem *obj) const;
     /** Associates the given object with the given index. */
     bool add(ConfigItem *obj, unsigned idx);
 
+    /** Returns @c true if both contexts refer to the same config and associate the same objects
+     * with the same indices. */
+    bool operator==(const Context &other) const;
+
     /** Adds a table for the given type. */
     bool addTable(const QMetaObject *obj);
 
@@ -216,26 +236,66 @@ public:
     }
 
   protected:
-    /** Internal used table type to associate objects and indices. */
+    /** Internal used table type to associate objects and indices.
+     *
+     * The indices are dense and small (they address elements within the codeplug), hence the
+     * index->object map is a plain vector. The object->index map is a flat hash table using open
+     * addressing. Objects cannot be removed from a table. */
     class Table {
     public:
-      /** The index->object map. */
-      QHash<unsigned, ConfigItem *> objects;
-      /** The object->index map. */
-      QHash<ConfigItem *, unsigned> indices;
+      /** Empty constructor. */
+      Table();
+
+      /** Returns the object associated with the given index or @c nullptr. */
+      ConfigItem *obj(unsigned idx) const;
+      /** Returns the index associated with the given object or -1. */
+      int index(ConfigItem *obj) const;
+      /** Associates the given object with the given index.
+       * @returns @c false if either the object or the index is already associated. */
+      bool add(ConfigItem *obj, unsigned idx);
+      /** Returns @c true if both tables associate the same objects with the same indices. */
+      bool operator==(const Table &other) const;
+
+    protected:
+      /** Returns the slot of the given object or the empty slot it would be stored in. */
+      size_t slot(ConfigItem *obj) const;
+      /** Doubles the number of slots of the object->index map. */
+      void grow();
+
+    protected:
+      /** The index->object map, @c nullptr marks undefined indices. */
+      std::vector<ConfigItem *> _objects;
+      /** The keys (objects) of the object->index map, @c nullptr marks empty slots. */
+      std::vector<ConfigItem *> _keys;
+      /** The values (indices) of the object->index map. */
+      std::vector<unsigned> _indices;
+      /** The number of objects in the table. */
+      size_t _count;
+      /** Number of slots of the object->index map as power of 2. */
+      unsigned _bits;
     };
 
   protected:
     /** Returns @c true if a table is defined for the given type. */
     bool hasTable(const QMetaObject *obj) const;
-    /** Returns a reference to the table for the given type. */
+    /** Returns a reference to the table for the given type. The resolved table is cached for the
+     * given type. */
     Table &getTable(const QMetaObject *obj);
+    /** Returns a const reference to the table for the given type. In contrast to the non-const
+     * variant, this method never modifies the context and may therefore be called concurrently. */
+    const Table &getTable(const QMetaObject *obj) const;
+    /** Returns the index of the table for the given type or any of its super classes.
+     * @returns -1 if no table is defined. */
+    int findTable(const QMetaObject *obj) const;
 
   protected:
     /** A weak reference to the config object. */
     Config *_config;
     /** Table of tables. */
-    QHash<QString, Table> _tables;
+    std::vector<Table> _tables;
+    /** Maps types to the index of their table. Besides the types, the tables were added for, this
+     * map also caches the tables resolved for derived types. */
+    QHash<const QMetaObject *, int> _types;
   };
 
 protected:
@@ -258,6 +318,15 @@ public:
   /** Encodes a given abstract configuration (@c config) to the device specific binary code-plug.
    * This must be implemented by the device-specific codeplug. */
   virtual bool encode(Config *config, const Flags &flags=Flags(), const ErrorStack &err=ErrorStack()) = 0;
+  /** Re-encodes only those elements of the codeplug, that represent the given modified objects.
+   * The codeplug must hold the result of a previous encoding using the given context and the
+   * indices of all objects must not have changed since.
+   *
+   * The default implementation does not support partial updates.
+   * @returns @c false if the codeplug cannot be updated partially. In this case, the caller must
+   *   encode the complete codeplug. */
+  virtual bool encodeModified(const QList<ConfigItem *> &items, const Flags &flags, Context &ctx,
+                              const ErrorStack &err=ErrorStack());
 };
 
 #endif // CODEPLUG_HH
@@ -0,0 +1,176 @@
+#include "codeplugcache.hh"
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QDir>
+#include <QtEndian>
+#include <QRegExp>
+#include <algorithm>
+#include "logger.hh"
+
+
+/* ********************************************************************************************* *
+ * Implementation of CodeplugCache
+ * ********************************************************************************************* */
+CodeplugCache::CodeplugCache(const RadioInfo &radio, const QString &version)
+  : _radio(radio), _version(version), _hash(QCryptographicHash::Sha1), _cached(), _loaded(false),
+    _hint(0)
+{
+  // pass...
+}
+
+bool
+CodeplugCache::isEnabled() const {
+  return ! _version.simplified().isEmpty();
+}
+
+void
+CodeplugCache::clearFingerprint() {
+  _hash.reset();
+}
+
+void
+CodeplugCache::addFingerprint(uint32_t addr, const uint8_t *data, uint32_t size) {
+  uint32_t header[2] = { qToLittleEndian(addr), qToLittleEndian(size) };
+  _hash.addData((const char *)header, sizeof(header));
+  _hash.addData((const char *)data, size);
+}
+
+QString
+CodeplugCache::key() const {
+  QString version = _version.simplified().replace(QRegExp("[^A-Za-z0-9._-]"), "_");
+  return QString("%1-%2-%3").arg(_radio.key()).arg(version).arg(QString(_hash.result().toHex()));
+}
+
+QString
+CodeplugCache::directory() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/codeplugs";
+}
+
+bool
+CodeplugCache::load(const ErrorStack &err) {
+  _loaded = false;
+  _hint = 0;
+  _cached.clear();
+
+  if (! isEnabled()) {
+    logDebug() << "Firmware version of " << _radio.name() << " unknown, codeplug cache disabled.";
+    return false;
+  }
+
+  QString filename = directory() + "/" + key() + ".dfu";
+  if (! QFileInfo::exists(filename)) {
+    logDebug() << "No cached codeplug image '" << filename << "'.";
+    return false;
+  }
+
+  DFUFile file;
+  if (! file.read(filename, err)) {
+    errMsg(err) << "Cannot load cached codeplug image '" << filename << "'.";
+    return false;
+  }
+  for (int i=0; i<file.numImages(); i++)
+    _cached.append(file.image(i));
+  _loaded = true;
+  logDebug() << "Loaded cached codeplug image '" << filename << "'.";
+  return true;
+}
+
+bool
+CodeplugCache::isLoaded() const {
+  return _loaded;
+}
+
+bool
+CodeplugCache::restore(uint32_t addr, uint8_t *data, uint32_t size, int img) const {
+  if ((! _loaded) || (img >= _cached.size()) || (0 == _cached[img].numElements()))
+    return false;
+
+  // Search for element containing the complete memory section, starting at the last match.
+  const DFUFile::Image &image = _cached[img];
+  for (int i=0; i<image.numElements(); i++) {
+    int idx = (_hint+i) % image.numElements();
+    const DFUFile::Element &el = image.element(idx);
+    if ((addr < el.address()) || ((addr+size) > (el.address()+el.memSize())))
+      continue;
+    memcpy(data, el.data() + (addr-el.address()), size);
+    _hint = idx;
+    return true;
+  }
+
+  return false;
+}
+
+bool
+CodeplugCache::restore(DFUFile::Image &image, int first, int last, int img) const {
+  if (0 > last)
+    last = image.numElements();
+  for (int i=first; i<last; i++) {
+    DFUFile::Element &el = image.element(i);
+    if (! restore(el.address(), el.data(), el.memSize(), img))
+      return false;
+  }
+  return true;
+}
+
+bool
+CodeplugCache::restore(DFUFile &file) const {
+  if (file.numImages() != _cached.size())
+    return false;
+  for (int i=0; i<file.numImages(); i++) {
+    if (! restore(file.image(i), 0, -1, i))
+      return false;
+  }
+  return true;
+}
+
+bool
+CodeplugCache::store(const DFUFile &file, const ErrorStack &err) const {
+  if (! isEnabled()) {
+    errMsg(err) << "Firmware version of " << _radio.name() << " unknown, codeplug cache disabled.";
+    return false;
+  }
+
+  QString path = directory();
+  QDir dir;
+  if ((! dir.exists(path)) && (! dir.mkpath(path))) {
+    errMsg(err) << "Cannot create codeplug cache directory '" << path << "'.";
+    return false;
+  }
+
+  DFUFile copy;
+  for (int i=0; i<file.numImages(); i++)
+    copy.addImage(file.image(i));
+  QString filename = path + "/" + key() + ".dfu";
+  if (! copy.write(filename, err)) {
+    errMsg(err) << "Cannot store codeplug image in cache.";
+    return false;
+  }
+
+  logDebug() << "Stored codeplug image in cache '" << filename << "'.";
+  return true;
+}
+
+QVector<uint32_t>
+CodeplugCache::samples(const DFUFile::Image &image, unsigned blocksize, int first, unsigned n) {
+  QVector<uint32_t> addresses;
+
+  // Count blocks
+  size_t nblocks = 0;
+  for (int i=first; i<image.numElements(); i++)
+    nblocks += image.element(i).memSize()/blocksize;
+  if (0 == nblocks)
+    return addresses;
+
+  n = std::min(size_t(n), nblocks);
+  size_t stride = nblocks/n, next = 0, count = 0;
+  for (int i=first; (i<image.numElements()) && (unsigned(addresses.size())<n); i++) {
+    size_t nb = image.element(i).memSize()/blocksize;
+    while ((next < (count+nb)) && (unsigned(addresses.size())<n)) {
+      addresses.append(image.element(i).address() + (next-count)*blocksize);
+      next += stride;
+    }
+    count += nb;
+  }
+
+  return addresses;
+}
@@ -0,0 +1,85 @@
+#ifndef CODEPLUGCACHE_HH
+#define CODEPLUGCACHE_HH
+
+#include <QString>
+#include <QVector>
+#include <QCryptographicHash>
+
+#include "dfufile.hh"
+#include "radioinfo.hh"
+#include "errorstack.hh"
+
+/** Persistent on-disk cache of binary codeplug images.
+ *
+ * Prior to the upload of a codeplug, most radios read the complete codeplug back from the device
+ * to maintain all settings not covered by the common config. When programming many identical
+ * radios, this read-back dominates the transfer time. This class stores the image written to a
+ * device on disk and allows to restore it instead of reading it back on the next upload.
+ *
+ * Cached images are identified by the radio model, the firmware version and a cheap fingerprint
+ * of the device memory. A firmware update may change the memory of the device outside of the
+ * sampled sections. Hence, the cache is disabled if the firmware version is unknown. The fingerprint is assembled by the radio from a few memory
+ * sections that are read from the device anyway (e.g., bitmaps) or that are sampled explicitly
+ * (see @c samples).
+ *
+ * @ingroup util */
+class CodeplugCache
+{
+public:
+  /** Constructs a cache for the specified radio model and firmware version. */
+  explicit CodeplugCache(const RadioInfo &radio, const QString &version=QString());
+
+  /** Returns @c true if the cache can be used, that is, if the firmware version is known. */
+  bool isEnabled() const;
+
+  /** Resets the fingerprint. */
+  void clearFingerprint();
+  /** Adds the given memory to the fingerprint. */
+  void addFingerprint(uint32_t addr, const uint8_t *data, uint32_t size);
+  /** Returns the key of the cached image for the current fingerprint. */
+  QString key() const;
+
+  /** Tries to load the cached image matching the current fingerprint.
+   * @returns @c false if there is no such image. */
+  bool load(const ErrorStack &err=ErrorStack());
+  /** Returns @c true if a cached image has been loaded. */
+  bool isLoaded() const;
+
+  /** Copies the cached memory at the specified address of image @c img into @c data.
+   * @returns @c false if the memory is not cached. */
+  bool restore(uint32_t addr, uint8_t *data, uint32_t size, int img=0) const;
+  /** Copies the cached memory into the elements @c first to @c last (exclusive) of the given
+   * image. If @c last is negative, all elements starting at @c first are restored.
+   * @returns @c false if any of these elements is not cached. */
+  bool restore(DFUFile::Image &image, int first=0, int last=-1, int img=0) const;
+  /** Copies the cached memory into all images of the given file.
+   * @returns @c false if any element is not cached. */
+  bool restore(DFUFile &file) const;
+
+  /** Stores all images of the given file under the key of the current fingerprint. */
+  bool store(const DFUFile &file, const ErrorStack &err=ErrorStack()) const;
+
+public:
+  /** Returns the directory, the cached images are stored in. */
+  static QString directory();
+  /** Returns the addresses of @c n blocks of the given size, evenly spread over the elements of the
+   * image starting at element @c first. These blocks are used to assemble the fingerprint. */
+  static QVector<uint32_t> samples(const DFUFile::Image &image, unsigned blocksize,
+                                   int first=0, unsigned n=16);
+
+protected:
+  /** The radio model. */
+  RadioInfo _radio;
+  /** The firmware version. */
+  QString _version;
+  /** The fingerprint hash. */
+  QCryptographicHash _hash;
+  /** The cached images. */
+  QVector<DFUFile::Image> _cached;
+  /** If @c true, the cached image has been loaded. */
+  bool _loaded;
+  /** Index of the last element found, used to speedup sequential lookups. */
+  mutable int _hint;
+};
+
+#endif // CODEPLUGCACHE_HH
@@ -0,0 +1,152 @@
+#include "codeplugsession.hh"
+#include "config.hh"
+#include "logger.hh"
+
+
+/* ********************************************************************************************* *
+ * Implementation of CodeplugSession
+ * ********************************************************************************************* */
+CodeplugSession::CodeplugSession(Config *config, QObject *parent)
+  : QObject(parent), _config(config), _context(nullptr), _codeplugType(nullptr), _flags(),
+    _checksum(0), _modified(), _partial(false)
+{
+  track(_config->radioIDs());
+  track(_config->contacts());
+  track(_config->rxGroupLists());
+  track(_config->channelList());
+  track(_config->zones());
+  track(_config->scanlists());
+  track(_config->posSystems());
+  track(_config->roaming());
+
+  // Any modification of the settings and extensions requires a complete encoding.
+  connect(_config->settings(), SIGNAL(modified(ConfigItem*)), this, SLOT(invalidate()));
+  connect(_config->commercialExtension(), SIGNAL(modified(ConfigItem*)), this, SLOT(invalidate()));
+  connect(_config, SIGNAL(beginClear()), this, SLOT(invalidate()));
+}
+
+CodeplugSession::~CodeplugSession() {
+  if (_context)
+    delete _context;
+}
+
+Config *
+CodeplugSession::config() const {
+  return _config;
+}
+
+bool
+CodeplugSession::isRetained() const {
+  return nullptr != _context;
+}
+
+const QList<ConfigItem *> &
+CodeplugSession::modified() const {
+  return _modified;
+}
+
+bool
+CodeplugSession::wasPartial() const {
+  return _partial;
+}
+
+uint32_t
+CodeplugSession::checksum() const {
+  return _checksum;
+}
+
+void
+CodeplugSession::setChecksum(uint32_t crc) {
+  _checksum = crc;
+}
+
+void
+CodeplugSession::invalidate() {
+  if (_context)
+    delete _context;
+  _context = nullptr;
+  _codeplugType = nullptr;
+  _checksum = 0;
+  _modified.clear();
+}
+
+bool
+CodeplugSession::encode(Codeplug *codeplug, const Codeplug::Flags &flags, bool retained, const ErrorStack &err) {
+  _partial = false;
+  if ((! retained) || (nullptr == _context) || (codeplug->metaObject() != _codeplugType))
+    return encodeAll(codeplug, flags, err);
+  // Flags affecting the encoding of the settings require a complete encoding.
+  if ((flags.updateCodePlug != _flags.updateCodePlug) ||
+      (flags.autoEnableGPS != _flags.autoEnableGPS) ||
+      (flags.autoEnableRoaming != _flags.autoEnableRoaming))
+    return encodeAll(codeplug, flags, err);
+
+  // Objects may have been moved without notification, hence verify that all indices are unchanged.
+  Codeplug::Context ctx(_config);
+  if (! codeplug->index(_config, ctx, err)) {
+    errMsg(err) << "Cannot index configuration.";
+    return false;
+  }
+  if (! (ctx == *_context)) {
+    logDebug() << "Indices of configuration changed, encode complete codeplug.";
+    return encodeAll(codeplug, flags, err);
+  }
+
+  if (_modified.isEmpty()) {
+    logDebug() << "Configuration not modified since last encoding.";
+    _partial = true;
+    return true;
+  }
+
+  // The error messages of a failed partial update are irrelevant, as the complete codeplug gets
+  // encoded then.
+  ErrorStack partialErr;
+  if (! codeplug->encodeModified(_modified, flags, *_context, partialErr)) {
+    logDebug() << "Cannot update " << _modified.count()
+               << " modified objects, encode complete codeplug.";
+    return encodeAll(codeplug, flags, err);
+  }
+
+  logDebug() << "Updated " << _modified.count() << " modified objects in codeplug.";
+  _modified.clear();
+  _partial = true;
+  return true;
+}
+
+bool
+CodeplugSession::encodeAll(Codeplug *codeplug, const Codeplug::Flags &flags, const ErrorStack &err) {
+  invalidate();
+
+  if (! codeplug->encode(_config, flags, err))
+    return false;
+
+  // Retain the context of this encoding. Indexing is deterministic, hence the context equals the
+  // one used for the encoding.
+  Codeplug::Context *ctx = new Codeplug::Context(_config);
+  if (! codeplug->index(_config, *ctx, err)) {
+    delete ctx;
+    return true;
+  }
+
+  _context = ctx;
+  _codeplugType = codeplug->metaObject();
+  _flags = flags;
+  return true;
+}
+
+void
+CodeplugSession::track(AbstractConfigObjectList *list) {
+  connect(list, SIGNAL(elementAdded(int)), this, SLOT(invalidate()));
+  connect(list, SIGNAL(elementRemoved(int)), this, SLOT(invalidate()));
+  connect(list, SIGNAL(elementModified(int)), this, SLOT(onElementModified(int)));
+}
+
+void
+CodeplugSession::onElementModified(int idx) {
+  AbstractConfigObjectList *list = qobject_cast<AbstractConfigObjectList *>(sender());
+  if (nullptr == list)
+    return;
+  ConfigItem *item = list->get(idx);
+  if ((nullptr != item) && (! _modified.contains(item)))
+    _modified.append(item);
+}
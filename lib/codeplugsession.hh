@@ -0,0 +1,97 @@
+#ifndef CODEPLUGSESSION_HH
+#define CODEPLUGSESSION_HH
+
+#include <QObject>
+#include <QList>
+#include "codeplug.hh"
+
+class Config;
+class ConfigItem;
+class AbstractConfigObjectList;
+
+/** Retains the state of the last encoding of a configuration to allow for incremental updates of
+ * the codeplug.
+ *
+ * The session keeps the context (index tables) of the last encoding alive and records all
+ * objects of the configuration that get modified afterwards. When encoding the configuration
+ * again into a codeplug that still holds the result of the last encoding (e.g., restored from the
+ * image cache), only the elements representing the modified objects get updated using
+ * @c Codeplug::encodeModified.
+ *
+ * The session falls back to a complete encoding, if
+ *  - there is no previous encoding or the codeplug does not hold it anymore,
+ *  - the codeplug type or the encoding flags differ from those of the previous encoding,
+ *  - objects were added or removed, or the global settings were modified,
+ *  - the indices of the objects changed (e.g., objects were moved),
+ *  - or the codeplug does not support a partial update of the modified objects.
+ *
+ * @ingroup conf */
+class CodeplugSession : public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a session for the given configuration. */
+  explicit CodeplugSession(Config *config, QObject *parent=nullptr);
+  /** Destructor. */
+  virtual ~CodeplugSession();
+
+  /** Returns the configuration of this session. */
+  Config *config() const;
+
+  /** Returns @c true if the previous encoding is retained. That is, the codeplug can be updated
+   * incrementally. */
+  bool isRetained() const;
+  /** Returns the objects modified since the last encoding. */
+  const QList<ConfigItem *> &modified() const;
+  /** Returns @c true if the last call to @c encode updated the modified objects only instead of
+   * encoding the complete codeplug. */
+  bool wasPartial() const;
+
+  /** Returns the checksum of the codeplug memory holding the last encoding, as set by the radio.
+   * It allows the radio to verify, that a codeplug image restored from the cache actually holds
+   * the last encoding of this session. */
+  uint32_t checksum() const;
+  /** Sets the checksum of the codeplug memory holding the last encoding. */
+  void setChecksum(uint32_t crc);
+
+  /** Encodes the configuration into the given codeplug.
+   *
+   * If @c retained is @c true, the caller ensures that the codeplug holds the result of the last
+   * encoding of this session. Then, only the modified objects get encoded if possible.
+   * @returns @c false on error. */
+  bool encode(Codeplug *codeplug, const Codeplug::Flags &flags, bool retained,
+              const ErrorStack &err=ErrorStack());
+
+protected:
+  /** Encodes the complete configuration and retains its context. */
+  bool encodeAll(Codeplug *codeplug, const Codeplug::Flags &flags, const ErrorStack &err);
+  /** Tracks the modifications of the given list. */
+  void track(AbstractConfigObjectList *list);
+
+public slots:
+  /** Discards the previous encoding. The next encoding will be complete. */
+  void invalidate();
+
+protected slots:
+  /** Gets called if an element of a tracked list is modified. */
+  void onElementModified(int idx);
+
+protected:
+  /** The configuration. */
+  Config *_config;
+  /** The context of the last encoding or @c nullptr if there is none. */
+  Codeplug::Context *_context;
+  /** The type of the codeplug of the last encoding. */
+  const QMetaObject *_codeplugType;
+  /** The flags of the last encoding. */
+  Codeplug::Flags _flags;
+  /** The checksum of the codeplug memory holding the last encoding. */
+  uint32_t _checksum;
+  /** The objects modified since the last encoding. */
+  QList<ConfigItem *> _modified;
+  /** If @c true, the last encoding updated the modified objects only. */
+  bool _partial;
+};
+
+#endif // CODEPLUGSESSION_HH
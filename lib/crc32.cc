@@ -1,4 +1,17 @@
 #include "crc32.hh"
+#include <cstring>
+#include <QtGlobal>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define CRC32_HAS_CLMUL
+#endif
+#if defined(__ARM_FEATURE_CRC32) && defined(__AARCH64EL__)
+#include <arm_acle.h>
+#define CRC32_HAS_ARMV8
+#endif
+
+/** Minimum number of bytes processed by the carry-less multiplication engine. */
+#define CLMUL_MIN_SIZE 64
 
 static const uint32_t _crc_table[256] = {
   /* CRC polynomial 0xedb88320 */
@@ -48,6 +61,170 @@ static const uint32_t _crc_table[256] = {
 };
 
 
+
+/* ********************************************************************************************* *
+ * CRC engines
+ * ********************************************************************************************* */
+/** Signature of the CRC engines, updates the CRC register with the given data. */
+typedef uint32_t (*CRC32Engine)(uint32_t crc, const uint8_t *buf, size_t n);
+
+/** Byte-wise reference engine. */
+static uint32_t
+crc32_bytewise(uint32_t crc, const uint8_t *buf, size_t n) {
+  for (size_t i=0; i<n; i++)
+    crc = ( _crc_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8) );
+  return crc;
+}
+
+/** Tables for the slicing-by-8 engine, derived from the byte-wise table. */
+struct CRC32SliceTables {
+  /** Table @c i holds the CRC of each byte followed by @c i zero bytes. */
+  uint32_t table[8][256];
+
+  /** Derives the tables. */
+  CRC32SliceTables() {
+    for (unsigned i=0; i<256; i++) {
+      table[0][i] = _crc_table[i];
+      for (unsigned j=1; j<8; j++)
+        table[j][i] = (table[j-1][i] >> 8) ^ _crc_table[table[j-1][i] & 0xff];
+    }
+  }
+};
+
+/** Portable slicing-by-8 engine, processes 8 bytes per iteration. */
+static uint32_t
+crc32_slice8(uint32_t crc, const uint8_t *buf, size_t n) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  static const CRC32SliceTables tables;
+  const uint32_t (&t)[8][256] = tables.table;
+  while (n >= 8) {
+    uint32_t lo, hi;
+    memcpy(&lo, buf, 4); memcpy(&hi, buf+4, 4);
+    lo ^= crc;
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+        t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    buf += 8; n -= 8;
+  }
+#endif
+  return crc32_bytewise(crc, buf, n);
+}
+
+#ifdef CRC32_HAS_CLMUL
+/** Engine using carry-less multiplication (PCLMULQDQ) to fold 64 bytes per iteration, see
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Intel. The
+ * constants are given in the bit-reflected domain for the polynomial 0xedb88320. */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t
+crc32_clmul(uint32_t crc, const uint8_t *buf, size_t n) {
+  if (n < CLMUL_MIN_SIZE)
+    return crc32_slice8(crc, buf, n);
+
+  alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+  alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+  alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+  alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+  x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(buf+0x00)), _mm_cvtsi32_si128(crc));
+  x2 = _mm_loadu_si128((const __m128i *)(buf+0x10));
+  x3 = _mm_loadu_si128((const __m128i *)(buf+0x20));
+  x4 = _mm_loadu_si128((const __m128i *)(buf+0x30));
+  buf += 64; n -= 64;
+
+  // Fold 4x128 bits in parallel
+  x0 = _mm_load_si128((const __m128i *)k1k2);
+  while (n >= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(buf+0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(buf+0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(buf+0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(buf+0x30)));
+    buf += 64; n -= 64;
+  }
+
+  // Fold into 128 bits
+  x0 = _mm_load_si128((const __m128i *)k3k4);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  // Fold remaining blocks of 128 bits
+  while (n >= 16) {
+    x2 = _mm_loadu_si128((const __m128i *)buf);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    buf += 16; n -= 16;
+  }
+
+  // Fold 128 bits into 64 bits
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits
+  x0 = _mm_load_si128((const __m128i *)poly);
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  crc = _mm_extract_epi32(x1, 1);
+
+  // Remaining bytes
+  return crc32_slice8(crc, buf, n);
+}
+#endif
+
+#ifdef CRC32_HAS_ARMV8
+/** Engine using the ARMv8 CRC32 instructions, which implement the same polynomial. */
+static uint32_t
+crc32_armv8(uint32_t crc, const uint8_t *buf, size_t n) {
+  while (n >= 8) {
+    uint64_t v; memcpy(&v, buf, 8);
+    crc = __crc32d(crc, v);
+    buf += 8; n -= 8;
+  }
+  while (n--)
+    crc = __crc32b(crc, *buf++);
+  return crc;
+}
+#endif
+
+/** Selects the fastest engine supported by the CPU. */
+static CRC32Engine
+crc32_select() {
+#ifdef CRC32_HAS_CLMUL
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+    return crc32_clmul;
+#endif
+#ifdef CRC32_HAS_ARMV8
+  return crc32_armv8;
+#else
+  return crc32_slice8;
+#endif
+}
+
+
 CRC32::CRC32()
   : _crc(0xFFFFFFFF)
 {
@@ -61,8 +238,8 @@ CRC32::update(uint8_t c) {
 
 void
 CRC32::update(const uint8_t *buf, size_t n) {
-	for (size_t i=0; i<n; i++)
-    _crc = ( _crc_table[(_crc ^ buf[i]) & 0xFF] ^ (_crc >> 8) );
+  static const CRC32Engine engine = crc32_select();
+  _crc = engine(_crc, buf, n);
 }
 
 void
@@ -4,6 +4,11 @@
 #include <QByteArray>
 
 /** Implements the CRC32 checksum as used in DFU files.
+ *
+ * Updating the CRC with a block of data uses the fastest engine supported by the CPU, selected at
+ * runtime. That is, carry-less multiplication on x86-64, the CRC32 instructions on ARMv8 (if
+ * enabled at compile time) and a portable slicing-by-8 implementation otherwise. All engines yield
+ * the same result as the byte-wise update.
  *
  * @ingroup util */
 class CRC32
@@ -6,6 +6,7 @@
 #include "userdatabase.hh"
 #include "config.h"
 #include "logger.hh"
+#include "bitmapview.hh"
 
 #include <QTimeZone>
 #include <QtEndian>
@@ -133,11 +134,13 @@ D578UVCodeplug::allocateHotKeySettings() {
 }
 
 bool
-D578UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err) {
+D578UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err, int first, int last) {
   Q_UNUSED(flags); Q_UNUSED(err)
 
   // Encode channels
-  for (int i=0; i<ctx.config()->channelList()->count(); i++) {
+  if ((0 > last) || (last > ctx.config()->channelList()->count()))
+    last = ctx.config()->channelList()->count();
+  for (int i=first; i<last; i++) {
     // enable channel
     uint16_t bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
@@ -147,18 +150,14 @@ D578UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStac
 }
 
 bool
-D578UVCodeplug::createChannels(Context &ctx, const ErrorStack &err) {
+D578UVCodeplug::createChannels(const ChannelRecords &records, Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create channels
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  for (int j=0; j<records.size(); j++) {
+    uint16_t i = records[j].first, bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
-    if (Channel *obj = ch.toChannelObj(ctx)) {
+    if (Channel *obj = ch.createChannelObj(records[j].second, ctx)) {
       ctx.config()->channelList()->add(obj); ctx.add(obj, i);
     }
   }
@@ -170,11 +169,9 @@ D578UVCodeplug::linkChannels(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Link channel objects
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == (((*data(CHANNEL_BITMAP+byte))>>bit) & 0x01))
-      continue;
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), NUM_CHANNELS);
+  for (unsigned i=channel_bitmap.first(); i<channel_bitmap.size(); i=channel_bitmap.next(i+1)) {
+    uint16_t bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
     if (ctx.has<Channel>(i))
       ch.linkChannelObj(ctx.get<Channel>(i), ctx);
@@ -186,12 +183,10 @@ D578UVCodeplug::linkChannels(Context &ctx, const ErrorStack &err) {
 void
 D578UVCodeplug::allocateContacts() {
   /* Allocate contacts */
-  uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
+  // enabled if false (ass hole)
+  BitmapView contact_bitmap(data(CONTACTS_BITMAP), NUM_CONTACTS, true);
   unsigned contactCount=0;
-  for (uint16_t i=0; i<NUM_CONTACTS; i++) {
-    // enabled if false (ass hole)
-    if (1 == ((contact_bitmap[i/8]>>(i%8)) & 0x01))
-      continue;
+  for (unsigned i=contact_bitmap.first(); i<contact_bitmap.size(); i=contact_bitmap.next(i+1)) {
     contactCount++;
     uint32_t addr = CONTACT_BANK_0+(i/CONTACTS_PER_BANK)*CONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
@@ -209,19 +204,29 @@ D578UVCodeplug::allocateContacts() {
 
 
 bool
-D578UVCodeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err) {
+D578UVCodeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err, int first, int last) {
   Q_UNUSED(flags); Q_UNUSED(err)
 
-  QVector<DigitalContact*> contacts;
-  // Encode contacts and also collect id<->index map
-  for (int i=0; i<ctx.config()->contacts()->digitalCount(); i++) {
+  // Encode contacts and the index list
+  if ((0 > last) || (last > ctx.config()->contacts()->digitalCount()))
+    last = ctx.config()->contacts()->digitalCount();
+  for (int i=first; i<last; i++) {
     ContactElement con(data(CONTACT_BANK_0+i*CONTACT_SIZE));
     DigitalContact *contact = ctx.config()->contacts()->digitalContact(i);
     if(! con.fromContactObj(contact, ctx))
       return false;
     ((uint32_t *)data(CONTACT_INDEX_LIST))[i] = qToLittleEndian(i);
-    contacts.append(contact);
   }
+  return true;
+}
+
+bool
+D578UVCodeplug::encodeContactIDMap(const Flags &flags, Context &ctx, const ErrorStack &err) {
+  Q_UNUSED(flags); Q_UNUSED(err)
+
+  QVector<DigitalContact*> contacts;
+  for (int i=0; i<ctx.config()->contacts()->digitalCount(); i++)
+    contacts.append(ctx.config()->contacts()->digitalContact(i));
   // encode index map for contacts
   std::sort(contacts.begin(), contacts.end(),
             [](DigitalContact *a, DigitalContact *b) {
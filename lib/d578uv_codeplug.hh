@@ -243,12 +243,15 @@ public:
 
   void allocateHotKeySettings();
 
-  bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
-  bool createChannels(Context &ctx, const ErrorStack &err=ErrorStack());
+  bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack(),
+                      int first=0, int last=-1);
+  bool createChannels(const ChannelRecords &records, Context &ctx, const ErrorStack &err=ErrorStack());
   bool linkChannels(Context &ctx, const ErrorStack &err=ErrorStack());
 
   void allocateContacts();
-  bool encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  bool encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack(),
+                      int first=0, int last=-1);
+  bool encodeContactIDMap(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
 };
 
 #endif // D578UV_CODEPLUG_HH
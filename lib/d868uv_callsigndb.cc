@@ -64,22 +64,27 @@ D868UVCallsignDB::EntryElement::setContent(
 }
 
 unsigned
-D868UVCallsignDB::EntryElement::fromUser(const UserDatabase::User &user) {
+D868UVCallsignDB::EntryElement::fromUser(const UserDatabase::UserView &user) {
+  QString name = user.name(), city = user.city(), call = user.call(), state = user.state(),
+      country = user.country();
   setCallType(DigitalContact::PrivateCall);
-  setNumber(user.id);
+  setNumber(user.id());
   setRingTone(RingTone::Off);
-  setContent(user.name, user.city, user.call, user.state, user.country, "");
-  return size(user);
+  setContent(name, city, call, state, country, "");
+  return 6 // header
+      + std::min(16, name.size())+1 + std::min(16, city.size())+1 + std::min(8, call.size())+1
+      + std::min(16, state.size())+1 + std::min(16, country.size())+1
+      + 1; // no comment but 0x00 terminator
 }
 
 unsigned
-D868UVCallsignDB::EntryElement::size(const UserDatabase::User &user) {
+D868UVCallsignDB::EntryElement::size(const UserDatabase::UserView &user) {
   return 6 // header
-      + std::min(16, user.name.size())+1 // name
-      + std::min(16, user.city.size())+1 // city
-      + std::min( 8, user.call.size())+1 // call
-      + std::min(16, user.state.size())+1 // state
-      + std::min(16, user.country.size())+1 // country
+      + std::min(16, user.name().size())+1 // name
+      + std::min(16, user.city().size())+1 // city
+      + std::min( 8, user.call().size())+1 // call
+      + std::min(16, user.state().size())+1 // state
+      + std::min(16, user.country().size())+1 // country
       + 1; // no comment but 0x00 terminator
 }
 
@@ -115,6 +120,11 @@ D868UVCallsignDB::LimitsElement::setCount(unsigned count) {
   setUInt32_le(0x0000, count);
 }
 
+unsigned
+D868UVCallsignDB::LimitsElement::totalSize() const {
+  return endOfDB() - CALLSIGN_BANK0;
+}
+
 unsigned
 D868UVCallsignDB::LimitsElement::endOfDB() const {
   return getUInt32_le(0x0004);
@@ -153,19 +163,16 @@ bool D868UVCallsignDB::encode(UserDatabase *db, const Selection &selection, cons
   if (selection.hasCountLimit())
     n = std::min(n, (qint64)selection.countLimit());
 
-  // Select n users and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  users.reserve(n);
-  for (unsigned i=0; i<n; i++)
-    users.append(db->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  // Select up to n users matching the filters and closest to the prefixes, sorted in ascending
+  // order of their IDs
+  QVector<UserDatabase::UserView> users = db->select(selection, n);
+  n = users.size();
 
-  // Compute total size of callsign db entries
+  // Compute size of each callsign db entry once and the total size
+  QVector<unsigned> sizes(n);
   size_t dbSize = 0;
-  size_t indexSize = n*IndexEntryElement::size();
   for (qint64 i=0; i<n; i++)
-    dbSize += EntryElement::size(users[i]);
+    dbSize += (sizes[i] = EntryElement::size(users[i]));
 
   // Allocate DB limits
   image(0).addElement(CALLSIGN_LIMITS, LimitsElement::size());
@@ -175,21 +182,9 @@ bool D868UVCallsignDB::encode(UserDatabase *db, const Selection &selection, cons
   limits.setCount(n);
   limits.setTotalSize(dbSize);
 
-  // Allocate index banks
-  for (int i=0; 0<indexSize; i++, indexSize-=std::min(indexSize, size_t(CALLSIGN_INDEX_BANK_SIZE))) {
-    size_t addr = CALLSIGN_INDEX_BANK0 + i*CALLSIGN_INDEX_BANK_OFFSET;
-    size_t size = align_size(std::min(indexSize, size_t(CALLSIGN_INDEX_BANK_SIZE)), 16);
-    image(0).addElement(addr, size);
-    memset(data(addr), 0xff, size);
-  }
-
-  // Allocate entry banks
-  for (int i=0; 0<dbSize; i++, dbSize-=std::min(dbSize, size_t(CALLSIGN_BANK_SIZE))) {
-    size_t addr = CALLSIGN_BANK0 + i*CALLSIGN_BANK_OFFSET;
-    size_t size = align_size(std::min(dbSize, size_t(CALLSIGN_BANK_SIZE)), 16);
-    image(0).addElement(addr, size);
-    memset(data(addr), 0x00, size);
-  }
+  // Allocate index and entry banks
+  allocateIndex(image(0), n);
+  allocateEntries(image(0), dbSize);
 
   // Fill index, the offset of the entry is not the real memory offset,
   // but a virtual one without the gaps.
@@ -201,9 +196,9 @@ bool D868UVCallsignDB::encode(UserDatabase *db, const Selection &selection, cons
       index_offset = 0; index_bank += 1;
     }
     IndexEntryElement index(data(CALLSIGN_INDEX_BANK0+index_bank*CALLSIGN_BANK_OFFSET+index_offset));
-    index.setID(users[i].id, false);
+    index.setID(users[i].id(), false);
     index.setIndex(entry_offset);
-    entry_offset += EntryElement::size(users[i]);
+    entry_offset += sizes[i];
   }
 
   // Then store DB entries
@@ -211,7 +206,7 @@ bool D868UVCallsignDB::encode(UserDatabase *db, const Selection &selection, cons
   entry_offset = 0;
   for (qint64 i=0; i<n; i++) {
     // Get size of current entry
-    uint32_t entry_size = EntryElement::size(users[i]);
+    uint32_t entry_size = sizes[i];
     // Check if entry fits into bank
     if (CALLSIGN_BANK_SIZE < (entry_offset+entry_size)) {
       // If not, split
@@ -238,3 +233,34 @@ bool D868UVCallsignDB::encode(UserDatabase *db, const Selection &selection, cons
 
   return true;
 }
+
+unsigned
+D868UVCallsignDB::capacity() const {
+  return MAX_CALLSIGNS;
+}
+
+uint32_t
+D868UVCallsignDB::limitsAddress() const {
+  return CALLSIGN_LIMITS;
+}
+
+void
+D868UVCallsignDB::allocateIndex(DFUFile::Image &image, unsigned count) const {
+  size_t indexSize = size_t(count)*IndexEntryElement::size();
+  for (int i=0; 0<indexSize; i++, indexSize-=std::min(indexSize, size_t(CALLSIGN_INDEX_BANK_SIZE))) {
+    size_t addr = CALLSIGN_INDEX_BANK0 + i*CALLSIGN_INDEX_BANK_OFFSET;
+    size_t size = align_size(std::min(indexSize, size_t(CALLSIGN_INDEX_BANK_SIZE)), 16);
+    image.addElement(addr, size);
+    memset(image.data(addr), 0xff, size);
+  }
+}
+
+void
+D868UVCallsignDB::allocateEntries(DFUFile::Image &image, size_t size) const {
+  for (int i=0; 0<size; i++, size-=std::min(size, size_t(CALLSIGN_BANK_SIZE))) {
+    size_t addr = CALLSIGN_BANK0 + i*CALLSIGN_BANK_OFFSET;
+    size_t bankSize = align_size(std::min(size, size_t(CALLSIGN_BANK_SIZE)), 16);
+    image.addElement(addr, bankSize);
+    memset(image.data(addr), 0x00, bankSize);
+  }
+}
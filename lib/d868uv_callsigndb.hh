@@ -66,10 +66,10 @@ public:
 
     /** Constructs a database entry from the given user.
      * @returns The size of the entry. */
-    virtual unsigned fromUser(const UserDatabase::User &user);
+    virtual unsigned fromUser(const UserDatabase::UserView &user);
 
     /** Computes the size of the database entry for the given user. */
-    static unsigned size(const UserDatabase::User &user);
+    static unsigned size(const UserDatabase::UserView &user);
   };
 
   /** Same index entry used by the codeplug to map normal digital contacts to an contact index. Here
@@ -102,6 +102,8 @@ public:
     virtual unsigned endOfDB() const;
     /** Sets the end-of-db address. */
     virtual void setEndOfDB(unsigned addr);
+    /** Returns the total size of the DB entries (derived from the end-of-db address). */
+    virtual unsigned totalSize() const;
     /** Sets the total size of the DB (updated end-of-db address). */
     virtual void setTotalSize(unsigned size);
 
@@ -118,6 +120,17 @@ public:
   /** Tries to encode as many entries of the given user-database. */
   bool encode(UserDatabase *db, const Selection &selection=Selection(),
               const ErrorStack &err=ErrorStack());
+
+  /** Returns the maximum number of entries. */
+  virtual unsigned capacity() const;
+  /** Returns the address of the DB limits. */
+  virtual uint32_t limitsAddress() const;
+  /** Appends the index banks for @c count entries to the given image. The banks are filled with
+   * 0xff (empty index entries). */
+  virtual void allocateIndex(DFUFile::Image &image, unsigned count) const;
+  /** Appends the entry banks for @c size bytes of DB entries to the given image. The banks are
+   * filled with 0x00. */
+  virtual void allocateEntries(DFUFile::Image &image, size_t size) const;
 };
 
 #endif // D868UVCALLSIGNDB_HH
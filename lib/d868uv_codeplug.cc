@@ -7,6 +7,8 @@
 #include "config.h"
 #include "logger.hh"
 #include "utils.hh"
+#include "taskgroup.hh"
+#include "bitmapview.hh"
 #include <cmath>
 
 #include <QTimeZone>
@@ -14,6 +16,9 @@
 #include <QSet>
 
 
+#define ENCODE_CHUNK_SIZE         500        // Number of channels or contacts encoded per task
+#define DECODE_CHUNK_SIZE         1000       // Number of channel or contact indices decoded per task
+
 #define NUM_CHANNELS              4000
 #define NUM_CHANNEL_BANKS         32
 #define CHANNEL_BANK_0            0x00800000
@@ -577,25 +582,21 @@ void
 D868UVCodeplug::setBitmaps(Config *config)
 {
   // Mark first radio ID as valid
-  uint8_t *radioid_bitmap = data(RADIOID_BITMAP);
-  memset(radioid_bitmap, 0, RADIOID_BITMAP_SIZE);
-  for (int i=0; i<std::min(NUM_RADIOIDS, config->radioIDs()->count()); i++)
-    radioid_bitmap[i/8] |= (1 << (i%8));
+  memset(data(RADIOID_BITMAP), 0, RADIOID_BITMAP_SIZE);
+  BitmapView(data(RADIOID_BITMAP), NUM_RADIOIDS).setRange(
+        0, std::min(NUM_RADIOIDS, config->radioIDs()->count()));
 
   // Mark valid channels (set bit)
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  memset(channel_bitmap, 0, CHANNEL_BITMAP_SIZE);
-  for (int i=0; i<std::min(NUM_CHANNELS, config->channelList()->count()); i++) {
-    channel_bitmap[i/8] |= (1 << (i%8));
-  }
+  memset(data(CHANNEL_BITMAP), 0, CHANNEL_BITMAP_SIZE);
+  BitmapView(data(CHANNEL_BITMAP), NUM_CHANNELS).setRange(
+        0, std::min(NUM_CHANNELS, config->channelList()->count()));
 
   // Mark valid contacts (clear bit)
   uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
   memset(contact_bitmap, 0x00, CONTACTS_BITMAP_SIZE);
   memset(contact_bitmap, 0xff, NUM_CONTACTS/8+1);
-  for (int i=0; i<std::min(NUM_CONTACTS, config->contacts()->digitalCount()); i++) {
-    contact_bitmap[i/8] &= ~(1 << (i%8));
-  }
+  BitmapView(contact_bitmap, NUM_CONTACTS, true).setRange(
+        0, std::min(NUM_CONTACTS, config->contacts()->digitalCount()));
 
   // Mark valid analog contacts (clear bytes)
   uint8_t *analog_contact_bitmap = data(ANALOGCONTACT_BYTEMAP);
@@ -605,27 +606,24 @@ D868UVCodeplug::setBitmaps(Config *config)
   }
 
   // Mark valid zones (set bits)
-  uint8_t *zone_bitmap = data(ZONE_BITMAPS);
-  memset(zone_bitmap, 0x00, ZONE_BITMAPS_SIZE);
+  memset(data(ZONE_BITMAPS), 0x00, ZONE_BITMAPS_SIZE);
+  BitmapView zone_bitmap(data(ZONE_BITMAPS), NUM_ZONES);
   for (int i=0,z=0; i<std::min(NUM_ZONES, config->zones()->count()); i++) {
-    zone_bitmap[z/8] |= (1 << (z%8)); z++;
+    zone_bitmap.set(z); z++;
     if (config->zones()->zone(i)->B()->count()) {
-      zone_bitmap[z/8] |= (1 << (z%8)); z++;
+      zone_bitmap.set(z); z++;
     }
   }
 
   // Mark group lists
-  uint8_t *group_bitmap = data(RXGRP_BITMAP);
-  memset(group_bitmap, 0x00, RXGRP_BITMAP_SIZE);
-  for (int i=0; i<std::min(NUM_RXGRP, config->rxGroupLists()->count()); i++)
-    group_bitmap[i/8] |= (1 << (i%8));
+  memset(data(RXGRP_BITMAP), 0x00, RXGRP_BITMAP_SIZE);
+  BitmapView(data(RXGRP_BITMAP), NUM_RXGRP).setRange(
+        0, std::min(NUM_RXGRP, config->rxGroupLists()->count()));
 
   // Mark scan lists
-  uint8_t *scan_bitmap = data(SCAN_BITMAP);
-  memset(scan_bitmap, 0x00, SCAN_BITMAP_SIZE);
-  for (int i=0; i<std::min(NUM_SCAN_LISTS, config->scanlists()->count()); i++) {
-    scan_bitmap[i/8] |= (1<<(i%8));
-  }
+  memset(data(SCAN_BITMAP), 0x00, SCAN_BITMAP_SIZE);
+  BitmapView(data(SCAN_BITMAP), NUM_SCAN_LISTS).setRange(
+        0, std::min(NUM_SCAN_LISTS, config->scanlists()->count()));
 }
 
 bool
@@ -644,44 +642,97 @@ bool D868UVCodeplug::decode(Config *config, const ErrorStack &err) {
 }
 
 bool
-D868UVCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err)
-{
-  if (! this->encodeRadioID(flags, ctx, err))
-    return false;
-
-  if (! this->encodeGeneralSettings(flags, ctx, err))
-    return false;
-
-  if (! this->encodeBootSettings(flags, ctx, err))
-    return false;
-
-  if (! this->encodeChannels(flags, ctx, err))
+D868UVCodeplug::encodeModified(const QList<ConfigItem *> &items, const Flags &flags, Context &ctx, const ErrorStack &err) {
+  // Collect the modified sections first, the elements of channels and contacts get updated
+  // individually
+  QList<int> channels, contacts;
+  bool analogContacts = false, groupLists = false, scanLists = false;
+  foreach (ConfigItem *item, items) {
+    if (item->is<Channel>())
+      channels.append(ctx.index(item));
+    else if (item->is<DigitalContact>())
+      contacts.append(ctx.index(item));
+    else if (item->is<DTMFContact>())
+      analogContacts = true;
+    else if (item->is<RXGroupList>())
+      groupLists = true;
+    else if (item->is<ScanList>())
+      scanLists = true;
+    else
+      return false;
+  }
+  if (channels.contains(-1) || contacts.contains(-1))
     return false;
 
-  if (! this->encodeContacts(flags, ctx, err))
+  foreach (int i, channels) {
+    if (! encodeChannels(flags, ctx, err, i, i+1))
+      return false;
+  }
+  foreach (int i, contacts) {
+    if (! encodeContacts(flags, ctx, err, i, i+1))
+      return false;
+  }
+  // The ID map is sorted by number, hence any modified contact may reorder it
+  if ((! contacts.isEmpty()) && (! encodeContactIDMap(flags, ctx, err)))
     return false;
-
-  if (! this->encodeAnalogContacts(flags, ctx, err))
+  if (analogContacts && (! encodeAnalogContacts(flags, ctx, err)))
     return false;
-
-  if (! this->encodeRXGroupLists(flags, ctx, err))
+  if (groupLists && (! encodeRXGroupLists(flags, ctx, err)))
     return false;
-
-  if (! this->encodeZones(flags, ctx, err))
-    return false;
-
-  if (! this->encodeScanLists(flags, ctx, err))
+  if (scanLists && (! encodeScanLists(flags, ctx, err)))
     return false;
+  return true;
+}
 
-  if (! this->encodeGPSSystems(flags, ctx, err))
-    return false;
+bool
+D868UVCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err)
+{
+  TaskGroup tasks(flags.parallelEncode);
+  this->addEncodeTasks(tasks, flags, ctx);
+  // The sections get encoded concurrently, hence the memory must not be shared anymore
+  if (tasks.isParallel())
+    detach();
+  return tasks.run(err);
+}
 
-  return true;
+void
+D868UVCodeplug::addEncodeTasks(TaskGroup &tasks, const Flags &flags, Context &ctx)
+{
+  // All sections are written into disjoint memory regions. Large sections get split into ranges.
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRadioID(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeGeneralSettings(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeBootSettings(flags, ctx, err); });
+  tasks.addRanges(ctx.config()->channelList()->count(), ENCODE_CHUNK_SIZE,
+                  [this, &flags, &ctx](int first, int last, const ErrorStack &err) {
+    return this->encodeChannels(flags, ctx, err, first, last); });
+  tasks.addRanges(ctx.config()->contacts()->digitalCount(), ENCODE_CHUNK_SIZE,
+                  [this, &flags, &ctx](int first, int last, const ErrorStack &err) {
+    return this->encodeContacts(flags, ctx, err, first, last); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeContactIDMap(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeAnalogContacts(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRXGroupLists(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeZones(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeScanLists(flags, ctx, err); });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeGPSSystems(flags, ctx, err); });
 }
 
 bool
 D868UVCodeplug::decodeElements(Context &ctx, const ErrorStack &err)
 {
+  // Decode channels and contacts first, the objects get created and linked below in order
+  ChannelRecords channels; ContactRecords contacts;
+  if (! this->decodeRecords(channels, contacts, err))
+    return false;
+
   if (! this->setRadioID(ctx, err))
     return false;
 
@@ -691,10 +742,10 @@ D868UVCodeplug::decodeElements(Context &ctx, const ErrorStack &err)
   if (! this->decodeBootSettings(ctx, err))
     return false;
 
-  if (! this->createChannels(ctx, err))
+  if (! this->createChannels(channels, ctx, err))
     return false;
 
-  if (! this->createContacts(ctx, err))
+  if (! this->createContacts(contacts, ctx, err))
     return false;
 
   if (! this->createAnalogContacts(ctx, err))
@@ -730,17 +781,46 @@ D868UVCodeplug::decodeElements(Context &ctx, const ErrorStack &err)
   return true;
 }
 
+bool
+D868UVCodeplug::decodeRecords(ChannelRecords &channels, ContactRecords &contacts, const ErrorStack &err) {
+  // The elements get decoded concurrently, hence the memory must not be shared anymore
+  detach();
+
+  // Decode ranges of channels and contacts into separate vectors, joined in order below
+  std::vector<ChannelRecords> channelChunks((NUM_CHANNELS+DECODE_CHUNK_SIZE-1)/DECODE_CHUNK_SIZE);
+  std::vector<ContactRecords> contactChunks((NUM_CONTACTS+DECODE_CHUNK_SIZE-1)/DECODE_CHUNK_SIZE);
+  TaskGroup tasks;
+  tasks.addRanges(NUM_CHANNELS, DECODE_CHUNK_SIZE,
+                  [this, &channelChunks](int first, int last, const ErrorStack &err) {
+    Q_UNUSED(err)
+    this->decodeChannelRecords(channelChunks[first/DECODE_CHUNK_SIZE], first, last);
+    return true;
+  });
+  tasks.addRanges(NUM_CONTACTS, DECODE_CHUNK_SIZE,
+                  [this, &contactChunks](int first, int last, const ErrorStack &err) {
+    Q_UNUSED(err)
+    this->decodeContactRecords(contactChunks[first/DECODE_CHUNK_SIZE], first, last);
+    return true;
+  });
+  if (! tasks.run(err))
+    return false;
+
+  channels.clear();
+  for (size_t i=0; i<channelChunks.size(); i++)
+    channels.append(channelChunks[i]);
+  contacts.clear();
+  for (size_t i=0; i<contactChunks.size(); i++)
+    contacts.append(contactChunks[i]);
+  return true;
+}
 
 void
 D868UVCodeplug::allocateChannels() {
   /* Allocate channels */
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Get byte and bit for channel, as well as bank of channel
-    uint16_t bit = i%8, byte = i/8, bank = i/128, idx=i%128;
-    // if disabled -> skip
-    if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), NUM_CHANNELS);
+  for (unsigned i=channel_bitmap.first(); i<channel_bitmap.size(); i=channel_bitmap.next(i+1)) {
+    // Get bank of enabled channel
+    uint16_t bank = i/128, idx=i%128;
     // compute address for channel
     uint32_t addr = CHANNEL_BANK_0
         + bank*CHANNEL_BANK_OFFSET
@@ -752,11 +832,13 @@ D868UVCodeplug::allocateChannels() {
 }
 
 bool
-D868UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err) {
+D868UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err, int first, int last) {
   Q_UNUSED(flags); Q_UNUSED(err)
 
   // Encode channels
-  for (int i=0; i<ctx.config()->channelList()->count(); i++) {
+  if ((0 > last) || (last > ctx.config()->channelList()->count()))
+    last = ctx.config()->channelList()->count();
+  for (int i=first; i<last; i++) {
     // enable channel
     uint16_t bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
@@ -766,18 +848,24 @@ D868UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStac
   return true;
 }
 
+void
+D868UVCodeplug::decodeChannelRecords(ChannelRecords &records, unsigned first, unsigned last) {
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), last);
+  for (unsigned i=channel_bitmap.next(first); i<last; i=channel_bitmap.next(i+1)) {
+    uint16_t bank = i/128, idx = i%128;
+    ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
+    records.append(qMakePair(unsigned(i), ch.toRecord()));
+  }
+}
+
 bool
-D868UVCodeplug::createChannels(Context &ctx, const ErrorStack &err) {
+D868UVCodeplug::createChannels(const ChannelRecords &records, Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
   // Create channels
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  for (int j=0; j<records.size(); j++) {
+    uint16_t i = records[j].first, bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
-    if (Channel *obj = ch.toChannelObj(ctx)) {
+    if (Channel *obj = ch.createChannelObj(records[j].second, ctx)) {
       ctx.config()->channelList()->add(obj); ctx.add(obj, i);
     }
   }
@@ -789,11 +877,9 @@ D868UVCodeplug::linkChannels(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Link channel objects
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == (((*data(CHANNEL_BITMAP+byte))>>bit) & 0x01))
-      continue;
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), NUM_CHANNELS);
+  for (unsigned i=channel_bitmap.first(); i<channel_bitmap.size(); i=channel_bitmap.next(i+1)) {
+    uint16_t bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
     if (ctx.has<Channel>(i))
       ch.linkChannelObj(ctx.get<Channel>(i), ctx);
@@ -814,12 +900,10 @@ D868UVCodeplug::allocateVFOSettings() {
 void
 D868UVCodeplug::allocateContacts() {
   /* Allocate contacts */
-  uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
+  // enabled if false (ass hole)
+  BitmapView contact_bitmap(data(CONTACTS_BITMAP), NUM_CONTACTS, true);
   unsigned contactCount=0;
-  for (uint16_t i=0; i<NUM_CONTACTS; i++) {
-    // enabled if false (ass hole)
-    if (1 == ((contact_bitmap[i/8]>>(i%8)) & 0x01))
-      continue;
+  for (unsigned i=contact_bitmap.first(); i<contact_bitmap.size(); i=contact_bitmap.next(i+1)) {
     contactCount++;
     uint32_t addr = CONTACT_BANK_0+(i/CONTACTS_PER_BANK)*CONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
@@ -836,19 +920,29 @@ D868UVCodeplug::allocateContacts() {
 }
 
 bool
-D868UVCodeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err) {
+D868UVCodeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err, int first, int last) {
   Q_UNUSED(flags); Q_UNUSED(err)
 
-  QVector<DigitalContact*> contacts;
-  // Encode contacts and also collect id<->index map
-  for (int i=0; i<ctx.config()->contacts()->digitalCount(); i++) {
+  // Encode contacts and the index list
+  if ((0 > last) || (last > ctx.config()->contacts()->digitalCount()))
+    last = ctx.config()->contacts()->digitalCount();
+  for (int i=first; i<last; i++) {
     ContactElement con(data(CONTACT_BANK_0+i*CONTACT_SIZE));
     DigitalContact *contact = ctx.config()->contacts()->digitalContact(i);
     if(! con.fromContactObj(contact, ctx))
       return false;
     ((uint32_t *)data(CONTACT_INDEX_LIST))[i] = qToLittleEndian(i);
-    contacts.append(contact);
   }
+  return true;
+}
+
+bool
+D868UVCodeplug::encodeContactIDMap(const Flags &flags, Context &ctx, const ErrorStack &err) {
+  Q_UNUSED(flags); Q_UNUSED(err)
+
+  QVector<DigitalContact*> contacts;
+  for (int i=0; i<ctx.config()->contacts()->digitalCount(); i++)
+    contacts.append(ctx.config()->contacts()->digitalContact(i));
   // encode index map for contacts
   std::sort(contacts.begin(), contacts.end(),
             [](DigitalContact *a, DigitalContact *b) {
@@ -862,19 +956,24 @@ D868UVCodeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStac
   return true;
 }
 
+void
+D868UVCodeplug::decodeContactRecords(ContactRecords &records, unsigned first, unsigned last) {
+  BitmapView contact_bitmap(data(CONTACTS_BITMAP), last, true);
+  for (unsigned i=contact_bitmap.next(first); i<last; i=contact_bitmap.next(i+1)) {
+    ContactElement con(data(CONTACT_BANK_0+i*CONTACT_SIZE));
+    records.append(qMakePair(unsigned(i), con.toRecord()));
+  }
+}
+
 bool
-D868UVCodeplug::createContacts(Context &ctx, const ErrorStack &err) {
+D868UVCodeplug::createContacts(const ContactRecords &records, Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create digital contacts
-  uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
-  for (uint16_t i=0; i<NUM_CONTACTS; i++) {
-    // Check if contact is enabled:
-    uint16_t  bit = i%8, byte = i/8;
-    if (1 == ((contact_bitmap[byte]>>bit) & 0x01))
-      continue;
+  for (int j=0; j<records.size(); j++) {
+    uint16_t i = records[j].first;
     ContactElement con(data(CONTACT_BANK_0+i*CONTACT_SIZE));
-    if (DigitalContact *obj = con.toContactObj(ctx)) {
+    if (DigitalContact *obj = con.createContactObj(records[j].second, ctx)) {
       ctx.config()->contacts()->add(obj); ctx.add(obj, i);
     }
   }
@@ -938,13 +1037,8 @@ D868UVCodeplug::createAnalogContacts(Context &ctx, const ErrorStack &err) {
 void
 D868UVCodeplug::allocateRadioIDs() {
   /* Allocate radio IDs */
-  uint8_t *radioid_bitmap = data(RADIOID_BITMAP);
-  for (uint8_t i=0; i<NUM_RADIOIDS; i++) {
-    // Get byte and bit for radio ID
-    uint16_t bit = i%8, byte = i/8;
-    // if disabled -> skip
-    if (0 == ((radioid_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView radioid_bitmap(data(RADIOID_BITMAP), NUM_RADIOIDS);
+  for (unsigned i=radioid_bitmap.first(); i<radioid_bitmap.size(); i=radioid_bitmap.next(i+1)) {
     // Allocate radio IDs individually
     uint32_t addr = ADDR_RADIOIDS + i*RADIOID_SIZE;
     if (nullptr == data(addr, 0)) {
@@ -970,10 +1064,8 @@ D868UVCodeplug::setRadioID(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Find a valid RadioID
-  uint8_t *radio_id_bitmap = data(RADIOID_BITMAP);
-  for (uint16_t i=0; i<NUM_RADIOIDS; i++) {
-    if (0 == (radio_id_bitmap[i/8] & (1 << (i%8))))
-      continue;
+  BitmapView radio_id_bitmap(data(RADIOID_BITMAP), NUM_RADIOIDS);
+  for (unsigned i=radio_id_bitmap.first(); i<radio_id_bitmap.size(); i=radio_id_bitmap.next(i+1)) {
     RadioIDElement id(data(ADDR_RADIOIDS + i*RADIOID_SIZE));
     logDebug() << "Store id " << id.number() << " at idx " << i << ".";
     if (DMRRadioID *rid = id.toRadioID()) {
@@ -989,13 +1081,8 @@ D868UVCodeplug::allocateRXGroupLists() {
   /*
    * Allocate group lists
    */
-  uint8_t *grouplist_bitmap = data(RXGRP_BITMAP);
-  for (uint16_t i=0; i<NUM_RXGRP; i++) {
-    // Get byte and bit for group list
-    uint16_t bit = i%8, byte = i/8;
-    // if disabled -> skip
-    if (0 == ((grouplist_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView grouplist_bitmap(data(RXGRP_BITMAP), NUM_RXGRP);
+  for (unsigned i=grouplist_bitmap.first(); i<grouplist_bitmap.size(); i=grouplist_bitmap.next(i+1)) {
     // Allocate RX group lists indivitually
     uint32_t addr = ADDR_RXGRP_0 + i*RXGRP_OFFSET;
     if (nullptr == data(addr, 0)) {
@@ -1023,12 +1110,8 @@ D868UVCodeplug::createRXGroupLists(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create RX group lists
-  uint8_t *grouplist_bitmap = data(RXGRP_BITMAP);
-  for (uint16_t i=0; i<NUM_RXGRP; i++) {
-    // check if group list is enabled
-    uint16_t  bit = i%8, byte = i/8;
-    if (0 == ((grouplist_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView grouplist_bitmap(data(RXGRP_BITMAP), NUM_RXGRP);
+  for (unsigned i=grouplist_bitmap.first(); i<grouplist_bitmap.size(); i=grouplist_bitmap.next(i+1)) {
     // construct RXGroupList from definition
     GroupListElement grp(data(ADDR_RXGRP_0+i*RXGRP_OFFSET));
     if (RXGroupList *obj = grp.toGroupListObj()) {
@@ -1042,12 +1125,8 @@ bool
 D868UVCodeplug::linkRXGroupLists(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
-  uint8_t *grouplist_bitmap = data(RXGRP_BITMAP);
-  for (uint16_t i=0; i<NUM_RXGRP; i++) {
-    // check if group list is enabled
-    uint16_t  bit = i%8, byte = i/8;
-    if (0 == ((grouplist_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView grouplist_bitmap(data(RXGRP_BITMAP), NUM_RXGRP);
+  for (unsigned i=grouplist_bitmap.first(); i<grouplist_bitmap.size(); i=grouplist_bitmap.next(i+1)) {
     // link group list
     GroupListElement grp(data(ADDR_RXGRP_0+i*RXGRP_OFFSET));
     if (! grp.linkGroupList(ctx.get<RXGroupList>(i), ctx)) {
@@ -1061,13 +1140,8 @@ D868UVCodeplug::linkRXGroupLists(Context &ctx, const ErrorStack &err) {
 
 void
 D868UVCodeplug::allocateZones() {
-  uint8_t *zone_bitmap = data(ZONE_BITMAPS);
-  for (uint16_t i=0; i<NUM_ZONES; i++) {
-    // Get byte and bit for zone
-    uint16_t bit = i%8, byte = i/8;
-    // if invalid -> skip
-    if (0 == ((zone_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView zone_bitmap(data(ZONE_BITMAPS), NUM_ZONES);
+  for (unsigned i=zone_bitmap.first(); i<zone_bitmap.size(); i=zone_bitmap.next(i+1)) {
     // Allocate zone itself
     image(0).addElement(ADDR_ZONE+i*ZONE_OFFSET, ZONE_SIZE);
     image(0).addElement(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET, ZONE_NAME_SIZE);
@@ -1131,14 +1205,10 @@ D868UVCodeplug::createZones(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create zones
-  uint8_t *zone_bitmap = data(ZONE_BITMAPS);
+  BitmapView zone_bitmap(data(ZONE_BITMAPS), NUM_ZONES);
   QString last_zonename, last_zonebasename; Zone *last_zone = nullptr;
   bool extend_last_zone = false;
-  for (uint16_t i=0; i<NUM_ZONES; i++) {
-    // Check if zone is enabled:
-    uint16_t bit = i%8, byte = i/8;
-    if (0 == ((zone_bitmap[byte]>>bit) & 0x01))
-      continue;
+  for (unsigned i=zone_bitmap.first(); i<zone_bitmap.size(); i=zone_bitmap.next(i+1)) {
     // Determine whether this zone should be combined with the previous one
     QString zonename = decode_ascii(data(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET), 16, 0);
     QString zonebasename = zonename; zonebasename.chop(2);
@@ -1180,14 +1250,10 @@ D868UVCodeplug::linkZones(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create zones
-  uint8_t *zone_bitmap = data(ZONE_BITMAPS);
+  BitmapView zone_bitmap(data(ZONE_BITMAPS), NUM_ZONES);
   QString last_zonename, last_zonebasename; Zone *last_zone = nullptr;
   bool extend_last_zone = false;
-  for (uint16_t i=0; i<NUM_ZONES; i++) {
-    // Check if zone is enabled:
-    uint16_t bit = i%8, byte = i/8;
-    if (0 == ((zone_bitmap[byte]>>bit) & 0x01))
-      continue;
+  for (unsigned i=zone_bitmap.first(); i<zone_bitmap.size(); i=zone_bitmap.next(i+1)) {
     // Determine whether this zone should be combined with the previous one
     QString zonename = decode_ascii(data(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET), 16, 0);
     QString zonebasename = zonename; zonebasename.chop(2);
@@ -1239,14 +1305,10 @@ D868UVCodeplug::allocateScanLists() {
   /*
    * Allocate scan lists
    */
-  uint8_t *scanlist_bitmap = data(SCAN_BITMAP);
-  for (uint8_t i=0; i<NUM_SCAN_LISTS; i++) {
-    // Get byte and bit for scan list, bank and bank_idx
-    uint16_t bit = i%8, byte = i/8;
+  BitmapView scanlist_bitmap(data(SCAN_BITMAP), NUM_SCAN_LISTS);
+  for (unsigned i=scanlist_bitmap.first(); i<scanlist_bitmap.size(); i=scanlist_bitmap.next(i+1)) {
+    // Get bank and bank_idx for scan list
     uint8_t bank = (i/NUM_SCANLISTS_PER_BANK), bank_idx = (i%NUM_SCANLISTS_PER_BANK);
-    // if disabled -> skip
-    if (0 == ((scanlist_bitmap[byte]>>bit) & 0x01))
-      continue;
     // Allocate scan lists indivitually
     uint32_t addr = SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + bank_idx*SCAN_LIST_OFFSET;
     if (nullptr == data(addr, 0)) {
@@ -1274,11 +1336,8 @@ D868UVCodeplug::createScanLists(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create scan lists
-  uint8_t *scanlist_bitmap = data(SCAN_BITMAP);
-  for (unsigned i=0; i<NUM_SCAN_LISTS; i++) {
-    uint8_t byte=i/8, bit=i%8;
-    if (0 == ((scanlist_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView scanlist_bitmap(data(SCAN_BITMAP), NUM_SCAN_LISTS);
+  for (unsigned i=scanlist_bitmap.first(); i<scanlist_bitmap.size(); i=scanlist_bitmap.next(i+1)) {
     uint8_t bank = i/NUM_SCANLISTS_PER_BANK, bank_idx = i%NUM_SCANLISTS_PER_BANK;
     uint32_t addr = SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + bank_idx*SCAN_LIST_OFFSET;
     ScanListElement scanl(data(addr));
@@ -1293,11 +1352,8 @@ bool
 D868UVCodeplug::linkScanLists(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
-  uint8_t *scanlist_bitmap = data(SCAN_BITMAP);
-  for (unsigned i=0; i<NUM_SCAN_LISTS; i++) {
-    uint8_t byte=i/8, bit=i%8;
-    if (0 == ((scanlist_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView scanlist_bitmap(data(SCAN_BITMAP), NUM_SCAN_LISTS);
+  for (unsigned i=scanlist_bitmap.first(); i<scanlist_bitmap.size(); i=scanlist_bitmap.next(i+1)) {
     uint8_t bank = i/NUM_SCANLISTS_PER_BANK, bank_idx = i%NUM_SCANLISTS_PER_BANK;
     uint32_t addr = SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + bank_idx*SCAN_LIST_OFFSET;
     ScanListElement scanl(data(addr));
@@ -1383,12 +1439,9 @@ D868UVCodeplug::createGPSSystems(Context &ctx, const ErrorStack &err) {
   QSet<uint8_t> systems;
   // First find all GPS systems linked, that is referenced by any channel
   // Create channels
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), NUM_CHANNELS);
+  for (unsigned i=channel_bitmap.first(); i<channel_bitmap.size(); i=channel_bitmap.next(i+1)) {
+    uint16_t bank = i/128, idx = i%128;
     if (ctx.get<Channel>(i)->is<AnalogChannel>())
       continue;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
@@ -1465,11 +1518,8 @@ D868UVCodeplug::allocateFMBroadcastSettings() {
 void
 D868UVCodeplug::allocate5ToneIDs() {
   // Allocate 5-tone functions
-  uint8_t *bitmap = data(FIVE_TONE_ID_BITMAP);
-  for (uint8_t i=0; i<NUM_FIVE_TONE_IDS; i++) {
-    uint16_t  bit = i%8, byte = i/8;
-    if (0 == (bitmap[byte] & (1<<bit)))
-      continue;
+  BitmapView bitmap(data(FIVE_TONE_ID_BITMAP), NUM_FIVE_TONE_IDS);
+  for (unsigned i=bitmap.first(); i<bitmap.size(); i=bitmap.next(i+1)) {
     image(0).addElement(ADDR_FIVE_TONE_ID_LIST + i*FIVE_TONE_ID_SIZE, FIVE_TONE_ID_SIZE);
   }
 }
@@ -1487,11 +1537,8 @@ D868UVCodeplug::allocate5ToneSettings() {
 void
 D868UVCodeplug::allocate2ToneIDs() {
   // Allocate 2-tone encoding
-  uint8_t *enc_bitmap = data(TWO_TONE_IDS_BITMAP);
-  for (uint8_t i=0; i<NUM_TWO_TONE_IDS; i++) {
-    uint16_t  bit = i%8, byte = i/8;
-    if (0 == (enc_bitmap[byte] & (1<<bit)))
-      continue;
+  BitmapView enc_bitmap(data(TWO_TONE_IDS_BITMAP), NUM_TWO_TONE_IDS);
+  for (unsigned i=enc_bitmap.first(); i<enc_bitmap.size(); i=enc_bitmap.next(i+1)) {
     image(0).addElement(ADDR_TWO_TONE_IDS + i*TWO_TONE_ID_SIZE, TWO_TONE_ID_SIZE);
   }
 }
@@ -1500,11 +1547,8 @@ D868UVCodeplug::allocate2ToneIDs() {
 void
 D868UVCodeplug::allocate2ToneFunctions() {
   // Allocate 2-tone decoding
-  uint8_t *dec_bitmap = data(TWO_TONE_FUNCTIONS_BITMAP);
-  for (uint8_t i=0; i<NUM_TWO_TONE_FUNCTIONS; i++) {
-    uint16_t  bit = i%8, byte = i/8;
-    if (0 == (dec_bitmap[byte] & (1<<bit)))
-      continue;
+  BitmapView dec_bitmap(data(TWO_TONE_FUNCTIONS_BITMAP), NUM_TWO_TONE_FUNCTIONS);
+  for (unsigned i=dec_bitmap.first(); i<dec_bitmap.size(); i=dec_bitmap.next(i+1)) {
     image(0).addElement(ADDR_TWO_TONE_FUNCTIONS + i*TWO_TONE_FUNCTION_SIZE, TWO_TONE_FUNCTION_SIZE);
   }
 }
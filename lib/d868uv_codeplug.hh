@@ -2,11 +2,14 @@
 #define D868UV_CODEPLUG_HH
 
 #include <QDateTime>
+#include <QVector>
+#include <QPair>
 
 #include "anytone_codeplug.hh"
 #include "signaling.hh"
 #include "codeplugcontext.hh"
 
+class TaskGroup;
 class Channel;
 class DigitalContact;
 class Zone;
@@ -316,6 +319,11 @@ public:
     virtual bool updateConfig(Context &ctx);
   };
 
+  /** Decoded channel elements and their indices, ordered by index. */
+  typedef QVector<QPair<unsigned, ChannelElement::Record>> ChannelRecords;
+  /** Decoded contact elements and their indices, ordered by index. */
+  typedef QVector<QPair<unsigned, ContactElement::Record>> ContactRecords;
+
 public:
   /** Empty constructor. */
   explicit D868UVCodeplug(QObject *parent = nullptr);
@@ -340,19 +348,36 @@ public:
 
   /** Encodes the given generic configuration as a binary codeplug. */
   bool encode(Config *config, const Flags &flags=Flags(), const ErrorStack &err=ErrorStack());
+  /** Re-encodes the modified channels, contacts, group lists and scan lists. Any other modified
+   * object requires a complete encoding. */
+  bool encodeModified(const QList<ConfigItem *> &items, const Flags &flags, Context &ctx,
+                      const ErrorStack &err=ErrorStack());
 
 protected:
   /** Encodes the given config (via context) to the binary codeplug. */
   virtual bool encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  /** Adds the tasks encoding the independent sections of the codeplug to the given task group.
+   * The tasks are run in the order they were added, or in parallel if
+   * @c Flags::parallelEncode is set. */
+  virtual void addEncodeTasks(TaskGroup &tasks, const Flags &flags, Context &ctx);
   /** Decodes the downloaded codeplug. */
   virtual bool decodeElements(Context &ctx, const ErrorStack &err=ErrorStack());
 
+  /** Decodes the channel and contact elements into records. Records do not refer to any config
+   * object, hence the elements get decoded in parallel. */
+  virtual bool decodeRecords(ChannelRecords &channels, ContactRecords &contacts,
+                             const ErrorStack &err=ErrorStack());
+
   /** Allocate channels from bitmap. */
   virtual void allocateChannels();
-  /** Encode channels into codeplug. */
-  virtual bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
-  /** Create channels from codeplug. */
-  virtual bool createChannels(Context &ctx, const ErrorStack &err=ErrorStack());
+  /** Encode channels [first, last) into codeplug. If @c last is negative, all channels starting at
+   * @c first are encoded. */
+  virtual bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack(),
+                              int first=0, int last=-1);
+  /** Decodes the enabled channels with indices [first, last) into records. */
+  virtual void decodeChannelRecords(ChannelRecords &records, unsigned first, unsigned last);
+  /** Create channels from the decoded records. */
+  virtual bool createChannels(const ChannelRecords &records, Context &ctx, const ErrorStack &err=ErrorStack());
   /** Link channels. */
   virtual bool linkChannels(Context &ctx, const ErrorStack &err=ErrorStack());
 
@@ -361,10 +386,17 @@ protected:
 
   /** Allocate contacts from bitmaps. */
   virtual void allocateContacts();
-  /** Encode contacts into codeplug. */
-  virtual bool encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
-  /** Create contacts from codeplug. */
-  virtual bool createContacts(Context &ctx, const ErrorStack &err=ErrorStack());
+  /** Encode contacts [first, last) and their index list into codeplug. If @c last is negative, all
+   * contacts starting at @c first are encoded. */
+  virtual bool encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack(),
+                              int first=0, int last=-1);
+  /** Encode the contact ID map into codeplug. That is, the index of all contacts sorted by their
+   * ID. */
+  virtual bool encodeContactIDMap(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  /** Decodes the enabled contacts with indices [first, last) into records. */
+  virtual void decodeContactRecords(ContactRecords &records, unsigned first, unsigned last);
+  /** Create contacts from the decoded records. */
+  virtual bool createContacts(const ContactRecords &records, Context &ctx, const ErrorStack &err=ErrorStack());
 
   /** Allocate analog contacts from bitmaps. */
   virtual void allocateAnalogContacts();
@@ -34,19 +34,16 @@ D878UV2CallsignDB::encode(UserDatabase *db, const Selection &selection, const Er
   if (selection.hasCountLimit())
     n = std::min(n, (qint64)selection.countLimit());
 
-  // Select n users and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  users.reserve(n);
-  for (unsigned i=0; i<n; i++)
-    users.append(db->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
-
-  // Compute total size of callsign db entries
+  // Select up to n users matching the filters and closest to the prefixes, sorted in ascending
+  // order of their IDs
+  QVector<UserDatabase::UserView> users = db->select(selection, n);
+  n = users.size();
+
+  // Compute size of each callsign db entry once and the total size
+  QVector<unsigned> sizes(n);
   size_t dbSize = 0;
-  size_t indexSize = n*IndexEntryElement::size();
   for (qint64 i=0; i<n; i++)
-    dbSize += EntryElement::size(users[i]);
+    dbSize += (sizes[i] = EntryElement::size(users[i]));
 
   // Allocate DB limits
   image(0).addElement(CALLSIGN_LIMITS, LimitsElement::size());
@@ -56,21 +53,9 @@ D878UV2CallsignDB::encode(UserDatabase *db, const Selection &selection, const Er
   limits.setCount(n);
   limits.setTotalSize(dbSize);
 
-  // Allocate index banks
-  for (int i=0; 0<indexSize; i++, indexSize-=std::min(indexSize, size_t(CALLSIGN_INDEX_BANK_SIZE))) {
-    size_t addr = CALLSIGN_INDEX_BANK0 + i*CALLSIGN_INDEX_BANK_OFFSET;
-    size_t size = align_size(std::min(indexSize, size_t(CALLSIGN_INDEX_BANK_SIZE)), 16);
-    image(0).addElement(addr, size);
-    memset(data(addr), 0xff, size);
-  }
-
-  // Allocate entry banks
-  for (int i=0; 0<dbSize; i++, dbSize-=std::min(dbSize, size_t(CALLSIGN_BANK_SIZE))) {
-    size_t addr = CALLSIGN_BANK0 + i*CALLSIGN_BANK_OFFSET;
-    size_t size = align_size(std::min(dbSize, size_t(CALLSIGN_BANK_SIZE)), 16);
-    image(0).addElement(addr, size);
-    memset(data(addr), 0x00, size);
-  }
+  // Allocate index and entry banks
+  allocateIndex(image(0), n);
+  allocateEntries(image(0), dbSize);
 
   // Fill index, the offset of the entry is not the real memory offset,
   // but a virtual one without the gaps.
@@ -82,9 +67,9 @@ D878UV2CallsignDB::encode(UserDatabase *db, const Selection &selection, const Er
       index_offset = 0; index_bank += 1;
     }
     IndexEntryElement index(data(CALLSIGN_INDEX_BANK0+index_bank*CALLSIGN_BANK_OFFSET+index_offset));
-    index.setID(users[i].id, false);
+    index.setID(users[i].id(), false);
     index.setIndex(entry_offset);
-    entry_offset += EntryElement::size(users[i]);
+    entry_offset += sizes[i];
   }
 
   // Then store DB entries
@@ -92,7 +77,7 @@ D878UV2CallsignDB::encode(UserDatabase *db, const Selection &selection, const Er
   entry_offset = 0;
   for (qint64 i=0; i<n; i++) {
     // Get size of current entry
-    uint32_t entry_size = EntryElement::size(users[i]);
+    uint32_t entry_size = sizes[i];
     // Check if entry fits into bank
     if (CALLSIGN_BANK_SIZE < (entry_offset+entry_size)) {
       // If not, split
@@ -118,3 +103,23 @@ D878UV2CallsignDB::encode(UserDatabase *db, const Selection &selection, const Er
 
   return true;
 }
+
+unsigned
+D878UV2CallsignDB::capacity() const {
+  return MAX_CALLSIGNS;
+}
+
+uint32_t
+D878UV2CallsignDB::limitsAddress() const {
+  return CALLSIGN_LIMITS;
+}
+
+void
+D878UV2CallsignDB::allocateEntries(DFUFile::Image &image, size_t size) const {
+  for (int i=0; 0<size; i++, size-=std::min(size, size_t(CALLSIGN_BANK_SIZE))) {
+    size_t addr = CALLSIGN_BANK0 + i*CALLSIGN_BANK_OFFSET;
+    size_t bankSize = align_size(std::min(size, size_t(CALLSIGN_BANK_SIZE)), 16);
+    image.addElement(addr, bankSize);
+    memset(image.data(addr), 0x00, bankSize);
+  }
+}
@@ -34,6 +34,10 @@ public:
   /** Tries to encode as many entries of the given user-database. */
   bool encode(UserDatabase *db, const Selection &selection=Selection(),
               const ErrorStack &err=ErrorStack());
+
+  unsigned capacity() const;
+  uint32_t limitsAddress() const;
+  void allocateEntries(DFUFile::Image &image, size_t size) const;
 };
 
 #endif // D868UVCALLSIGNDB_HH
@@ -6,6 +6,7 @@
 #include "userdatabase.hh"
 #include "config.h"
 #include "logger.hh"
+#include "bitmapview.hh"
 
 #include <QTimeZone>
 #include <QtEndian>
@@ -38,12 +39,10 @@ D878UV2Codeplug::D878UV2Codeplug(QObject *parent)
 void
 D878UV2Codeplug::allocateContacts() {
   /* Allocate contacts */
-  uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
+  // enabled if false (ass hole)
+  BitmapView contact_bitmap(data(CONTACTS_BITMAP), NUM_CONTACTS, true);
   unsigned contactCount=0;
-  for (uint16_t i=0; i<NUM_CONTACTS; i++) {
-    // enabled if false (ass hole)
-    if (1 == ((contact_bitmap[i/8]>>(i%8)) & 0x01))
-      continue;
+  for (unsigned i=contact_bitmap.first(); i<contact_bitmap.size(); i=contact_bitmap.next(i+1)) {
     contactCount++;
     uint32_t addr = CONTACT_BANK_0+(i/CONTACTS_PER_BANK)*CONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
@@ -60,19 +59,29 @@ D878UV2Codeplug::allocateContacts() {
 }
 
 bool
-D878UV2Codeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err) {
+D878UV2Codeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err, int first, int last) {
   Q_UNUSED(flags); Q_UNUSED(err)
 
-  QVector<DigitalContact*> contacts;
-  // Encode contacts and also collect id<->index map
-  for (int i=0; i<ctx.config()->contacts()->digitalCount(); i++) {
+  // Encode contacts and the index list
+  if ((0 > last) || (last > ctx.config()->contacts()->digitalCount()))
+    last = ctx.config()->contacts()->digitalCount();
+  for (int i=first; i<last; i++) {
     ContactElement con(data(CONTACT_BANK_0+i*CONTACT_SIZE));
     DigitalContact *contact = ctx.config()->contacts()->digitalContact(i);
     if(! con.fromContactObj(contact, ctx))
       return false;
     ((uint32_t *)data(CONTACT_INDEX_LIST))[i] = qToLittleEndian(i);
-    contacts.append(contact);
   }
+  return true;
+}
+
+bool
+D878UV2Codeplug::encodeContactIDMap(const Flags &flags, Context &ctx, const ErrorStack &err) {
+  Q_UNUSED(flags); Q_UNUSED(err)
+
+  QVector<DigitalContact*> contacts;
+  for (int i=0; i<ctx.config()->contacts()->digitalCount(); i++)
+    contacts.append(ctx.config()->contacts()->digitalContact(i));
   // encode index map for contacts
   std::sort(contacts.begin(), contacts.end(),
             [](DigitalContact *a, DigitalContact *b) {
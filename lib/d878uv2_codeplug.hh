@@ -203,7 +203,9 @@ public:
   explicit D878UV2Codeplug(QObject *parent = nullptr);
 
   void allocateContacts();
-  bool encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  bool encodeContacts(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack(),
+                      int first=0, int last=-1);
+  bool encodeContactIDMap(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
 };
 
 #endif // D878UVCODEPLUG_HH
@@ -6,6 +6,8 @@
 #include "userdatabase.hh"
 #include "config.h"
 #include "logger.hh"
+#include "taskgroup.hh"
+#include "bitmapview.hh"
 
 #include <QTimeZone>
 #include <QtEndian>
@@ -176,8 +178,8 @@ D878UVCodeplug::ChannelElement::setFrequencyCorrection(int corr) {
 }
 
 Channel *
-D878UVCodeplug::ChannelElement::toChannelObj(Context &ctx) const {
-  Channel *ch = AnytoneCodeplug::ChannelElement::toChannelObj(ctx);
+D878UVCodeplug::ChannelElement::createChannelObj(const Record &rec, Context &ctx) const {
+  Channel *ch = AnytoneCodeplug::ChannelElement::createChannelObj(rec, ctx);
 
   if (nullptr == ch)
     return nullptr;
@@ -2181,32 +2183,39 @@ D878UVCodeplug::setBitmaps(Config *config)
   D868UVCodeplug::setBitmaps(config);
 
   // Mark roaming zones
-  uint8_t *roaming_zone_bitmap = data(ADDR_ROAMING_ZONE_BITMAP);
-  memset(roaming_zone_bitmap, 0x00, ROAMING_ZONE_BITMAP_SIZE);
-  for (int i=0; i<config->roaming()->count(); i++)
-    roaming_zone_bitmap[i/8] |= (1<<(i%8));
+  memset(data(ADDR_ROAMING_ZONE_BITMAP), 0x00, ROAMING_ZONE_BITMAP_SIZE);
+  BitmapView(data(ADDR_ROAMING_ZONE_BITMAP), NUM_ROAMING_ZONES).setRange(
+        0, config->roaming()->count());
 
   // Mark roaming channels
-  uint8_t *roaming_ch_bitmap = data(ADDR_ROAMING_CHANNEL_BITMAP);
-  memset(roaming_ch_bitmap, 0x00, ROAMING_CHANNEL_BITMAP_SIZE);
+  memset(data(ADDR_ROAMING_CHANNEL_BITMAP), 0x00, ROAMING_CHANNEL_BITMAP_SIZE);
   // Get all (unique) channels used in roaming
   QSet<DigitalChannel*> roaming_channels;
   config->roaming()->uniqueChannels(roaming_channels);
-  for (int i=0; i<std::min(NUM_ROAMING_CHANNEL,roaming_channels.count()); i++)
-    roaming_ch_bitmap[i/8] |= (1<<(i%8));
+  BitmapView(data(ADDR_ROAMING_CHANNEL_BITMAP), NUM_ROAMING_CHANNEL).setRange(
+        0, std::min(NUM_ROAMING_CHANNEL,roaming_channels.count()));
 }
 
 
-bool
-D878UVCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err)
+void
+D878UVCodeplug::addEncodeTasks(TaskGroup &tasks, const Flags &flags, Context &ctx)
 {
   // Encode everything common between d868uv and d878uv radios.
-  if (! D868UVCodeplug::encodeElements(flags, ctx, err))
-    return false;
+  D868UVCodeplug::addEncodeTasks(tasks, flags, ctx);
+
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRoaming(flags, ctx, err); });
+}
 
-  if (! this->encodeRoaming(flags, ctx, err))
+bool
+D878UVCodeplug::encodeModified(const QList<ConfigItem *> &items, const Flags &flags, Context &ctx, const ErrorStack &err) {
+  if (! D868UVCodeplug::encodeModified(items, flags, ctx, err))
     return false;
 
+  foreach (ConfigItem *item, items) {
+    if (item->is<Channel>())
+      return this->encodeRoaming(flags, ctx, err);
+  }
   return true;
 }
 
@@ -2230,13 +2239,10 @@ D878UVCodeplug::decodeElements(Context &ctx, const ErrorStack &err)
 void
 D878UVCodeplug::allocateChannels() {
   /* Allocate channels */
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Get byte and bit for channel, as well as bank of channel
-    uint16_t bit = i%8, byte = i/8, bank = i/128, idx=i%128;
-    // if disabled -> skip
-    if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), NUM_CHANNELS);
+  for (unsigned i=channel_bitmap.first(); i<channel_bitmap.size(); i=channel_bitmap.next(i+1)) {
+    // Get bank of enabled channel
+    uint16_t bank = i/128, idx=i%128;
     // compute address for channel
     uint32_t addr = CHANNEL_BANK_0
         + bank*CHANNEL_BANK_OFFSET
@@ -2252,10 +2258,12 @@ D878UVCodeplug::allocateChannels() {
 }
 
 bool
-D878UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err) {
+D878UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err, int first, int last) {
   Q_UNUSED(flags); Q_UNUSED(err)
   // Encode channels
-  for (int i=0; i<ctx.config()->channelList()->count(); i++) {
+  if ((0 > last) || (last > ctx.config()->channelList()->count()))
+    last = ctx.config()->channelList()->count();
+  for (int i=first; i<last; i++) {
     // enable channel
     uint16_t bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
@@ -2265,18 +2273,14 @@ D878UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStac
 }
 
 bool
-D878UVCodeplug::createChannels(Context &ctx, const ErrorStack &err) {
+D878UVCodeplug::createChannels(const ChannelRecords &records, Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Create channels
-  uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  for (int j=0; j<records.size(); j++) {
+    uint16_t i = records[j].first, bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
-    if (Channel *obj = ch.toChannelObj(ctx)) {
+    if (Channel *obj = ch.createChannelObj(records[j].second, ctx)) {
       ctx.config()->channelList()->add(obj); ctx.add(obj, i);
     }
   }
@@ -2288,11 +2292,9 @@ D878UVCodeplug::linkChannels(Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
   // Link channel objects
-  for (uint16_t i=0; i<NUM_CHANNELS; i++) {
-    // Check if channel is enabled:
-    uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
-    if (0 == (((*data(CHANNEL_BITMAP+byte))>>bit) & 0x01))
-      continue;
+  BitmapView channel_bitmap(data(CHANNEL_BITMAP), NUM_CHANNELS);
+  for (unsigned i=channel_bitmap.first(); i<channel_bitmap.size(); i=channel_bitmap.next(i+1)) {
+    uint16_t bank = i/128, idx = i%128;
     ChannelElement ch(data(CHANNEL_BANK_0 + bank*CHANNEL_BANK_OFFSET + idx*CHANNEL_SIZE));
     if (ctx.has<Channel>(i))
       ch.linkChannelObj(ctx.get<Channel>(i), ctx);
@@ -2472,13 +2474,9 @@ D878UVCodeplug::linkGPSSystems(Context &ctx, const ErrorStack &err) {
 void
 D878UVCodeplug::allocateRoaming() {
   /* Allocate roaming channels */
-  uint8_t *roaming_channel_bitmap = data(ADDR_ROAMING_CHANNEL_BITMAP);
-  for (uint8_t i=0; i<NUM_ROAMING_CHANNEL; i++) {
-    // Get byte and bit for roaming channel
-    uint16_t bit = i%8, byte = i/8;
-    // if disabled -> skip
-    if (0 == ((roaming_channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView roaming_channel_bitmap(data(ADDR_ROAMING_CHANNEL_BITMAP), NUM_ROAMING_CHANNEL);
+  for (unsigned i=roaming_channel_bitmap.first(); i<roaming_channel_bitmap.size();
+       i=roaming_channel_bitmap.next(i+1)) {
     // Allocate roaming channel
     uint32_t addr = ADDR_ROAMING_CHANNEL_0 + i*ROAMING_CHANNEL_OFFSET;
     if (nullptr == data(addr, 0))
@@ -2486,13 +2484,9 @@ D878UVCodeplug::allocateRoaming() {
   }
 
   /* Allocate roaming zones. */
-  uint8_t *roaming_zone_bitmap = data(ADDR_ROAMING_ZONE_BITMAP);
-  for (uint8_t i=0; i<NUM_ROAMING_ZONES; i++) {
-    // Get byte and bit for radio ID
-    uint16_t bit = i%8, byte = i/8;
-    // if disabled -> skip
-    if (0 == ((roaming_zone_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView roaming_zone_bitmap(data(ADDR_ROAMING_ZONE_BITMAP), NUM_ROAMING_ZONES);
+  for (unsigned i=roaming_zone_bitmap.first(); i<roaming_zone_bitmap.size();
+       i=roaming_zone_bitmap.next(i+1)) {
     // Allocate roaming zone
     uint32_t addr = ADDR_ROAMING_ZONE_0 + i*ROAMING_ZONE_OFFSET;
     if (nullptr == data(addr, 0)) {
@@ -2541,11 +2535,9 @@ D878UVCodeplug::createRoaming(Context &ctx, const ErrorStack &err) {
 
   QHash<unsigned, DigitalChannel*> map;
   // Create or find roaming channels
-  uint8_t *roaming_channel_bitmap = data(ADDR_ROAMING_CHANNEL_BITMAP);
-  for (int i=0; i<NUM_ROAMING_CHANNEL; i++) {
-    uint8_t byte=i/8, bit=i%8;
-    if (0 == ((roaming_channel_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView roaming_channel_bitmap(data(ADDR_ROAMING_CHANNEL_BITMAP), NUM_ROAMING_CHANNEL);
+  for (unsigned i=roaming_channel_bitmap.first(); i<roaming_channel_bitmap.size();
+       i=roaming_channel_bitmap.next(i+1)) {
     uint32_t addr = ADDR_ROAMING_CHANNEL_0 + i*ROAMING_CHANNEL_OFFSET;
     RoamingChannelElement ch(data(addr));
     if (DigitalChannel *digi = ch.toChannel(ctx))
@@ -2553,11 +2545,9 @@ D878UVCodeplug::createRoaming(Context &ctx, const ErrorStack &err) {
   }
 
   // Create and link roaming zones
-  uint8_t *roaming_zone_bitmap = data(ADDR_ROAMING_ZONE_BITMAP);
-  for (int i=0; i<NUM_ROAMING_ZONES; i++) {
-    uint8_t byte=i/8, bit=i%8;
-    if (0 == ((roaming_zone_bitmap[byte]>>bit) & 0x01))
-      continue;
+  BitmapView roaming_zone_bitmap(data(ADDR_ROAMING_ZONE_BITMAP), NUM_ROAMING_ZONES);
+  for (unsigned i=roaming_zone_bitmap.first(); i<roaming_zone_bitmap.size();
+       i=roaming_zone_bitmap.next(i+1)) {
     uint32_t addr = ADDR_ROAMING_ZONE_0 + i*ROAMING_ZONE_OFFSET;
     RoamingZoneElement z(data(addr));
     RoamingZone *zone = z.toRoamingZone();
@@ -310,8 +310,8 @@ public:
     /** Sets the frequency correction in ???. */
     virtual void setFrequencyCorrection(int corr);
 
-    /** Constructs a Channel object from this element. */
-    Channel *toChannelObj(Context &ctx) const;
+    /** Constructs a Channel object from the given record, decoded from this element. */
+    Channel *createChannelObj(const Record &rec, Context &ctx) const;
     /** Links a previously created channel object. */
     bool linkChannelObj(Channel *c, Context &ctx) const;
     /** Encodes the given channel object. */
@@ -1371,13 +1371,19 @@ public:
   /** Allocate all code-plug elements that are defined through the common Config. */
   void allocateForEncoding();
 
+  /** Re-encodes the modified objects. The roaming channels are derived from the channels, hence
+   * they get updated once any channel is modified. */
+  bool encodeModified(const QList<ConfigItem *> &items, const Flags &flags, Context &ctx,
+                      const ErrorStack &err=ErrorStack());
+
 protected:
   bool decodeElements(Context &ctx, const ErrorStack &err=ErrorStack());
-  bool encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  void addEncodeTasks(TaskGroup &tasks, const Flags &flags, Context &ctx);
 
   void allocateChannels();
-  bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
-  bool createChannels(Context &ctx, const ErrorStack &err=ErrorStack());
+  bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack(),
+                      int first=0, int last=-1);
+  bool createChannels(const ChannelRecords &records, Context &ctx, const ErrorStack &err=ErrorStack());
   bool linkChannels(Context &ctx, const ErrorStack &err=ErrorStack());
 
   virtual void allocateZones();
@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include "logger.hh"
 #include "utils.hh"
+#include "radioemulator.hh"
 
 
 // USB request types.
@@ -47,7 +48,7 @@ DFUDevice::Descriptor::Descriptor(const USBDeviceInfo &info, uint8_t bus, uint8_
  * Implementation of DFUDevice
  * ********************************************************************************************* */
 DFUDevice::DFUDevice(const USBDeviceDescriptor &descr, const ErrorStack &err, QObject *parent)
-  : QObject(parent), _ctx(nullptr), _dev(nullptr)
+  : QObject(parent), _ctx(nullptr), _dev(nullptr), _emulator(nullptr)
 {
   if (USBDeviceInfo::Class::DFU != descr.interfaceClass()) {
     errMsg(err) << "Cannot connect to DFU device using a non DFU descriptor: "
@@ -55,6 +56,11 @@ DFUDevice::DFUDevice(const USBDeviceDescriptor &descr, const ErrorStack &err, QO
     return;
   }
 
+  if (nullptr != (_emulator = RadioEmulator::find(descr))) {
+    logDebug() << "Connected to emulated DFU device " << descr.description() << ".";
+    return;
+  }
+
   int error = libusb_init(&_ctx);
   if (error < 0) {
     errMsg(err) << "Libusb init failed (" << error << "): "
@@ -175,7 +181,7 @@ DFUDevice::detect(uint16_t vid, uint16_t pid)
 
 bool
 DFUDevice::isOpen() const {
-  return nullptr != _dev;
+  return (nullptr != _dev) || (nullptr != _emulator);
 }
 
 void
@@ -188,13 +194,13 @@ DFUDevice::close() {
     libusb_exit(_ctx);
   _ctx = nullptr;
   _dev = nullptr;
+  _emulator = nullptr;
 }
 
 
 int
 DFUDevice::download(unsigned block, uint8_t *data, unsigned len, const ErrorStack &err) {
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_DEVICE, REQUEST_DNLOAD, block, 0, data, len, 0);
+  int error = control(REQUEST_TYPE_TO_DEVICE, REQUEST_DNLOAD, block, data, len);
 
   if (error < 0) {
     errMsg(err) << "Cannot write to device: " << libusb_strerror((enum libusb_error) error) << ".";
@@ -206,8 +212,7 @@ DFUDevice::download(unsigned block, uint8_t *data, unsigned len, const ErrorStac
 
 int
 DFUDevice::upload(unsigned block, uint8_t *data, unsigned len, const ErrorStack &err) {
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_HOST, REQUEST_UPLOAD, block, 0, data, len, 0);
+  int error = control(REQUEST_TYPE_TO_HOST, REQUEST_UPLOAD, block, data, len);
 
   if (error < 0) {
     errMsg(err) << "Cannot read block: " << libusb_strerror((enum libusb_error) error) << ".";
@@ -220,8 +225,7 @@ DFUDevice::upload(unsigned block, uint8_t *data, unsigned len, const ErrorStack
 int
 DFUDevice::detach(int timeout, const ErrorStack &err)
 {
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_DEVICE, REQUEST_DETACH, timeout, 0, nullptr, 0, 0);
+  int error = control(REQUEST_TYPE_TO_DEVICE, REQUEST_DETACH, timeout, nullptr, 0);
   if (0 > error) {
     errMsg(err) << "Cannot detach device: " << libusb_strerror((enum libusb_error) error) << ".";
     return error;
@@ -232,8 +236,7 @@ DFUDevice::detach(int timeout, const ErrorStack &err)
 int
 DFUDevice::get_status(const ErrorStack &err)
 {
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_HOST, REQUEST_GETSTATUS, 0, 0, (unsigned char*)&_status, 6, 0);
+  int error = control(REQUEST_TYPE_TO_HOST, REQUEST_GETSTATUS, 0, (unsigned char*)&_status, 6);
   if (0 > error) {
     errMsg(err) << "Cannot get status: " << libusb_strerror((enum libusb_error) error) << ".";
     return error;
@@ -244,8 +247,7 @@ DFUDevice::get_status(const ErrorStack &err)
 int
 DFUDevice::clear_status(const ErrorStack &err)
 {
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_DEVICE, REQUEST_CLRSTATUS, 0, 0, NULL, 0, 0);
+  int error = control(REQUEST_TYPE_TO_DEVICE, REQUEST_CLRSTATUS, 0, NULL, 0);
   if (0 > error) {
     errMsg(err) << "Cannot clear status: " << libusb_strerror((enum libusb_error) error) << ".";
     return error;
@@ -258,8 +260,7 @@ DFUDevice::get_state(int &pstate, const ErrorStack &err)
 {
   unsigned char state;
 
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_HOST, REQUEST_GETSTATE, 0, 0, &state, 1, 0);
+  int error = control(REQUEST_TYPE_TO_HOST, REQUEST_GETSTATE, 0, &state, 1);
   pstate = state;
   if (error < 0) {
     errMsg(err) << "Cannot get state: " << libusb_strerror((enum libusb_error) error) << ".";
@@ -271,8 +272,7 @@ DFUDevice::get_state(int &pstate, const ErrorStack &err)
 int
 DFUDevice::abort(const ErrorStack &err)
 {
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_DEVICE, REQUEST_ABORT, 0, 0, NULL, 0, 0);
+  int error = control(REQUEST_TYPE_TO_DEVICE, REQUEST_ABORT, 0, NULL, 0);
   if (error < 0) {
     errMsg(err) << "Cannot abort: " << libusb_strerror((enum libusb_error) error) << ".";
     return error;
@@ -318,4 +318,10 @@ DFUDevice::wait_idle()
   }
 }
 
-
+int
+DFUDevice::control(uint8_t type, uint8_t request, uint16_t value, uint8_t *data, uint16_t len)
+{
+  if (nullptr != _emulator)
+    return _emulator->controlTransfer(type, request, value, data, len);
+  return libusb_control_transfer(_dev, type, request, value, 0, data, len, 0);
+}
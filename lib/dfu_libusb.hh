@@ -6,6 +6,8 @@
 #include "errorstack.hh"
 #include "radiointerface.hh"
 
+class RadioEmulator;
+
 /** This class implements DFU protocol to access radios.
  *
  * Many manufactures use the standardized DFU protocol to program codeplugs and update the
@@ -68,6 +70,8 @@ protected:
   int abort(const ErrorStack &err=ErrorStack());
   /** Internal used function to busy-wait for a response from the device. */
   int wait_idle();
+  /** Performs a control transfer on the device or the emulator. */
+  int control(uint8_t type, uint8_t request, uint16_t value, uint8_t *data, uint16_t len);
 
 protected:
   /** USB context. */
@@ -76,6 +80,8 @@ protected:
 	libusb_device_handle *_dev;
   /** Device status. */
 	status_t _status;
+  /** The emulated device, if the descriptor refers to one. */
+  RadioEmulator *_emulator;
 };
 
 #endif // DFU_LIBUSB_HH
@@ -1,7 +1,10 @@
 #include "dfufile.hh"
 #include <QFile>
+#include <QSaveFile>
 #include <QtEndian>
 #include "crc32.hh"
+#include "pagedmemory.hh"
+#include "logger.hh"
 
 
 typedef struct __attribute((packed)) {
@@ -94,6 +97,12 @@ DFUFile::remImage(int i) {
   _images.remove(i);
 }
 
+void
+DFUFile::detach() {
+  for (int i=0; i<_images.size(); i++)
+    _images[i].detach();
+}
+
 bool
 DFUFile::isAligned(unsigned blocksize) const {
   for (int i=0; i<_images.size(); i++)
@@ -104,83 +113,83 @@ DFUFile::isAligned(unsigned blocksize) const {
 
 bool
 DFUFile::read(const QString &filename, const ErrorStack &err) {
-  QFile file(filename);
-
-  if (! file.open(QIODevice::ReadOnly)) {
-    errMsg(err) << "Cannot read DFU file '" << filename << "': " << file.errorString() << ".";
-    return false;
-  }
-
-  if (! read(file, err)) {
-    file.close();
+  QSharedPointer<Content> content(new Content(filename));
+  if (! content->map(err)) {
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
-
-  return true;
+  return parse(content, err);
 }
 
 bool
 DFUFile::read(QFile &file, const ErrorStack &err)
 {
-  CRC32 crc;
+  QSharedPointer<Content> content(new Content(file.fileName()));
+  content->load(file);
+  return parse(content, err);
+}
 
+bool
+DFUFile::parse(const QSharedPointer<Content> &content, const ErrorStack &err) {
   _images.clear();
 
-  file_prefix_t prefix;
-  if (sizeof(file_prefix_t) != file.read((char *)&prefix, sizeof(file_prefix_t))) {
-    errMsg(err) << "Cannot read suffix: " << file.errorString() << ".";
-    errMsg(err) << "Cannot read DFU file '" << file.fileName() << "'.";
+  const QString filename = content->file.fileName();
+  if (qint64(sizeof(file_prefix_t)) > content->size) {
+    errMsg(err) << "Cannot read prefix: File too short.";
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
 
-  // update crc
-  crc.update((const uint8_t *)&prefix, sizeof(file_prefix_t));
+  file_prefix_t prefix;
+  memcpy(&prefix, content->data, sizeof(file_prefix_t));
 
   if (memcmp(prefix.signature, "DfuSe", 5)) {
     errMsg(err) << "Invalid DFU file signature. Not a DFU file?";
-    errMsg(err) << "Cannot read DFU file '" << file.fileName() << "'.";
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
 
   uint32_t filesize = qFromLittleEndian(prefix.image_size);
   uint8_t  n_images = prefix.n_targets;
 
+  uint32_t offset = sizeof(file_prefix_t);
   for (uint8_t i=0; i<n_images; i++) {
     Image img; QString errorMessage;
-    if (! img.read(file, crc, errorMessage)) {
+    if (! img.read(content, offset, errorMessage)) {
       errMsg(err) << errorMessage;
       return false;
     }
     _images.append(img);
   }
 
-  file_suffix_t suffix;
-  if (sizeof(file_suffix_t) != file.read((char *)&suffix, sizeof(suffix))) {
-    errMsg(err) << "Cannot read suffix: " << file.errorString() << ".";
-    errMsg(err) << "Cannot read DFU file '" << file.fileName() << "'.";
+  if ((qint64(offset)+qint64(sizeof(file_suffix_t))) > content->size) {
+    errMsg(err) << "Cannot read suffix: File too short.";
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
 
-  // Update CRC with suffix excl. CRC itself
-  crc.update((const uint8_t *) &suffix, sizeof(file_suffix_t)-4);
+  file_suffix_t suffix;
+  memcpy(&suffix, content->data+offset, sizeof(file_suffix_t));
 
-  if (filesize != (size()-sizeof(file_suffix_t))) {
-    errMsg(err) << "Filesize " << (size()-sizeof(file_suffix_t))
-                << " does not match declared content " << filesize << ".";
-    errMsg(err) << "Cannot read DFU file '" << file.fileName() << "'.";
+  if (filesize != offset) {
+    errMsg(err) << "Filesize " << offset << " does not match declared content " << filesize << ".";
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
 
   if (memcmp(suffix.signature, "UFD", 3)) {
     errMsg(err) << "Invalid suffix signature.";
-    errMsg(err) << "Cannot read DFU file '" << file.fileName() << "'.";
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
 
-  if (crc.get() != suffix.crc) {
-    errMsg(err) << "Invalid checksum got " << QString::number(unsigned(suffix.crc),16)
-                << " expected " << QString::number(unsigned(crc.get())) << ".";
-    errMsg(err) << "Cannot read DFU file '" << file.fileName() << "'.";
+  // Compute CRC over the complete file excl. CRC itself in one pass
+  CRC32 crc;
+  crc.update(content->data, offset+sizeof(file_suffix_t)-4);
+  if (crc.get() != qFromLittleEndian(suffix.crc)) {
+    errMsg(err) << "Invalid checksum got " << QString::number(unsigned(qFromLittleEndian(suffix.crc)),16)
+                << " expected " << QString::number(unsigned(crc.get()),16) << ".";
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
     return false;
   }
   return true;
@@ -188,42 +197,57 @@ DFUFile::read(QFile &file, const ErrorStack &err)
 
 bool
 DFUFile::write(const QString &filename, const ErrorStack &err) {
-  QFile file(filename);
+  // Write into a temporary file, that replaces the target once complete. The target may still be
+  // mapped by the images, hence it must not be truncated.
+  QSaveFile file(filename);
   if (! file.open(QIODevice::WriteOnly)) {
     errMsg(err) << "Cannot create DFU file '" << filename << "': " << file.errorString() << ".";
     return false;
   }
 
-  bool res = write(file, err);
-  file.close();
+  QByteArray buffer;
+  serialize(buffer);
+  if (buffer.size() != file.write(buffer)) {
+    errMsg(err) << "Cannot write DFU file '" << filename << "': " << file.errorString() << ".";
+    file.cancelWriting();
+    return false;
+  }
 
-  return res;
+  if (! file.commit()) {
+    errMsg(err) << "Cannot write DFU file '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+
+  return true;
 }
 
 bool
 DFUFile::write(QFile &file, const ErrorStack &err) {
+  QByteArray buffer;
+  serialize(buffer);
+  if (buffer.size() != file.write(buffer)) {
+    errMsg(err) << "Cannot write DFU file '" << file.fileName() << "': " << file.errorString() << ".";
+    return false;
+  }
+  return true;
+}
+
+void
+DFUFile::serialize(QByteArray &buffer) const {
+  uint32_t total = size();
+  buffer.resize(total);
+  unsigned char *ptr = (unsigned char *)buffer.data();
+
   file_prefix_t prefix;
   memcpy(prefix.signature, "DfuSe", 5);
   prefix.version = 0x01;
-  prefix.image_size = qToLittleEndian(uint32_t(size()-sizeof(file_suffix_t)));
+  prefix.image_size = qToLittleEndian(uint32_t(total-sizeof(file_suffix_t)));
   prefix.n_targets = _images.size();
+  memcpy(ptr, &prefix, sizeof(file_prefix_t));
+  ptr += sizeof(file_prefix_t);
 
-  if (sizeof(file_prefix_t) != file.write((char *)&prefix, sizeof(file_prefix_t))) {
-    errMsg(err) << "Cannot write DFU prefix to '" << file.fileName()
-                << "': " << file.errorString() << ".";
-    return false;
-  }
-
-  CRC32 crc;
-  crc.update((uint8_t *)&prefix, sizeof(file_prefix_t));
-
-  foreach (const Image &i, _images) {
-    QString errorMessage;
-    if (! i.write(file, crc, errorMessage)) {
-      errMsg(err) << errorMessage;
-      return false;
-    }
-  }
+  foreach (const Image &i, _images)
+    ptr = i.write(ptr);
 
   file_suffix_t suffix;
   suffix.device_id = qToLittleEndian((uint16_t)0xffff);
@@ -233,17 +257,13 @@ DFUFile::write(QFile &file, const ErrorStack &err) {
   suffix.DFUhi = 0x01;
   memcpy(suffix.signature, "UFD", 3);
   suffix.size = 16;
+  memcpy(ptr, &suffix, sizeof(file_suffix_t)-4);
 
-  crc.update((uint8_t *) &suffix, sizeof(file_suffix_t)-4);
+  // Compute CRC over the complete file excl. CRC itself in one pass
+  CRC32 crc;
+  crc.update((const uint8_t *)buffer.constData(), total-4);
   suffix.crc = qToLittleEndian(crc.get());
-
-  if (sizeof(file_suffix_t) != file.write((char *)&suffix, sizeof(file_suffix_t))) {
-    errMsg(err) << "Cannot write DFU suffix to '" << file.fileName()
-                << "': " << file.errorString() << ".";
-    return false;
-  }
-
-  return true;
+  memcpy(ptr, &suffix, sizeof(file_suffix_t));
 }
 
 unsigned char *
@@ -273,19 +293,19 @@ DFUFile::dump(QTextStream &stream) const {
  * Implementation of DFUFile::Element
  * ********************************************************************************************* */
 DFUFile::Element::Element()
-  : _address(0), _data()
+  : _address(0), _size(0), _data(nullptr)
 {
   // pass...
 }
 
-DFUFile::Element::Element(uint32_t addr, uint32_t size)
-  : _address(addr), _data(size, 0x00)
+DFUFile::Element::Element(uint32_t addr, uint32_t size, unsigned char *data)
+  : _address(addr), _size(size), _data(data)
 {
   // pass...
 }
 
 DFUFile::Element::Element(const Element &other)
-  : _address(other._address), _data(other._data)
+  : _address(other._address), _size(other._size), _data(other._data)
 {
   // pass...
 }
@@ -293,18 +313,19 @@ DFUFile::Element::Element(const Element &other)
 DFUFile::Element &
 DFUFile::Element::operator=(const Element &other) {
   _address = other._address;
+  _size = other._size;
   _data = other._data;
   return *this;
 }
 
 uint32_t
 DFUFile::Element::size() const {
-  return sizeof(element_prefix_t) + _data.size();
+  return sizeof(element_prefix_t) + _size;
 }
 
 uint32_t
 DFUFile::Element::memSize() const {
-  return _data.size();
+  return _size;
 }
 
 uint32_t
@@ -312,111 +333,65 @@ DFUFile::Element::address() const {
   return _address;
 }
 
-void
-DFUFile::Element::setAddress(uint32_t addr) {
-  _address = addr;
-}
-
 bool
 DFUFile::Element::isAligned(unsigned blocksize) const {
-  return (0 == (_address % blocksize)) && (0 == (_data.size() % blocksize));
+  return (0 == (_address % blocksize)) && (0 == (_size % blocksize));
 }
 
-const QByteArray &
+const unsigned char *
 DFUFile::Element::data() const {
   return _data;
 }
 
-QByteArray &
+unsigned char *
 DFUFile::Element::data() {
   return _data;
 }
 
-bool
-DFUFile::Element::read(QFile &file, CRC32 &crc, QString &errorMessage)
-{
-  // Read Element prefix:
-  element_prefix_t prefix;
-  if (sizeof(element_prefix_t) != file.read((char *)&prefix, sizeof(element_prefix_t))) {
-    errorMessage = tr("Cannot read DFU file '%1': Cannot read element prefix: %2").arg(file.fileName()).arg(file.errorString());
-    return false;
-  }
-
-  crc.update((const uint8_t *) &prefix, sizeof(element_prefix_t));
-
-  _address = qFromLittleEndian(prefix.address);
-  uint32_t size = qFromLittleEndian(prefix.size);
-
-  _data.clear();
-  _data = file.read(size);
-
-  if (size != uint32_t(_data.size())) {
-    errorMessage = tr("Cannot read DFU file '%1': Cannot read element data: %2").arg(file.fileName()).arg(file.errorString());
-    return false;
-  }
-
-  crc.update(_data);
-
-  return true;
-}
-
-bool
-DFUFile::Element::write(QFile &file, CRC32 &crc, QString &errorMessage) const {
+unsigned char *
+DFUFile::Element::write(unsigned char *ptr) const {
   element_prefix_t prefix;
   prefix.address = qToLittleEndian(_address);
-  prefix.size = qToLittleEndian(uint32_t(_data.size()));
-
-  crc.update((uint8_t *) &prefix, sizeof(element_prefix_t));
-
-  if (sizeof(element_prefix_t) != file.write((const char *)&prefix, sizeof(element_prefix_t))) {
-    errorMessage = tr("Cannot write element prefix to file '%1': %2")
-        .arg(file.fileName()).arg(file.errorString());
-    return false;
-  }
-
-  crc.update(_data);
-
-  if (_data.size() != file.write(_data)) {
-    errorMessage = tr("Cannot write element data to file '%1': %2")
-        .arg(file.fileName()).arg(file.errorString());
-    return false;
-  }
-
-  return true;
+  prefix.size = qToLittleEndian(_size);
+  memcpy(ptr, &prefix, sizeof(element_prefix_t));
+  ptr += sizeof(element_prefix_t);
+  if (_size)
+    memcpy(ptr, _data, _size);
+  return ptr + _size;
 }
 
 void
 DFUFile::Element::dump(QTextStream &stream) const {
   stream.setIntegerBase(16);
-  stream << "  Element @ 0x" << _address << ", size=0x" << _data.size() << "\n";
-  int nrow = _data.size()/16;
+  stream << "  Element @ 0x" << _address << ", size=0x" << _size << "\n";
+  int nrow = _size/16;
   uint8_t last_line[16]; memset(last_line, 0, 16);
   bool skipping = false;
   for (int i=0; i<nrow; i++) {
-    if ((i>0) && (0==memcmp(last_line, _data.constData()+i*16, 16)) && skipping)
+    if ((i>0) && (0==memcmp(last_line, _data+i*16, 16)) && skipping)
       continue;
-    if ((i>0) && (0==memcmp(last_line, _data.constData()+i*16, 16))) {
+    if ((i>0) && (0==memcmp(last_line, _data+i*16, 16))) {
       skipping = true;
       stream.setFieldAlignment(QTextStream::AlignRight);
       stream << qSetFieldWidth(8) << "*" << qSetFieldWidth(1) << "\n";
       continue;
     }
-    memcpy(last_line, _data.constData()+i*16, 16);
+    memcpy(last_line, _data+i*16, 16);
     skipping = false;
     stream << qSetFieldWidth(8) << (_address+i*16)
            << qSetFieldWidth(1) << "  ";
     for (int j=(i*16); j<(i*16+8); j++) {
-      stream << QString("%1").arg(uint8_t(_data.at(j)), 2, 16, QChar('0'))
+      stream << QString("%1").arg(uint8_t(_data[j]), 2, 16, QChar('0'))
              << qSetFieldWidth(1) << " ";
     }
     stream << " ";
     for (int j=(i*16+8); j<(i*16+16); j++) {
-      stream << QString("%1").arg(uint8_t(_data.at(j)), 2, 16, QChar('0'))
+      stream << QString("%1").arg(uint8_t(_data[j]), 2, 16, QChar('0'))
              << qSetFieldWidth(1) << " ";
     }
     stream << " |";
     for (int j=(i*16); j<(i*16+16); j++) {
-      char c = _data.at(j);
+      char c = _data[j];
       if ((c>=32) && (c<127))
         stream << c;
       else
@@ -427,24 +402,120 @@ DFUFile::Element::dump(QTextStream &stream) const {
 }
 
 
+/* ********************************************************************************************* *
+ * Implementation of DFUFile::Content
+ * ********************************************************************************************* */
+/** The content of a DFU file read. Either the file is mapped into memory or its content is read
+ * into a buffer. The elements of all images read refer to this content, hence it is kept until
+ * all of these images are destroyed or detached. */
+class DFUFile::Content
+{
+public:
+  /** Constructor. */
+  Content(const QString &filename)
+    : file(filename), buffer(), data(nullptr), size(0)
+  {
+    // pass...
+  }
+
+  /** Maps the file into memory. If the file cannot be mapped, its content is read instead. */
+  bool map(const ErrorStack &err) {
+    if (! file.open(QIODevice::ReadOnly)) {
+      errMsg(err) << "Cannot open file '" << file.fileName() << "': " << file.errorString() << ".";
+      return false;
+    }
+    size = file.size();
+    // The mapping is private, modified pages get copied and never written back to the file.
+    if ((0 < size) && (nullptr != (data = file.map(0, size, QFileDevice::MapPrivateOption))))
+      return true;
+    logDebug() << "Cannot map file '" << file.fileName() << "': " << file.errorString()
+               << ". Read it instead.";
+    load(file);
+    file.close();
+    return true;
+  }
+
+  /** Reads the remaining content of the given file at once. */
+  void load(QFile &f) {
+    buffer = f.readAll();
+    data = (unsigned char *)buffer.data();
+    size = buffer.size();
+  }
+
+public:
+  /** The file, kept open while it is mapped. */
+  QFile file;
+  /** Holds the content, if the file is not mapped. */
+  QByteArray buffer;
+  /** Pointer to the content. */
+  unsigned char *data;
+  /** Size of the content. */
+  qint64 size;
+};
+
+
+/* ********************************************************************************************* *
+ * Implementation of DFUFile::Image::Memory
+ * ********************************************************************************************* */
+/** The elements of an image together with their memory. Shared implicitly between copies of an
+ * image. */
+class DFUFile::Image::Memory: public QSharedData
+{
+public:
+  /** Empty constructor. */
+  Memory()
+    : QSharedData(), elements(), addressmap(), memory(), content()
+  {
+    // pass...
+  }
+
+  /** Copy constructor, copies the memory of all elements into a single chunk. The copy does not
+   * refer to the file content. */
+  Memory(const Memory &other)
+    : QSharedData(other), elements(other.elements), addressmap(other.addressmap), memory(),
+      content()
+  {
+    size_t total = 0;
+    foreach (const Element &el, elements)
+      total += el._size + 8;
+    memory.reserve(total);
+    for (int i=0; i<elements.size(); i++) {
+      Element &el = elements[i];
+      unsigned char *ptr = memory.allocate(el._address, el._size);
+      memcpy(ptr, el._data, el._size);
+      el._data = ptr;
+    }
+  }
+
+public:
+  /** The elements of the image. */
+  QVector<Element> elements;
+  /** Maps an address range to element index. */
+  AddressMap addressmap;
+  /** Holds the memory of all elements. */
+  PagedMemory memory;
+  /** The file content, elements read refer to. */
+  QSharedPointer<Content> content;
+};
+
+
 /* ********************************************************************************************* *
  * Implementation of DFUFile::Image
  * ********************************************************************************************* */
 DFUFile::Image::Image()
-  : _alternate_settings(0), _name(), _elements(), _addressmap()
+  : _alternate_settings(0), _name(), _memory(new Memory())
 {
   // pass...
 }
 
 DFUFile::Image::Image(const QString &name, uint8_t altSettings)
-  : _alternate_settings(altSettings), _name(name), _elements(), _addressmap()
+  : _alternate_settings(altSettings), _name(name), _memory(new Memory())
 {
   // pass...
 }
 
 DFUFile::Image::Image(const Image &other)
-  : _alternate_settings(other._alternate_settings), _name(other._name), _elements(other._elements),
-    _addressmap(other._addressmap)
+  : _alternate_settings(other._alternate_settings), _name(other._name), _memory(other._memory)
 {
   // pass...
 }
@@ -457,15 +528,14 @@ DFUFile::Image &
 DFUFile::Image::operator=(const Image &other) {
   _alternate_settings = other._alternate_settings;
   _name = other._name;
-  _elements = other._elements;
-  _addressmap = other._addressmap;
+  _memory = other._memory;
   return *this;
 }
 
 uint32_t
 DFUFile::Image::size() const {
   uint32_t size = sizeof(image_prefix_t);
-  foreach (const Element &e, _elements)
+  foreach (const Element &e, _memory->elements)
     size += e.size();
   return size;
 }
@@ -473,7 +543,7 @@ DFUFile::Image::size() const {
 uint32_t
 DFUFile::Image::memSize() const {
   uint32_t size = 0;
-  foreach (const Element &e, _elements)
+  foreach (const Element &e, _memory->elements)
     size += e.memSize();
   return size;
 }
@@ -505,63 +575,75 @@ DFUFile::Image::setName(const QString &name) {
 
 int
 DFUFile::Image::numElements() const {
-  return _elements.size();
+  return _memory->elements.size();
 }
 
 const DFUFile::Element &
 DFUFile::Image::element(int i) const {
-  return _elements[i];
+  return _memory->elements[i];
 }
 
 DFUFile::Element &
 DFUFile::Image::element(int i) {
-  return _elements[i];
+  return _memory->elements[i];
 }
 
 void
 DFUFile::Image::addElement(uint32_t addr, uint32_t size, int index) {
-  if ((0 > index) || (_elements.size() <= index)) {
-    _elements.append(Element(addr, size));
-    _addressmap.add(addr, size);
-  } else {
-    _elements.insert(index, Element(addr, size));
-    _addressmap.add(addr, size, index);
+  Memory *m = _memory.data();
+  Element element(addr, size, m->memory.allocate(addr, size));
+  if ((0 > index) || (m->elements.size() <= index))
+    index = m->elements.size();
+  m->elements.insert(index, element);
+  if (! m->addressmap.add(addr, size, index)) {
+    logWarn() << "DFU image: Element at 0x" << QString::number(addr, 16) << " of size 0x"
+              << QString::number(size, 16) << " overlaps with another element.";
   }
 }
 
 void
 DFUFile::Image::addElement(const Element &element) {
-  _elements.append(element);
-  _addressmap.add(element.address(), element.size());
+  // The element may refer to an element of this image, that gets moved when adding. The memory
+  // itself never moves.
+  uint32_t addr = element.address(), size = element.memSize();
+  const unsigned char *content = element.data();
+  addElement(addr, size);
+  if (content)
+    memcpy(_memory->elements.last()._data, content, size);
 }
 
 void
 DFUFile::Image::remElement(int i) {
-  _elements.remove(i);
-  _addressmap.rem(i);
+  Memory *m = _memory.data();
+  // The memory of the element is kept until the image gets destroyed or copied
+  m->memory.unmap(m->elements[i].address(), m->elements[i].memSize());
+  m->addressmap.rem(m->elements[i].address(), i);
+  m->elements.remove(i);
 }
 
 bool
 DFUFile::Image::isAligned(unsigned blocksize) const {
-  for (int i=0; i<_elements.count(); i++)
-    if (! _elements.at(i).isAligned(blocksize))
+  for (int i=0; i<_memory->elements.count(); i++)
+    if (! _memory->elements.at(i).isAligned(blocksize))
       return false;
   return true;
 }
 
 bool
-DFUFile::Image::read(QFile &file, CRC32 &crc, QString &errorMessage)
+DFUFile::Image::read(const QSharedPointer<Content> &content, uint32_t &offset, QString &errorMessage)
 {
-  image_prefix_t prefix;
-  if (sizeof(image_prefix_t) != file.read((char *)&prefix, sizeof(image_prefix_t))) {
-    errorMessage = tr("Cannot read DFU file '%1': Cannot read image: %2").arg(file.fileName()).arg(file.errorString());
+  const QString filename = content->file.fileName();
+  if ((qint64(offset)+qint64(sizeof(image_prefix_t))) > content->size) {
+    errorMessage = tr("Cannot read DFU file '%1': Cannot read image: File too short.").arg(filename);
     return false;
   }
 
-  crc.update((const uint8_t *) &prefix, sizeof(image_prefix_t));
+  image_prefix_t prefix;
+  memcpy(&prefix, content->data+offset, sizeof(image_prefix_t));
+  offset += sizeof(image_prefix_t);
 
   if (memcmp(prefix.signature, "Target", 6)) {
-    errorMessage = tr("Cannot read DFU file '%1': Invalid image signature value.").arg(file.fileName());
+    errorMessage = tr("Cannot read DFU file '%1': Invalid image signature value.").arg(filename);
     return false;
   }
 
@@ -572,26 +654,49 @@ DFUFile::Image::read(QFile &file, CRC32 &crc, QString &errorMessage)
     _name = tmp;
   }
 
+  Memory *m = _memory.data();
+  m->content = content;
+
   uint32_t size = qFromLittleEndian(prefix.size);
   uint32_t n_elements = qFromLittleEndian(prefix.n_elements);
   for (uint32_t i=0; i<n_elements; i++) {
-    Element element;
-    if (! element.read(file, crc, errorMessage))
+    if ((qint64(offset)+qint64(sizeof(element_prefix_t))) > content->size) {
+      errorMessage = tr("Cannot read DFU file '%1': Cannot read element prefix: File too short.").arg(filename);
       return false;
-    this->addElement(element);
+    }
+    element_prefix_t eprefix;
+    memcpy(&eprefix, content->data+offset, sizeof(element_prefix_t));
+    offset += sizeof(element_prefix_t);
+
+    uint32_t eaddr = qFromLittleEndian(eprefix.address);
+    uint32_t esize = qFromLittleEndian(eprefix.size);
+    if (esize > (content->size-offset)) {
+      errorMessage = tr("Cannot read DFU file '%1': Element size %2b exceeds file.").arg(filename).arg(esize);
+      return false;
+    }
+
+    // The element refers to the file content directly
+    unsigned char *edata = content->data+offset;
+    offset += esize;
+    m->memory.map(eaddr, esize, edata);
+    m->elements.append(Element(eaddr, esize, edata));
+    if (! m->addressmap.add(eaddr, esize)) {
+      logWarn() << "DFU image: Element at 0x" << QString::number(eaddr, 16) << " of size 0x"
+                << QString::number(esize, 16) << " overlaps with another element.";
+    }
   }
 
   // verify size:
   if (size != (this->size()-sizeof(image_prefix_t))) {
     errorMessage = tr("Cannot read DFU file '%1': Invalid image size %2b specified, expected %3b.")
-        .arg(file.fileName()).arg(size).arg(this->size()-sizeof(image_prefix_t));
+        .arg(filename).arg(size).arg(this->size()-sizeof(image_prefix_t));
     return false;
   }
   return true;
 }
 
-bool
-DFUFile::Image::write(QFile &file, CRC32 &crc, QString &errorMessage) const {
+unsigned char *
+DFUFile::Image::write(unsigned char *ptr) const {
   image_prefix_t prefix;
   memcpy(prefix.signature, "Target", 6);
   prefix.alternate_setting = _alternate_settings;
@@ -600,35 +705,90 @@ DFUFile::Image::write(QFile &file, CRC32 &crc, QString &errorMessage) const {
   if (! _name.isEmpty())
     memcpy(prefix.name, _name.toLocal8Bit().constData(), std::min(255, _name.size()));
   prefix.size = qToLittleEndian(uint32_t(size()-sizeof(image_prefix_t)));
-  prefix.n_elements = qToLittleEndian(uint32_t(_elements.size()));
-
-  crc.update((uint8_t *)&prefix, sizeof(image_prefix_t));
+  prefix.n_elements = qToLittleEndian(uint32_t(_memory->elements.size()));
+  memcpy(ptr, &prefix, sizeof(image_prefix_t));
+  ptr += sizeof(image_prefix_t);
 
-  if (sizeof(image_prefix_t) != file.write((char *)&prefix, sizeof(image_prefix_t))) {
-    errorMessage = tr("Cannot write image prefix to '%1': %2.")
-        .arg(file.fileName()).arg(file.errorString());
-    return false;
-  }
+  foreach (const Element &e, _memory->elements)
+    ptr = e.write(ptr);
 
-  foreach (const Element &e, _elements) {
-    if (! e.write(file, crc, errorMessage))
-      return false;
-  }
+  return ptr;
+}
 
-  return true;
+void
+DFUFile::Image::detach() {
+  _memory.detach();
 }
 
 void
 DFUFile::Image::sort() {
-  std::stable_sort(_elements.begin(), _elements.end(),
+  Memory *m = _memory.data();
+  std::stable_sort(m->elements.begin(), m->elements.end(),
                    [](const Element &first, const Element &second) {
                      return first.address()<second.address();
                    });
 
   // Rebuild address map
-  _addressmap.clear();
-  for (int i=0; i<_elements.size(); i++)
-    _addressmap.add(_elements[i].address(), _elements.size());
+  std::vector<AddressMap::Region> regions;
+  regions.reserve(m->elements.size());
+  foreach (const Element &el, m->elements)
+    regions.push_back(AddressMap::Region(el.address(), el.memSize()));
+  m->addressmap.build(regions);
+}
+
+QVector<DFUFile::Image::Transfer>
+DFUFile::Image::planTransfers(uint32_t maxGap, uint32_t boundary, int first, int last) const {
+  const QVector<Element> &elements = _memory->elements;
+  if ((0 > last) || (elements.size() < last))
+    last = elements.size();
+
+  // Order elements by address
+  QVector<int> order;
+  for (int i=first; i<last; i++)
+    order.append(i);
+  std::stable_sort(order.begin(), order.end(), [&elements](int a, int b) {
+    return elements[a].address() < elements[b].address();
+  });
+
+  QVector<Transfer> transfers;
+  foreach (int idx, order) {
+    const Element &el = elements[idx];
+    if (0 == el.memSize())
+      continue;
+    uint32_t start = el.address(), end = el.address()+el.memSize();
+    if (! transfers.isEmpty()) {
+      Transfer &prev = transfers.last();
+      uint32_t prevEnd = prev.address+prev.size;
+      bool sameSegment = (0 == boundary) || ((prev.address/boundary) == ((end-1)/boundary));
+      // Overlapping elements are not merged
+      if ((start >= prevEnd) && ((start-prevEnd) <= maxGap) && sameSegment) {
+        prev.size = end-prev.address;
+        prev.elements.append(idx);
+        continue;
+      }
+    }
+    transfers.append(Transfer{start, el.memSize(), {idx}});
+  }
+
+  return transfers;
+}
+
+void
+DFUFile::Image::gather(const Transfer &transfer, QByteArray &buffer) const {
+  buffer.fill(0x00, transfer.size);
+  foreach (int idx, transfer.elements) {
+    const Element &el = _memory->elements[idx];
+    memcpy(buffer.data()+(el.address()-transfer.address), el.data(), el.memSize());
+  }
+}
+
+void
+DFUFile::Image::scatter(const Transfer &transfer, const QByteArray &buffer) {
+  Memory *m = _memory.data();
+  foreach (int idx, transfer.elements) {
+    Element &el = m->elements[idx];
+    memcpy(el.data(), buffer.constData()+(el.address()-transfer.address), el.memSize());
+  }
 }
 
 void
@@ -638,36 +798,32 @@ DFUFile::Image::dump(QTextStream &stream) const {
     stream << ", target not named";
   else
     stream << ", target '" << _name << "'";
-  stream << ", #elements=" << _elements.size() << ":\n";
-  foreach (const Element &e, _elements) {
+  stream << ", #elements=" << _memory->elements.size() << ":\n";
+  foreach (const Element &e, _memory->elements) {
     e.dump(stream);
   }
 }
 
 unsigned char *
 DFUFile::Image::data(uint32_t offset) {
-  // Search for element that contains address
-  /*for  (int i=0; i<numElements(); i++) {
-    if ((offset >= element(i).address()) &&
-        (offset < (element(i).address()+element(i).data().size())))
-    {
-      return (unsigned char *)(element(i).data().data()+
-                               (offset-element(i).address()));
-    }
-  }
-  return nullptr;*/
-  int idx = _addressmap.find(offset);
+  Memory *m = _memory.data();
+  // Pages covered by a single element get translated directly
+  if (unsigned char *ptr = m->memory.translate(offset))
+    return ptr;
+  // Otherwise, search for element that contains address
+  int idx = m->addressmap.find(offset);
   if (0 > idx)
     return nullptr;
-  return (unsigned char *)(element(idx).data().data()+
-                           (offset-element(idx).address()));
+  return m->elements[idx].data() + (offset-m->elements[idx].address());
 }
 
 const unsigned char *
 DFUFile::Image::data(uint32_t offset) const {
-  int idx = _addressmap.find(offset);
+  const Memory *m = _memory.constData();
+  if (const unsigned char *ptr = m->memory.translate(offset))
+    return ptr;
+  int idx = m->addressmap.find(offset);
   if (0 > idx)
     return nullptr;
-  return (unsigned char *)(element(idx).data().data()+
-                           (offset-element(idx).address()));
+  return m->elements[idx].data() + (offset-m->elements[idx].address());
 }
@@ -6,12 +6,12 @@
 #include <QByteArray>
 #include <QString>
 #include <QTextStream>
+#include <QSharedDataPointer>
+#include <QSharedPointer>
 
 #include "addressmap.hh"
 #include "errorstack.hh"
 
-class CRC32;
-
 /** A collection of images, each consisting of one or more memory sections.
  *
  * This class forms the base of all binary encoded codeplugs and call-sign DBs. To this end, it
@@ -67,44 +67,57 @@ class CRC32;
  * +---+---+---+---+---+---+---+---+---+...+---+
  * @endcode
  *
+ * When reading a file, it gets mapped into memory (if possible) and the elements of all images refer
+ * directly to the mapped file content. The mapping is private, hence modifications of the elements
+ * are never written back to the file. Instead, the modified pages get copied by the operating
+ * system. Writing a file lays out the entire file in a single buffer, which gets written at once.
+ *
  * @ingroup util
  */
 class DFUFile: public QObject
 {
 	Q_OBJECT
 
+protected:
+  /** The content of a DFU file read. The elements of all images read refer to it. */
+  class Content;
+
 public:
-  /** Represents a single element within a @c Image. */
+  /** Represents a single element within a @c Image.
+   *
+   * An element is a view onto a contiguous section of the memory of the image it belongs to. Hence
+   * elements can only be created by an @c Image. */
 	class Element {
 	public:
     /** Empty constructor. */
 		Element();
-    /** Constructs an element for the given address and of the given size. */
-		Element(uint32_t addr, uint32_t size);
-    /** Copy constructor. */
+    /** Copy constructor, the copy refers to the same memory. */
 		Element(const Element &other);
-    /** Copying assignment. */
+    /** Copying assignment, the copy refers to the same memory. */
 		Element &operator= (const Element &other);
 
+  protected:
+    /** Constructs an element for the given address and of the given size, located at the
+     * given memory. */
+    Element(uint32_t addr, uint32_t size, unsigned char *data);
+
+  public:
     /** Returns the address of the element. */
 		uint32_t address() const;
-    /** Sets the address of the element. */
-		void setAddress(uint32_t addr);
     /** Returns the size of the element (including headers). */
 		uint32_t size() const;
     /** Returns the memory size of the element. */
     uint32_t memSize() const;
     /** Checks if the element address and size is aligned with the given block size. */
     bool isAligned(unsigned blocksize) const;
-    /** Returns a reference to the data. */
-		const QByteArray &data() const;
-    /** Returns a reference to the data. */
-		QByteArray &data();
+    /** Returns a pointer to the data. */
+		const unsigned char *data() const;
+    /** Returns a pointer to the data. */
+		unsigned char *data();
 
-    /** Reads an element from the given file and updates the CRC. */
-		bool read(QFile &file, CRC32 &crc, QString &errorMessage);
-    /** Writes an element to the given file and updates the CRC. */
-		bool write(QFile &file, CRC32 &crc, QString &errorMessage) const;
+    /** Serializes the element into the given buffer.
+     * @returns A pointer behind the serialized element. */
+		unsigned char *write(unsigned char *ptr) const;
 
     /** Dumps a textual representation of the element. */
 		void dump(QTextStream &stream) const;
@@ -112,14 +125,39 @@ public:
 	protected:
     /** The address of the element. */
 		uint32_t _address;
-    /** The data of the element. */
-		QByteArray _data;
+    /** The size of the element. */
+    uint32_t _size;
+    /** The data of the element, owned by the image. */
+		unsigned char *_data;
+
+    friend class Image;
 	};
 
-  /** Represents a single image within a @c DFUFile. */
+  /** Represents a single image within a @c DFUFile.
+   *
+   * The memory of all elements is held by a @c PagedMemory, that allows to translate addresses
+   * into pointers in constant time. The memory is implicitly shared between copies of an image and
+   * gets copied once one of the copies is modified. Like for a @c QByteArray, this invalidates
+   * all pointers into the memory of the modified copy. */
 	class Image
 	{
+  protected:
+    /** The implicitly shared elements and their memory. */
+    class Memory;
+
 	public:
+    /** Describes a single transfer of a contiguous memory range covering one or more elements of
+     * the image. The elements are ordered by address. Between two consecutive elements there may be
+     * a gap, that is not covered by any element. */
+    struct Transfer {
+      /** The start address of the transfer. */
+      uint32_t address;
+      /** The size of the transfer in bytes. */
+      uint32_t size;
+      /** The indices of the elements covered by this transfer. */
+      QVector<int> elements;
+    };
+
     /** Default constructor.
      * Constructs an empty image. */
 		Image();
@@ -156,17 +194,19 @@ public:
     /** Adds an element to the image with the given address and size at the specified index.
      * If the index is negative, the element gets appended. */
     void addElement(uint32_t addr, uint32_t size, int index=-1);
-    /** Adds an element to the image. */
+    /** Adds an element to the image. The content of the given element gets copied. */
     void addElement(const Element &element);
     /** Removes the i-th element from this image. */
 		void remElement(int i);
     /** Checks if all element addresses and sizes is aligned with the given block size. */
     bool isAligned(unsigned blocksize) const;
 
-    /** Reads an image from the given file and updates the CRC. */
-		bool read(QFile &file, CRC32 &crc, QString &errorMessage);
-    /** Writes this image to the given file and updates the CRC. */
-		bool write(QFile &file, CRC32 &crc, QString &errorMessage) const;
+    /** Reads an image from the given file content starting at the given offset. The elements
+     * refer to the content directly. On success, @c offset points behind the image. */
+		bool read(const QSharedPointer<Content> &content, uint32_t &offset, QString &errorMessage);
+    /** Serializes this image into the given buffer.
+     * @returns A pointer behind the serialized image. */
+		unsigned char *write(unsigned char *ptr) const;
 
     /** Prints a textual representation of the image into the given stream. */
 		void dump(QTextStream &stream) const;
@@ -178,16 +218,35 @@ public:
 
     /** Sorts all elements with respect to their addresses. */
     void sort();
+    /** Ensures, that the memory of this image is not shared with any copy. Afterwards, accessing
+     * the memory does not modify the image, hence several threads may access disjoint parts of
+     * the memory concurrently. */
+    void detach();
+
+    /** Plans the transfer of the elements [first, last) by merging adjacent elements into larger
+     * transfers. The transfers are ordered by address.
+     *
+     * Two elements get merged if the gap between them does not exceed @c maxGap bytes. Transfers
+     * that write to the device must not contain any gaps, hence @c maxGap must be 0 for them.
+     * If @c boundary is non-zero, elements are not merged across multiples of @c boundary, e.g.,
+     * memory banks or sectors.
+     *
+     * If @c last is negative, all elements starting at @c first are planned. */
+    QVector<Transfer> planTransfers(uint32_t maxGap=0, uint32_t boundary=0,
+                                    int first=0, int last=-1) const;
+    /** Copies the content of all elements covered by the given transfer into the buffer.
+     * The buffer gets resized to the size of the transfer. Gaps are filled with 0x00. */
+    void gather(const Transfer &transfer, QByteArray &buffer) const;
+    /** Copies the content of the given buffer into the elements covered by the transfer. */
+    void scatter(const Transfer &transfer, const QByteArray &buffer);
 
 	protected:
     /** Alternate settings byte. */
 		uint8_t  _alternate_settings;
     /** Optional image name. */
 		QString _name;
-    /** The elements of the image. */
-		QVector<Element> _elements;
-    /** Maps an address range to element index. */
-    AddressMap _addressmap;
+    /** The elements of the image and their memory. */
+    QSharedDataPointer<Memory> _memory;
 	};
 
 public:
@@ -215,14 +274,20 @@ public:
   /** Checks if all image addresses and sizes is aligned with the given block size. */
   bool isAligned(unsigned blocksize) const;
 
-  /** Reads the specified DFU file.
+  /** Detaches all images from their copies. Afterwards, several threads may access disjoint parts
+   * of the memory concurrently, e.g., when encoding several parts of a codeplug in parallel. */
+  void detach();
+
+  /** Reads the specified DFU file. The file gets mapped into memory and is kept open until all
+   * images read are destroyed.
    * @return @c false on error. */
   bool read(const QString &filename, const ErrorStack &err=ErrorStack());
-  /** Reads the specified DFU file.
+  /** Reads the specified DFU file. The remaining content of the file is read at once.
    * @returns @c false on error. */
   bool read(QFile &file, const ErrorStack &err=ErrorStack());
 
-  /** Writes to the specified file.
+  /** Writes to the specified file. The file gets replaced atomically, hence it is safe to write to
+   * the file this DFU file was read from.
    * @returns @c false on error. */
   bool write(const QString &filename, const ErrorStack &err=ErrorStack());
   /** Writes to the specified file.
@@ -237,6 +302,12 @@ public:
   /** Returns a const pointer to the encoded raw data at the specified offset. */
   virtual const unsigned char *data(uint32_t offset, uint32_t img=0) const;
 
+protected:
+  /** Parses the given file content. */
+  bool parse(const QSharedPointer<Content> &content, const ErrorStack &err);
+  /** Serializes the entire file into the given buffer. */
+  void serialize(QByteArray &buffer) const;
+
 protected:
   /// The list of images.
 	QVector<Image> _images;
@@ -0,0 +1,233 @@
+#ifndef ELEMENTLAYOUT_HH
+#define ELEMENTLAYOUT_HH
+
+#include <QString>
+#include <QtEndian>
+#include <inttypes.h>
+#include <cstring>
+
+/** Compile-time description of the memory layout of a codeplug element of @c Size bytes.
+ *
+ * Each field of an element is described by a type, specifying its offset, width, bit position,
+ * endianness and encoding (e.g., BCD or ASCII). The field is then read and written by static
+ * methods operating on the pointer to the element. In contrast to the accessors provided by
+ * @c Codeplug::Element, the bounds of each field are verified at compile time, hence the accessors
+ * compile into direct loads and stores.
+ *
+ * @code
+ * typedef ElementLayout<0x0040> Layout;
+ * unsigned frequency = Layout::BCD8_be<0x0000>::get(_data)*10;
+ * Layout::Bit<0x0034, 0>::set(_data, true);
+ * @endcode
+ *
+ * @ingroup util */
+template <unsigned Size>
+class ElementLayout
+{
+public:
+  /** A single bit at the given byte offset. */
+  template <unsigned Offset, unsigned BitPos>
+  struct Bit {
+    static_assert(Offset < Size, "Bit exceeds element.");
+    static_assert(BitPos < 8, "Invalid bit position.");
+
+    /** Reads the bit. */
+    static inline bool get(const uint8_t *data) {
+      return data[Offset] & (1u << BitPos);
+    }
+    /** Writes the bit. */
+    static inline void set(uint8_t *data, bool value) {
+      if (value)
+        data[Offset] |= (1u << BitPos);
+      else
+        data[Offset] &= ~(1u << BitPos);
+    }
+  };
+
+  /** An unsigned integer of @c Width bits at the given byte offset and bit position. */
+  template <unsigned Offset, unsigned BitPos, unsigned Width>
+  struct UInt {
+    static_assert(Offset < Size, "Integer exceeds element.");
+    static_assert((0 < Width) && ((BitPos+Width) <= 8), "Integer exceeds byte.");
+
+    /** Reads the integer. */
+    static inline uint8_t get(const uint8_t *data) {
+      return (data[Offset] >> BitPos) & ((1u << Width)-1);
+    }
+    /** Writes the integer. */
+    static inline void set(uint8_t *data, uint8_t value) {
+      uint8_t mask = ((1u << Width)-1);
+      data[Offset] = (data[Offset] & ~(mask << BitPos)) | ((value & mask) << BitPos);
+    }
+  };
+
+  /** An unsigned 8bit integer at the given byte offset. */
+  template <unsigned Offset>
+  struct UInt8 {
+    static_assert(Offset < Size, "Integer exceeds element.");
+
+    /** Reads the integer. */
+    static inline uint8_t get(const uint8_t *data) {
+      return data[Offset];
+    }
+    /** Writes the integer. */
+    static inline void set(uint8_t *data, uint8_t value) {
+      data[Offset] = value;
+    }
+  };
+
+  /** A signed 8bit integer at the given byte offset. */
+  template <unsigned Offset>
+  struct Int8 {
+    static_assert(Offset < Size, "Integer exceeds element.");
+
+    /** Reads the integer. */
+    static inline int8_t get(const uint8_t *data) {
+      return int8_t(data[Offset]);
+    }
+    /** Writes the integer. */
+    static inline void set(uint8_t *data, int8_t value) {
+      data[Offset] = uint8_t(value);
+    }
+  };
+
+  /** An unsigned 16 or 32bit integer of type @c T at the given byte offset. */
+  template <unsigned Offset, class T, bool BigEndian>
+  struct Integer {
+    static_assert((Offset+sizeof(T)) <= Size, "Integer exceeds element.");
+
+    /** Reads the integer. */
+    static inline T get(const uint8_t *data) {
+      return BigEndian ? qFromBigEndian<T>(data+Offset) : qFromLittleEndian<T>(data+Offset);
+    }
+    /** Writes the integer. */
+    static inline void set(uint8_t *data, T value) {
+      if (BigEndian)
+        qToBigEndian<T>(value, data+Offset);
+      else
+        qToLittleEndian<T>(value, data+Offset);
+    }
+  };
+
+  /** An unsigned 24bit integer at the given byte offset. */
+  template <unsigned Offset, bool BigEndian>
+  struct UInt24 {
+    static_assert((Offset+3) <= Size, "Integer exceeds element.");
+
+    /** Reads the integer. */
+    static inline uint32_t get(const uint8_t *data) {
+      const uint8_t *ptr = data+Offset;
+      if (BigEndian)
+        return uint32_t(ptr[2]) + (uint32_t(ptr[1])<<8) + (uint32_t(ptr[0])<<16);
+      return uint32_t(ptr[0]) + (uint32_t(ptr[1])<<8) + (uint32_t(ptr[2])<<16);
+    }
+    /** Writes the integer. */
+    static inline void set(uint8_t *data, uint32_t value) {
+      uint8_t *ptr = data+Offset;
+      ptr[BigEndian ? 2 : 0] = ((value >> 0)  & 0xff);
+      ptr[1]                 = ((value >> 8)  & 0xff);
+      ptr[BigEndian ? 0 : 2] = ((value >> 16) & 0xff);
+    }
+  };
+
+  /** A BCD encoded number of @c Digits digits stored in the integer field @c Raw. */
+  template <class Raw, unsigned Digits>
+  struct BCD {
+    /** Reads the number. */
+    static inline uint32_t get(const uint8_t *data) {
+      uint32_t val = Raw::get(data), res = 0, factor = 1;
+      for (unsigned i=0; i<Digits; i++, val >>= 4, factor *= 10)
+        res += (val & 0xf)*factor;
+      return res;
+    }
+    /** Writes the number. */
+    static inline void set(uint8_t *data, uint32_t value) {
+      uint32_t res = 0;
+      for (unsigned i=0; i<Digits; i++, value /= 10)
+        res |= (value % 10) << (4*i);
+      Raw::set(data, res);
+    }
+  };
+
+  /** Up to @c Length ASCII chars at the given byte offset, terminated or padded by @c Eos. */
+  template <unsigned Offset, unsigned Length, uint8_t Eos=0x00>
+  struct ASCII {
+    static_assert((Offset+Length) <= Size, "String exceeds element.");
+
+    /** Reads the string. */
+    static inline QString get(const uint8_t *data) {
+      const uint8_t *ptr = data+Offset;
+      unsigned n = 0;
+      while ((n < Length) && ptr[n] && (Eos != ptr[n]))
+        n++;
+      return QString::fromLatin1((const char *)ptr, n);
+    }
+    /** Writes the string. */
+    static inline void set(uint8_t *data, const QString &txt) {
+      uint8_t *ptr = data+Offset;
+      for (unsigned i=0; i<Length; i++)
+        ptr[i] = (i < unsigned(txt.length())) ? uint8_t(txt.at(i).toLatin1()) : Eos;
+    }
+  };
+
+  /** Up to @c Length 16bit unicode chars at the given byte offset, terminated or padded by
+   * @c Eos. */
+  template <unsigned Offset, unsigned Length, uint16_t Eos=0x0000>
+  struct Unicode {
+    static_assert((Offset+2*Length) <= Size, "String exceeds element.");
+
+    /** Reads the string. */
+    static inline QString get(const uint8_t *data) {
+      QString txt;
+      for (unsigned i=0; i<Length; i++) {
+        uint16_t c; memcpy(&c, data+Offset+2*i, 2);
+        if (Eos == c)
+          break;
+        txt.append(QChar(c));
+      }
+      return txt;
+    }
+    /** Writes the string. */
+    static inline void set(uint8_t *data, const QString &txt) {
+      for (unsigned i=0; i<Length; i++) {
+        uint16_t c = (i < unsigned(txt.length())) ? txt.at(i).unicode() : Eos;
+        memcpy(data+Offset+2*i, &c, 2);
+      }
+    }
+  };
+
+  /** A 2bit unsigned integer. */
+  template <unsigned Offset, unsigned BitPos> using UInt2 = UInt<Offset, BitPos, 2>;
+  /** A 3bit unsigned integer. */
+  template <unsigned Offset, unsigned BitPos> using UInt3 = UInt<Offset, BitPos, 3>;
+  /** A 4bit unsigned integer. */
+  template <unsigned Offset, unsigned BitPos> using UInt4 = UInt<Offset, BitPos, 4>;
+  /** A 5bit unsigned integer. */
+  template <unsigned Offset, unsigned BitPos> using UInt5 = UInt<Offset, BitPos, 5>;
+  /** A 6bit unsigned integer. */
+  template <unsigned Offset, unsigned BitPos> using UInt6 = UInt<Offset, BitPos, 6>;
+  /** A 16bit big-endian unsigned integer. */
+  template <unsigned Offset> using UInt16_be = Integer<Offset, uint16_t, true>;
+  /** A 16bit little-endian unsigned integer. */
+  template <unsigned Offset> using UInt16_le = Integer<Offset, uint16_t, false>;
+  /** A 24bit big-endian unsigned integer. */
+  template <unsigned Offset> using UInt24_be = UInt24<Offset, true>;
+  /** A 24bit little-endian unsigned integer. */
+  template <unsigned Offset> using UInt24_le = UInt24<Offset, false>;
+  /** A 32bit big-endian unsigned integer. */
+  template <unsigned Offset> using UInt32_be = Integer<Offset, uint32_t, true>;
+  /** A 32bit little-endian unsigned integer. */
+  template <unsigned Offset> using UInt32_le = Integer<Offset, uint32_t, false>;
+  /** A 2-digit BCD number. */
+  template <unsigned Offset> using BCD2 = BCD<UInt8<Offset>, 2>;
+  /** A 4-digit big-endian BCD number. */
+  template <unsigned Offset> using BCD4_be = BCD<UInt16_be<Offset>, 4>;
+  /** A 4-digit little-endian BCD number. */
+  template <unsigned Offset> using BCD4_le = BCD<UInt16_le<Offset>, 4>;
+  /** A 8-digit big-endian BCD number. */
+  template <unsigned Offset> using BCD8_be = BCD<UInt32_be<Offset>, 8>;
+  /** A 8-digit little-endian BCD number. */
+  template <unsigned Offset> using BCD8_le = BCD<UInt32_le<Offset>, 8>;
+};
+
+#endif // ELEMENTLAYOUT_HH
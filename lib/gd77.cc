@@ -94,7 +94,7 @@ GD77::uploadCallsigns()
   // Then upload callsign DB
   for (int n=0; n<_callsigns.image(0).numElements(); n++) {
     unsigned addr = _callsigns.image(0).element(n).address();
-    unsigned size = _callsigns.image(0).element(n).data().size();
+    unsigned size = _callsigns.image(0).element(n).memSize();
     unsigned b0 = addr/BSIZE, nb = size/BSIZE;
     RadioddityInterface::MemoryBank bank = (
           (0x10000 > addr) ? RadioddityInterface::MEMBANK_CALLSIGN_LOWER : RadioddityInterface::MEMBANK_CALLSIGN_UPPER );
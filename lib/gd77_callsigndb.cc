@@ -42,10 +42,10 @@ GD77CallsignDB::userdb_entry_t::setName(const QString &name) {
 }
 
 void
-GD77CallsignDB::userdb_entry_t::fromEntry(const UserDatabase::User &user) {
+GD77CallsignDB::userdb_entry_t::fromEntry(const UserDatabase::UserView &user) {
   clear();
-  setNumber(user.id);
-  setName(user.call);
+  setNumber(user.id());
+  setName(user.call());
 }
 
 
@@ -93,14 +93,11 @@ GD77CallsignDB::encode(UserDatabase *calldb, const Selection &selection, const E
   if (0 == n)
     return true;
 
-  // Select first n entries and sort them in ascending order of their IDs
-  logDebug() << "Select first " << n << " entries out off " << calldb->count() << ".";
-  QVector<UserDatabase::User> users;
-  for (unsigned i=0; i<n; i++)
-    users.append(calldb->user(i));
-  logDebug() << "Sort selected w.r.t their ID in ascending order.";
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  // Select up to n users matching the filters and closest to the prefixes, sorted in ascending
+  // order of their IDs
+  logDebug() << "Select " << n << " entries out off " << calldb->count() << ".";
+  QVector<UserDatabase::UserView> users = calldb->select(selection, n);
+  n = users.size();
 
   // Allocate segment for user db if requested
   unsigned size = align_size(sizeof(userdb_t)+n*sizeof(userdb_entry_t), BLOCK_SIZE);
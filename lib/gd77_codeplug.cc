@@ -3,6 +3,7 @@
 #include "channel.hh"
 #include "utils.hh"
 #include "logger.hh"
+#include "bitmapview.hh"
 #include <QDateTime>
 
 #define ADDR_SETTINGS             0x0000e0
@@ -385,14 +386,16 @@ bool
 GD77Codeplug::createChannels(Config *config, Context &ctx, const ErrorStack &err) {
   Q_UNUSED(err)
 
-  for (int b=0,c=0; b<NUM_CHANNEL_BANKS; b++) {
+  for (int b=0; b<NUM_CHANNEL_BANKS; b++) {
     uint8_t *ptr = nullptr;
     if (0 == b) ptr = data(ADDR_CHANNEL_BANK_0);
     else ptr = data(ADDR_CHANNEL_BANK_1 + (b-1)*CHANNEL_BANK_SIZE);
     ChannelBankElement bank(ptr);
-    for (int i=0; (i<NUM_CHANNELS_PER_BANK)&&(c<NUM_CHANNELS); i++, c++) {
-      if (! bank.isEnabled(i))
-        continue;
+    BitmapView enabled = bank.bitmap();
+    for (unsigned i=enabled.first(); i<enabled.size(); i=enabled.next(i+1)) {
+      int c = b*NUM_CHANNELS_PER_BANK + i;
+      if (c >= NUM_CHANNELS)
+        break;
       Channel *ch = ChannelElement(bank.get(i)).toChannelObj(ctx);
       config->channelList()->add(ch); ctx.add(ch, c+1);
     }
@@ -404,14 +407,16 @@ bool
 GD77Codeplug::linkChannels(Config *config, Context &ctx, const ErrorStack &err) {
   Q_UNUSED(config); Q_UNUSED(err)
 
-  for (int b=0,c=0; b<NUM_CHANNEL_BANKS; b++) {
+  for (int b=0; b<NUM_CHANNEL_BANKS; b++) {
     uint8_t *ptr = nullptr;
     if (0 == b) ptr = data(ADDR_CHANNEL_BANK_0);
     else ptr = data(ADDR_CHANNEL_BANK_1 + (b-1)*CHANNEL_BANK_SIZE);
     ChannelBankElement bank(ptr);
-    for (int i=0; (i<NUM_CHANNELS_PER_BANK)&&(c<NUM_CHANNELS); i++, c++) {
-      if (! bank.isEnabled(i))
-        continue;
+    BitmapView enabled = bank.bitmap();
+    for (unsigned i=enabled.first(); i<enabled.size(); i=enabled.next(i+1)) {
+      int c = b*NUM_CHANNELS_PER_BANK + i;
+      if (c >= NUM_CHANNELS)
+        break;
       if (!ChannelElement(bank.get(i)).linkChannelObj(ctx.get<Channel>(c+1), ctx))
         return false;
     }
@@ -508,9 +513,8 @@ GD77Codeplug::createZones(Config *config, Context &ctx, const ErrorStack &err) {
   bool extend_last_zone = false;
   ZoneBankElement bank(data(ADDR_ZONE_BANK));
 
-  for (int i=0; i<NUM_ZONES; i++) {
-    if (! bank.isEnabled(i))
-      continue;
+  BitmapView enabled = bank.bitmap();
+  for (unsigned i=enabled.first(); (i<enabled.size()) && (i<NUM_ZONES); i=enabled.next(i+1)) {
     ZoneElement z(bank.get(i));
 
     // Determine whether this zone should be combined with the previous one
@@ -543,9 +547,8 @@ GD77Codeplug::linkZones(Config *config, Context &ctx, const ErrorStack &err) {
   bool extend_last_zone = false;
   ZoneBankElement bank(data(ADDR_ZONE_BANK));
 
-  for (int i=0; i<NUM_ZONES; i++) {
-    if (! bank.isEnabled(i))
-      continue;
+  BitmapView enabled = bank.bitmap();
+  for (unsigned i=enabled.first(); (i<enabled.size()) && (i<NUM_ZONES); i=enabled.next(i+1)) {
     ZoneElement z(bank.get(i));
 
     // Determine whether this zone should be combined with the previous one
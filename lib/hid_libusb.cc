@@ -1,9 +1,137 @@
 #include "hid_libusb.hh"
 #include "logger.hh"
+#include "radioemulator.hh"
+#include <QQueue>
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <vector>
 
 #define HID_INTERFACE   0                   // interface index
 #define TIMEOUT_MSEC    500                 // receive timeout
 #define MAX_RETRY       100                 // Number of retries
+#define REPORT_SIZE     42                  // size of input and output reports
+#define DEFAULT_WINDOW  4                   // default number of commands in flight
+#define IN_TRANSFERS    2                   // number of armed interrupt transfers during batches
+#define BATCH_TIMEOUT_MSEC 5000             // max. time without progress during batches
+#define DRAIN_MSEC      200                 // time to wait for pending reports after an error
+
+/** State of a batch transfer, shared with the libusb callbacks. */
+struct HIDBatch {
+  /** If @c true, the interrupt transfers get re-submitted. */
+  bool armed;
+  /** Number of interrupt transfers submitted. */
+  int inActive;
+  /** Number of control transfers submitted. */
+  int outActive;
+  /** The first libusb error, 0 if none. */
+  int error;
+  /** The reports received. */
+  QQueue<QByteArray> reports;
+  /** The control transfers available for the next command. */
+  QVector<libusb_transfer *> outFree;
+  /** The maximum number of control transfers submitted at the same time. */
+  int outMax;
+  /** The emulated device, if any. Then, the transfers get completed by
+   * @c hid_batch_handle_events instead of libusb. */
+  RadioEmulator *emulator;
+  /** The emulated interrupt transfers waiting for a report. */
+  QQueue<libusb_transfer *> inArmed;
+  /** The emulated control transfers waiting for completion. */
+  QQueue<libusb_transfer *> outPending;
+  /** The reports of the emulated device, not yet delivered to an interrupt transfer. */
+  QQueue<QByteArray> inPending;
+};
+
+static int
+hid_batch_submit(HIDBatch *batch, struct libusb_transfer *t) {
+  if (nullptr == batch->emulator)
+    return libusb_submit_transfer(t);
+
+  if (LIBUSB_ENDPOINT_IN & t->endpoint) {
+    batch->inArmed.enqueue(t);
+    return 0;
+  }
+
+  // The emulator replies immediately, the report gets delivered with the next events
+  unsigned char reply[REPORT_SIZE];
+  int len = batch->emulator->hidTransfer(t->buffer+LIBUSB_CONTROL_SETUP_SIZE, REPORT_SIZE,
+                                         reply, REPORT_SIZE);
+  if (0 > len)
+    return LIBUSB_ERROR_IO;
+  batch->inPending.enqueue(QByteArray((const char *)reply, len));
+  batch->outPending.enqueue(t);
+  return 0;
+}
+
+static void
+hid_batch_cancel(HIDBatch *batch, struct libusb_transfer *t) {
+  if (nullptr == batch->emulator) {
+    libusb_cancel_transfer(t);
+    return;
+  }
+
+  if ((! batch->inArmed.removeOne(t)) && (! batch->outPending.removeOne(t)))
+    return;
+  t->status = LIBUSB_TRANSFER_CANCELLED;
+  t->callback(t);
+}
+
+static int
+hid_batch_handle_events(libusb_context *ctx, HIDBatch *batch, long usec) {
+  if (nullptr == batch->emulator) {
+    struct timeval tv = {0, usec};
+    return libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+  }
+
+  if (batch->outPending.isEmpty() && (batch->inPending.isEmpty() || batch->inArmed.isEmpty())) {
+    QThread::usleep(usec);
+    return LIBUSB_ERROR_TIMEOUT;
+  }
+
+  // Complete the control transfers, then deliver the reports in order to the armed transfers
+  while (! batch->outPending.isEmpty()) {
+    libusb_transfer *t = batch->outPending.dequeue();
+    t->status = LIBUSB_TRANSFER_COMPLETED;
+    t->callback(t);
+  }
+  while ((! batch->inPending.isEmpty()) && (! batch->inArmed.isEmpty())) {
+    libusb_transfer *t = batch->inArmed.dequeue();
+    QByteArray report = batch->inPending.dequeue();
+    t->actual_length = std::min(report.size(), t->length);
+    memcpy(t->buffer, report.constData(), t->actual_length);
+    t->status = LIBUSB_TRANSFER_COMPLETED;
+    t->callback(t);
+  }
+  return 0;
+}
+
+static void
+hid_batch_in_callback(struct libusb_transfer *t) {
+  HIDBatch *batch = (HIDBatch *)t->user_data;
+
+  if (LIBUSB_TRANSFER_COMPLETED == t->status)
+    batch->reports.enqueue(QByteArray((const char *)t->buffer, t->actual_length));
+  else if ((LIBUSB_TRANSFER_CANCELLED != t->status) && (0 == batch->error))
+    batch->error = (LIBUSB_TRANSFER_NO_DEVICE == t->status) ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_ERROR_IO;
+
+  // Keep endpoint armed
+  if (batch->armed && (LIBUSB_TRANSFER_CANCELLED != t->status) && (0 == hid_batch_submit(batch, t)))
+    return;
+  batch->inActive--;
+}
+
+static void
+hid_batch_out_callback(struct libusb_transfer *t) {
+  HIDBatch *batch = (HIDBatch *)t->user_data;
+
+  if ((LIBUSB_TRANSFER_COMPLETED != t->status) && (LIBUSB_TRANSFER_CANCELLED != t->status)
+      && (0 == batch->error))
+    batch->error = (LIBUSB_TRANSFER_TIMED_OUT == t->status) ? LIBUSB_ERROR_TIMEOUT : LIBUSB_ERROR_IO;
+
+  batch->outActive--;
+  batch->outFree.append(t);
+}
 
 /* ********************************************************************************************* *
  * Implementation of HIDevice::Descriptor
@@ -19,7 +147,8 @@ HIDevice::Descriptor::Descriptor(const USBDeviceInfo &info, uint8_t bus, uint8_t
  * Implementation of HIDevice
  * ********************************************************************************************* */
 HIDevice::HIDevice(const USBDeviceDescriptor &descr, const ErrorStack &err, QObject *parent)
-  : QObject(parent), _ctx(nullptr), _dev(nullptr), _transfer(nullptr)
+  : QObject(parent), _ctx(nullptr), _dev(nullptr), _transfer(nullptr), _window(DEFAULT_WINDOW),
+    _maxInFlight(0), _emulator(nullptr)
 {
   if (USBDeviceInfo::Class::HID != descr.interfaceClass()) {
     errMsg(err) << "Cannot connect to HID device using a non HID descriptor: "
@@ -27,6 +156,11 @@ HIDevice::HIDevice(const USBDeviceDescriptor &descr, const ErrorStack &err, QObj
     return;
   }
 
+  if (nullptr != (_emulator = RadioEmulator::find(descr))) {
+    logDebug() << "Connected to emulated HID device " << descr.description() << ".";
+    return;
+  }
+
   int error = libusb_init(&_ctx);
   if (error < 0) {
     errMsg(err) << "Libusb init failed (" << error << "): "
@@ -148,11 +282,12 @@ HIDevice::detect(uint16_t vid, uint16_t pid) {
 
 bool
 HIDevice::isOpen() const {
-  return (nullptr != _ctx) && (nullptr != _dev);
+  return ((nullptr != _ctx) && (nullptr != _dev)) || (nullptr != _emulator);
 }
 
 void
 HIDevice::close() {
+  _emulator = nullptr;
   if (nullptr == _ctx)
     return;
 
@@ -195,9 +330,16 @@ HIDevice::hid_send_recv(const unsigned char *data, unsigned nbytes,
     return false;
   }
 
-  if (reply_len != sizeof(reply)) {
+  return check_reply(reply, reply_len, rdata, rlength, err);
+}
+
+bool
+HIDevice::check_reply(const unsigned char *reply, int reply_len,
+                      unsigned char *rdata, unsigned rlength, const ErrorStack &err)
+{
+  if (reply_len != REPORT_SIZE) {
     errMsg(err) << "Short read: " << reply_len
-                << " bytes instead of " << (int)sizeof(reply) << "!";
+                << " bytes instead of " << REPORT_SIZE << "!";
     return false;
   }
   if (reply[0] != 3 || reply[1] != 0 || reply[3] != 0) {
@@ -214,11 +356,169 @@ HIDevice::hid_send_recv(const unsigned char *data, unsigned nbytes,
   return true;
 }
 
+unsigned
+HIDevice::window() const {
+  return _window;
+}
+
+void
+HIDevice::setWindow(unsigned window) {
+  _window = std::max(1U, window);
+}
+
+unsigned
+HIDevice::maxInFlight() const {
+  return _maxInFlight;
+}
+
+bool
+HIDevice::hid_send_recv_batch(const unsigned char *data, unsigned nbytes, unsigned count,
+                              unsigned char *rdata, unsigned rlength, const ErrorStack &err)
+{
+  if ((2 > _window) || (2 > count)) {
+    _maxInFlight = std::min(1U, count);
+    for (unsigned i=0; i<count; i++) {
+      if (! hid_send_recv(data+i*nbytes, nbytes, rdata+i*rlength, rlength, err))
+        return false;
+    }
+    return true;
+  }
+
+  unsigned window = std::min(_window, count);
+  HIDBatch batch;
+  batch.armed = true; batch.inActive = 0; batch.outActive = 0; batch.error = 0;
+  batch.outMax = 0; batch.emulator = _emulator;
+
+  // Keep several interrupt transfers armed, such that no report gets lost
+  unsigned char inbuf[IN_TRANSFERS][REPORT_SIZE];
+  libusb_transfer *in[IN_TRANSFERS];
+  for (int i=0; i<IN_TRANSFERS; i++) {
+    in[i] = libusb_alloc_transfer(0);
+    libusb_fill_interrupt_transfer(
+          in[i], _dev, LIBUSB_RECIPIENT_INTERFACE | LIBUSB_ENDPOINT_IN,
+          inbuf[i], REPORT_SIZE, hid_batch_in_callback, &batch, 0);
+    if (0 == hid_batch_submit(&batch, in[i]))
+      batch.inActive++;
+  }
+
+  // One control transfer per command in flight
+  std::vector<unsigned char> outbuf(window*(LIBUSB_CONTROL_SETUP_SIZE+REPORT_SIZE));
+  QVector<libusb_transfer *> out;
+  for (unsigned i=0; i<window; i++) {
+    libusb_transfer *t = libusb_alloc_transfer(0);
+    t->buffer = outbuf.data() + i*(LIBUSB_CONTROL_SETUP_SIZE+REPORT_SIZE);
+    out.append(t);
+    batch.outFree.append(t);
+  }
+
+  bool ok = (0 < batch.inActive);
+  if (! ok)
+    errMsg(err) << "Cannot submit interrupt transfer.";
+
+  unsigned sent = 0, received = 0;
+  QElapsedTimer timer; timer.start();
+  while (ok && (received < count)) {
+    // Send commands as long as the window allows
+    while ((sent < count) && ((sent-received) < window) && (! batch.outFree.isEmpty())) {
+      libusb_transfer *t = batch.outFree.takeLast();
+      unsigned char *buf = t->buffer;
+      libusb_fill_control_setup(
+            buf, LIBUSB_REQUEST_TYPE_CLASS|LIBUSB_RECIPIENT_INTERFACE|LIBUSB_ENDPOINT_OUT,
+            0x09/*HID Set_Report*/, (2/*HID output*/ << 8) | 0, HID_INTERFACE, REPORT_SIZE);
+      unsigned char *report = buf + LIBUSB_CONTROL_SETUP_SIZE;
+      memset(report, 0, REPORT_SIZE);
+      report[0] = 1;
+      report[1] = 0;
+      report[2] = nbytes;
+      report[3] = nbytes >> 8;
+      if (nbytes > 0)
+        memcpy(report+4, data+sent*nbytes, nbytes);
+      libusb_fill_control_transfer(t, _dev, buf, hid_batch_out_callback, &batch, TIMEOUT_MSEC);
+      if (int error = hid_batch_submit(&batch, t)) {
+        errMsg(err) << "Error " << error << " transmitting data via control transfer: "
+                    << libusb_strerror((enum libusb_error) error) << ".";
+        batch.outFree.append(t);
+        ok = false;
+        break;
+      }
+      batch.outActive++;
+      batch.outMax = std::max(batch.outMax, batch.outActive);
+      sent++;
+    }
+
+    // Process received reports, responses arrive in order
+    while (ok && (! batch.reports.isEmpty()) && (received < count)) {
+      QByteArray report = batch.reports.dequeue();
+      ok = check_reply((const unsigned char *)report.constData(), report.size(),
+                       rdata+received*rlength, rlength, err);
+      received++;
+      timer.restart();
+    }
+
+    if ((! ok) || (received == count))
+      break;
+
+    if (batch.error) {
+      errMsg(err) << "Error " << batch.error << " during batch transfer: "
+                  << libusb_strerror((enum libusb_error) batch.error) << ".";
+      ok = false;
+      break;
+    }
+
+    if (BATCH_TIMEOUT_MSEC < timer.elapsed()) {
+      errMsg(err) << "Timeout during batch transfer: Received " << received
+                  << " of " << count << " responses.";
+      ok = false;
+      break;
+    }
+
+    int result = hid_batch_handle_events(_ctx, &batch, 100000);
+    if ((result < 0) && (LIBUSB_ERROR_INTERRUPTED != result) && (LIBUSB_ERROR_TIMEOUT != result)) {
+      errMsg(err) << "Error " << result << " handling events: "
+                  << libusb_strerror((enum libusb_error) result) << ".";
+      ok = false;
+    }
+  }
+
+  // On error, swallow any pending reports, such that the next command gets its response
+  if (! ok) {
+    timer.restart();
+    while (DRAIN_MSEC > timer.elapsed())
+      hid_batch_handle_events(_ctx, &batch, 10000);
+  }
+
+  // Disarm and wait for all transfers to return
+  batch.armed = false;
+  for (int i=0; i<IN_TRANSFERS; i++)
+    hid_batch_cancel(&batch, in[i]);
+  foreach (libusb_transfer *t, out)
+    hid_batch_cancel(&batch, t);
+  while ((0 < batch.inActive) || (0 < batch.outActive))
+    hid_batch_handle_events(_ctx, &batch, 10000);
+
+  for (int i=0; i<IN_TRANSFERS; i++)
+    libusb_free_transfer(in[i]);
+  foreach (libusb_transfer *t, out) {
+    t->buffer = nullptr;
+    libusb_free_transfer(t);
+  }
+
+  _maxInFlight = batch.outMax;
+  return ok;
+}
+
 
 int
 HIDevice::write_read(const unsigned char *data, unsigned length,
                      unsigned char *reply, unsigned rlength, const ErrorStack &err)
 {
+  if (nullptr != _emulator) {
+    int result = _emulator->hidTransfer(data, length, reply, rlength);
+    if (0 > result)
+      errMsg(_cbError) << "Emulated HID device rejected report.";
+    return result;
+  }
+
   if (! _transfer) {
     // Allocate transfer descriptor on first invocation.
     _transfer = libusb_alloc_transfer(0);
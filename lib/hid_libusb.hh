@@ -6,6 +6,8 @@
 #include "errorstack.hh"
 #include "radiointerface.hh"
 
+class RadioEmulator;
+
 /** Implements the HID radio interface using libusb.
  * @ingroup rif */
 class HIDevice: public QObject
@@ -38,6 +40,19 @@ public:
    * @param err Passes an error stack to put error messages on. */
   bool hid_send_recv(const unsigned char *data, unsigned nbytes,
                      unsigned char *rdata, unsigned rlength, const ErrorStack &err=ErrorStack());
+  /** Sends @c count commands and receives their responses. The commands of @c nbytes each are
+   * stored consecutively in @c data, the responses of @c rlength bytes each are stored
+   * consecutively in @c rdata. Up to @c window() commands are sent ahead of their responses.
+   * @returns @c false on error. Then, the content of @c rdata is undefined. */
+  bool hid_send_recv_batch(const unsigned char *data, unsigned nbytes, unsigned count,
+                           unsigned char *rdata, unsigned rlength, const ErrorStack &err=ErrorStack());
+
+  /** Returns the maximum number of commands in flight during a batch transfer. */
+  unsigned window() const;
+  /** Sets the maximum number of commands in flight. A window of 1 disables pipelining. */
+  void setWindow(unsigned window);
+  /** Returns the maximum number of commands in flight during the last batch transfer. */
+  unsigned maxInFlight() const;
 
   /** Close connection to device. */
 	void close();
@@ -52,6 +67,9 @@ protected:
                  unsigned char *reply, unsigned rlength, const ErrorStack &err=ErrorStack());
   /** Callback for response data. */
   static void read_callback(struct libusb_transfer *t);
+  /** Checks the given reply and copies its payload of @c rlength bytes into @c rdata. */
+  static bool check_reply(const unsigned char *reply, int reply_len,
+                          unsigned char *rdata, unsigned rlength, const ErrorStack &err=ErrorStack());
 
 protected:
   /** libusb context. */
@@ -66,6 +84,12 @@ protected:
 	volatile int _nbytes_received;
   /** Internal used error stack for the static callback function. */
   ErrorStack _cbError;
+  /** Maximum number of commands in flight during a batch transfer. */
+  unsigned _window;
+  /** Maximum number of commands in flight during the last batch transfer. */
+  unsigned _maxInFlight;
+  /** The emulated device, if the descriptor refers to one. */
+  RadioEmulator *_emulator;
 };
 
 #endif // HID_MACOS_HH
@@ -6,6 +6,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <logger.hh>
+#include <algorithm>
+#include "radioemulator.hh"
 
 
 /* ********************************************************************************************* *
@@ -21,8 +23,13 @@ HIDevice::Descriptor::Descriptor(const USBDeviceInfo &info, uint32_t locationId,
  * Implementation of HIDevice
  * ********************************************************************************************* */
 HIDevice::HIDevice(const USBDeviceDescriptor &desc, const ErrorStack &err, QObject *parent)
-  : QObject(parent), _dev(nullptr)
+  : QObject(parent), _HIDManager(nullptr), _dev(nullptr)
 {
+  if (nullptr != (_emulator = RadioEmulator::find(desc))) {
+    logDebug() << "Connected to emulated HID device " << desc.description() << ".";
+    return;
+  }
+
   // Create the USB HID Manager.
   _HIDManager = IOHIDManagerCreate(kCFAllocatorDefault,
                                    kIOHIDOptionsTypeNone);
@@ -151,7 +158,7 @@ HIDevice::detect(uint16_t vid, uint16_t pid)
 
 bool
 HIDevice::isOpen() const {
-  return nullptr != _dev;
+  return (nullptr != _dev) || (nullptr != _emulator);
 }
 
 //
@@ -183,6 +190,11 @@ HIDevice::hid_send_recv(const unsigned char *data, unsigned nbytes,
   memset(_receive_buf, 0, sizeof(_receive_buf));
 
   uint retrycount = 0;
+  if (nullptr != _emulator) {
+    _nbytes_received = _emulator->hidTransfer(buf, sizeof(buf), _receive_buf, sizeof(_receive_buf));
+    goto check;
+  }
+
 again:
   // Write to HID device.
   result = IOHIDDeviceSetReport(_dev, kIOHIDReportTypeOutput, 0, buf, sizeof(buf));
@@ -206,6 +218,7 @@ again:
   }
   usleep(100);
 
+check:
   if (_nbytes_received != sizeof(_receive_buf)) {
     errMsg(err) << "Short read: " << _nbytes_received << " bytes instead of "
                 << (int)sizeof(_receive_buf) << "!";
@@ -229,6 +242,33 @@ again:
   return true;
 }
 
+bool
+HIDevice::hid_send_recv_batch(const unsigned char *data, unsigned nbytes, unsigned count,
+                              unsigned char *rdata, unsigned rlength, const ErrorStack &err)
+{
+  _maxInFlight = std::min(1U, count);
+  for (unsigned i=0; i<count; i++) {
+    if (! hid_send_recv(data+i*nbytes, nbytes, rdata+i*rlength, rlength, err))
+      return false;
+  }
+  return true;
+}
+
+unsigned
+HIDevice::window() const {
+  return _window;
+}
+
+void
+HIDevice::setWindow(unsigned window) {
+  _window = std::max(1U, window);
+}
+
+unsigned
+HIDevice::maxInFlight() const {
+  return _maxInFlight;
+}
+
 //
 // Callback: data is received from the HID device
 //
@@ -304,6 +344,7 @@ HIDevice::callback_close(void *context, IOReturn result, void *sender, IOHIDDevi
 void
 HIDevice::close()
 {
+  _emulator = nullptr;
   if (! _dev)
     return;
   IOHIDDeviceClose(_dev, kIOHIDOptionsTypeNone);
@@ -6,6 +6,8 @@
 #include "errorstack.hh"
 #include "radiointerface.hh"
 
+class RadioEmulator;
+
 /** Implements the HID radio interface MacOS X API.
  * @ingroup rif */
 class HIDevice: public QObject
@@ -39,6 +41,19 @@ public:
 	bool hid_send_recv(const unsigned char *data, unsigned nbytes,
                      unsigned char *rdata, unsigned rlength,
                      const ErrorStack &err=ErrorStack());
+  /** Sends @c count commands and receives their responses. The commands of @c nbytes each are
+   * stored consecutively in @c data, the responses of @c rlength bytes each are stored
+   * consecutively in @c rdata. Up to @c window() commands are sent ahead of their responses.
+   * @returns @c false on error. Then, the content of @c rdata is undefined. */
+  bool hid_send_recv_batch(const unsigned char *data, unsigned nbytes, unsigned count,
+                           unsigned char *rdata, unsigned rlength, const ErrorStack &err=ErrorStack());
+
+  /** Returns the maximum number of commands in flight during a batch transfer. */
+  unsigned window() const;
+  /** Sets the maximum number of commands in flight. A window of 1 disables pipelining. */
+  void setWindow(unsigned window);
+  /** Returns the maximum number of commands in flight during the last batch transfer. */
+  unsigned maxInFlight() const;
 
   /** Close connection to device. */
 	void close();
@@ -67,6 +82,13 @@ protected:
 	unsigned char _receive_buf[42];
 	/** Receive result. */
 	volatile int _nbytes_received = 0;
+  /** Maximum number of commands in flight during a batch transfer. Batch transfers are not
+   * pipelined on MacOS. */
+  unsigned _window = 1;
+  /** Maximum number of commands in flight during the last batch transfer. */
+  unsigned _maxInFlight = 0;
+  /** The emulated device, if the descriptor refers to one. */
+  RadioEmulator *_emulator = nullptr;
 };
 
 #endif // HID_MACOS_HH
@@ -77,6 +77,7 @@ Logger::~Logger() {
 
 void
 Logger::log(const LogMessage &msg) {
+  QMutexLocker locker(&_mutex);
   foreach (LogHandler *handler, _handler) {
     handler->handle(msg);
   }
@@ -6,6 +6,7 @@
 #include <QFile>
 #include <QTextStream>
 #include <QList>
+#include <QMutex>
 
 /** Constructs a debug message. */
 #define logDebug() LogMessage(LogMessage::DEBUG, __FILE__, __LINE__)
@@ -98,7 +99,8 @@ public:
   /** Destructor. */
   virtual ~Logger();
 
-  /** Logs a message. */
+  /** Logs a message. This method may be called from any thread, the handlers get called
+   * sequentially. */
   void log(const LogMessage &msg);
   /** Adds a log-handler to the logger. The ownership is transferred to the logger. */
   void addHandler(LogHandler *handler);
@@ -118,6 +120,8 @@ protected:
   static Logger *_instance;
   /** The list of registered log-handler. */
   QList<LogHandler *> _handler;
+  /** Serializes the calls to the handlers. */
+  QMutex _mutex;
 };
 
 
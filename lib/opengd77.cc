@@ -2,14 +2,18 @@
 #include "opengd77_limits.hh"
 #include "logger.hh"
 #include "config.hh"
+#include "codeplugcache.hh"
 
 
 #define BSIZE 32
+/** Transfers are split into chunks of this size to report the progress. */
+#define CHUNK_SIZE 1024
 
 RadioLimits *OpenGD77::_limits = nullptr;
 
 OpenGD77::OpenGD77(OpenGD77Interface *device, QObject *parent)
-  : Radio(parent), _name("Open GD-77"), _dev(device), _config(nullptr), _codeplug(), _callsigns()
+  : Radio(parent), _name("Open GD-77"), _dev(device), _codeplugFlags(), _config(nullptr),
+    _codeplug(), _callsigns()
 {
   // pass...
 }
@@ -49,6 +53,13 @@ OpenGD77::codeplug() {
   return _codeplug;
 }
 
+const TransferMetrics *
+OpenGD77::metrics() const {
+  if (nullptr == _dev)
+    return nullptr;
+  return &_dev->metrics();
+}
+
 RadioInfo
 OpenGD77::defaultRadioInfo() {
   return RadioInfo(
@@ -82,8 +93,6 @@ OpenGD77::startDownload(bool blocking, const ErrorStack &err) {
 
 bool
 OpenGD77::startUpload(Config *config, bool blocking, const Codeplug::Flags &flags, const ErrorStack &err) {
-  Q_UNUSED(flags)
-
   logDebug() << "Start upload to " << name() << "...";
 
   if (StatusIdle != _task) {
@@ -97,6 +106,7 @@ OpenGD77::startUpload(Config *config, bool blocking, const Codeplug::Flags &flag
   }
 
   _task = StatusUpload;
+  _codeplugFlags = flags;
   _errorStack = err;
 
   if (blocking) {
@@ -236,22 +246,22 @@ OpenGD77::download()
 
   // Then download codeplug
   size_t bcount = 0;
+  QByteArray buffer;
   for (int image=0; image<_codeplug.numImages(); image++) {
     uint32_t bank = (0 == image) ? OpenGD77Codeplug::EEPROM : OpenGD77Codeplug::FLASH;
 
-    for (int n=0; n<_codeplug.image(image).numElements(); n++) {
-      unsigned addr = _codeplug.image(image).element(n).address();
-      unsigned size = _codeplug.image(image).element(n).data().size();
-      unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-
-      for (unsigned b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->read(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE, _errorStack)) {
-          errMsg(_errorStack) << "Cannot read block " << (b0+b) << ".";
+    foreach (const DFUFile::Image::Transfer &t, _codeplug.image(image).planTransfers()) {
+      buffer.resize(t.size);
+      for (unsigned o=0; o<t.size; o+=CHUNK_SIZE) {
+        unsigned n = std::min(unsigned(CHUNK_SIZE), t.size-o);
+        if (! _dev->read(bank, t.address+o, (uint8_t *)buffer.data()+o, n, _errorStack)) {
+          errMsg(_errorStack) << "Cannot read block " << (t.address+o)/BSIZE << ".";
           return false;
         }
-        QThread::usleep(100);
+        bcount += n;
         emit downloadProgress(float(bcount*100)/totb);
       }
+      _codeplug.image(image).scatter(t, buffer);
     }
     _dev->read_finish(_errorStack);
   }
@@ -283,23 +293,50 @@ OpenGD77::upload()
     return false;
   }
 
+  // Assemble fingerprint from some sampled blocks and try to restore the image from the cache
+  // The interface does not report the firmware version, hence the cache stays disabled, as a
+  // cached image may be stale after a firmware update.
+  CodeplugCache cache(_dev->identifier());
+  bool useCache = _codeplugFlags.useImageCache && cache.isEnabled();
+  QVector<uint32_t> samples[2];
+  bool restored = false;
+  if (useCache) {
+    for (int image=0; image<_codeplug.numImages(); image++) {
+      uint32_t bank = (0 == image) ? OpenGD77Codeplug::EEPROM : OpenGD77Codeplug::FLASH;
+      samples[image] = CodeplugCache::samples(_codeplug.image(image), BSIZE);
+      foreach (uint32_t addr, samples[image]) {
+        if (! _dev->read(bank, addr, _codeplug.data(addr, image), BSIZE, _errorStack)) {
+          errMsg(_errorStack) << "Cannot read block at " << QString::number(addr, 16) << ".";
+          return false;
+        }
+        cache.addFingerprint(addr, _codeplug.data(addr, image), BSIZE);
+      }
+    }
+    if (cache.load() && cache.restore(_codeplug)) {
+      logDebug() << "Restored codeplug from cache, skip read-back.";
+      _dev->read_finish();
+      restored = true;
+    }
+  }
+
   // Then download codeplug
-  size_t bcount = 0;
-  for (int image=0; image<_codeplug.numImages(); image++) {
+  size_t bcount = restored ? totb : 0;
+  QByteArray buffer;
+  for (int image=0; (!restored) && (image<_codeplug.numImages()); image++) {
     uint32_t bank = ( (0 == image) ? OpenGD77Codeplug::EEPROM : OpenGD77Codeplug::FLASH );
 
-    for (int n=0; n<_codeplug.image(image).numElements(); n++) {
-      unsigned addr = _codeplug.image(image).element(n).address();
-      unsigned size = _codeplug.image(image).element(n).data().size();
-      unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-      for (unsigned b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->read(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE, _errorStack)) {
-          errMsg(_errorStack) << "Cannot read block " << (b0+b) << ".";
+    foreach (const DFUFile::Image::Transfer &t, _codeplug.image(image).planTransfers()) {
+      buffer.resize(t.size);
+      for (unsigned o=0; o<t.size; o+=CHUNK_SIZE) {
+        unsigned n = std::min(unsigned(CHUNK_SIZE), t.size-o);
+        if (! _dev->read(bank, t.address+o, (uint8_t *)buffer.data()+o, n, _errorStack)) {
+          errMsg(_errorStack) << "Cannot read block " << (t.address+o)/BSIZE << ".";
           return false;
         }
-        QThread::usleep(100);
+        bcount += n;
         emit uploadProgress(float(bcount*50)/totb);
       }
+      _codeplug.image(image).scatter(t, buffer);
     }
     _dev->read_finish();
   }
@@ -316,23 +353,33 @@ OpenGD77::upload()
   for (int image=0; image<_codeplug.numImages(); image++) {
     uint32_t bank = (0 == image) ? OpenGD77Codeplug::EEPROM : OpenGD77Codeplug::FLASH;
 
-    for (int n=0; n<_codeplug.image(image).numElements(); n++) {
-      unsigned addr = _codeplug.image(image).element(n).address();
-      unsigned size = _codeplug.image(image).element(n).data().size();
-      unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-
-      for (unsigned b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->write(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE, _errorStack)) {
-          errMsg(_errorStack) << "Cannot write block " << (b0+b) << ".";
+    foreach (const DFUFile::Image::Transfer &t, _codeplug.image(image).planTransfers()) {
+      _codeplug.image(image).gather(t, buffer);
+      for (unsigned o=0; o<t.size; o+=CHUNK_SIZE) {
+        unsigned n = std::min(unsigned(CHUNK_SIZE), t.size-o);
+        if (! _dev->write(bank, t.address+o, (uint8_t *)buffer.data()+o, n, _errorStack)) {
+          errMsg(_errorStack) << "Cannot write block " << (t.address+o)/BSIZE << ".";
           return false;
         }
-        QThread::usleep(100);
+        bcount += n;
         emit uploadProgress(float(bcount*50)/totb);
       }
     }
     _dev->write_finish();
   }
 
+  // Store the image written in the cache
+  if (useCache) {
+    cache.clearFingerprint();
+    for (int image=0; image<_codeplug.numImages(); image++) {
+      foreach (uint32_t addr, samples[image])
+        cache.addFingerprint(addr, _codeplug.data(addr, image), BSIZE);
+    }
+    ErrorStack cacheErr;
+    if (! cache.store(_codeplug, cacheErr))
+      logWarn() << "Cannot store codeplug image in cache: " << cacheErr.format();
+  }
+
   return true;
 }
 
@@ -356,18 +403,19 @@ OpenGD77::uploadCallsigns()
   }
 
   unsigned bcount = 0;
+  QByteArray buffer;
   // Then upload callsign DB
-  for (int n=0; n<_callsigns.image(0).numElements(); n++) {
-    unsigned addr = _callsigns.image(0).element(n).address();
-    unsigned size = _callsigns.image(0).element(n).data().size();
-    unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-    for (unsigned b=0; b<nb; b++, bcount+=BSIZE) {
-      if (! _dev->write(OpenGD77Codeplug::FLASH, (b0+b)*BSIZE,
-                        _callsigns.data((b0+b)*BSIZE, 0), BSIZE, _errorStack))
+  foreach (const DFUFile::Image::Transfer &t, _callsigns.image(0).planTransfers()) {
+    _callsigns.image(0).gather(t, buffer);
+    for (unsigned o=0; o<t.size; o+=CHUNK_SIZE) {
+      unsigned n = std::min(unsigned(CHUNK_SIZE), t.size-o);
+      if (! _dev->write(OpenGD77Codeplug::FLASH, t.address+o, (uint8_t *)buffer.data()+o, n,
+                        _errorStack))
       {
-        errMsg(_errorStack) << "Cannot write block " << (b0+b) << ".";
+        errMsg(_errorStack) << "Cannot write block " << (t.address+o)/BSIZE << ".";
         return false;
       }
+      bcount += n;
       emit uploadProgress(float(bcount*100)/totb);
     }
   }
@@ -27,6 +27,7 @@ public:
   const RadioLimits &limits() const;
   const Codeplug &codeplug() const;
   Codeplug &codeplug();
+  const TransferMetrics *metrics() const;
 
   /** Returns the default radio information. The actual instance may have different properties
    * due to variants of the same radio. */
@@ -59,6 +60,8 @@ protected:
 	QString _name;
   /** The interface to the radio. */
   OpenGD77Interface *_dev;
+  /** Holds the flags to control assembly and upload of code-plugs. */
+  Codeplug::Flags _codeplugFlags;
   /** The generic configuration. */
 	Config *_config;
   /** The actual binary codeplug representation. */
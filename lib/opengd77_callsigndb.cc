@@ -42,11 +42,11 @@ OpenGD77CallsignDB::userdb_entry_t::setName(const QString &name) {
 }
 
 void
-OpenGD77CallsignDB::userdb_entry_t::fromEntry(const UserDatabase::User &user) {
-  setNumber(user.id);
-  QString tmp = user.call;
-  if (!user.name.isEmpty())
-    tmp = tmp + " " + user.name;
+OpenGD77CallsignDB::userdb_entry_t::fromEntry(const UserDatabase::UserView &user) {
+  setNumber(user.id());
+  QString tmp = user.call(), name = user.name();
+  if (!name.isEmpty())
+    tmp = tmp + " " + name;
   setName(tmp);
 }
 
@@ -99,12 +99,10 @@ OpenGD77CallsignDB::encode(UserDatabase *calldb, const Selection &selection, con
   if (0 == n)
     return true;
 
-  // Select first n entries and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  for (unsigned i=0; i<n; i++)
-    users.append(calldb->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  // Select up to n users matching the filters and closest to the prefixes, sorted in ascending
+  // order of their IDs
+  QVector<UserDatabase::UserView> users = calldb->select(selection, n);
+  n = users.size();
 
   // Allocate segment for user db if requested
   unsigned size = align_size(sizeof(userdb_t)+n*sizeof(userdb_entry_t), BLOCK_SIZE);
@@ -46,7 +46,7 @@ public:
     void setName(const QString &name);
 
     /** Encodes the given user. */
-    void fromEntry(const UserDatabase::User &user);
+    void fromEntry(const UserDatabase::UserView &user);
   };
 
   /** Represents the binary call-sign database header.
@@ -0,0 +1,143 @@
+#include "opengd77_emulator.hh"
+#include "opengd77_interface.hh"
+#include "logger.hh"
+#include <QtEndian>
+
+#define SECTOR_SIZE 4096
+#define COMMAND_SIZE 23
+
+/* ********************************************************************************************* *
+ * Implementation of OpenGD77Emulator
+ * ********************************************************************************************* */
+OpenGD77Emulator::OpenGD77Emulator(QObject *parent)
+  : SerialEmulator(OpenGD77Interface::interfaceInfo(), parent),
+    _maxChunkSize(OpenGD77Interface::MAX_CHUNK_SIZE), _sector(-1), _sectorBuffer()
+{
+  start();
+}
+
+OpenGD77Emulator::~OpenGD77Emulator() {
+  stop();
+}
+
+unsigned
+OpenGD77Emulator::maxChunkSize() const {
+  return _maxChunkSize;
+}
+
+void
+OpenGD77Emulator::setMaxChunkSize(unsigned size) {
+  _maxChunkSize = size;
+}
+
+int
+OpenGD77Emulator::handle(const QByteArray &data) {
+  switch (data.at(0)) {
+  case 'C':
+    // Display and control commands are simply acknowledged
+    if (COMMAND_SIZE > data.size())
+      return 0;
+    respond(QByteArray(1, '-'));
+    return COMMAND_SIZE;
+
+  case 'R': {
+    // Read request: 'R', memory, address (big endian), length (big endian)
+    if (8 > data.size())
+      return 0;
+    uint8_t memory = data.at(1);
+    uint32_t addr = qFromBigEndian<quint32>((const uchar *)data.constData()+2);
+    uint16_t len = qFromBigEndian<quint16>((const uchar *)data.constData()+6);
+    uint32_t bank = OpenGD77Interface::EEPROM;
+    if (1 == memory)
+      bank = OpenGD77Interface::FLASH;
+    if (((1 != memory) && (2 != memory)) || (len > _maxChunkSize)) {
+      // Reject with an empty error response
+      respond(QByteArray("-\0\0", 3));
+      return 8;
+    }
+    QByteArray resp(3+len, 0);
+    resp[0] = 'R';
+    qToBigEndian<quint16>(len, (uchar *)resp.data()+1);
+    read(bank, addr, (uint8_t *)resp.data()+3, len);
+    respond(resp);
+    return 8;
+  }
+
+  case 'W':
+    return handleWrite(data);
+
+  default:
+    break;
+  }
+
+  return -1;
+}
+
+int
+OpenGD77Emulator::handleWrite(const QByteArray &data) {
+  if (2 > data.size())
+    return 0;
+
+  char command = data.at(1);
+  QByteArray ok(data.left(2)), error(1, '-');
+  error.append(command);
+
+  switch (command) {
+  case 1: {
+    // Select flash sector and load it into the buffer
+    if (5 > data.size())
+      return 0;
+    const uint8_t *s = (const uint8_t *)data.constData()+2;
+    _sector = (uint32_t(s[0])<<16) | (uint32_t(s[1])<<8) | s[2];
+    _sectorBuffer.resize(SECTOR_SIZE);
+    read(OpenGD77Interface::FLASH, _sector*SECTOR_SIZE, (uint8_t *)_sectorBuffer.data(), SECTOR_SIZE);
+    respond(ok);
+    return 5;
+  }
+
+  case 2:
+  case 4: {
+    // Write to sector buffer or EEPROM: address (big endian), length (big endian), data
+    if (8 > data.size())
+      return 0;
+    uint32_t addr = qFromBigEndian<quint32>((const uchar *)data.constData()+2);
+    uint16_t len = qFromBigEndian<quint16>((const uchar *)data.constData()+6);
+    if ((8+len) > data.size())
+      return 0;
+    const uint8_t *payload = (const uint8_t *)data.constData()+8;
+    if (len > _maxChunkSize) {
+      respond(error);
+    } else if (4 == command) {
+      write(OpenGD77Interface::EEPROM, addr, payload, len);
+      respond(ok);
+    } else if ((0 > _sector) || (int32_t(addr/SECTOR_SIZE) != _sector)
+               || (SECTOR_SIZE < ((addr%SECTOR_SIZE)+len))) {
+      logDebug() << "Emulated OpenGD77: Write to 0x" << QString::number(addr, 16)
+                 << " outside of selected sector " << _sector << ".";
+      respond(error);
+    } else {
+      memcpy(_sectorBuffer.data()+(addr%SECTOR_SIZE), payload, len);
+      respond(ok);
+    }
+    return 8+len;
+  }
+
+  case 3:
+    // Write sector buffer to flash
+    if (0 > _sector) {
+      respond(error);
+      return 2;
+    }
+    write(OpenGD77Interface::FLASH, _sector*SECTOR_SIZE,
+          (const uint8_t *)_sectorBuffer.constData(), SECTOR_SIZE);
+    _sector = -1;
+    respond(ok);
+    return 2;
+
+  default:
+    break;
+  }
+
+  respond(error);
+  return 2;
+}
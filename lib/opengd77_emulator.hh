@@ -0,0 +1,42 @@
+#ifndef OPENGD77EMULATOR_HH
+#define OPENGD77EMULATOR_HH
+
+#include "radioemulator.hh"
+
+/** Emulates the serial interface of radios running the OpenGD77 firmware.
+ *
+ * Implements the display commands ('C'), reading the EEPROM and flash ('R') as well as writing
+ * the EEPROM and the sector-wise writing of the flash ('W'). The EEPROM is held in bank
+ * @c OpenGD77Interface::EEPROM, the flash in bank @c OpenGD77Interface::FLASH. Requests larger
+ * than @c maxChunkSize are rejected, such that the adaptive chunking of the interface can be
+ * exercised.
+ *
+ * @ingroup emulator */
+class OpenGD77Emulator: public SerialEmulator
+{
+public:
+  /** Constructor. */
+  explicit OpenGD77Emulator(QObject *parent=nullptr);
+  /** Destructor. */
+  virtual ~OpenGD77Emulator();
+
+  /** Returns the largest request accepted. */
+  unsigned maxChunkSize() const;
+  /** Sets the largest request accepted. */
+  void setMaxChunkSize(unsigned size);
+
+protected:
+  int handle(const QByteArray &data);
+  /** Handles a write request. */
+  int handleWrite(const QByteArray &data);
+
+protected:
+  /** The largest request accepted. */
+  unsigned _maxChunkSize;
+  /** The currently selected flash sector or -1. */
+  int32_t _sector;
+  /** Buffer of the currently selected flash sector. */
+  QByteArray _sectorBuffer;
+};
+
+#endif // OPENGD77EMULATOR_HH
@@ -8,6 +8,8 @@
 
 #define BLOCK_SIZE  32
 #define SECTOR_SIZE 4096
+#define EEPROM_PAGE_SIZE 128
+#define DRAIN_TIMEOUT 100
 #define ALIGN_BLOCK_SIZE(n) ((0==((n)%BLOCK_SIZE)) ? (n) : (n)+(BLOCK_SIZE-((n)%BLOCK_SIZE)))
 
 /* ********************************************************************************************* *
@@ -37,8 +39,8 @@ OpenGD77Interface::ReadRequest::initReadFlash(uint32_t addr, uint16_t length) {
  * ********************************************************************************************* */
 bool
 OpenGD77Interface::WriteRequest::initWriteEEPROM(uint32_t addr, const uint8_t *data, uint16_t size) {
-  if (size > 32)
-    size = 32;
+  if (size > MAX_CHUNK_SIZE)
+    size = MAX_CHUNK_SIZE;
   this->type = 'W';
   this->command = WRITE_EEPROM;
   this->payload.address = qToBigEndian(addr);
@@ -60,8 +62,8 @@ OpenGD77Interface::WriteRequest::initSetFlashSector(uint32_t addr) {
 
 bool
 OpenGD77Interface::WriteRequest::initWriteFlash(uint32_t addr, const uint8_t *data, uint16_t size) {
-  if (size > 32)
-    size = 32;
+  if (size > MAX_CHUNK_SIZE)
+    size = MAX_CHUNK_SIZE;
   this->type = 'W';
   this->command = WRITE_SECTOR_BUFFER;
   this->payload.address = qToBigEndian(addr);
@@ -160,7 +162,9 @@ OpenGD77Interface::CommandRequest::initCommand(Option option) {
  * Implementation of OpenGD77Interface
  * ********************************************************************************************* */
 OpenGD77Interface::OpenGD77Interface(const USBDeviceDescriptor &descr, const ErrorStack &err, QObject *parent)
-  : USBSerial(descr, err, parent), _sector(-1)
+  : USBSerial(descr, err, parent), _sector(-1),
+    _readChunkSize(MIN_CHUNK_SIZE), _readChunkLimit(MAX_CHUNK_SIZE),
+    _writeChunkSize(MIN_CHUNK_SIZE), _writeChunkLimit(MAX_CHUNK_SIZE)
 {
   // pass...
 }
@@ -197,6 +201,7 @@ OpenGD77Interface::identifier(const ErrorStack &err) {
 bool
 OpenGD77Interface::write_start(uint32_t bank, uint32_t addr, const ErrorStack &err)
 {
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::EnterProgramMode);
   logDebug() << "Send enter prog mode ...";
   if (! sendShowCPSScreen(err))
     return false;
@@ -239,40 +244,50 @@ OpenGD77Interface::write_start(uint32_t bank, uint32_t addr, const ErrorStack &e
 bool
 OpenGD77Interface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err)
 {
-  if (EEPROM == bank) {
-    if ((0 <= _sector) && (! finishWriteFlash(err)))
-      return false;
-    for (int i=0; i<nbytes; i+=BLOCK_SIZE) {
-      if (! writeEEPROM(addr+i, data+i, BLOCK_SIZE, err)) {
-        _sector = -1;
-        return false;
-      }
-    }
-    return true;
-  }
-
-start:
-  int32_t sector = addr/SECTOR_SIZE;
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Write, nbytes);
 
-  if (0 > _sector) {
-    if (! setFlashSector(addr))
+  if ((EEPROM == bank) && (0 <= _sector)) {
+    _sector = -1;
+    if (! finishWriteFlash(err))
       return false;
-    _sector = sector;
   }
 
-  if (sector == _sector) {
-    for (int i=0; i<nbytes; i+=BLOCK_SIZE) {
-      if (! writeFlash(addr+i, data+i, BLOCK_SIZE)) {
+  for (int i=0; i<nbytes;) {
+    // Chunks must not cross EEPROM pages or Flash sectors
+    uint32_t boundary = (EEPROM == bank) ? EEPROM_PAGE_SIZE : SECTOR_SIZE;
+    uint16_t n = std::min(uint32_t(std::min(int(_writeChunkSize), nbytes-i)),
+                          boundary - ((addr+i) % boundary));
+
+    if (FLASH == bank) {
+      int32_t sector = (addr+i)/SECTOR_SIZE;
+      if ((0 <= _sector) && (sector != _sector)) {
         _sector = -1;
-        return false;
+        if (! finishWriteFlash(err))
+          return false;
+      }
+      if (0 > _sector) {
+        if (! setFlashSector(addr+i, err))
+          return false;
+        _sector = sector;
       }
     }
-  } else {
-    _sector = -1;
-    if (! finishWriteFlash()) {
+
+    // Larger chunks may be rejected by the firmware, hence errors are only reported for the
+    // smallest chunk size.
+    bool small = (MIN_CHUNK_SIZE >= n);
+    bool ok = (EEPROM == bank) ? writeEEPROM(addr+i, data+i, n, small ? err : ErrorStack())
+                               : writeFlash(addr+i, data+i, n, small ? err : ErrorStack());
+    if (ok) {
+      if (n == _writeChunkSize)
+        grow(_writeChunkSize, _writeChunkLimit);
+      i += n;
+    } else if (small) {
+      _sector = -1;
       return false;
+    } else {
+      _metrics.addRetry(TransferMetrics::Write);
+      backoff(_writeChunkSize, _writeChunkLimit);
     }
-    goto start;
   }
 
   return true;
@@ -280,6 +295,7 @@ start:
 
 bool
 OpenGD77Interface::write_finish(const ErrorStack &err) {
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::LeaveProgramMode);
   _sector = -1;
   if (0 > _sector)
     return true;
@@ -294,6 +310,7 @@ OpenGD77Interface::write_finish(const ErrorStack &err) {
 bool
 OpenGD77Interface::read_start(uint32_t bank, uint32_t addr, const ErrorStack &err) {
   Q_UNUSED(bank); Q_UNUSED(addr)
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::EnterProgramMode);
 
   if (! sendShowCPSScreen(err))
     return false;
@@ -317,24 +334,35 @@ OpenGD77Interface::read_start(uint32_t bank, uint32_t addr, const ErrorStack &er
 
 bool
 OpenGD77Interface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err) {
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Read, nbytes);
+
   if (! isOpen()) {
     errMsg(err) << "Cannot read block: Device not open!";
     return false;
   }
 
-  for (int i=0; i<nbytes; i+=BLOCK_SIZE) {
-    bool ok;
-    if (EEPROM == bank)
-      ok = readEEPROM(addr+i, data+i, BLOCK_SIZE, err);
-    else if (FLASH == bank)
-      ok = readFlash(addr+i, data+i, BLOCK_SIZE, err);
-    else {
-      errMsg(err) << "Cannot read from bank " << bank << ": Unknown memory bank.";
-      return false;
-    }
+  if ((EEPROM != bank) && (FLASH != bank)) {
+    errMsg(err) << "Cannot read from bank " << bank << ": Unknown memory bank.";
+    return false;
+  }
 
-    if (! ok)
+  for (int i=0; i<nbytes;) {
+    uint16_t n = std::min(int(_readChunkSize), nbytes-i);
+    // Larger chunks may be rejected by the firmware, hence errors are only reported for the
+    // smallest chunk size.
+    bool small = (MIN_CHUNK_SIZE >= n);
+    bool ok = (EEPROM == bank) ? readEEPROM(addr+i, data+i, n, small ? err : ErrorStack())
+                               : readFlash(addr+i, data+i, n, small ? err : ErrorStack());
+    if (ok) {
+      if (n == _readChunkSize)
+        grow(_readChunkSize, _readChunkLimit);
+      i += n;
+    } else if (small) {
       return false;
+    } else {
+      _metrics.addRetry(TransferMetrics::Read);
+      backoff(_readChunkSize, _readChunkLimit);
+    }
   }
 
   return true;
@@ -342,6 +370,7 @@ OpenGD77Interface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
 
 bool
 OpenGD77Interface::read_finish(const ErrorStack &err) {
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::LeaveProgramMode);
   if (! sendCloseScreen(err))
     return false;
 
@@ -356,242 +385,158 @@ OpenGD77Interface::reboot(const ErrorStack &err) {
 
 bool
 OpenGD77Interface::readEEPROM(uint32_t addr, uint8_t *data, uint16_t len, const ErrorStack &err) {
-  Q_UNUSED(len)
-
   if (! isOpen()) {
     errMsg(err) << "Cannot read block: Device not open!";
     return false;
   }
 
-  ReadRequest req; req.initReadEEPROM(addr, BLOCK_SIZE);
-  if (sizeof(ReadRequest) != QSerialPort::write((const char *)&req, sizeof(ReadRequest))) {
-    errMsg(err) << "Cannot write to serial port.";
-    return false;
-  }
-
-  if (! waitForReadyRead(1000)) {
-    errMsg(err) << "Cannot read from serial port: Timeout!";
-    return false;
-  }
-
-  ReadResponse resp;
-  int retlen = QSerialPort::read((char *)&resp, sizeof(ReadResponse));
-
-  if (0 > retlen) {
-    errMsg(err) << "Cannot read from serial port";
-    return false;
-  } else if (0 == retlen) {
-    errMsg(err) << "Cannot read from serial port: Device returned empty message.";
-    return false;
-  }
-
-  if ('R' != resp.type) {
-    errMsg(err) << "Cannot read from device: Device returned error '" << resp.type << "'.";
-    return false;
-  }
-
-  if (qFromBigEndian(req.length) != qFromBigEndian(resp.length)) {
-    errMsg(err) << "Cannot read from device: Device returned invalid length " <<
-                qFromBigEndian(resp.length) << ".";
-    return false;
-  }
-
-  memcpy(data, resp.data, qFromBigEndian(resp.length));
-  return true;
+  ReadRequest req; req.initReadEEPROM(addr, len);
+  return sendRead(req, data, err);
 }
 
 
 bool
 OpenGD77Interface::writeEEPROM(uint32_t addr, const uint8_t *data, uint16_t len, const ErrorStack &err) {
   WriteRequest req; req.initWriteEEPROM(addr, data, len);
-  WriteResponse resp;
-
-  if ((8+len) != QSerialPort::write((const char *)&req, 8+len)) {
-    errMsg(err) << "Cannot write to serial port.";
-    return false;
-  }
-
-  if (! waitForReadyRead(1000)) {
-    errMsg(err) << "Cannot read from serial port: Timeout!";
-    return false;
-  }
-
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
-    errMsg(err) << "Cannot read from serial port.";
-    return false;
-  } else if (0 == retlen) {
-    errMsg(err) << "Cannot write EEPROM: Device returned empty message.";
-    return false;
-  }
-
-  if ((req.type != resp.type) || (req.command != resp.command)) {
-    errMsg(err) << "Cannot write EEPROM at " << QString::number(addr, 16)
-             << ": Device returned error " << resp.type << ".";
+  if (! sendWrite(req, 8+len, err)) {
+    errMsg(err) << "Cannot write EEPROM at " << QString::number(addr, 16) << ".";
     return false;
   }
-
   return true;
 }
 
 
 bool
 OpenGD77Interface::readFlash(uint32_t addr, uint8_t *data, uint16_t len, const ErrorStack &err) {
-  Q_UNUSED(len)
-
   if (! isOpen()) {
     errMsg(err) << "Cannot read block: Device not open!";
     return false;
   }
 
-  ReadRequest req;
-  req.initReadFlash(addr, BLOCK_SIZE);
-  if (sizeof(ReadRequest) != QSerialPort::write((const char *)&req, sizeof(ReadRequest))) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot write to serial port.";
-    return false;
-  }
-
-  if (! waitForReadyRead(1000)) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot read from serial port: Timeout!";
-    return false;
-  }
-
-  ReadResponse resp;
-  int retlen = QSerialPort::read((char *)&resp, sizeof(ReadResponse));
-
-  if (0 > retlen) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot read from serial port.";
-    return false;
-  } else if (0 == retlen) {
-    errMsg(err) << "Cannot read from serial port: Device returned empty message.";
-    return false;
-  }
-
-  if ('R' != resp.type) {
-    errMsg(err) << "Cannot read from device: Device returned error " << resp.type << ".";
-    return false;
-  }
-
-  if (qFromBigEndian(req.length) != qFromBigEndian(resp.length)) {
-    errMsg(err) << "Cannot read from device: Device returned invalid length "
-                << qFromBigEndian(resp.length) << ".";
-    return false;
-  }
-
-  memcpy(data, resp.data, qFromBigEndian(resp.length));
-  return true;
+  ReadRequest req; req.initReadFlash(addr, len);
+  return sendRead(req, data, err);
 }
 
 bool
 OpenGD77Interface::setFlashSector(uint32_t addr, const ErrorStack &err) {
   WriteRequest req; req.initSetFlashSector(addr);
-  WriteResponse resp;
-
-  if (5 != QSerialPort::write((const char *)&req, 5)) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot write to serial port.";
+  if (! sendWrite(req, 5, err)) {
+    errMsg(err) << "Cannot set flash sector.";
     return false;
   }
+  return true;
+}
 
-  if (! waitForReadyRead(1000)) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot read from serial port: Timeout!";
-    return false;
-  }
-
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot read from serial port.";
-    return false;
-  } else if (0 == retlen) {
-    errMsg(err) << "Cannot set flash sector: Device returned empty message.";
+bool
+OpenGD77Interface::writeFlash(uint32_t addr, const uint8_t *data, uint16_t len, const ErrorStack &err) {
+  WriteRequest req; req.initWriteFlash(addr, data, len);
+  if (! sendWrite(req, 8+len, err)) {
+    errMsg(err) << "Cannot write to buffer at " << QString::number(addr,16) << ".";
     return false;
   }
+  return true;
+}
 
-  if ((req.type != resp.type) || (req.command != resp.command)) {
-    errMsg(err) << "Cannot set flash sector: Device returned error " << resp.type << ".";
+bool
+OpenGD77Interface::finishWriteFlash(const ErrorStack &err) {
+  WriteRequest req; req.initFinishWriteFlash();
+  if (! sendWrite(req, 2, err)) {
+    errMsg(err) << "Cannot write to flash.";
     return false;
   }
-
   return true;
 }
 
 bool
-OpenGD77Interface::writeFlash(uint32_t addr, const uint8_t *data, uint16_t len, const ErrorStack &err) {
-  WriteRequest req; req.initWriteFlash(addr, data, len);
-  WriteResponse resp;
-
-  if ((8+len) != QSerialPort::write((const char *)&req, 8+len)) {
+OpenGD77Interface::sendRead(const ReadRequest &req, uint8_t *data, const ErrorStack &err) {
+  if (sizeof(ReadRequest) != QSerialPort::write((const char *)&req, sizeof(ReadRequest))) {
     errMsg(err) << QSerialPort::errorString();
     errMsg(err) << "Cannot write to serial port.";
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    errMsg(err) << QSerialPort::errorString();
+  // Receive header first, then exactly the announced payload
+  ReadResponse resp;
+  int retlen = receive((char *)&resp, 3);
+  if (0 == retlen) {
+    _metrics.addTimeout(TransferMetrics::Read);
     errMsg(err) << "Cannot read from serial port: Timeout!";
     return false;
+  } else if (('R' != resp.type) || (3 != retlen)) {
+    errMsg(err) << "Cannot read from device: Device returned error '" << resp.type << "'.";
+    return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
-    errMsg(err) << QSerialPort::errorString();
-    errMsg(err) << "Cannot read from serial port.";
-    return false;
-  } else if (0 == retlen) {
-    errMsg(err) << "Cannot write to buffer: Device returned empty message.";
+  uint16_t len = qFromBigEndian(resp.length);
+  if (qFromBigEndian(req.length) != len) {
+    errMsg(err) << "Cannot read from device: Device returned invalid length " << len << ".";
     return false;
   }
 
-  if ((req.type != resp.type) || (req.command != resp.command)) {
-    errMsg(err) << "Cannot write to buffer at " << QString::number(addr,16)
-             << ": Device returned error " << resp.type << ".";
+  if (len != receive((char *)resp.data, len)) {
+    _metrics.addTimeout(TransferMetrics::Read);
+    errMsg(err) << "Cannot read from serial port: Timeout!";
     return false;
   }
 
+  memcpy(data, resp.data, len);
   return true;
 }
 
 bool
-OpenGD77Interface::finishWriteFlash(const ErrorStack &err) {
-  //logDebug() << "Send finish write flash command ...";
-  WriteRequest req;
-  req.initFinishWriteFlash();
-  WriteResponse resp;
-
-  if ((2) != QSerialPort::write((const char *)&req, 2)) {
+OpenGD77Interface::sendWrite(const WriteRequest &req, int len, const ErrorStack &err) {
+  if (len != QSerialPort::write((const char *)&req, len)) {
+    errMsg(err) << QSerialPort::errorString();
     errMsg(err) << "Cannot write to serial port.";
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
+  WriteResponse resp;
+  int retlen = receive((char *)&resp, sizeof(WriteResponse));
+  if (0 == retlen) {
+    _metrics.addTimeout(TransferMetrics::Write);
     errMsg(err) << "Cannot read from serial port: Timeout!";
     return false;
+  } else if ((int(sizeof(WriteResponse)) != retlen) || (req.type != resp.type) || (req.command != resp.command)) {
+    errMsg(err) << "Device returned error " << resp.type << ".";
+    return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
+  return true;
+}
 
-  if (0 > retlen) {
-    errMsg(err) << "Cannot read from serial port.";
-    return false;
-  } else if (0 == retlen) {
-    errMsg(err) << "Cannot write to flash: Device returned empty message.";
-    return false;
+int
+OpenGD77Interface::receive(char *data, int len, int timeout) {
+  int count = 0;
+  while (count < len) {
+    if ((0 == bytesAvailable()) && (! waitForReadyRead(timeout)))
+      break;
+    int r = QSerialPort::read(data+count, len-count);
+    if (0 > r)
+      break;
+    count += r;
   }
+  return count;
+}
 
-  if ((req.type != resp.type) || (req.command != resp.command)) {
-    errMsg(err) << "Cannot write to flash: Device returned error " << resp.type << ".";
-    return false;
-  }
+void
+OpenGD77Interface::grow(uint16_t &chunkSize, uint16_t limit) {
+  if (chunkSize >= limit)
+    return;
+  chunkSize = std::min(limit, uint16_t(2*chunkSize));
+  logDebug() << "Request accepted, increase chunk size to " << chunkSize << "b.";
+}
 
-  return true;
+void
+OpenGD77Interface::backoff(uint16_t &chunkSize, uint16_t &limit) {
+  // Drop any pending (partial) response
+  while (waitForReadyRead(DRAIN_TIMEOUT))
+    QSerialPort::readAll();
+  QSerialPort::clear(QSerialPort::Input);
+  // Every rejected request costs a timeout, hence never try the rejected size again
+  chunkSize = std::max(uint16_t(MIN_CHUNK_SIZE), uint16_t(chunkSize/2));
+  limit = chunkSize;
+  logDebug() << "Request rejected, reduce chunk size to " << chunkSize << "b.";
 }
 
 bool
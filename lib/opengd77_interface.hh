@@ -21,6 +21,12 @@ public:
   static const uint32_t EEPROM = 0;
   /** The Flash memory bank. */
   static const uint32_t FLASH  = 1;
+  /** The chunk size, the stock firmware is known to accept. Transfers start with this size. */
+  static const uint16_t MIN_CHUNK_SIZE = 32;
+  /** The largest chunk size to try for a single read or write request. This is not a limit known
+   * for any firmware version, just the upper bound of the request buffers. The chunk size grows
+   * from @c MIN_CHUNK_SIZE up to this size as long as the device accepts the requests. */
+  static const uint16_t MAX_CHUNK_SIZE = 1024;
 
 public:
   /** Constructs a new interface to a specific OpenGD77 device.  */
@@ -70,7 +76,7 @@ protected:
     uint8_t command;
     /// Memory address to read from in big endian.
     uint32_t address;
-    /// Amount of data to read, max 32 bytes in big endian.
+    /// Amount of data to read, max @c MAX_CHUNK_SIZE bytes in big endian.
     uint16_t length;
 
     /** Constructs a FLASH read message. */
@@ -86,7 +92,7 @@ protected:
     /// Length of paylod.
     uint16_t length;
     /// Payload.
-    uint8_t data[32];
+    uint8_t data[MAX_CHUNK_SIZE];
   } ReadResponse;
 
   /** Represents a write message. */
@@ -115,7 +121,7 @@ protected:
         /** Payload length. */
         uint16_t length;
         /** Payload data. */
-        uint8_t data[32];
+        uint8_t data[MAX_CHUNK_SIZE];
       } payload;
     };
 
@@ -210,6 +216,19 @@ protected:
    * the changes are lost. */
   bool finishWriteFlash(const ErrorStack &err=ErrorStack());
 
+  /** Sends the given read request and receives the response into @c data. */
+  bool sendRead(const ReadRequest &req, uint8_t *data, const ErrorStack &err=ErrorStack());
+  /** Sends the given write request of the given length and waits for the response. */
+  bool sendWrite(const WriteRequest &req, int len, const ErrorStack &err=ErrorStack());
+  /** Receives exactly @c len bytes. Returns the number of bytes received, which is less than
+   * @c len on timeout. */
+  int receive(char *data, int len, int timeout=1000);
+  /** Doubles the given chunk size after a successful request, up to the given limit. */
+  void grow(uint16_t &chunkSize, uint16_t limit);
+  /** Drops any pending response, halves the given chunk size and limits any further growth to
+   * the reduced size. */
+  void backoff(uint16_t &chunkSize, uint16_t &limit);
+
   /** Send a "show CPS screen" message. */
   bool sendShowCPSScreen(const ErrorStack &err=ErrorStack());
   /** Send a "clear screen" message. */
@@ -226,6 +245,15 @@ protected:
 protected:
   /** The current Flash sector, set to -1 if none is currently selected. */
   int32_t _sector;
+  /** The current chunk size for read requests. Starts at @c MIN_CHUNK_SIZE, grows with every
+   * accepted request and gets reduced whenever the device rejects a request. */
+  uint16_t _readChunkSize;
+  /** The largest chunk size to try for read requests. */
+  uint16_t _readChunkLimit;
+  /** The current chunk size for write requests. */
+  uint16_t _writeChunkSize;
+  /** The largest chunk size to try for write requests. */
+  uint16_t _writeChunkLimit;
 };
 
 #endif // OPENGD77INTERFACE_HH
@@ -0,0 +1,107 @@
+#include "pagedmemory.hh"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/** Size of each chunk of the arena. */
+#define CHUNK_SIZE 0x10000
+/** Allocations larger than this get a chunk on their own. */
+#define MAX_SHARED_ALLOC (CHUNK_SIZE/4)
+/** Alignment of allocations. */
+#define ALIGNMENT 8
+
+unsigned char PagedMemory::_shared = 0;
+
+PagedMemory::PagedMemory()
+  : _chunks(), _next(nullptr), _free(0), _allocated(0)
+{
+  memset(_directory, 0, sizeof(_directory));
+}
+
+PagedMemory::~PagedMemory() {
+  clear();
+}
+
+void
+PagedMemory::clear() {
+  for (unsigned i=0; i<(1u<<DirBits); i++) {
+    delete[] _directory[i];
+    _directory[i] = nullptr;
+  }
+  for (size_t i=0; i<_chunks.size(); i++)
+    free(_chunks[i]);
+  _chunks.clear();
+  _next = nullptr;
+  _free = 0;
+  _allocated = 0;
+}
+
+void
+PagedMemory::reserve(size_t size) {
+  size = (size + ALIGNMENT-1) & ~size_t(ALIGNMENT-1);
+  if (size <= _free)
+    return;
+  size_t n = (size > CHUNK_SIZE) ? size : size_t(CHUNK_SIZE);
+  unsigned char *chunk = (unsigned char *)calloc(n, 1);
+  if (nullptr == chunk)
+    throw std::bad_alloc();
+  _chunks.push_back(chunk);
+  _next = chunk;
+  _free = n;
+}
+
+unsigned char *
+PagedMemory::allocate(uint32_t addr, uint32_t size) {
+  size_t n = (size_t(size) + ALIGNMENT-1) & ~size_t(ALIGNMENT-1);
+  unsigned char *ptr = nullptr;
+  if ((n > _free) && (n > MAX_SHARED_ALLOC)) {
+    // Large allocations get a chunk on their own, keeping the current one
+    if (nullptr == (ptr = (unsigned char *)calloc(n ? n : 1, 1)))
+      throw std::bad_alloc();
+    _chunks.push_back(ptr);
+  } else {
+    reserve(n);
+    ptr = _next;
+    _next += n; _free -= n;
+  }
+  _allocated += size;
+  map(addr, size, ptr);
+  return ptr;
+}
+
+void
+PagedMemory::map(uint32_t addr, uint32_t size, unsigned char *ptr) {
+  // Map all pages touched by the memory. Only pages completely covered get mapped to the memory,
+  // all others are marked as shared.
+  uint64_t start = addr, end = uint64_t(addr) + size;
+  for (uint64_t page = start & ~uint64_t((1u<<PageBits)-1); page < end; page += (1u<<PageBits)) {
+    unsigned char *&e = entry(uint32_t(page));
+    bool covered = (page >= start) && ((page + (1u<<PageBits)) <= end);
+    if (covered && (nullptr == e))
+      e = ptr + (page - start);
+    else
+      e = &_shared;
+  }
+}
+
+void
+PagedMemory::unmap(uint32_t addr, uint32_t size) {
+  uint64_t end = uint64_t(addr) + size;
+  for (uint64_t page = addr & ~uint64_t((1u<<PageBits)-1); page < end; page += (1u<<PageBits))
+    entry(uint32_t(page)) = &_shared;
+}
+
+size_t
+PagedMemory::allocated() const {
+  return _allocated;
+}
+
+unsigned char *&
+PagedMemory::entry(uint32_t addr) {
+  unsigned char **&table = _directory[addr >> (PageBits+TableBits)];
+  if (nullptr == table) {
+    table = new unsigned char *[1u<<TableBits];
+    memset(table, 0, sizeof(unsigned char *)*(1u<<TableBits));
+  }
+  return table[(addr >> PageBits) & ((1u<<TableBits)-1)];
+}
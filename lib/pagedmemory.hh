@@ -0,0 +1,89 @@
+#ifndef PAGEDMEMORY_HH
+#define PAGEDMEMORY_HH
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <vector>
+
+/** Sparse paged memory backing the elements of a @c DFUFile::Image.
+ *
+ * The memory of all elements is allocated from a small number of large chunks (the arena) instead
+ * of a separate heap allocation per element. Alternatively, external memory (e.g., a memory mapped
+ * file) can be mapped into the address space. Each allocation is contiguous and never moves, hence
+ * pointers into an allocation stay valid for the lifetime of the memory.
+ *
+ * A two-level page table maps each page (4kb) of the 32-bit address space to the allocation
+ * covering it. This allows for a translation of an address into a pointer in constant time. If a
+ * page is not completely covered by a single allocation (e.g., the page is shared by several small
+ * elements), @c translate returns @c nullptr and the caller needs to resolve the address by other
+ * means (e.g., an @c AddressMap).
+ *
+ * @ingroup util */
+class PagedMemory
+{
+public:
+  /** Number of address bits of the page offset. */
+  static const unsigned PageBits  = 12;
+  /** Number of address bits indexing a page table. */
+  static const unsigned TableBits = 10;
+  /** Number of address bits indexing the page directory. */
+  static const unsigned DirBits   = 32-PageBits-TableBits;
+
+public:
+  /** Empty constructor. */
+  PagedMemory();
+  /** Destructor, frees all memory. */
+  ~PagedMemory();
+
+  /** Frees all memory and clears the page table. */
+  void clear();
+  /** Ensures that the next allocations of @c size bytes in total are taken from a single chunk. */
+  void reserve(size_t size);
+  /** Allocates @c size bytes of zero-initialized memory for the given address and maps all pages
+   * completely covered by it. */
+  unsigned char *allocate(uint32_t addr, uint32_t size);
+  /** Maps all pages completely covered by the given external memory of @c size bytes to the given
+   * address. The memory is not owned and must outlive the page table. */
+  void map(uint32_t addr, uint32_t size, unsigned char *ptr);
+  /** Unmaps all pages touched by the given address range. The memory itself is not freed. */
+  void unmap(uint32_t addr, uint32_t size);
+  /** Returns the number of bytes allocated. */
+  size_t allocated() const;
+
+  /** Translates the given address into a pointer. Returns @c nullptr if the page containing the
+   * address is not mapped to a single allocation. */
+  inline unsigned char *translate(uint32_t addr) const {
+    unsigned char **table = _directory[addr >> (PageBits+TableBits)];
+    if (nullptr == table)
+      return nullptr;
+    unsigned char *base = table[(addr >> PageBits) & ((1u<<TableBits)-1)];
+    if ((nullptr == base) || (&_shared == base))
+      return nullptr;
+    return base + (addr & ((1u<<PageBits)-1));
+  }
+
+private:
+  /** Copying is not supported, pointers cannot be shared between memories. */
+  PagedMemory(const PagedMemory &other);
+  /** Copying is not supported, pointers cannot be shared between memories. */
+  PagedMemory &operator=(const PagedMemory &other);
+
+  /** Returns the page table entry for the given address, allocates the table if needed. */
+  unsigned char *&entry(uint32_t addr);
+
+protected:
+  /** The chunks of the arena. */
+  std::vector<unsigned char *> _chunks;
+  /** Next free byte in the current chunk. */
+  unsigned char *_next;
+  /** Number of free bytes in the current chunk. */
+  size_t _free;
+  /** Number of bytes allocated. */
+  size_t _allocated;
+  /** The page directory, each entry points to a page table or is @c nullptr. */
+  unsigned char **_directory[1u<<DirBits];
+  /** Marks pages that are touched by several allocations. */
+  static unsigned char _shared;
+};
+
+#endif // PAGEDMEMORY_HH
@@ -26,7 +26,7 @@
  * Implementation of Radio
  * ******************************************************************************************** */
 Radio::Radio(QObject *parent)
-  : QThread(parent), _task(StatusIdle)
+  : QThread(parent), _task(StatusIdle), _session(nullptr)
 {
   // pass...
 }
@@ -45,6 +45,11 @@ Radio::callsignDB() {
   return nullptr;
 }
 
+const TransferMetrics *
+Radio::metrics() const {
+  return nullptr;
+}
+
 
 Radio *
 Radio::detect(const USBDeviceDescriptor &descr, const RadioInfo &force, const ErrorStack &err) {
@@ -146,3 +151,8 @@ const ErrorStack &
 Radio::errorStack() const {
   return _errorStack;
 }
+
+void
+Radio::setCodeplugSession(CodeplugSession *session) {
+  _session = session;
+}
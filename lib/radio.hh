@@ -18,6 +18,7 @@
 class Config;
 class UserDatabase;
 class RadioLimits;
+class CodeplugSession;
 
 
 /** Base class for all Radio objects.
@@ -68,6 +69,10 @@ public:
   /** Returns the call-sign DB instance. */
   virtual CallsignDB *callsignDB();
 
+  /** Returns the transfer metrics of the interface to the radio or @c nullptr if there is no
+   * connection to the device. */
+  virtual const TransferMetrics *metrics() const;
+
   /** Returns the current status. */
   Status status() const;
 
@@ -75,6 +80,11 @@ public:
    * @c startUploadCallsignDB. It contains the error messages from the upload/download process. */
   const ErrorStack &errorStack() const;
 
+  /** Sets the codeplug session used to encode the configuration on upload. If set, radios
+   * supporting incremental encoding only update the modified objects of the codeplug, if it
+   * holds the previous encoding of the session. The session is not owned by the radio. */
+  void setCodeplugSession(CodeplugSession *session);
+
 public:
   /** Tries to detect the radio connected to the specified interface or constructs the specified
    * radio using the @c RadioInfo passed by @c force. */
@@ -121,6 +131,8 @@ protected:
   Status _task;
   /** The error stack. */
   ErrorStack _errorStack;
+  /** The codeplug session used for encoding or @c nullptr if there is none. */
+  CodeplugSession *_session;
 };
 
 #endif // RADIO_HH
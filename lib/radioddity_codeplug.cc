@@ -1,6 +1,7 @@
 #include "radioddity_codeplug.hh"
 #include "utils.hh"
 #include "logger.hh"
+#include "taskgroup.hh"
 #include "scanlist.hh"
 #include "radioid.hh"
 #include "contact.hh"
@@ -34,88 +35,89 @@ RadioddityCodeplug::ChannelElement::clear() {
   setRXFrequency(0);
   setTXFrequency(0);
   setMode(MODE_ANALOG);
-  setUInt8(0x0019, 0x00); setUInt8(0x001a, 0x00);
+  Layout::UInt8<0x0019>::set(_data, 0x00); Layout::UInt8<0x001a>::set(_data, 0x00);
   setTXTimeOut(0);
   setTXTimeOutRekeyDelay(0);
   setAdmitCriterion(ADMIT_ALWAYS);
-  setUInt8(0x001e, 0x50);
+  Layout::UInt8<0x001e>::set(_data, 0x50);
   setScanListIndex(0x00);
   setRXTone(Signaling::SIGNALING_NONE);
   setTXTone(Signaling::SIGNALING_NONE);
-  setUInt8(0x0024, 0x00);
+  Layout::UInt8<0x0024>::set(_data, 0x00);
   setTXSignalingIndex(0);
-  setUInt8(0x0026, 0x00);
+  Layout::UInt8<0x0026>::set(_data, 0x00);
   setRXSignalingIndex(0);
-  setUInt8(0x0028, 0x16);
+  Layout::UInt8<0x0028>::set(_data, 0x16);
   setPrivacyGroup(PRIVGR_NONE);
   setTXColorCode(0);
   setGroupListIndex(0);
   setRXColorCode(0);
   setEmergencySystemIndex(0);
   setContactIndex(0);
-  setUInt32_be(0x0030, 0); // clear all bitfields at once.
-  setUInt8(0x0034, 0); setUInt8(0x0035, 0); setUInt8(0x0036, 0);
+  Layout::UInt32_be<0x0030>::set(_data, 0); // clear all bitfields at once.
+  Layout::UInt8<0x0034>::set(_data, 0); Layout::UInt8<0x0035>::set(_data, 0);
+  Layout::UInt8<0x0036>::set(_data, 0);
 }
 
 QString
 RadioddityCodeplug::ChannelElement::name() const {
-  return readASCII(0x0000, 16, 0xff);
+  return Layout::ASCII<0x0000, 16, 0xff>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setName(const QString &n) {
-  writeASCII(0x0000, n, 16, 0xff);
+  Layout::ASCII<0x0000, 16, 0xff>::set(_data, n);
 }
 
 uint32_t
 RadioddityCodeplug::ChannelElement::rxFrequency() const {
-  return getBCD8_le(0x0010)*10;
+  return Layout::BCD8_le<0x0010>::get(_data)*10;
 }
 void
 RadioddityCodeplug::ChannelElement::setRXFrequency(uint32_t freq) {
-  setBCD8_le(0x0010, freq/10);
+  Layout::BCD8_le<0x0010>::set(_data, freq/10);
 }
 uint32_t
 RadioddityCodeplug::ChannelElement::txFrequency() const {
-  return getBCD8_le(0x0014)*10;
+  return Layout::BCD8_le<0x0014>::get(_data)*10;
 }
 void
 RadioddityCodeplug::ChannelElement::setTXFrequency(uint32_t freq) {
-  setBCD8_le(0x0014, freq/10);
+  Layout::BCD8_le<0x0014>::set(_data, freq/10);
 }
 
 RadioddityCodeplug::ChannelElement::Mode
 RadioddityCodeplug::ChannelElement::mode() const {
-  return (Mode)getUInt8(0x0018);
+  return (Mode)Layout::UInt8<0x0018>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setMode(Mode mode) {
-  setUInt8(0x0018, (unsigned)mode);
+  Layout::UInt8<0x0018>::set(_data, (unsigned)mode);
 }
 
 unsigned
 RadioddityCodeplug::ChannelElement::txTimeOut() const {
-  return getUInt8(0x001b)*15;
+  return Layout::UInt8<0x001b>::get(_data)*15;
 }
 void
 RadioddityCodeplug::ChannelElement::setTXTimeOut(unsigned tot) {
-  setUInt8(0x001b, tot/15);
+  Layout::UInt8<0x001b>::set(_data, tot/15);
 }
 unsigned
 RadioddityCodeplug::ChannelElement::txTimeOutRekeyDelay() const {
-  return getUInt8(0x001c);
+  return Layout::UInt8<0x001c>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setTXTimeOutRekeyDelay(unsigned delay) {
-  setUInt8(0x001c, delay);
+  Layout::UInt8<0x001c>::set(_data, delay);
 }
 
 RadioddityCodeplug::ChannelElement::Admit
 RadioddityCodeplug::ChannelElement::admitCriterion() const {
-  return (Admit) getUInt8(0x001d);
+  return (Admit) Layout::UInt8<0x001d>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setAdmitCriterion(Admit admit) {
-  setUInt8(0x001d, (unsigned)admit);
+  Layout::UInt8<0x001d>::set(_data, (unsigned)admit);
 }
 
 bool
@@ -124,63 +126,63 @@ RadioddityCodeplug::ChannelElement::hasScanList() const {
 }
 unsigned
 RadioddityCodeplug::ChannelElement::scanListIndex() const {
-  return getUInt8(0x001f);
+  return Layout::UInt8<0x001f>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setScanListIndex(unsigned index) {
-  setUInt8(0x001f, index);
+  Layout::UInt8<0x001f>::set(_data, index);
 }
 
 Signaling::Code
 RadioddityCodeplug::ChannelElement::rxTone() const {
-  return decode_ctcss_tone_table(getUInt16_le(0x0020));
+  return decode_ctcss_tone_table(Layout::UInt16_le<0x0020>::get(_data));
 }
 void
 RadioddityCodeplug::ChannelElement::setRXTone(Signaling::Code code) {
-  setUInt16_le(0x0020, encode_ctcss_tone_table(code));
+  Layout::UInt16_le<0x0020>::set(_data, encode_ctcss_tone_table(code));
 }
 Signaling::Code
 RadioddityCodeplug::ChannelElement::txTone() const {
-  return decode_ctcss_tone_table(getUInt16_le(0x0022));
+  return decode_ctcss_tone_table(Layout::UInt16_le<0x0022>::get(_data));
 }
 void
 RadioddityCodeplug::ChannelElement::setTXTone(Signaling::Code code) {
-  setUInt16_le(0x0022, encode_ctcss_tone_table(code));
+  Layout::UInt16_le<0x0022>::set(_data, encode_ctcss_tone_table(code));
 }
 
 unsigned
 RadioddityCodeplug::ChannelElement::txSignalingIndex() const {
-  return getUInt8(0x0025);
+  return Layout::UInt8<0x0025>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setTXSignalingIndex(unsigned index) {
-  setUInt8(0x0025, index);
+  Layout::UInt8<0x0025>::set(_data, index);
 }
 unsigned
 RadioddityCodeplug::ChannelElement::rxSignalingIndex() const {
-  return getUInt8(0x0027);
+  return Layout::UInt8<0x0027>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setRXSignalingIndex(unsigned index) {
-  setUInt8(0x0027, index);
+  Layout::UInt8<0x0027>::set(_data, index);
 }
 
 RadioddityCodeplug::ChannelElement::PrivacyGroup
 RadioddityCodeplug::ChannelElement::privacyGroup() const {
-  return (PrivacyGroup) getUInt8(0x0029);
+  return (PrivacyGroup) Layout::UInt8<0x0029>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setPrivacyGroup(PrivacyGroup grp) {
-  setUInt8(0x0029, (unsigned)grp);
+  Layout::UInt8<0x0029>::set(_data, (unsigned)grp);
 }
 
 unsigned
 RadioddityCodeplug::ChannelElement::txColorCode() const {
-  return getUInt8(0x002a);
+  return Layout::UInt8<0x002a>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setTXColorCode(unsigned cc) {
-  setUInt8(0x002a, cc);
+  Layout::UInt8<0x002a>::set(_data, cc);
 }
 
 bool
@@ -189,20 +191,20 @@ RadioddityCodeplug::ChannelElement::hasGroupList() const {
 }
 unsigned
 RadioddityCodeplug::ChannelElement::groupListIndex() const {
-  return getUInt8(0x002b);
+  return Layout::UInt8<0x002b>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setGroupListIndex(unsigned index) {
-  setUInt8(0x002b, index);
+  Layout::UInt8<0x002b>::set(_data, index);
 }
 
 unsigned
 RadioddityCodeplug::ChannelElement::rxColorCode() const {
-  return getUInt8(0x002c);
+  return Layout::UInt8<0x002c>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setRXColorCode(unsigned cc) {
-  setUInt8(0x002c, cc);
+  Layout::UInt8<0x002c>::set(_data, cc);
 }
 
 bool
@@ -211,11 +213,11 @@ RadioddityCodeplug::ChannelElement::hasEmergencySystem() const {
 }
 unsigned
 RadioddityCodeplug::ChannelElement::emergencySystemIndex() const {
-  return getUInt8(0x002d);
+  return Layout::UInt8<0x002d>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setEmergencySystemIndex(unsigned index) {
-  setUInt8(0x002d, index);
+  Layout::UInt8<0x002d>::set(_data, index);
 }
 
 bool
@@ -224,121 +226,123 @@ RadioddityCodeplug::ChannelElement::hasContact() const {
 }
 unsigned
 RadioddityCodeplug::ChannelElement::contactIndex() const {
-  return getUInt16_le(0x002e);
+  return Layout::UInt16_le<0x002e>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::setContactIndex(unsigned index) {
-  setUInt16_le(0x002e, index);
+  Layout::UInt16_le<0x002e>::set(_data, index);
 }
 
 bool
 RadioddityCodeplug::ChannelElement::dataCallConfirm() const {
-  return getBit(0x0030, 7);
+  return Layout::Bit<0x0030, 7>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableDataCallConfirm(bool enable) {
-  setBit(0x0030, 7, enable);
+  Layout::Bit<0x0030, 7>::set(_data, enable);
 }
 bool
 RadioddityCodeplug::ChannelElement::emergencyAlarmACK() const {
-  return getBit(0x0030, 6);
+  return Layout::Bit<0x0030, 6>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableEmergencyAlarmACK(bool enable) {
-  setBit(0x0030, 6, enable);
+  Layout::Bit<0x0030, 6>::set(_data, enable);
 }
 bool
 RadioddityCodeplug::ChannelElement::privateCallConfirm() const {
-  return getBit(0x0031, 0);
+  return Layout::Bit<0x0031, 0>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enablePrivateCallConfirm(bool enable) {
-  setBit(0x0031, 0, enable);
+  Layout::Bit<0x0031, 0>::set(_data, enable);
 }
 bool
 RadioddityCodeplug::ChannelElement::privacyEnabled() const {
-  return getBit(0x0031, 4);
+  return Layout::Bit<0x0031, 4>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enablePrivacy(bool enable) {
-  setBit(0x00031, 4, enable);
+  Layout::Bit<0x00031, 4>::set(_data, enable);
 }
 
 DigitalChannel::TimeSlot
 RadioddityCodeplug::ChannelElement::timeSlot() const {
-  return (getBit(0x0031, 6) ? DigitalChannel::TimeSlot::TS2 : DigitalChannel::TimeSlot::TS1);
+  return (Layout::Bit<0x0031, 6>::get(_data) ?
+            DigitalChannel::TimeSlot::TS2 : DigitalChannel::TimeSlot::TS1);
 }
 void
 RadioddityCodeplug::ChannelElement::setTimeSlot(DigitalChannel::TimeSlot ts) {
-  setBit(0x0031, 6, DigitalChannel::TimeSlot::TS2 == ts);
+  Layout::Bit<0x0031, 6>::set(_data, DigitalChannel::TimeSlot::TS2 == ts);
 }
 
 bool
 RadioddityCodeplug::ChannelElement::dualCapacityDirectMode() const {
-  return getBit(0x0032, 0);
+  return Layout::Bit<0x0032, 0>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableDualCapacityDirectMode(bool enable) {
-  setBit(0x0032, 0, enable);
+  Layout::Bit<0x0032, 0>::set(_data, enable);
 }
 bool
 RadioddityCodeplug::ChannelElement::nonSTEFrequency() const {
-  return getBit(0x0032, 5);
+  return Layout::Bit<0x0032, 5>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableNonSTEFrequency(bool enable) {
-  setBit(0x0032, 5, enable);
+  Layout::Bit<0x0032, 5>::set(_data, enable);
 }
 
 AnalogChannel::Bandwidth
 RadioddityCodeplug::ChannelElement::bandwidth() const {
-  return (getBit(0x0033, 1) ? AnalogChannel::Bandwidth::Wide : AnalogChannel::Bandwidth::Narrow);
+  return (Layout::Bit<0x0033, 1>::get(_data) ?
+            AnalogChannel::Bandwidth::Wide : AnalogChannel::Bandwidth::Narrow);
 }
 void
 RadioddityCodeplug::ChannelElement::setBandwidth(AnalogChannel::Bandwidth bw) {
-  setBit(0x0033, 1, AnalogChannel::Bandwidth::Wide == bw);
+  Layout::Bit<0x0033, 1>::set(_data, AnalogChannel::Bandwidth::Wide == bw);
 }
 
 bool
 RadioddityCodeplug::ChannelElement::rxOnly() const {
-  return getBit(0x0033, 2);
+  return Layout::Bit<0x0033, 2>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableRXOnly(bool enable) {
-  setBit(0x0033, 2, enable);
+  Layout::Bit<0x0033, 2>::set(_data, enable);
 }
 bool
 RadioddityCodeplug::ChannelElement::talkaround() const {
-  return getBit(0x0033, 3);
+  return Layout::Bit<0x0033, 3>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableTalkaround(bool enable) {
-  setBit(0x0033, 3, enable);
+  Layout::Bit<0x0033, 3>::set(_data, enable);
 }
 bool
 RadioddityCodeplug::ChannelElement::vox() const {
-  return getBit(0x0033, 6);
+  return Layout::Bit<0x0033, 6>::get(_data);
 }
 void
 RadioddityCodeplug::ChannelElement::enableVOX(bool enable) {
-  setBit(0x0033, 6, enable);
+  Layout::Bit<0x0033, 6>::set(_data, enable);
 }
 
 Channel::Power
 RadioddityCodeplug::ChannelElement::power() const {
-  return (getBit(0x0033, 7) ? Channel::Power::High : Channel::Power::Low);
+  return (Layout::Bit<0x0033, 7>::get(_data) ? Channel::Power::High : Channel::Power::Low);
 }
 void
 RadioddityCodeplug::ChannelElement::setPower(Channel::Power pwr) {
   switch (pwr) {
   case Channel::Power::Min:
   case Channel::Power::Low:
-    clearBit(0x0033, 7);
+    Layout::Bit<0x0033, 7>::set(_data, false);
     break;
   case Channel::Power::Mid:
   case Channel::Power::High:
   case Channel::Power::Max:
-    setBit(0x0033, 7);
+    Layout::Bit<0x0033, 7>::set(_data, true);
     break;
   }
 }
@@ -483,13 +487,15 @@ RadioddityCodeplug::ChannelBankElement::clear() {
 
 bool
 RadioddityCodeplug::ChannelBankElement::isEnabled(unsigned idx) const {
-  unsigned byte = idx/8, bit = idx%8;
-  return getBit(byte, bit);
+  return bitmap().isSet(idx);
 }
 void
 RadioddityCodeplug::ChannelBankElement::enable(unsigned idx, bool enabled) {
-  unsigned byte = idx/8, bit = idx%8;
-  return setBit(byte, bit, enabled);
+  bitmap().set(idx, enabled);
+}
+BitmapView
+RadioddityCodeplug::ChannelBankElement::bitmap() const {
+  return BitmapView(_data, 128);
 }
 
 uint8_t *
@@ -902,13 +908,15 @@ RadioddityCodeplug::ZoneBankElement::clear() {
 
 bool
 RadioddityCodeplug::ZoneBankElement::isEnabled(unsigned idx) const {
-  unsigned byte=idx/8, bit = idx%8;
-  return getBit(byte, bit);
+  return bitmap().isSet(idx);
 }
 void
 RadioddityCodeplug::ZoneBankElement::enable(unsigned idx, bool enabled) {
-  unsigned byte=idx/8, bit = idx%8;
-  setBit(byte, bit, enabled);
+  bitmap().set(idx, enabled);
+}
+BitmapView
+RadioddityCodeplug::ZoneBankElement::bitmap() const {
+  return BitmapView(_data, 256);
 }
 uint8_t *
 RadioddityCodeplug::ZoneBankElement::get(unsigned idx) const {
@@ -2684,54 +2692,84 @@ RadioddityCodeplug::encode(Config *config, const Flags &flags, const ErrorStack
 
 bool
 RadioddityCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err) {
+  // All sections are written into disjoint memory regions, hence they may be encoded in parallel.
+  TaskGroup tasks(flags.parallelEncode);
+
   // General config
-  if (! this->encodeGeneralSettings(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode general settings.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeGeneralSettings(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode general settings.";
+      return false;
+    }
+    return true;
+  });
 
   // Define Contacts
-  if (! this->encodeContacts(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode contacts.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeContacts(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode contacts.";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeDTMFContacts(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode DTMF contacts.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeDTMFContacts(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode DTMF contacts.";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeChannels(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode channels";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeChannels(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode channels";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeBootText(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode boot text.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeBootText(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode boot text.";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeZones(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode zones.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeZones(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode zones.";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeScanLists(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode scan lists.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeScanLists(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode scan lists.";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeGroupLists(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode group lists.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeGroupLists(ctx.config(), flags, ctx, err)) {
+      errMsg(err) << "Cannot encode group lists.";
+      return false;
+    }
+    return true;
+  });
 
-  if (! this->encodeEncryption(ctx.config(), flags, ctx, err)) {
-    errMsg(err) << "Cannot encode encryption keys.";
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeEncryption(ctx.config(), flags, ctx, err))
+      errMsg(err) << "Cannot encode encryption keys.";
     return true;
-  }
+  });
 
-  return true;
+  if (tasks.isParallel())
+    detach();
+  return tasks.run(err);
 }
 
 bool
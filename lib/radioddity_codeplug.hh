@@ -6,6 +6,7 @@
 #include "channel.hh"
 #include "contact.hh"
 #include "radioddity_extensions.hh"
+#include "bitmapview.hh"
 
 class DigitalContact;
 class Zone;
@@ -216,6 +217,10 @@ public:
     virtual bool linkChannelObj(Channel *c, Context &ctx) const;
     /** Initializes this codeplug channel from the given generic configuration. */
     virtual bool fromChannelObj(const Channel *c, Context &ctx);
+
+  protected:
+    /** Compile-time layout of the channel element. */
+    typedef ElementLayout<0x0038> Layout;
   };
 
   /** Implements the base for channel banks in Radioddity codeplugs.
@@ -241,6 +246,8 @@ public:
     virtual bool isEnabled(unsigned idx) const ;
     /** Enable/disable a channel in the bank. */
     virtual void enable(unsigned idx, bool enabled);
+    /** Returns the bitmap of enabled channels. */
+    virtual BitmapView bitmap() const;
     /** Returns a pointer to the channel at the given index. */
     virtual uint8_t *get(unsigned idx) const;
   };
@@ -463,6 +470,8 @@ public:
     virtual bool isEnabled(unsigned idx) const ;
     /** Enable/disable a channel in the bank. */
     virtual void enable(unsigned idx, bool enabled);
+    /** Returns the bitmap of enabled zones. */
+    virtual BitmapView bitmap() const;
     /** Returns a pointer to the channel at the given index. */
     virtual uint8_t *get(unsigned idx) const;
   };
@@ -0,0 +1,76 @@
+#include "radioddity_emulator.hh"
+#include "radioddity_interface.hh"
+#include "logger.hh"
+#include <cstring>
+#include <algorithm>
+
+#define REPORT_SIZE 42
+#define BLOCK_SIZE  32
+#define IDENT_SIZE  16
+
+/* ********************************************************************************************* *
+ * Implementation of RadioddityEmulator
+ * ********************************************************************************************* */
+RadioddityEmulator::RadioddityEmulator(const QString &ident)
+  : RadioEmulator(RadioddityInterface::interfaceInfo()), _ident(ident), _bank(0)
+{
+  registerDevice();
+}
+
+RadioddityEmulator::~RadioddityEmulator() {
+  // pass...
+}
+
+int
+RadioddityEmulator::hidTransfer(const uint8_t *report, unsigned len, uint8_t *reply, unsigned rlen) {
+  if ((REPORT_SIZE > len) || (REPORT_SIZE > rlen) || (1 != report[0]))
+    return -1;
+
+  delay(2*REPORT_SIZE);
+
+  // Output report: 1, 0, length (little endian), command
+  unsigned n = unsigned(report[2]) | (unsigned(report[3])<<8);
+  const uint8_t *cmd = report+4;
+  // Input report: 3, 0, length, 0, response
+  memset(reply, 0, REPORT_SIZE);
+  reply[0] = 3;
+  uint8_t *resp = reply+4;
+  unsigned rn = 1;
+  resp[0] = 'A';
+
+  if ((7 == n) && (0 == memcmp(cmd, "\2PROGRA", 7))) {
+    // Enter program mode
+  } else if ((2 == n) && (0 == memcmp(cmd, "M\2", 2))) {
+    // Identify: name padded with 0xff, followed by some version information
+    rn = IDENT_SIZE;
+    memset(resp, 0xff, 8);
+    QByteArray ident = _ident.toLocal8Bit().left(8);
+    memcpy(resp, ident.constData(), ident.size());
+    memcpy(resp+8, "V210\0\4\x80\4", 8);
+  } else if ((1 == n) && ('A' == cmd[0])) {
+    // Acknowledge
+  } else if ((8 == n) && (0 == memcmp(cmd, "CWB\4\0", 5))) {
+    // Select memory bank
+    _bank = cmd[5];
+  } else if ((4 == n) && ('R' == cmd[0])) {
+    // Read block: 'R', address (big endian), size
+    uint32_t addr = (uint32_t(cmd[1])<<8) | cmd[2];
+    unsigned size = std::min(unsigned(cmd[3]), unsigned(REPORT_SIZE-8));
+    memcpy(resp, cmd, 4);
+    read(_bank, addr, resp+4, size);
+    rn = 4+size;
+  } else if ((4 < n) && ('W' == cmd[0])) {
+    // Write block: 'W', address (big endian), size, data
+    uint32_t addr = (uint32_t(cmd[1])<<8) | cmd[2];
+    unsigned size = std::min(unsigned(cmd[3]), n-4);
+    write(_bank, addr, cmd+4, size);
+  } else if ((4 == n) && ((0 == memcmp(cmd, "ENDR", 4)) || (0 == memcmp(cmd, "ENDW", 4)))) {
+    // Leave program mode
+  } else {
+    logDebug() << "Emulated Radioddity: Unknown command of length " << n << ".";
+    resp[0] = '-';
+  }
+
+  reply[2] = rn;
+  return REPORT_SIZE;
+}
@@ -0,0 +1,30 @@
+#ifndef RADIODDITYEMULATOR_HH
+#define RADIODDITYEMULATOR_HH
+
+#include "radioemulator.hh"
+
+/** Emulates the HID interface of Radioddity radios (GD-77, RD-5R).
+ *
+ * Implements the HID reports exchanged by @c HIDevice and the Radioddity command set on top of
+ * them (program mode, identify, memory bank selection, reading and writing blocks of 32 bytes).
+ * The memory banks are addressed as in @c RadioddityInterface::MemoryBank, each holding 64kB.
+ *
+ * @ingroup emulator */
+class RadioddityEmulator: public RadioEmulator
+{
+public:
+  /** Constructs an emulator reporting the given identifier (e.g., "BF-5R" or "MD-760P"). */
+  explicit RadioddityEmulator(const QString &ident="BF-5R");
+  /** Destructor. */
+  virtual ~RadioddityEmulator();
+
+  int hidTransfer(const uint8_t *report, unsigned len, uint8_t *reply, unsigned rlen);
+
+protected:
+  /** The identifier string. */
+  QString _ident;
+  /** The currently selected memory bank. */
+  uint32_t _bank;
+};
+
+#endif // RADIODDITYEMULATOR_HH
@@ -4,6 +4,8 @@
 #include <string.h>
 #include <unistd.h>
 #include "logger.hh"
+#include <vector>
+#include <algorithm>
 
 #define USB_VID 0x15a2
 #define USB_PID 0x0073
@@ -21,7 +23,7 @@ static const unsigned char CMD_CWB3[]  = "CWB\4\0\3\0\0";
 static const unsigned char CMD_CWB4[]  = "CWB\4\0\4\0\0";
 
 RadioddityInterface::RadioddityInterface(const USBDeviceDescriptor &descr, const ErrorStack &err, QObject *parent)
-  : HIDevice(descr, err, parent), _current_bank(MEMBANK_NONE), _identifier()
+  : HIDevice(descr, err, parent), _current_bank(MEMBANK_NONE), _identifier(), _version()
 {
   if (isOpen())
     identifier();
@@ -63,6 +65,7 @@ RadioddityInterface::identifier(const ErrorStack &err) {
     return _identifier;
 
   logDebug() << "Radioddity HID interface: Enter program mode.";
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::EnterProgramMode);
 
   if (! hid_send_recv(CMD_PRG, 7, &ack, 1, err)) {
     errMsg(err) << "Cannot identify radio.";
@@ -95,6 +98,9 @@ RadioddityInterface::identifier(const ErrorStack &err) {
   // 42 46 2d 35 52 ff ff ff 56 32 31 30 00 04 80 04
   //  B  F  -  5  R           V  2  1  0
 
+  // The version follows the name, terminated by 0x00.
+  _version = QString::fromLatin1((const char *)reply+8, qstrnlen((const char *)reply+8, 8));
+
   // Terminate the string.
   char *p = (char *)memchr(reply, 0xff, sizeof(reply));
   if (p)
@@ -109,10 +115,17 @@ RadioddityInterface::identifier(const ErrorStack &err) {
     return RadioInfo();
   }
 
-  logDebug() << "Got device '" << _identifier.name() << "'.";
+  logDebug() << "Got device '" << _identifier.name() << "', version " << _version << ".";
   return _identifier;
 }
 
+QString
+RadioddityInterface::version(const ErrorStack &err) {
+  if (! _identifier.isValid())
+    identifier(err);
+  return _version;
+}
+
 
 bool
 RadioddityInterface::read_start(uint32_t bank, uint32_t addr, const ErrorStack &err) {
@@ -132,12 +145,38 @@ RadioddityInterface::read(uint32_t bank, uint32_t addr, unsigned char *data, int
   unsigned char cmd[4], reply[32+4];
   int n;
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Read, nbytes);
+
   if (! selectMemoryBank(MemoryBank(bank), err)) {
     errMsg(err) << "Cannot select memory bank " << bank << ".";
     return false;
   }
 
-  // send data
+  // Send all read commands at once
+  unsigned count = nbytes/32;
+  std::vector<unsigned char> cmds(4*count);
+  for (unsigned i=0; i<count; i++) {
+    cmds[4*i+0] = CMD_READ[0];
+    cmds[4*i+1] = (addr + i*32) >> 8;
+    cmds[4*i+2] = addr + i*32;
+    cmds[4*i+3] = 32;
+  }
+  // Each response echoes the command in front of the data
+  std::vector<unsigned char> replies((4+32)*count);
+  bool ok = hid_send_recv_batch(cmds.data(), 4, count, replies.data(), 4+32, ErrorStack());
+  // A dropped or reordered reply must not shift data into the wrong block
+  for (unsigned i=0; ok && (i<count); i++)
+    ok = (0 == memcmp(replies.data() + (4+32)*i, cmds.data() + 4*i, 4));
+  if (ok) {
+    for (unsigned i=0; i<count; i++)
+      memcpy(data + i*32, replies.data() + (4+32)*i + 4, 32);
+    return true;
+  }
+
+  // On error, fall back to single block transfers
+  logDebug() << "Batch read failed, fall back to single block reads.";
+  _metrics.addRetry(TransferMetrics::Read);
+  setWindow(1);
   for (n=0; n<nbytes; n+=32) {
     cmd[0] = CMD_READ[0];
     cmd[1] = (addr + n) >> 8;
@@ -157,6 +196,8 @@ RadioddityInterface::read_finish(const ErrorStack &err)
 {
   unsigned char ack;
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::LeaveProgramMode);
+
   if (! hid_send_recv(CMD_ENDR, 4, &ack, 1, err)) {
     errMsg(err) << "Cannot finish read().";
     return false;
@@ -192,12 +233,32 @@ RadioddityInterface::write(uint32_t bank, uint32_t addr, unsigned char *data, in
 {
   unsigned char ack, cmd[4+32];
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Write, nbytes);
+
   if (! selectMemoryBank(MemoryBank(bank), err)) {
     errMsg(err) << "Cannot select memory bank " << bank << ".";
     return false;
   }
 
-  // send data
+  // Send all write commands at once
+  unsigned count = nbytes/32;
+  std::vector<unsigned char> cmds((4+32)*count), acks(count);
+  for (unsigned i=0; i<count; i++) {
+    unsigned char *c = cmds.data() + (4+32)*i;
+    c[0] = CMD_WRITE[0];
+    c[1] = (addr + i*32) >> 8;
+    c[2] = addr + i*32;
+    c[3] = 32;
+    memcpy(c + 4, data + i*32, 32);
+  }
+  if (hid_send_recv_batch(cmds.data(), 4+32, count, acks.data(), 1, ErrorStack())
+      && (count == unsigned(std::count(acks.begin(), acks.end(), CMD_ACK[0]))))
+    return true;
+
+  // On error, fall back to single block transfers
+  logDebug() << "Batch write failed, fall back to single block writes.";
+  _metrics.addRetry(TransferMetrics::Write);
+  setWindow(1);
   for (int n=0; n<nbytes; n+=32) {
     cmd[0] = CMD_WRITE[0];
     cmd[1] = (addr + n) >> 8;
@@ -209,6 +270,7 @@ RadioddityInterface::write(uint32_t bank, uint32_t addr, unsigned char *data, in
     else if (ack != CMD_ACK[0]) {
       errMsg(err) << "Cannot write block: Wrong acknowledge " << (int)ack
                   << ", expected " << (int)CMD_ACK[0] << ".";
+      _metrics.addRetry(TransferMetrics::Write);
       n-=32;
     }
   }
@@ -221,6 +283,8 @@ RadioddityInterface::write_finish(const ErrorStack &err)
 {
   unsigned char ack;
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::LeaveProgramMode);
+
   if (! hid_send_recv(CMD_ENDW, 4, &ack, 1, err)) {
     errMsg(err) << "Cannot finish write().";
     return false;
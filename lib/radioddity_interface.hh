@@ -41,6 +41,8 @@ public:
 
   /** Returns radio identifier string. */
   RadioInfo identifier(const ErrorStack &err=ErrorStack());
+  /** Returns the firmware version reported by the radio (e.g., "V210"). */
+  QString version(const ErrorStack &err=ErrorStack());
 
   bool read_start(uint32_t bank, uint32_t addr, const ErrorStack &err=ErrorStack());
 
@@ -83,6 +85,8 @@ private:
   MemoryBank _current_bank;
   /** Identifier received when entering the prog mode. */
   RadioInfo _identifier;
+  /** Firmware version received along with the identifier. */
+  QString _version;
 };
 
 #endif // RADIODDITY_INTERFACE_HH
@@ -2,8 +2,11 @@
 #include "config.hh"
 #include "logger.hh"
 #include "utils.hh"
+#include "codeplugcache.hh"
+#include <algorithm>
 
 #define BSIZE           32
+#define BANK_SIZE       0x10000
 
 
 RadioddityRadio::RadioddityRadio(RadioddityInterface *device, QObject *parent)
@@ -24,6 +27,13 @@ RadioddityRadio::~RadioddityRadio() {
   }
 }
 
+const TransferMetrics *
+RadioddityRadio::metrics() const {
+  if (nullptr == _dev)
+    return nullptr;
+  return &_dev->metrics();
+}
+
 bool
 RadioddityRadio::startDownload(bool blocking, const ErrorStack &err) {
   if (StatusIdle != _task)
@@ -134,31 +144,57 @@ RadioddityRadio::run() {
   }
 }
 
+bool
+RadioddityRadio::readCodeplug(uint32_t addr, uint8_t *data, uint32_t size) {
+  for (uint32_t offset=0; offset<size;) {
+    // Split at the bank boundary, addresses within the upper bank are relative to the bank
+    uint32_t a = addr+offset;
+    uint32_t n = std::min(size-offset, BANK_SIZE - (a % BANK_SIZE));
+    RadioddityInterface::MemoryBank bank = (
+          (BANK_SIZE > a) ? RadioddityInterface::MEMBANK_CODEPLUG_LOWER : RadioddityInterface::MEMBANK_CODEPLUG_UPPER );
+    if (! _dev->read(bank, a % BANK_SIZE, data+offset, n, _errorStack))
+      return false;
+    offset += n;
+  }
+  return true;
+}
+
+bool
+RadioddityRadio::writeCodeplug(uint32_t addr, uint8_t *data, uint32_t size) {
+  for (uint32_t offset=0; offset<size;) {
+    // Split at the bank boundary, addresses within the upper bank are relative to the bank
+    uint32_t a = addr+offset;
+    uint32_t n = std::min(size-offset, BANK_SIZE - (a % BANK_SIZE));
+    RadioddityInterface::MemoryBank bank = (
+          (BANK_SIZE > a) ? RadioddityInterface::MEMBANK_CODEPLUG_LOWER : RadioddityInterface::MEMBANK_CODEPLUG_UPPER );
+    if (! _dev->write(bank, a % BANK_SIZE, data+offset, n, _errorStack))
+      return false;
+    offset += n;
+  }
+  return true;
+}
+
 bool
 RadioddityRadio::download() {
   emit downloadStarted();
 
   unsigned btot = 0;
   for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    btot += codeplug().image(0).element(n).data().size()/BSIZE;
+    btot += codeplug().image(0).element(n).memSize()/BSIZE;
   }
 
   unsigned bcount = 0;
-  for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    int b0 = codeplug().image(0).element(n).address()/BSIZE;
-    int nb = codeplug().image(0).element(n).data().size()/BSIZE;
-    for (int i=0; i<nb; i++, bcount++) {
-      // Select bank by addr
-      uint32_t addr = (b0+i)*BSIZE;
-      RadioddityInterface::MemoryBank bank = (
-            (0x10000 > addr) ? RadioddityInterface::MEMBANK_CODEPLUG_LOWER : RadioddityInterface::MEMBANK_CODEPLUG_UPPER );
-      // read
-      if (! _dev->read(bank, (b0+i)*BSIZE, codeplug().data((b0+i)*BSIZE), BSIZE, _errorStack)) {
-        errMsg(_errorStack) << "Cannot download codeplug.";
-        return false;
-      }
-      emit downloadProgress(float(bcount*100)/btot);
+  QByteArray buffer;
+  // Merge adjacent elements within each memory bank
+  foreach (const DFUFile::Image::Transfer &t, codeplug().image(0).planTransfers(0, BANK_SIZE)) {
+    buffer.resize(t.size);
+    if (! readCodeplug(t.address, (uint8_t *)buffer.data(), t.size)) {
+      errMsg(_errorStack) << "Cannot download codeplug.";
+      return false;
     }
+    codeplug().image(0).scatter(t, buffer);
+    bcount += t.size/BSIZE;
+    emit downloadProgress(float(bcount*100)/btot);
   }
 
   _dev->read_finish(_errorStack);
@@ -171,27 +207,47 @@ RadioddityRadio::upload() {
 
   unsigned btot = 0;
   for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    btot += codeplug().image(0).element(n).data().size()/BSIZE;
+    btot += codeplug().image(0).element(n).memSize()/BSIZE;
   }
 
   unsigned bcount = 0;
-  if (_codeplugFlags.updateCodePlug) {
+  CodeplugCache cache(_dev->identifier(), _dev->version());
+  // Without a known firmware version, a cached image may be stale
+  bool useCache = _codeplugFlags.useImageCache && cache.isEnabled();
+  QVector<uint32_t> samples;
+  bool restored = false;
+  if (useCache)
+    samples = CodeplugCache::samples(codeplug().image(0), BSIZE);
+  if (_codeplugFlags.updateCodePlug && useCache) {
+    // Assemble fingerprint from some sampled blocks and try to restore the image from the cache
+    foreach (uint32_t addr, samples) {
+      if (! readCodeplug(addr, codeplug().data(addr), BSIZE)) {
+        errMsg(_errorStack) << "Cannot upload codeplug.";
+        return false;
+      }
+      cache.addFingerprint(addr, codeplug().data(addr), BSIZE);
+    }
+    if (cache.load() && cache.restore(codeplug())) {
+      logDebug() << "Restored codeplug from cache, skip read-back.";
+      restored = true;
+    }
+  }
+
+  // Merge adjacent elements within each memory bank
+  QVector<DFUFile::Image::Transfer> transfers = codeplug().image(0).planTransfers(0, BANK_SIZE);
+  QByteArray buffer;
+
+  if (_codeplugFlags.updateCodePlug && (! restored)) {
     // If codeplug gets updated, download codeplug from device first:
-    for (int n=0; n<codeplug().image(0).numElements(); n++) {
-      int b0 = codeplug().image(0).element(n).address()/BSIZE;
-      int nb = codeplug().image(0).element(n).data().size()/BSIZE;
-      for (int i=0; i<nb; i++, bcount++) {
-        // Select bank by addr
-        uint32_t addr = (b0+i)*BSIZE;
-        RadioddityInterface::MemoryBank bank = (
-              (0x10000 > addr) ? RadioddityInterface::MEMBANK_CODEPLUG_LOWER : RadioddityInterface::MEMBANK_CODEPLUG_UPPER );
-        // read
-        if (! _dev->read(bank, addr, codeplug().data(addr), BSIZE, _errorStack)) {
-          errMsg(_errorStack) << "Cannot upload codeplug.";
-          return false;
-        }
-        emit uploadProgress(float(bcount*50)/btot);
+    foreach (const DFUFile::Image::Transfer &t, transfers) {
+      buffer.resize(t.size);
+      if (! readCodeplug(t.address, (uint8_t *)buffer.data(), t.size)) {
+        errMsg(_errorStack) << "Cannot upload codeplug.";
+        return false;
       }
+      codeplug().image(0).scatter(t, buffer);
+      bcount += t.size/BSIZE;
+      emit uploadProgress(float(bcount*50)/btot);
     }
   }
 
@@ -203,21 +259,24 @@ RadioddityRadio::upload() {
 
   // then, upload modified codeplug
   bcount = 0;
-  for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    int b0 = codeplug().image(0).element(n).address()/BSIZE;
-    int nb = codeplug().image(0).element(n).data().size()/BSIZE;
-    for (int i=0; i<nb; i++, bcount++) {
-      // Select bank by addr
-      uint32_t addr = (b0+i)*BSIZE;
-      RadioddityInterface::MemoryBank bank = (
-            (0x10000 > addr) ? RadioddityInterface::MEMBANK_CODEPLUG_LOWER : RadioddityInterface::MEMBANK_CODEPLUG_UPPER );
-      // write block
-      if (! _dev->write(bank, addr, codeplug().data(addr), BSIZE, _errorStack)) {
-        errMsg(_errorStack) << "Cannot upload codeplug.";
-        return false;
-      }
-      emit uploadProgress(50+float(bcount*50)/btot);
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    codeplug().image(0).gather(t, buffer);
+    if (! writeCodeplug(t.address, (uint8_t *)buffer.data(), t.size)) {
+      errMsg(_errorStack) << "Cannot upload codeplug.";
+      return false;
     }
+    bcount += t.size/BSIZE;
+    emit uploadProgress(50+float(bcount*50)/btot);
+  }
+
+  // Store the image written in the cache
+  if (useCache) {
+    cache.clearFingerprint();
+    foreach (uint32_t addr, samples)
+      cache.addFingerprint(addr, codeplug().data(addr), BSIZE);
+    ErrorStack cacheErr;
+    if (! cache.store(codeplug(), cacheErr))
+      logWarn() << "Cannot store codeplug image in cache: " << cacheErr.format();
   }
 
   return true;
@@ -21,6 +21,8 @@ public:
 
   virtual ~RadioddityRadio();
 
+  const TransferMetrics *metrics() const;
+
 public slots:
   /** Starts the download of the codeplug and derives the generic configuration from it. */
   bool startDownload(bool blocking=false, const ErrorStack &err=ErrorStack());
@@ -36,6 +38,13 @@ protected:
   /** Thread main routine, performs all blocking IO operations for codeplug up- and download. */
 	void run();
 
+  /** Reads @c size bytes starting at the given codeplug address. The transfer gets split at the
+   * boundary between the lower and upper memory bank. */
+  bool readCodeplug(uint32_t addr, uint8_t *data, uint32_t size);
+  /** Writes @c size bytes starting at the given codeplug address. The transfer gets split at the
+   * boundary between the lower and upper memory bank. */
+  bool writeCodeplug(uint32_t addr, uint8_t *data, uint32_t size);
+
 private:
   virtual bool download();
   virtual bool upload();
@@ -0,0 +1,330 @@
+#include "radioemulator.hh"
+#include "logger.hh"
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#endif
+
+#define PAGE_SIZE 0x1000
+#define POLL_TIMEOUT 10
+
+/** All registered emulators. */
+static QList<RadioEmulator *> _emulators;
+/** Guards the registry. */
+static QMutex _emulatorsLock;
+/** The next virtual USB device address. */
+static uint8_t _nextDevice = 1;
+
+
+/* ********************************************************************************************* *
+ * Implementation of RadioEmulator::Descriptor
+ * ********************************************************************************************* */
+RadioEmulator::Descriptor::Descriptor(const USBDeviceInfo &info, const QString &device)
+  : USBDeviceDescriptor(info, device)
+{
+  // pass...
+}
+
+RadioEmulator::Descriptor::Descriptor(const USBDeviceInfo &info, const USBDeviceHandle &device)
+  : USBDeviceDescriptor(info, device)
+{
+  // pass...
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of RadioEmulator
+ * ********************************************************************************************* */
+RadioEmulator::RadioEmulator(const USBDeviceInfo &info)
+  : _info(info), _descriptor(), _latency(0), _bandwidth(0), _memoryLock(), _memory()
+{
+  // pass...
+}
+
+RadioEmulator::~RadioEmulator() {
+  QMutexLocker locker(&_emulatorsLock);
+  _emulators.removeAll(this);
+}
+
+bool
+RadioEmulator::isOpen() const {
+  return USBDeviceInfo::Class::None != _descriptor.interfaceClass();
+}
+
+const USBDeviceDescriptor &
+RadioEmulator::descriptor() const {
+  return _descriptor;
+}
+
+unsigned
+RadioEmulator::latency() const {
+  return _latency;
+}
+
+void
+RadioEmulator::setLatency(unsigned usec) {
+  _latency = usec;
+}
+
+unsigned
+RadioEmulator::bandwidth() const {
+  return _bandwidth;
+}
+
+void
+RadioEmulator::setBandwidth(unsigned bytesPerSec) {
+  _bandwidth = bytesPerSec;
+}
+
+void
+RadioEmulator::read(uint32_t bank, uint32_t addr, uint8_t *data, unsigned n) const {
+  QMutexLocker locker(&_memoryLock);
+  while (n) {
+    uint32_t offset = addr % PAGE_SIZE, len = std::min(n, PAGE_SIZE-offset);
+    quint64 key = (quint64(bank)<<32) | (addr/PAGE_SIZE);
+    if (_memory.contains(key))
+      memcpy(data, _memory[key].constData()+offset, len);
+    else
+      memset(data, 0xff, len);
+    addr += len; data += len; n -= len;
+  }
+}
+
+void
+RadioEmulator::write(uint32_t bank, uint32_t addr, const uint8_t *data, unsigned n) {
+  QMutexLocker locker(&_memoryLock);
+  while (n) {
+    uint32_t offset = addr % PAGE_SIZE, len = std::min(n, PAGE_SIZE-offset);
+    quint64 key = (quint64(bank)<<32) | (addr/PAGE_SIZE);
+    if (! _memory.contains(key))
+      _memory[key] = QByteArray(PAGE_SIZE, char(0xff));
+    memcpy(_memory[key].data()+offset, data, len);
+    addr += len; data += len; n -= len;
+  }
+}
+
+void
+RadioEmulator::fill(uint32_t bank, uint32_t addr, unsigned n, uint8_t value) {
+  QMutexLocker locker(&_memoryLock);
+  while (n) {
+    uint32_t offset = addr % PAGE_SIZE, len = std::min(n, PAGE_SIZE-offset);
+    quint64 key = (quint64(bank)<<32) | (addr/PAGE_SIZE);
+    if ((0xff == value) && (0 == offset) && (PAGE_SIZE == len))
+      _memory.remove(key);
+    else {
+      if (! _memory.contains(key))
+        _memory[key] = QByteArray(PAGE_SIZE, char(0xff));
+      memset(_memory[key].data()+offset, value, len);
+    }
+    addr += len; n -= len;
+  }
+}
+
+int
+RadioEmulator::controlTransfer(uint8_t type, uint8_t request, uint16_t value,
+                               uint8_t *data, uint16_t len)
+{
+  Q_UNUSED(type); Q_UNUSED(request); Q_UNUSED(value); Q_UNUSED(data); Q_UNUSED(len);
+  return -1;
+}
+
+int
+RadioEmulator::hidTransfer(const uint8_t *report, unsigned len, uint8_t *reply, unsigned rlen) {
+  Q_UNUSED(report); Q_UNUSED(len); Q_UNUSED(reply); Q_UNUSED(rlen);
+  return -1;
+}
+
+RadioEmulator *
+RadioEmulator::find(const USBDeviceDescriptor &descr) {
+  QMutexLocker locker(&_emulatorsLock);
+  foreach (RadioEmulator *emulator, _emulators) {
+    if ((emulator->descriptor() == descr) &&
+        (emulator->descriptor().deviceHandle() == descr.deviceHandle()))
+      return emulator;
+  }
+  return nullptr;
+}
+
+QList<USBDeviceDescriptor>
+RadioEmulator::detect() {
+  QMutexLocker locker(&_emulatorsLock);
+  QList<USBDeviceDescriptor> res;
+  foreach (RadioEmulator *emulator, _emulators)
+    res.append(emulator->descriptor());
+  return res;
+}
+
+void
+RadioEmulator::registerDevice(const QString &device) {
+  _descriptor = Descriptor(_info, device);
+  _emulatorsLock.lock();
+  _emulators.append(this);
+  _emulatorsLock.unlock();
+  logDebug() << "Register emulated radio at " << _descriptor.description() << ".";
+}
+
+void
+RadioEmulator::registerDevice() {
+  _emulatorsLock.lock();
+  // Bus 0 is never assigned to real USB devices
+  _descriptor = Descriptor(_info, USBDeviceHandle(0, _nextDevice++));
+  _emulators.append(this);
+  _emulatorsLock.unlock();
+  logDebug() << "Register emulated radio at " << _descriptor.description() << ".";
+}
+
+qint64
+RadioEmulator::transferTime(unsigned nbytes) const {
+  if (0 == _bandwidth)
+    return 0;
+  return (qint64(nbytes)*1000000)/_bandwidth;
+}
+
+void
+RadioEmulator::delay(unsigned nbytes) const {
+  qint64 usec = _latency + transferTime(nbytes);
+  if (usec)
+    usleep(usec);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of SerialEmulator
+ * ********************************************************************************************* */
+SerialEmulator::SerialEmulator(const USBDeviceInfo &info, QObject *parent)
+  : QThread(parent), RadioEmulator(info), _master(-1), _slave(-1), _running(false),
+    _clock(), _linkFree(0), _pending(), _maxPending(0)
+{
+#ifdef Q_OS_UNIX
+  if (0 > (_master = posix_openpt(O_RDWR | O_NOCTTY))) {
+    logError() << "Cannot create pseudo terminal for emulated radio: " << strerror(errno) << ".";
+    return;
+  }
+
+  const char *name = nullptr;
+  if ((0 != grantpt(_master)) || (0 != unlockpt(_master)) || (nullptr == (name = ptsname(_master)))) {
+    logError() << "Cannot unlock pseudo terminal for emulated radio: " << strerror(errno) << ".";
+    ::close(_master); _master = -1;
+    return;
+  }
+
+  // Keep the slave open, otherwise reading the master fails once the interface closes the port.
+  // Also set the slave into raw mode, such that nothing gets echoed or translated.
+  if (0 > (_slave = ::open(name, O_RDWR | O_NOCTTY))) {
+    logError() << "Cannot open pseudo terminal '" << name << "': " << strerror(errno) << ".";
+    ::close(_master); _master = -1;
+    return;
+  }
+  struct termios tio;
+  if (0 == tcgetattr(_slave, &tio)) {
+    cfmakeraw(&tio);
+    tcsetattr(_slave, TCSANOW, &tio);
+  }
+
+  registerDevice(QString(name));
+#else
+  logError() << "Serial radio emulators are not supported on this platform.";
+#endif
+}
+
+SerialEmulator::~SerialEmulator() {
+  stop();
+#ifdef Q_OS_UNIX
+  if (0 <= _slave)
+    ::close(_slave);
+  if (0 <= _master)
+    ::close(_master);
+#endif
+}
+
+bool
+SerialEmulator::isOpen() const {
+  return (0 <= _master) && RadioEmulator::isOpen();
+}
+
+unsigned
+SerialEmulator::maxPending() const {
+  return _maxPending.load();
+}
+
+void
+SerialEmulator::resetMaxPending() {
+  _maxPending.store(0);
+}
+
+void
+SerialEmulator::start() {
+  if ((! isOpen()) || _running)
+    return;
+  _clock.start();
+  _linkFree = 0;
+  _running = true;
+  QThread::start();
+}
+
+void
+SerialEmulator::stop() {
+  _running = false;
+  wait();
+}
+
+void
+SerialEmulator::run() {
+#ifdef Q_OS_UNIX
+  QByteArray buffer;
+  char rxbuf[1024];
+
+  while (_running) {
+    // Send all responses that are due
+    qint64 now = _clock.nsecsElapsed()/1000;
+    while ((! _pending.isEmpty()) && (_pending.head().due <= now)) {
+      QByteArray data = _pending.dequeue().data;
+      for (int n=0; n<data.size();) {
+        ssize_t r = ::write(_master, data.constData()+n, data.size()-n);
+        if (0 > r)
+          break;
+        n += r;
+      }
+    }
+
+    // Wait for requests, at most until the next response is due
+    int timeout = POLL_TIMEOUT;
+    if (! _pending.isEmpty())
+      timeout = std::min(qint64(timeout), (_pending.head().due-now+999)/1000);
+    struct pollfd pfd;
+    pfd.fd = _master; pfd.events = POLLIN; pfd.revents = 0;
+    if (0 >= poll(&pfd, 1, timeout))
+      continue;
+    ssize_t n = ::read(_master, rxbuf, sizeof(rxbuf));
+    if (0 >= n)
+      continue;
+
+    // Handle all complete requests
+    buffer.append(rxbuf, n);
+    while (! buffer.isEmpty()) {
+      int consumed = handle(buffer);
+      if (0 == consumed)
+        break;
+      buffer.remove(0, std::max(1, consumed));
+    }
+  }
+#endif
+}
+
+void
+SerialEmulator::respond(const QByteArray &data) {
+  qint64 now = _clock.nsecsElapsed()/1000;
+  Response resp;
+  resp.due = std::max(now + _latency, _linkFree) + transferTime(data.size());
+  resp.data = data;
+  _linkFree = resp.due;
+  _pending.enqueue(resp);
+  if (_pending.size() > _maxPending.load())
+    _maxPending.store(_pending.size());
+}
@@ -0,0 +1,191 @@
+/** @defgroup emulator Radio emulators.
+ * This module collects software emulators for the supported radio interfaces.
+ *
+ * An emulator holds a memory image and speaks the wire protocol of a specific radio. Once
+ * created, it registers its interface and appears as a device with a matching VID:PID
+ * combination in @c USBDeviceDescriptor::detect. Hence the emulated radio can be selected like
+ * any other connected device, and the usual code paths (@c Radio::detect, the radio interfaces
+ * and the up- and download of codeplugs and call-sign DBs) can be exercised without a physical
+ * radio.
+ *
+ * The AnyTone and OpenGD77 emulators speak their serial protocol over a pseudo terminal, while
+ * the TyT (DFU) and Radioddity (HID) emulators are hooked into the @c DFUDevice and
+ * @c HIDevice transports directly.
+ *
+ * Each emulator adds a configurable latency and limits the bandwidth of the link, such that
+ * the transfer speed of the radio interfaces can be benchmarked.
+ *
+ * @ingroup rif */
+
+#ifndef RADIOEMULATOR_HH
+#define RADIOEMULATOR_HH
+
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QQueue>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include "usbdevice.hh"
+
+/** Base class of all radio emulators.
+ *
+ * Holds the memory image of the emulated device, the link properties (latency and bandwidth) and
+ * registers the emulated interface, such that it can be found by @c USBDeviceDescriptor::detect.
+ * The memory is organized in banks, each addressed by a 32-bit address. Unwritten memory reads
+ * as @c 0xff (erased flash).
+ *
+ * @ingroup emulator */
+class RadioEmulator
+{
+public:
+  /** Descriptor of an emulated interface. */
+  class Descriptor: public USBDeviceDescriptor
+  {
+  public:
+    /** Constructor from interface info and serial port. */
+    Descriptor(const USBDeviceInfo &info, const QString &device);
+    /** Constructor from interface info and virtual USB device address. */
+    Descriptor(const USBDeviceInfo &info, const USBDeviceHandle &device);
+  };
+
+protected:
+  /** Hidden constructor from the interface info of the emulated radio. */
+  explicit RadioEmulator(const USBDeviceInfo &info);
+
+public:
+  /** Destructor, unregisters the emulated interface. */
+  virtual ~RadioEmulator();
+
+  /** Returns @c true if the emulated interface is available. */
+  virtual bool isOpen() const;
+  /** Returns the descriptor of the emulated interface. */
+  const USBDeviceDescriptor &descriptor() const;
+
+  /** Returns the latency of each response in micro seconds. */
+  unsigned latency() const;
+  /** Sets the latency of each response in micro seconds. */
+  void setLatency(unsigned usec);
+  /** Returns the bandwidth of the link in bytes per second, 0 means unlimited. */
+  unsigned bandwidth() const;
+  /** Sets the bandwidth of the link in bytes per second, 0 means unlimited. */
+  void setBandwidth(unsigned bytesPerSec);
+
+  /** Reads @c n bytes from the memory image. */
+  void read(uint32_t bank, uint32_t addr, uint8_t *data, unsigned n) const;
+  /** Writes @c n bytes to the memory image. */
+  void write(uint32_t bank, uint32_t addr, const uint8_t *data, unsigned n);
+  /** Fills @c n bytes of the memory image with the given value. */
+  void fill(uint32_t bank, uint32_t addr, unsigned n, uint8_t value=0xff);
+
+  /** Handles a control transfer to an emulated USB device. Mimics @c libusb_control_transfer,
+   * that is, returns the number of bytes transferred or a negative value on error.
+   * The default implementation fails. */
+  virtual int controlTransfer(uint8_t type, uint8_t request, uint16_t value,
+                              uint8_t *data, uint16_t len);
+  /** Handles an output report to an emulated HID device and stores the input report in
+   * @c reply. Returns the size of the input report or a negative value on error.
+   * The default implementation fails. */
+  virtual int hidTransfer(const uint8_t *report, unsigned len, uint8_t *reply, unsigned rlen);
+
+public:
+  /** Returns the emulator for the given descriptor or @c nullptr if the descriptor does not
+   * describe an emulated interface. */
+  static RadioEmulator *find(const USBDeviceDescriptor &descr);
+  /** Returns the descriptors of all emulated interfaces. */
+  static QList<USBDeviceDescriptor> detect();
+
+protected:
+  /** Registers the emulated interface at the given serial port or virtual USB address. */
+  void registerDevice(const QString &device);
+  /** Registers the emulated interface at a new virtual USB address. */
+  void registerDevice();
+  /** Blocks for the time needed to transfer @c nbytes bytes (latency + size/bandwidth). */
+  void delay(unsigned nbytes) const;
+  /** Returns the time in micro seconds needed to transfer @c nbytes bytes over the link,
+   * excluding the latency. */
+  qint64 transferTime(unsigned nbytes) const;
+
+protected:
+  /** The interface info of the emulated radio. */
+  USBDeviceInfo _info;
+  /** The descriptor of the emulated interface. */
+  USBDeviceDescriptor _descriptor;
+  /** Latency in micro seconds. */
+  unsigned _latency;
+  /** Bandwidth in bytes per second. */
+  unsigned _bandwidth;
+  /** Guards the memory image. */
+  mutable QMutex _memoryLock;
+  /** The memory image, pages indexed by bank and page address. */
+  QHash<quint64, QByteArray> _memory;
+};
+
+
+/** Base class of all emulators speaking a serial protocol.
+ *
+ * Creates a pseudo terminal and registers its slave side as a serial interface with the VID:PID
+ * of the emulated radio. A thread reads the requests from the master side and passes them to
+ * @c handle. Responses are queued by @c respond and sent once the latency and the transfer time
+ * of the link have passed. Hence several requests may be in flight at the same time.
+ *
+ * @ingroup emulator */
+class SerialEmulator: public QThread, public RadioEmulator
+{
+protected:
+  /** Hidden constructor. */
+  SerialEmulator(const USBDeviceInfo &info, QObject *parent=nullptr);
+
+public:
+  /** Destructor, stops the emulator and closes the pseudo terminal. */
+  virtual ~SerialEmulator();
+
+  bool isOpen() const;
+
+  /** Returns the maximum number of responses queued at the same time since the last call to
+   * @c resetMaxPending. That is, the maximum number of requests in flight. */
+  unsigned maxPending() const;
+  /** Resets the maximum number of queued responses. */
+  void resetMaxPending();
+
+protected:
+  /** Starts the emulator thread. Must be called by the constructor of the derived emulator. */
+  void start();
+  /** Stops the emulator thread. Must be called by the destructor of the derived emulator, as the
+   * thread calls @c handle. */
+  void stop();
+  /** Main loop of the emulator. */
+  void run();
+  /** Handles the received data. Returns the number of bytes consumed, 0 if more data is needed
+   * and a negative value if the data cannot be handled. In the latter case, the first byte gets
+   * dropped. */
+  virtual int handle(const QByteArray &data) = 0;
+  /** Queues the given response. */
+  void respond(const QByteArray &data);
+
+protected:
+  /** A queued response. */
+  struct Response {
+    /** Time at which the response gets sent, in micro seconds. */
+    qint64 due;
+    /** The response. */
+    QByteArray data;
+  };
+
+  /** Master side of the pseudo terminal. */
+  int _master;
+  /** Slave side of the pseudo terminal, kept open for the lifetime of the emulator. */
+  int _slave;
+  /** If @c false, the main loop stops. */
+  volatile bool _running;
+  /** Clock of the link. */
+  QElapsedTimer _clock;
+  /** Time at which the link is free again, in micro seconds. */
+  qint64 _linkFree;
+  /** Queued responses. */
+  QQueue<Response> _pending;
+  /** Maximum number of queued responses. */
+  QAtomicInt _maxPending;
+};
+
+#endif // RADIOEMULATOR_HH
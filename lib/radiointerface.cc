@@ -9,6 +9,7 @@
  * Implementation of RadioInterface
  * ********************************************************************************************* */
 RadioInterface::RadioInterface()
+  : _metrics()
 {
 	// pass...
 }
@@ -28,3 +29,13 @@ RadioInterface::reboot(const ErrorStack &err) {
   Q_UNUSED(err)
   return true;
 }
+
+const TransferMetrics &
+RadioInterface::metrics() const {
+  return _metrics;
+}
+
+TransferMetrics &
+RadioInterface::metrics() {
+  return _metrics;
+}
@@ -8,6 +8,7 @@
 #include "usbdevice.hh"
 #include "radioinfo.hh"
 #include "errorstack.hh"
+#include "transfermetrics.hh"
 
 /** Abstract radio interface.
  * A radion interface must provide means to communicate with the device. That is, open a connection
@@ -90,6 +91,15 @@ public:
    * this function does nothing.
    * @param err Passes an error stack to put error messages on. */
   virtual bool reboot(const ErrorStack &err=ErrorStack());
+
+  /** Returns the transfer statistics recorded by this interface. */
+  const TransferMetrics &metrics() const;
+  /** Returns the transfer statistics recorded by this interface. */
+  TransferMetrics &metrics();
+
+protected:
+  /** Transfer statistics. */
+  TransferMetrics _metrics;
 };
 
 #endif // RADIOINFERFACE_HH
@@ -0,0 +1,153 @@
+#include "taskgroup.hh"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <algorithm>
+
+
+/* ********************************************************************************************* *
+ * Internal state shared between the workers of a task group
+ * ********************************************************************************************* */
+/** The state of a running task group, shared by all workers.
+ * The tasks are claimed in order through an atomic counter. A task is skipped, if any task
+ * preceding it has failed. */
+class TaskGroupState
+{
+public:
+  /** Constructor. */
+  explicit TaskGroupState(const std::vector<TaskGroup::Task> &tasks)
+    : tasks(tasks), errors(tasks.size()), next(0), firstFailed(int(tasks.size())),
+      pending(int(tasks.size()))
+  {
+    // pass...
+  }
+
+  /** Runs tasks until all tasks are claimed. */
+  void work() {
+    int n = int(tasks.size());
+    for (int i=next.fetchAndAddOrdered(1); i<n; i=next.fetchAndAddOrdered(1)) {
+      if ((firstFailed.loadAcquire() > i) && (! tasks[i](errors[i])))
+        setFailed(i);
+      QMutexLocker locker(&mutex);
+      if (0 == (--pending))
+        finished.wakeAll();
+    }
+  }
+
+  /** Waits for all tasks to finish. */
+  void wait() {
+    QMutexLocker locker(&mutex);
+    while (0 < pending)
+      finished.wait(&mutex);
+  }
+
+protected:
+  /** Records the failed task, if it precedes all other failed tasks. */
+  void setFailed(int i) {
+    int current = firstFailed.loadAcquire();
+    while ((i < current) && (! firstFailed.testAndSetOrdered(current, i)))
+      current = firstFailed.loadAcquire();
+  }
+
+public:
+  /** A copy of the tasks. */
+  std::vector<TaskGroup::Task> tasks;
+  /** An error stack for each task. */
+  std::vector<ErrorStack> errors;
+  /** The index of the next task to claim. */
+  QAtomicInt next;
+  /** The index of the first failed task or the number of tasks if none failed. */
+  QAtomicInt firstFailed;
+  /** The number of tasks not finished yet, guarded by the mutex. */
+  int pending;
+  /** Guards the number of pending tasks. */
+  QMutex mutex;
+  /** Signals that all tasks are finished. */
+  QWaitCondition finished;
+};
+
+
+/** Runs the tasks of a group within the thread pool. */
+class TaskGroupWorker: public QRunnable
+{
+public:
+  /** Constructor. */
+  explicit TaskGroupWorker(const QSharedPointer<TaskGroupState> &state)
+    : QRunnable(), _state(state)
+  {
+    // pass...
+  }
+
+  void run() {
+    _state->work();
+  }
+
+protected:
+  /** The shared state. The worker may be started after the group has finished. */
+  QSharedPointer<TaskGroupState> _state;
+};
+
+
+/* ********************************************************************************************* *
+ * Implementation of TaskGroup
+ * ********************************************************************************************* */
+TaskGroup::TaskGroup(bool parallel)
+  : _parallel(parallel), _tasks()
+{
+  // pass...
+}
+
+bool
+TaskGroup::isParallel() const {
+  return _parallel;
+}
+
+int
+TaskGroup::count() const {
+  return int(_tasks.size());
+}
+
+void
+TaskGroup::add(const Task &task) {
+  _tasks.push_back(task);
+}
+
+void
+TaskGroup::addRanges(int count, int chunkSize, const std::function<bool (int, int, const ErrorStack &)> &task) {
+  if (0 >= chunkSize)
+    chunkSize = count;
+  for (int first=0; first<count; first+=chunkSize) {
+    int last = std::min(first+chunkSize, count);
+    add([task, first, last](const ErrorStack &err) { return task(first, last, err); });
+  }
+}
+
+bool
+TaskGroup::run(const ErrorStack &err) {
+  if ((! _parallel) || (2 > count())) {
+    for (size_t i=0; i<_tasks.size(); i++) {
+      if (! _tasks[i](err))
+        return false;
+    }
+    return true;
+  }
+
+  QSharedPointer<TaskGroupState> state(new TaskGroupState(_tasks));
+  QThreadPool *pool = QThreadPool::globalInstance();
+  int helpers = std::min(int(_tasks.size())-1, pool->maxThreadCount());
+  for (int i=0; i<helpers; i++)
+    pool->start(new TaskGroupWorker(state));
+
+  // Participate, then wait for the helpers to finish their last task
+  state->work();
+  state->wait();
+
+  // Collect error messages of all tasks up to the first failed one in order
+  int failed = state->firstFailed.loadAcquire();
+  for (int i=0; (i<=failed) && (i<count()); i++)
+    err.take(state->errors[i]);
+  return failed >= count();
+}
@@ -0,0 +1,56 @@
+#ifndef TASKGROUP_HH
+#define TASKGROUP_HH
+
+#include <functional>
+#include <vector>
+#include "errorstack.hh"
+
+/** A group of independent tasks, that can be run either sequentially or in parallel.
+ *
+ * This class is used to split the encoding of codeplugs into independent parts (e.g., sections or
+ * ranges of elements). In parallel mode, the tasks are executed by the global @c QThreadPool as
+ * well as the calling thread. Hence running a group never blocks, even if the thread pool is busy.
+ *
+ * The result does not depend on the mode. In sequential mode, the tasks are run in the order
+ * they were added, until the first task fails. In parallel mode, tasks following a failed one get
+ * skipped once the failure is known. The error messages of all tasks up to the first failed one
+ * (w.r.t. the order they were added) get reported in order. Every task preceding the failed one
+ * was started before it, hence the reported errors are identical to those of the sequential mode.
+ *
+ * Tasks must not modify any state shared with other tasks of the same group.
+ *
+ * @ingroup util */
+class TaskGroup
+{
+public:
+  /** The task type. The task gets its own error stack and returns @c false on error. */
+  typedef std::function<bool(const ErrorStack &err)> Task;
+
+public:
+  /** Constructs an empty task group.
+   * @param parallel If @c true, the tasks are run in parallel. */
+  explicit TaskGroup(bool parallel=true);
+
+  /** Returns @c true if the tasks are run in parallel. */
+  bool isParallel() const;
+  /** Returns the number of tasks. */
+  int count() const;
+
+  /** Adds a task to the group. */
+  void add(const Task &task);
+  /** Adds a task for each of the index ranges [first, last) of @c count items. Each range spans at
+   * most @c chunkSize items. */
+  void addRanges(int count, int chunkSize, const std::function<bool(int first, int last, const ErrorStack &err)> &task);
+
+  /** Runs all tasks and waits for them to finish.
+   * @returns @c false if any task failed. */
+  bool run(const ErrorStack &err=ErrorStack());
+
+protected:
+  /** If @c true, the tasks are run in parallel. */
+  bool _parallel;
+  /** The tasks of the group. */
+  std::vector<Task> _tasks;
+};
+
+#endif // TASKGROUP_HH
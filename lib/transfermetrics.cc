@@ -0,0 +1,114 @@
+#include "transfermetrics.hh"
+#include <cstring>
+
+
+/* ********************************************************************************************* *
+ * Implementation of TransferMetrics::Timer
+ * ********************************************************************************************* */
+TransferMetrics::Timer::Timer(TransferMetrics &metrics, Operation op, size_t bytes)
+  : _metrics(metrics), _operation(op), _bytes(bytes), _timer()
+{
+  _timer.start();
+}
+
+TransferMetrics::Timer::~Timer() {
+  _metrics.record(_operation, _timer.nsecsElapsed()/1000, _bytes);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of TransferMetrics
+ * ********************************************************************************************* */
+TransferMetrics::TransferMetrics()
+{
+  clear();
+}
+
+void
+TransferMetrics::clear() {
+  memset(_counters, 0, sizeof(_counters));
+}
+
+bool
+TransferMetrics::isEmpty() const {
+  for (int i=0; i<NumOperations; i++) {
+    if (_counters[i].calls || _counters[i].retries || _counters[i].timeouts)
+      return false;
+  }
+  return true;
+}
+
+void
+TransferMetrics::record(Operation op, uint64_t usec, size_t bytes) {
+  Counter &c = _counters[op];
+  if ((0 == c.calls) || (usec < c.minUs))
+    c.minUs = usec;
+  if (usec > c.maxUs)
+    c.maxUs = usec;
+  c.calls++;
+  c.bytes += bytes;
+  c.totalUs += usec;
+
+  int bin = 0;
+  while ((usec >>= 1) && (bin < (NumBins-1)))
+    bin++;
+  c.bins[bin]++;
+}
+
+void
+TransferMetrics::addRetry(Operation op) {
+  _counters[op].retries++;
+}
+
+void
+TransferMetrics::addTimeout(Operation op) {
+  _counters[op].timeouts++;
+}
+
+const TransferMetrics::Counter &
+TransferMetrics::counter(Operation op) const {
+  return _counters[op];
+}
+
+void
+TransferMetrics::dump(QTextStream &stream) const {
+  stream << "Transfer statistics:\n";
+  for (int i=0; i<NumOperations; i++) {
+    const Counter &c = _counters[i];
+    if ((0 == c.calls) && (0 == c.retries) && (0 == c.timeouts))
+      continue;
+    double total = double(c.totalUs)/1e3, mean = c.calls ? total/c.calls : 0;
+    stream << " " << operationName(Operation(i)) << ": " << c.calls << " calls";
+    if (c.bytes)
+      stream << ", " << c.bytes << "b";
+    stream << ", " << c.retries << " retries, " << c.timeouts << " timeouts\n";
+    stream << "  time: total " << QString::number(total, 'f', 1) << "ms, min "
+           << QString::number(double(c.minUs)/1e3, 'f', 3) << "ms, mean "
+           << QString::number(mean, 'f', 3) << "ms, max "
+           << QString::number(double(c.maxUs)/1e3, 'f', 3) << "ms";
+    if (c.bytes && c.totalUs)
+      stream << ", " << QString::number(double(c.bytes)/(double(c.totalUs)/1e6)/1024, 'f', 1)
+             << "kb/s";
+    stream << "\n";
+    stream << "  latency:";
+    for (int b=0; b<NumBins; b++) {
+      if (0 == c.bins[b])
+        continue;
+      stream << " [" << (uint64_t(1)<<b) << "us, " << (uint64_t(1)<<(b+1)) << "us): " << c.bins[b];
+    }
+    stream << "\n";
+  }
+}
+
+QString
+TransferMetrics::operationName(Operation op) {
+  switch (op) {
+  case Read: return "read";
+  case Write: return "write";
+  case Erase: return "erase";
+  case EnterProgramMode: return "enter program mode";
+  case LeaveProgramMode: return "leave program mode";
+  default: break;
+  }
+  return "unknown";
+}
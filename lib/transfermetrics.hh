@@ -0,0 +1,103 @@
+#ifndef TRANSFERMETRICS_HH
+#define TRANSFERMETRICS_HH
+
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QString>
+
+/** Collects some statistics about the transfers between the computer and a radio.
+ *
+ * For each operation (read, write, erase, entering and leaving the program mode), the number of
+ * calls, the number of bytes moved, the number of retries and timeouts as well as a histogram
+ * of the latencies are recorded. The latency histogram uses logarithmic bins, where bin @c i
+ * counts all calls that took between 2^i and 2^(i+1) micro seconds.
+ *
+ * @ingroup rif */
+class TransferMetrics
+{
+public:
+  /** The operations to record. */
+  enum Operation {
+    Read = 0,           ///< Reading memory from the device.
+    Write,              ///< Writing memory to the device.
+    Erase,              ///< Erasing memory of the device.
+    EnterProgramMode,   ///< Entering the program mode.
+    LeaveProgramMode,   ///< Leaving the program mode (or rebooting the device).
+    NumOperations       ///< Number of operations, not an operation.
+  };
+
+  /** Number of latency histogram bins. */
+  static const int NumBins = 24;
+
+  /** Counters for a single operation. */
+  struct Counter {
+    /** Number of calls. */
+    unsigned calls;
+    /** Number of bytes moved. */
+    uint64_t bytes;
+    /** Number of retries. */
+    unsigned retries;
+    /** Number of timeouts. */
+    unsigned timeouts;
+    /** Total time spent in micro seconds. */
+    uint64_t totalUs;
+    /** Shortest call in micro seconds. */
+    uint64_t minUs;
+    /** Longest call in micro seconds. */
+    uint64_t maxUs;
+    /** Latency histogram. */
+    unsigned bins[NumBins];
+  };
+
+  /** Measures the duration of a single call and records it on destruction. */
+  class Timer
+  {
+  public:
+    /** Starts the timer for the given operation moving @c bytes bytes. */
+    Timer(TransferMetrics &metrics, Operation op, size_t bytes=0);
+    /** Records the operation. */
+    ~Timer();
+
+  protected:
+    /** The metrics to record the operation in. */
+    TransferMetrics &_metrics;
+    /** The operation. */
+    Operation _operation;
+    /** The number of bytes moved. */
+    size_t _bytes;
+    /** The actual timer. */
+    QElapsedTimer _timer;
+  };
+
+public:
+  /** Empty constructor. */
+  TransferMetrics();
+
+  /** Resets all counters. */
+  void clear();
+  /** Returns @c true if nothing was recorded yet. */
+  bool isEmpty() const;
+
+  /** Records a single call of the given operation. */
+  void record(Operation op, uint64_t usec, size_t bytes=0);
+  /** Counts a retry of the given operation. */
+  void addRetry(Operation op);
+  /** Counts a timeout of the given operation. */
+  void addTimeout(Operation op);
+
+  /** Returns the counters of the given operation. */
+  const Counter &counter(Operation op) const;
+
+  /** Dumps a textual representation of the metrics into the given stream. */
+  void dump(QTextStream &stream) const;
+
+public:
+  /** Returns a human readable name of the given operation. */
+  static QString operationName(Operation op);
+
+protected:
+  /** The counters for each operation. */
+  Counter _counters[NumOperations];
+};
+
+#endif // TRANSFERMETRICS_HH
@@ -112,20 +112,20 @@ TyTCallsignDB::EntryElement::clear() {
 }
 
 void
-TyTCallsignDB::EntryElement::set(const UserDatabase::User &user) {
+TyTCallsignDB::EntryElement::set(const UserDatabase::UserView &user) {
   // Set id
-  *((uint32_t *)(_data + 0x0000)) = qToLittleEndian(user.id);
+  *((uint32_t *)(_data + 0x0000)) = qToLittleEndian(user.id());
   _data[3] = 0xff;
 
   // Set call
-  encode_ascii(_data + 0x0004, user.call, 16);
+  encode_ascii(_data + 0x0004, user.call(), 16);
 
   // Set name
-  QString name = user.name;
-  if (! user.surname.isEmpty())
-    name += " " + user.surname;
-  if (! user.country.isEmpty())
-    name += ", " + user.country;
+  QString name = user.name(), surname = user.surname(), country = user.country();
+  if (! surname.isEmpty())
+    name += " " + surname;
+  if (! country.isEmpty())
+    name += ", " + country;
   encode_ascii(_data + 0x0014, name, 100);
 }
 
@@ -148,36 +148,38 @@ bool
 TyTCallsignDB::encode(UserDatabase *db, const Selection &selection, const ErrorStack &err) {
   Q_UNUSED(err)
 
-  // Allocate space for callsign db
-  size_t n = db->count();
+  // Determine size of callsign db
+  size_t n = std::min(size_t(db->count()), size_t(MAX_CALLSIGNS));
   if (selection.hasCountLimit())
     n = std::min(n, selection.countLimit());
+
+  // Select up to n users matching the filters and closest to the prefixes, sorted in ascending
+  // order of their IDs
+  QVector<UserDatabase::UserView> users = db->select(selection, n);
+  n = users.size();
+
+  // Allocate space for callsign db
   alloate(n);
 
   // Clear DB index
   clearIndex();
 
-  // Select n users and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  for (unsigned i=0; i<n; i++)
-    users.append(db->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
-
   // Store number of entries
   setNumEntries(n);
+  if (0 == n)
+    return true;
 
   // First index entry
   int  j = 0;
-  setIndexEntry(j++, users[0].id, 1);
-  unsigned cidh = (users[0].id >> 12);
+  setIndexEntry(j++, users[0].id(), 1);
+  unsigned cidh = (users[0].id() >> 12);
 
   // Store users and update index
   for (unsigned i=0; i<n; i++) {
     setEntry(i, users[i]);
-    unsigned idh = (users[i].id >> 12);
+    unsigned idh = (users[i].id() >> 12);
     if (idh != cidh) {
-      setIndexEntry(j++,users[i].id, i+1);
+      setIndexEntry(j++,users[i].id(), i+1);
       cidh = idh;
     }
   }
@@ -212,7 +214,7 @@ TyTCallsignDB::setIndexEntry(unsigned n, unsigned id, unsigned index) {
 }
 
 void
-TyTCallsignDB::setEntry(unsigned n, const UserDatabase::User &user) {
+TyTCallsignDB::setEntry(unsigned n, const UserDatabase::UserView &user) {
   // Get pointer to entry
   EntryElement(data(ADDR_CALLSIGNS + n*CALLSIGN_ENTRY_SIZE)).set(user);
 }
@@ -91,7 +91,7 @@ public:
     void clear();
 
     /** Encodes the given user. */
-    virtual void set(const UserDatabase::User &user);
+    virtual void set(const UserDatabase::UserView &user);
   };
 
 protected:
@@ -115,7 +115,7 @@ protected:
   /** Sets the given index entry. */
   virtual void setIndexEntry(unsigned n, unsigned id, unsigned index);
   /** Sets a given call-sign entry. */
-  virtual void setEntry(unsigned n, const UserDatabase::User &user);
+  virtual void setEntry(unsigned n, const UserDatabase::UserView &user);
 };
 
 #endif // TYTCALLSIGNDB_HH
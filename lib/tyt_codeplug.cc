@@ -6,6 +6,7 @@
 #include "gpssystem.hh"
 #include "config.h"
 #include "logger.hh"
+#include "taskgroup.hh"
 #include "tyt_extensions.hh"
 #include "encryptionextension.hh"
 #include <QTimeZone>
@@ -39,7 +40,8 @@ TyTCodeplug::ChannelElement::~ChannelElement() {
 
 bool
 TyTCodeplug::ChannelElement::isValid() const {
-  return Element::isValid() && (0x0000 != getUInt16_be(0x20)) && (0xffff != getUInt16_be(0x20));
+  return Element::isValid() && (0x0000 != Layout::UInt16_be<0x20>::get(_data))
+      && (0xffff != Layout::UInt16_be<0x20>::get(_data));
 }
 
 void
@@ -49,7 +51,7 @@ TyTCodeplug::ChannelElement::clear() {
   setMode(MODE_ANALOG);
   setBandwidth(AnalogChannel::Bandwidth::Narrow);
   enableAutoScan(0);
-  setBit(0, 1); setBit(0,2);
+  Layout::Bit<0, 1>::set(_data, true); Layout::Bit<0, 2>::set(_data, true);
   enableLoneWorker(false);
   enableTalkaround(false);
   enableRXOnly(false);
@@ -60,19 +62,20 @@ TyTCodeplug::ChannelElement::clear() {
   enablePrivateCallConfirm(false);
   enableDataCallConfirm(false);
   setRXRefFrequency(TyTChannelExtension::RefFrequency::Low);
-  clearBit(3,2);
+  Layout::Bit<3, 2>::set(_data, false);
   enableEmergencyAlarmACK(false);
-  clearBit(3,4); setBit(3,5); setBit(3,6);
+  Layout::Bit<3, 4>::set(_data, false);
+  Layout::Bit<3, 5>::set(_data, true); Layout::Bit<3, 6>::set(_data, true);
   enableDisplayPTTId(true);
   setTXRefFrequency(TyTChannelExtension::RefFrequency::Low);
-  setBit(4,2); clearBit(4,3);
+  Layout::Bit<4, 2>::set(_data, true); Layout::Bit<4, 3>::set(_data, false);
   enableVOX(false);
-  setBit(4,5);
+  Layout::Bit<4, 5>::set(_data, true);
   setAdmitCriterion(ADMIT_ALWAYS);
-  clearBit(5,0);
+  Layout::Bit<5, 0>::set(_data, false);
   setContactIndex(0);
   setTXTimeOut(0);
-  clearBit(8,6);
+  Layout::Bit<8, 6>::set(_data, false);
   setTXTimeOutRekeyDelay(0);
   setEmergencySystemIndex(0);
   setScanListIndex(0);
@@ -86,248 +89,251 @@ TyTCodeplug::ChannelElement::clear() {
   setTXSignaling(Signaling::SIGNALING_NONE);
   setRXSignalingSystemIndex(0);
   setTXSignalingSystemIndex(0);
-  setBit(30,2); setBit(30,3); setBit(30,4); setBit(30,5); setBit(30,6); setBit(30,7);
+  Layout::Bit<30, 2>::set(_data, true); Layout::Bit<30, 3>::set(_data, true);
+  Layout::Bit<30, 4>::set(_data, true); Layout::Bit<30, 5>::set(_data, true);
+  Layout::Bit<30, 6>::set(_data, true); Layout::Bit<30, 7>::set(_data, true);
   enableTXGPSInfo(true);
   enableRXGPSInfo(true);
-  setBit(31, 5); setBit(31, 6); setBit(31, 7);
+  Layout::Bit<31, 5>::set(_data, true); Layout::Bit<31, 6>::set(_data, true);
+  Layout::Bit<31, 7>::set(_data, true);
   memset((_data+32), 0x00, sizeof(32));
 }
 
 
 TyTCodeplug::ChannelElement::Mode
 TyTCodeplug::ChannelElement::mode() const {
-  return TyTCodeplug::ChannelElement::Mode(getUInt2(0, 0));
+  return TyTCodeplug::ChannelElement::Mode(Layout::UInt2<0, 0>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setMode(Mode mode) {
-  setUInt2(0,0, uint8_t(mode));
+  Layout::UInt2<0, 0>::set(_data, uint8_t(mode));
 }
 
 AnalogChannel::Bandwidth
 TyTCodeplug::ChannelElement::bandwidth() const {
-  if (0 == getUInt2(0, 2))
+  if (0 == Layout::UInt2<0, 2>::get(_data))
     return AnalogChannel::Bandwidth::Narrow;
   return AnalogChannel::Bandwidth::Wide;
 }
 void
 TyTCodeplug::ChannelElement::setBandwidth(AnalogChannel::Bandwidth bw) {
   if (AnalogChannel::Bandwidth::Narrow == bw)
-    setUInt2(0, 2, BW_12_5_KHZ);
+    Layout::UInt2<0, 2>::set(_data, BW_12_5_KHZ);
   else
-    setUInt2(0, 2, BW_25_KHZ);
+    Layout::UInt2<0, 2>::set(_data, BW_25_KHZ);
 }
 
 bool
 TyTCodeplug::ChannelElement::autoScan() const {
-  return getBit(0, 4);
+  return Layout::Bit<0, 4>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableAutoScan(bool enable) {
-  setBit(0, 4, enable);
+  Layout::Bit<0, 4>::set(_data, enable);
 }
 
 bool
 TyTCodeplug::ChannelElement::loneWorker() const {
-  return getBit(0, 7);
+  return Layout::Bit<0, 7>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableLoneWorker(bool enable) {
-  setBit(0, 7, enable);
+  Layout::Bit<0, 7>::set(_data, enable);
 }
 
 bool
 TyTCodeplug::ChannelElement::talkaround() const {
-  return ! getBit(1, 0);
+  return ! Layout::Bit<1, 0>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableTalkaround(bool enable) {
-  setBit(1, 0, !enable);
+  Layout::Bit<1, 0>::set(_data, !enable);
 }
 
 bool
 TyTCodeplug::ChannelElement::rxOnly() const {
-  return getBit(1, 1);
+  return Layout::Bit<1, 1>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableRXOnly(bool enable) {
-  setBit(1, 1, enable);
+  Layout::Bit<1, 1>::set(_data, enable);
 }
 
 DigitalChannel::TimeSlot
 TyTCodeplug::ChannelElement::timeSlot() const {
-  if (2 == getUInt2(1,2))
+  if (2 == Layout::UInt2<1, 2>::get(_data))
     return DigitalChannel::TimeSlot::TS2;
   return DigitalChannel::TimeSlot::TS1;
 }
 void
 TyTCodeplug::ChannelElement::setTimeSlot(DigitalChannel::TimeSlot ts) {
   if (DigitalChannel::TimeSlot::TS1 == ts)
-    setUInt2(1,2,1);
+    Layout::UInt2<1, 2>::set(_data, 1);
   else
-    setUInt2(1,2,2);
+    Layout::UInt2<1, 2>::set(_data, 2);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::colorCode() const {
-  return getUInt4(1,4);
+  return Layout::UInt4<1, 4>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setColorCode(uint8_t cc) {
-  setUInt4(1,4, std::min(uint8_t(16), cc));
+  Layout::UInt4<1, 4>::set(_data, std::min(uint8_t(16), cc));
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::privacyIndex() const {
-  return getUInt4(2,0);
+  return Layout::UInt4<2, 0>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setPrivacyIndex(uint8_t idx) {
-  setUInt4(2,0, idx);
+  Layout::UInt4<2, 0>::set(_data, idx);
 }
 
 TyTCodeplug::ChannelElement::PrivacyType
 TyTCodeplug::ChannelElement::privacyType() const {
-  return TyTCodeplug::ChannelElement::PrivacyType(getUInt2(2,4));
+  return TyTCodeplug::ChannelElement::PrivacyType(Layout::UInt2<2, 4>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setPrivacyType(TyTCodeplug::ChannelElement::PrivacyType type) {
-  setUInt2(2,4, uint8_t(type));
+  Layout::UInt2<2, 4>::set(_data, uint8_t(type));
 }
 
 bool
 TyTCodeplug::ChannelElement::privateCallConfirm() const {
-  return getBit(2, 6);
+  return Layout::Bit<2, 6>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enablePrivateCallConfirm(bool enable) {
-  setBit(2, 6, enable);
+  Layout::Bit<2, 6>::set(_data, enable);
 }
 
 bool
 TyTCodeplug::ChannelElement::dataCallConfirm() const {
-  return getBit(2, 7);
+  return Layout::Bit<2, 7>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableDataCallConfirm(bool enable) {
-  setBit(2, 7, enable);
+  Layout::Bit<2, 7>::set(_data, enable);
 }
 
 TyTChannelExtension::RefFrequency
 TyTCodeplug::ChannelElement::rxRefFrequency() const {
-  return TyTChannelExtension::RefFrequency(getUInt2(3,0));
+  return TyTChannelExtension::RefFrequency(Layout::UInt2<3, 0>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setRXRefFrequency(TyTChannelExtension::RefFrequency ref) {
-  setUInt2(3,0, uint8_t(ref));
+  Layout::UInt2<3, 0>::set(_data, uint8_t(ref));
 }
 
 bool
 TyTCodeplug::ChannelElement::emergencyAlarmACK() const {
-  return getBit(3,3);
+  return Layout::Bit<3, 3>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableEmergencyAlarmACK(bool enable) {
-  setBit(3,3, enable);
+  Layout::Bit<3, 3>::set(_data, enable);
 }
 
 bool
 TyTCodeplug::ChannelElement::displayPTTId() const {
-  return ! getBit(3,7);
+  return ! Layout::Bit<3, 7>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableDisplayPTTId(bool enable) {
-  setBit(3,7, !enable);
+  Layout::Bit<3, 7>::set(_data, !enable);
 }
 
 TyTChannelExtension::RefFrequency
 TyTCodeplug::ChannelElement::txRefFrequency() const {
-  return TyTChannelExtension::RefFrequency(getUInt2(4,0));
+  return TyTChannelExtension::RefFrequency(Layout::UInt2<4, 0>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setTXRefFrequency(TyTChannelExtension::RefFrequency ref) {
-  setUInt2(4,0, uint8_t(ref));
+  Layout::UInt2<4, 0>::set(_data, uint8_t(ref));
 }
 
 bool
 TyTCodeplug::ChannelElement::vox() const {
-  return getBit(4,4);
+  return Layout::Bit<4, 4>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableVOX(bool enable) {
   if (enable)
     logDebug() << "Enable VOX!";
-  setBit(4,4, enable);
+  Layout::Bit<4, 4>::set(_data, enable);
 }
 
 TyTCodeplug::ChannelElement::Admit
 TyTCodeplug::ChannelElement::admitCriterion() const {
-  return TyTCodeplug::ChannelElement::Admit(getUInt2(4,6));
+  return TyTCodeplug::ChannelElement::Admit(Layout::UInt2<4, 6>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setAdmitCriterion(TyTCodeplug::ChannelElement::Admit admit) {
-  setUInt2(4,6, uint8_t(admit));
+  Layout::UInt2<4, 6>::set(_data, uint8_t(admit));
 }
 
 uint16_t
 TyTCodeplug::ChannelElement::contactIndex() const {
-  return getUInt16_le(6);
+  return Layout::UInt16_le<6>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setContactIndex(uint16_t idx) {
-  setUInt16_le(6, idx);
+  Layout::UInt16_le<6>::set(_data, idx);
 }
 
 unsigned TyTCodeplug::ChannelElement::txTimeOut() const {
-  return getUInt6(8, 0)*15;
+  return Layout::UInt6<8, 0>::get(_data)*15;
 }
 void
 TyTCodeplug::ChannelElement::setTXTimeOut(unsigned tot) {
-  return setUInt6(8, 0, tot/15);
+  return Layout::UInt6<8, 0>::set(_data, tot/15);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::txTimeOutRekeyDelay() const {
-  return getUInt8(9);
+  return Layout::UInt8<9>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setTXTimeOutRekeyDelay(uint8_t delay) {
-  return setUInt8(9, delay);
+  return Layout::UInt8<9>::set(_data, delay);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::emergencySystemIndex() const {
-  return getUInt8(10);
+  return Layout::UInt8<10>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setEmergencySystemIndex(uint8_t delay) {
-  return setUInt8(10, delay);
+  return Layout::UInt8<10>::set(_data, delay);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::scanListIndex() const {
-  return getUInt8(11);
+  return Layout::UInt8<11>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setScanListIndex(uint8_t idx) {
-  return setUInt8(11, idx);
+  return Layout::UInt8<11>::set(_data, idx);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::groupListIndex() const {
-  return getUInt8(12);
+  return Layout::UInt8<12>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setGroupListIndex(uint8_t idx) {
-  return setUInt8(12, idx);
+  return Layout::UInt8<12>::set(_data, idx);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::positioningSystemIndex() const {
-  return getUInt8(13);
+  return Layout::UInt8<13>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setPositioningSystemIndex(uint8_t idx) {
-  return setUInt8(13, idx);
+  return Layout::UInt8<13>::set(_data, idx);
 }
 
 bool
@@ -341,83 +347,83 @@ TyTCodeplug::ChannelElement::setDTMFDecode(uint8_t idx, bool enable) {
 
 uint32_t
 TyTCodeplug::ChannelElement::rxFrequency() const {
-  return getBCD8_le(16)*10;
+  return Layout::BCD8_le<16>::get(_data)*10;
 }
 void
 TyTCodeplug::ChannelElement::setRXFrequency(uint32_t freq_Hz) {
-  return setBCD8_le(16, freq_Hz/10);
+  return Layout::BCD8_le<16>::set(_data, freq_Hz/10);
 }
 
 uint32_t
 TyTCodeplug::ChannelElement::txFrequency() const {
-  return getBCD8_le(20)*10;
+  return Layout::BCD8_le<20>::get(_data)*10;
 }
 void
 TyTCodeplug::ChannelElement::setTXFrequency(uint32_t freq_Hz) {
-  return setBCD8_le(20, freq_Hz/10);
+  return Layout::BCD8_le<20>::set(_data, freq_Hz/10);
 }
 
 Signaling::Code
 TyTCodeplug::ChannelElement::rxSignaling() const {
-  return decode_ctcss_tone_table(getUInt16_le(24));
+  return decode_ctcss_tone_table(Layout::UInt16_le<24>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setRXSignaling(Signaling::Code code) {
-  setUInt16_le(24, encode_ctcss_tone_table(code));
+  Layout::UInt16_le<24>::set(_data, encode_ctcss_tone_table(code));
 }
 
 Signaling::Code
 TyTCodeplug::ChannelElement::txSignaling() const {
-  return decode_ctcss_tone_table(getUInt16_le(26));
+  return decode_ctcss_tone_table(Layout::UInt16_le<26>::get(_data));
 }
 void
 TyTCodeplug::ChannelElement::setTXSignaling(Signaling::Code code) {
-  setUInt16_le(26, encode_ctcss_tone_table(code));
+  Layout::UInt16_le<26>::set(_data, encode_ctcss_tone_table(code));
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::rxSignalingSystemIndex() const {
-  return getUInt8(28);
+  return Layout::UInt8<28>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setRXSignalingSystemIndex(uint8_t idx) {
-  setUInt8(28, idx);
+  Layout::UInt8<28>::set(_data, idx);
 }
 
 uint8_t
 TyTCodeplug::ChannelElement::txSignalingSystemIndex() const {
-  return getUInt8(29);
+  return Layout::UInt8<29>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setTXSignalingSystemIndex(uint8_t idx) {
-  setUInt8(29, idx);
+  Layout::UInt8<29>::set(_data, idx);
 }
 
 bool
 TyTCodeplug::ChannelElement::txGPSInfo() const {
-  return ! getBit(31, 0);
+  return ! Layout::Bit<31, 0>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableTXGPSInfo(bool enable) {
-  setBit(31,0, !enable);
+  Layout::Bit<31, 0>::set(_data, !enable);
 }
 
 bool
 TyTCodeplug::ChannelElement::rxGPSInfo() const {
-  return !getBit(31, 1);
+  return !Layout::Bit<31, 1>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::enableRXGPSInfo(bool enable) {
-  setBit(31,1, !enable);
+  Layout::Bit<31, 1>::set(_data, !enable);
 }
 
 QString
 TyTCodeplug::ChannelElement::name() const {
-  return readUnicode(32, 16, 0x0000);
+  return Layout::Unicode<32, 16, 0x0000>::get(_data);
 }
 void
 TyTCodeplug::ChannelElement::setName(const QString &name) {
-  return writeUnicode(32, name, 16, 0x0000);
+  return Layout::Unicode<32, 16, 0x0000>::set(_data, name);
 }
 
 Channel *
@@ -2851,61 +2857,94 @@ TyTCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &
     errMsg(err) << "Cannot encode time-stamp.";
     return false;
   }
+
+  // All sections are written into disjoint memory regions, hence they may be encoded in parallel.
+  TaskGroup tasks(flags.parallelEncode);
+
   // General config
-  if (! this->encodeGeneralSettings(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode general settings.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeGeneralSettings(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode general settings.";
+      return false;
+    }
+    return true;
+  });
 
   // Define Contacts
-  if (! this->encodeContacts(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode contacts.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeContacts(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode contacts.";
+      return false;
+    }
+    return true;
+  });
 
   // Define RX GroupLists
-  if (! this->encodeGroupLists(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode group lists.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeGroupLists(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode group lists.";
+      return false;
+    }
+    return true;
+  });
 
   // Define encryption keys
-  if (! this->encodePrivacyKeys(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode encryption keys.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodePrivacyKeys(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode encryption keys.";
+      return false;
+    }
+    return true;
+  });
 
   // Define Channels
-  if (! this->encodeChannels(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode channels.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeChannels(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode channels.";
+      return false;
+    }
+    return true;
+  });
 
   // Define Zones
-  if (! this->encodeZones(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode zones.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeZones(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode zones.";
+      return false;
+    }
+    return true;
+  });
 
   // Define Scanlists
-  if (! this->encodeScanLists(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode scan lists.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeScanLists(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode scan lists.";
+      return false;
+    }
+    return true;
+  });
 
   // Define GPS systems
-  if (! this->encodePositioningSystems(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode positioning systems.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodePositioningSystems(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode positioning systems.";
+      return false;
+    }
+    return true;
+  });
 
   // Encode button settings
-  if (! this->encodeButtonSettings(ctx.config(), flags, ctx)) {
-    errMsg(err) << "Cannot encode button settings.";
-    return false;
-  }
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    if (! this->encodeButtonSettings(ctx.config(), flags, ctx)) {
+      errMsg(err) << "Cannot encode button settings.";
+      return false;
+    }
+    return true;
+  });
 
-  return true;
+  if (tasks.isParallel())
+    detach();
+  return tasks.run(err);
 }
 
 bool
@@ -249,6 +249,10 @@ public:
     virtual bool linkChannelObj(Channel *c, Context &ctx) const;
     /** Initializes this codeplug channel from the given generic configuration. */
     virtual void fromChannelObj(const Channel *c, Context &ctx);
+
+  protected:
+    /** Compile-time layout of the channel element. */
+    typedef ElementLayout<0x0040> Layout;
   };
 
   /** Represents a digital (DMR) contact within the codeplug.
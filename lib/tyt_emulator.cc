@@ -0,0 +1,161 @@
+#include "tyt_emulator.hh"
+#include "tyt_interface.hh"
+#include "logger.hh"
+#include <unistd.h>
+#include <cstring>
+#include <algorithm>
+
+#define BLOCK_SIZE 1024
+#define SECTOR_SIZE 0x10000
+#define IDENT_SIZE 64
+
+// USB request types.
+#define REQUEST_TYPE_TO_HOST    0xA1
+#define REQUEST_TYPE_TO_DEVICE  0x21
+
+// DFU requests and states, see dfu_libusb.cc
+#define REQUEST_DETACH     0
+#define REQUEST_DNLOAD     1
+#define REQUEST_UPLOAD     2
+#define REQUEST_GETSTATUS  3
+#define REQUEST_CLRSTATUS  4
+#define REQUEST_GETSTATE   5
+#define REQUEST_ABORT      6
+#define STATE_DFU_IDLE     2
+
+/* ********************************************************************************************* *
+ * Implementation of TyTEmulator
+ * ********************************************************************************************* */
+TyTEmulator::TyTEmulator(const QString &ident)
+  : RadioEmulator(TyTInterface::interfaceInfo()), _ident(ident), _address(0), _command(0),
+    _eraseTime(0), _erasedSectors(0)
+{
+  registerDevice();
+}
+
+TyTEmulator::~TyTEmulator() {
+  // pass...
+}
+
+unsigned
+TyTEmulator::eraseTime() const {
+  return _eraseTime;
+}
+
+void
+TyTEmulator::setEraseTime(unsigned usec) {
+  _eraseTime = usec;
+}
+
+unsigned
+TyTEmulator::erasedSectors() const {
+  return _erasedSectors;
+}
+
+int
+TyTEmulator::controlTransfer(uint8_t type, uint8_t request, uint16_t value, uint8_t *data, uint16_t len)
+{
+  switch (request) {
+  case REQUEST_DNLOAD:
+    if (REQUEST_TYPE_TO_DEVICE != type)
+      return -1;
+    delay(len);
+    if (0 == value)
+      return command(data, len);
+    if (2 > value)
+      return -1;
+    {
+      // Flash can only clear bits
+      uint32_t addr = _address + (value-2)*BLOCK_SIZE;
+      QByteArray current(len, 0);
+      read(0, addr, (uint8_t *)current.data(), len);
+      for (uint16_t i=0; i<len; i++)
+        current[i] = current.at(i) & data[i];
+      write(0, addr, (const uint8_t *)current.constData(), len);
+    }
+    return len;
+
+  case REQUEST_UPLOAD:
+    if (REQUEST_TYPE_TO_HOST != type)
+      return -1;
+    delay(len);
+    if (0 == value) {
+      // Response to the last command, only identify is implemented
+      memset(data, 0, len);
+      if (0xa2 == _command) {
+        QByteArray ident = _ident.toLocal8Bit().left(std::min(int(len), IDENT_SIZE)-1);
+        memcpy(data, ident.constData(), ident.size());
+      }
+      return len;
+    }
+    if (2 > value)
+      return -1;
+    read(0, _address + (value-2)*BLOCK_SIZE, data, len);
+    return len;
+
+  case REQUEST_GETSTATUS:
+    if (6 > len)
+      return -1;
+    memset(data, 0, 6);
+    data[4] = STATE_DFU_IDLE;
+    return 6;
+
+  case REQUEST_GETSTATE:
+    if (1 > len)
+      return -1;
+    data[0] = STATE_DFU_IDLE;
+    return 1;
+
+  case REQUEST_DETACH:
+  case REQUEST_CLRSTATUS:
+  case REQUEST_ABORT:
+    return 0;
+
+  default:
+    break;
+  }
+
+  return -1;
+}
+
+int
+TyTEmulator::command(const uint8_t *data, uint16_t len) {
+  if (1 > len)
+    return -1;
+
+  _command = data[0];
+  switch (data[0]) {
+  case 0x21:
+    // Set address
+    if (5 > len)
+      return -1;
+    _address = uint32_t(data[1]) | (uint32_t(data[2])<<8) | (uint32_t(data[3])<<16)
+        | (uint32_t(data[4])<<24);
+    break;
+
+  case 0x41: {
+    // Erase sector
+    if (5 > len)
+      return -1;
+    uint32_t addr = uint32_t(data[1]) | (uint32_t(data[2])<<8) | (uint32_t(data[3])<<16)
+        | (uint32_t(data[4])<<24);
+    addr -= addr % SECTOR_SIZE;
+    fill(0, addr, SECTOR_SIZE);
+    _erasedSectors++;
+    if (_eraseTime)
+      usleep(_eraseTime);
+    break;
+  }
+
+  case 0x91:
+  case 0xa2:
+    // Program mode, reboot and identify
+    break;
+
+  default:
+    logDebug() << "Emulated TyT: Unknown command 0x" << QString::number(data[0], 16) << ".";
+    break;
+  }
+
+  return len;
+}
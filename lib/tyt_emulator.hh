@@ -0,0 +1,48 @@
+#ifndef TYTEMULATOR_HH
+#define TYTEMULATOR_HH
+
+#include "radioemulator.hh"
+
+/** Emulates the DFU interface of TyT (and Retevis) radios.
+ *
+ * Implements the DFU requests issued by @c DFUDevice and the TyT command set on top of them
+ * (program mode, identify, set address, erase and reboot, see @c TyTInterface). The memory
+ * behaves like NOR flash: erasing a sector of 64kB sets it to @c 0xff while writing can only
+ * clear bits. Hence writing into sectors not erased before is detected as corruption.
+ *
+ * @ingroup emulator */
+class TyTEmulator: public RadioEmulator
+{
+public:
+  /** Constructs an emulator reporting the given identifier (e.g., "MD-UV390" or "DR780"). */
+  explicit TyTEmulator(const QString &ident="MD-UV390");
+  /** Destructor. */
+  virtual ~TyTEmulator();
+
+  /** Returns the time in micro seconds, the erasure of a sector takes. */
+  unsigned eraseTime() const;
+  /** Sets the time in micro seconds, the erasure of a sector takes. */
+  void setEraseTime(unsigned usec);
+  /** Returns the number of sectors erased so far. */
+  unsigned erasedSectors() const;
+
+  int controlTransfer(uint8_t type, uint8_t request, uint16_t value, uint8_t *data, uint16_t len);
+
+protected:
+  /** Handles a command written to block 0. */
+  int command(const uint8_t *data, uint16_t len);
+
+protected:
+  /** The identifier string. */
+  QString _ident;
+  /** The current memory address. */
+  uint32_t _address;
+  /** The last command written. */
+  uint8_t _command;
+  /** Time in micro seconds needed to erase a sector. */
+  unsigned _eraseTime;
+  /** Number of sectors erased. */
+  unsigned _erasedSectors;
+};
+
+#endif // TYTEMULATOR_HH
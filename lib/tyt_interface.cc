@@ -158,19 +158,23 @@ bool
 TyTInterface::erase(unsigned start, unsigned size, void(*progress)(unsigned, void *), void *ctx, const ErrorStack &err) {
   int error;
   // Enter Programming Mode.
-  if ((error = get_status(err)))
-    return false;
-  if ((error = wait_idle()))
-    return false;
-  if ((error = md380_command(0x91, 0x01, err)))
-    return false;
-  usleep(100000);
+  {
+    TransferMetrics::Timer timer(_metrics, TransferMetrics::EnterProgramMode);
+    if ((error = get_status(err)))
+      return false;
+    if ((error = wait_idle()))
+      return false;
+    if ((error = md380_command(0x91, 0x01, err)))
+      return false;
+    usleep(100000);
+  }
 
   unsigned end = start+size;
   start = align_addr(start, 0x10000);
   end = align_size(end, 0x10000);
   size = end-start;
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Erase, size);
   for (unsigned i=0; i<size; i+=0x10000) {
     erase_block(start+i, err);
     if (progress)
@@ -199,6 +203,7 @@ TyTInterface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes, cons
     return false;
   }
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Read, nbytes);
   uint32_t block = addr/1024;
   return 0 == upload(block+2, data, nbytes, err);
 }
@@ -225,6 +230,7 @@ TyTInterface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes, con
     return false;
   }
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::Write, nbytes);
   uint32_t block = addr/1024;
   if (download(block+2, data, nbytes, err))
     return false;
@@ -242,9 +248,10 @@ TyTInterface::write_finish(const ErrorStack &err) {
 bool
 TyTInterface::reboot(const ErrorStack &err) {
 
-  if (! _ctx)
+  if (! DFUDevice::isOpen())
     return false;
 
+  TransferMetrics::Timer timer(_metrics, TransferMetrics::LeaveProgramMode);
   if (wait_idle())
     return false;
 
@@ -2,8 +2,35 @@
 #include "config.hh"
 #include "logger.hh"
 #include "utils.hh"
+#include "codeplugcache.hh"
+#include <algorithm>
 
 #define BSIZE 1024
+#define SECTOR_SIZE 0x10000
+
+
+/** Returns the first erase sector covered by the given transfer. */
+static inline uint32_t
+tyt_first_sector(const DFUFile::Image::Transfer &t) {
+  return t.address/SECTOR_SIZE;
+}
+
+/** Returns the last erase sector covered by the given transfer. */
+static inline uint32_t
+tyt_last_sector(const DFUFile::Image::Transfer &t) {
+  return (t.address+t.size-1)/SECTOR_SIZE;
+}
+
+/** Collects all erase sectors covered by the given transfers in ascending order. */
+static void
+tyt_all_sectors(const QVector<DFUFile::Image::Transfer> &transfers, QVector<uint32_t> &sectors) {
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    for (uint32_t s=tyt_first_sector(t); s<=tyt_last_sector(t); s++) {
+      if (sectors.isEmpty() || (sectors.last() < s))
+        sectors.append(s);
+    }
+  }
+}
 
 
 TyTRadio::TyTRadio(TyTInterface *device, QObject *parent)
@@ -26,6 +53,13 @@ TyTRadio::~TyTRadio() {
   logDebug() << "Destructed TyT radio.";
 }
 
+const TransferMetrics *
+TyTRadio::metrics() const {
+  if (nullptr == _dev)
+    return nullptr;
+  return &_dev->metrics();
+}
+
 bool
 TyTRadio::startDownload(bool blocking, const ErrorStack &err) {
   if (StatusIdle != _task)
@@ -159,26 +193,26 @@ TyTRadio::download() {
       errMsg(_errorStack)
           << "Cannot download codeplug: Codeplug element " << n
           << " (addr=" << codeplug().image(0).element(n).address()
-          << ", size=" << codeplug().image(0).element(n).data().size()
+          << ", size=" << codeplug().image(0).element(n).memSize()
           << ") is not aligned with blocksize " << BSIZE;
       return false;
     }
-    totb += codeplug().image(0).element(n).data().size()/BSIZE;
+    totb += codeplug().image(0).element(n).memSize()/BSIZE;
   }
 
-  // Then download codeplug
+  // Then download codeplug, merging adjacent elements
   size_t bcount = 0;
-  for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    unsigned addr = codeplug().image(0).element(n).address();
-    unsigned size = codeplug().image(0).element(n).data().size();
-    unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-    for (unsigned b=0; b<nb; b++, bcount++) {
-      if (! _dev->read(0, (b0+b)*BSIZE, codeplug().data((b0+b)*BSIZE), BSIZE, _errorStack)) {
+  QByteArray buffer;
+  foreach (const DFUFile::Image::Transfer &t, codeplug().image(0).planTransfers()) {
+    buffer.resize(t.size);
+    for (unsigned o=0; o<t.size; o+=BSIZE, bcount++) {
+      if (! _dev->read(0, t.address+o, (uint8_t *)buffer.data()+o, BSIZE, _errorStack)) {
         errMsg(_errorStack) << "Cannot download codeplug.";
         return false;
       }
       emit downloadProgress(float(bcount*100)/totb);
     }
+    codeplug().image(0).scatter(t, buffer);
   }
 
   return true;
@@ -199,44 +233,84 @@ TyTRadio::upload() {
 
   size_t bcount = 0;
   // If codeplug gets updated, download codeplug from device first:
-  if (_codeplugFlags.updateCodePlug) {
-    for (int n=0; n<codeplug().image(0).numElements(); n++) {
-      unsigned addr = codeplug().image(0).element(n).address();
-      unsigned size = codeplug().image(0).element(n).data().size();
-      unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-      for (unsigned b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->read(0, (b0+b)*BSIZE, codeplug().data((b0+b)*BSIZE), BSIZE, _errorStack)) {
+  // The interface does not report the firmware version, hence the cache stays disabled, as a
+  // cached image may be stale after a firmware update.
+  CodeplugCache cache(_dev->identifier());
+  bool useCache = _codeplugFlags.useImageCache && cache.isEnabled();
+  QVector<uint32_t> samples;
+  bool restored = false;
+  if (useCache)
+    samples = CodeplugCache::samples(codeplug().image(0), BSIZE);
+  if (_codeplugFlags.updateCodePlug && useCache) {
+    // Assemble fingerprint from some sampled blocks and try to restore the image from the cache
+    foreach (uint32_t addr, samples) {
+      if (! _dev->read(0, addr, codeplug().data(addr), BSIZE, _errorStack)) {
+        errMsg(_errorStack) << "Cannot upload codeplug.";
+        return false;
+      }
+      cache.addFingerprint(addr, codeplug().data(addr), BSIZE);
+    }
+    if (cache.load() && cache.restore(codeplug())) {
+      logDebug() << "Restored codeplug from cache, skip read-back.";
+      restored = true;
+    }
+  }
+  QByteArray buffer;
+  if (_codeplugFlags.updateCodePlug && (! restored)) {
+    foreach (const DFUFile::Image::Transfer &t, codeplug().image(0).planTransfers()) {
+      buffer.resize(t.size);
+      for (unsigned o=0; o<t.size; o+=BSIZE, bcount+=BSIZE) {
+        if (! _dev->read(0, t.address+o, (uint8_t *)buffer.data()+o, BSIZE, _errorStack)) {
           errMsg(_errorStack) << "Cannot upload codeplug.";
           return false;
         }
         emit uploadProgress(float(bcount*50)/totb);
       }
+      codeplug().image(0).scatter(t, buffer);
     }
   }
 
+  // If only changed sectors are written, keep a copy of the device memory
+  DFUFile::Image device;
+  if (_codeplugFlags.diffUpload && _codeplugFlags.updateCodePlug)
+    device = codeplug().image(0);
+
   // Encode config into codeplug
   logDebug() << "Encode codeplug.";
   codeplug().encode(_config, _codeplugFlags);
 
-  // then erase memory
-  for (int i=0; i<codeplug().image(0).numElements(); i++)
-    _dev->erase(codeplug().image(0).element(i).address(), codeplug().image(0).element(i).memSize(),
-                nullptr, nullptr, _errorStack);
+  // Merge adjacent elements into single transfers within each erase sector. Elements may still
+  // span several sectors, hence each transfer gets handled sector by sector.
+  QVector<DFUFile::Image::Transfer> transfers = codeplug().image(0).planTransfers(0, SECTOR_SIZE);
 
-  logDebug() << "Upload " << codeplug().image(0).numElements() << " elements.";
-  // then, upload modified codeplug
-  bcount = 0;
-  for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    unsigned addr = codeplug().image(0).element(n).address();
-    unsigned size = codeplug().image(0).element(n).memSize();
-    unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-    for (size_t b=0; b<nb; b++,bcount+=BSIZE) {
-      if (! _dev->write(0, (b0+b)*BSIZE, codeplug().data((b0+b)*BSIZE), BSIZE, _errorStack)) {
-        errMsg(_errorStack) << "Cannot upload codeplug.";
-        return false;
-      }
-      emit uploadProgress(50+float(bcount*50)/totb);
+  // Collect sectors to erase and write
+  QVector<uint32_t> sectors;
+  if (_codeplugFlags.diffUpload) {
+    if (! changedSectors(codeplug().image(0), transfers,
+                         (_codeplugFlags.updateCodePlug ? &device : nullptr), sectors)) {
+      errMsg(_errorStack) << "Cannot upload codeplug.";
+      return false;
     }
+  } else {
+    tyt_all_sectors(transfers, sectors);
+  }
+
+  logDebug() << "Upload " << codeplug().image(0).numElements() << " elements in "
+             << transfers.size() << " transfers.";
+  // then, erase and upload modified codeplug
+  if (! writeSectors(codeplug().image(0), transfers, sectors, 50, 100)) {
+    errMsg(_errorStack) << "Cannot upload codeplug.";
+    return false;
+  }
+
+  // Store the image written in the cache
+  if (useCache) {
+    cache.clearFingerprint();
+    foreach (uint32_t addr, samples)
+      cache.addFingerprint(addr, codeplug().data(addr), BSIZE);
+    ErrorStack cacheErr;
+    if (! cache.store(codeplug(), cacheErr))
+      logWarn() << "Cannot store codeplug image in cache: " << cacheErr.format();
   }
 
   return true;
@@ -254,27 +328,106 @@ TyTRadio::uploadCallsigns() {
     return false;
   }
 
-  // then erase memory
-  logDebug() << "Erase memory section for call-sign DB.";
-  _dev->erase(callsignDB()->image(0).element(0).address(),
-              callsignDB()->image(0).element(0).memSize(),
-              [](unsigned percent, void *ctx) { emit ((TyTRadio *)ctx)->uploadProgress(percent/2); },
-              this, _errorStack);
+  // Skip all sectors already holding the encoded call-sign DB
+  QVector<DFUFile::Image::Transfer> transfers = callsignDB()->image(0).planTransfers(0, SECTOR_SIZE);
+  QVector<uint32_t> sectors;
+  logDebug() << "Compare call-sign DB with device memory.";
+  if (! changedSectors(callsignDB()->image(0), transfers, nullptr, sectors)) {
+    errMsg(_errorStack) << "Cannot upload callsign db.";
+    return false;
+  }
 
   logDebug() << "Upload " << callsignDB()->image(0).numElements() << " elements.";
-  // Total amount of data to transfer
-  size_t totb = callsignDB()->memSize();
-  // Upload callsign DB
-  unsigned addr = callsignDB()->image(0).element(0).address();
-  unsigned size = callsignDB()->image(0).element(0).memSize();
-  unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-  for (size_t b=0, bcount=0; b<nb; b++,bcount+=BSIZE) {
-    if (! _dev->write(0, (b0+b)*BSIZE, callsignDB()->data((b0+b)*BSIZE), BSIZE, _errorStack)) {
-      errMsg(_errorStack) << "Cannot upload codeplug.";
+  if (! writeSectors(callsignDB()->image(0), transfers, sectors, 0, 100)) {
+    errMsg(_errorStack) << "Cannot upload callsign db.";
+    return false;
+  }
+
+  return true;
+}
+
+bool
+TyTRadio::changedSectors(const DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                         const DFUFile::Image *device, QVector<uint32_t> &sectors)
+{
+  QByteArray encoded, current;
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    image.gather(t, encoded);
+    if (nullptr != device)
+      device->gather(t, current);
+    else
+      current.resize(BSIZE);
+
+    // Compare each sector covered by the transfer on its own
+    for (uint32_t sector=tyt_first_sector(t); sector<=tyt_last_sector(t); sector++) {
+      if ((! sectors.isEmpty()) && (sector == sectors.last()))
+        continue;
+      uint32_t start = std::max(t.address, sector*SECTOR_SIZE) - t.address;
+      uint32_t end = std::min(t.address+t.size, (sector+1)*SECTOR_SIZE) - t.address;
+      bool changed = false;
+      if (nullptr != device) {
+        changed = (0 != memcmp(encoded.constData()+start, current.constData()+start, end-start));
+      } else {
+        // Read block-wise until the first difference is found
+        for (uint32_t o=start; (o<end) && (! changed); o+=BSIZE) {
+          if (! _dev->read(0, t.address+o, (uint8_t *)current.data(), BSIZE, _errorStack))
+            return false;
+          changed = (0 != memcmp(current.constData(), encoded.constData()+o, BSIZE));
+        }
+      }
+      if (changed)
+        sectors.append(sector);
+    }
+  }
+
+  return true;
+}
+
+bool
+TyTRadio::writeSectors(const DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                       const QVector<uint32_t> &sectors, float p0, float p1)
+{
+  // Erase consecutive sectors at once
+  for (int i=0; i<sectors.size();) {
+    int j = i+1;
+    while ((j<sectors.size()) && (sectors[j] == (sectors[j-1]+1)))
+      j++;
+    if (! _dev->erase(sectors[i]*SECTOR_SIZE, (sectors[j-1]-sectors[i]+1)*SECTOR_SIZE,
+                      nullptr, nullptr, _errorStack))
       return false;
+    i = j;
+  }
+
+  // Blocks never cross sector boundaries, hence each block is written if its sector was erased
+  size_t total = 0, count = 0;
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    for (unsigned o=0; o<t.size; o+=BSIZE) {
+      if (std::binary_search(sectors.begin(), sectors.end(), (t.address+o)/SECTOR_SIZE))
+        total += BSIZE;
     }
-    emit uploadProgress(50+float(bcount*50)/totb);
   }
 
+  QByteArray buffer;
+  foreach (const DFUFile::Image::Transfer &t, transfers) {
+    if (std::upper_bound(sectors.begin(), sectors.end(), tyt_last_sector(t)) ==
+        std::lower_bound(sectors.begin(), sectors.end(), tyt_first_sector(t)))
+      continue;
+    image.gather(t, buffer);
+    for (unsigned o=0; o<t.size; o+=BSIZE) {
+      if (! std::binary_search(sectors.begin(), sectors.end(), (t.address+o)/SECTOR_SIZE))
+        continue;
+      if (! _dev->write(0, t.address+o, (uint8_t *)buffer.data()+o, BSIZE, _errorStack))
+        return false;
+      count += BSIZE;
+      emit uploadProgress(p0 + float(count*(p1-p0))/total);
+    }
+  }
+
+  // Count all sectors touched by the transfers
+  QVector<uint32_t> all;
+  tyt_all_sectors(transfers, all);
+  if (all.size() > sectors.size())
+    logInfo() << "Skipped " << (all.size()-sectors.size()) << " of " << all.size() << " unchanged sectors.";
+
   return true;
 }
@@ -21,6 +21,8 @@ public:
 
   virtual ~TyTRadio();
 
+  const TransferMetrics *metrics() const;
+
 public slots:
   /** Starts the download of the codeplug and derives the generic configuration from it. */
   bool startDownload(bool blocking=false, const ErrorStack &err=ErrorStack());
@@ -43,6 +45,16 @@ private:
   virtual bool upload();
   virtual bool uploadCallsigns();
 
+  /** Collects all erase sectors of the image, that differ from the device memory. If @c device
+   * is given, it holds the current content of the device memory. Otherwise, the device memory
+   * gets read until the first difference within each sector is found. */
+  bool changedSectors(const DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                      const DFUFile::Image *device, QVector<uint32_t> &sectors);
+  /** Erases the given (sorted) sectors and writes all transfers within them. The progress gets
+   * reported linearly from @c p0 to @c p1 percent. */
+  bool writeSectors(const DFUFile::Image &image, const QVector<DFUFile::Image::Transfer> &transfers,
+                    const QVector<uint32_t> &sectors, float p0, float p1);
+
 protected:
   /** The interface to the radio. */
   TyTInterface *_dev;
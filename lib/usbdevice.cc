@@ -9,6 +9,7 @@
 #include "radioddity_interface.hh"
 #include "opengd77_interface.hh"
 #include "tyt_interface.hh"
+#include "radioemulator.hh"
 
 
 /* ********************************************************************************************* *
@@ -181,6 +182,10 @@ USBDeviceDescriptor::isValid() const {
   if (! USBDeviceInfo::isValid())
     return false;
 
+  // Emulated devices are valid as long as the emulator exists
+  if (RadioEmulator::find(*this))
+    return true;
+
   // dispatch by device class
   switch (_class) {
   case Class::None:
@@ -260,7 +265,9 @@ USBDeviceDescriptor::validSerial() const {
 
 QString
 USBDeviceDescriptor::description() const {
-  if (USBDeviceInfo::Class::Serial == _class) {
+  if (RadioEmulator::find(*this)) {
+    return QString("Emulated %1 at '%2'").arg(USBDeviceInfo::description()).arg(deviceHandle());
+  } else if (USBDeviceInfo::Class::Serial == _class) {
     return QString("Serial interface '%1'").arg(_device.toString());
   } else if (USBDeviceInfo::Class::DFU == _class) {
     USBDeviceHandle addr = _device.value<USBDeviceHandle>();
@@ -300,6 +307,7 @@ USBDeviceDescriptor::detect() {
   res.append(OpenGD77Interface::detect());
   res.append(RadioddityInterface::detect());
   res.append(TyTInterface::detect());
+  res.append(RadioEmulator::detect());
   return res;
 }
 
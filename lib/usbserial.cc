@@ -89,7 +89,12 @@ USBSerial::USBSerial(const USBDeviceDescriptor &descriptor, const ErrorStack &er
 
   logDebug() << "Try to open " << descriptor.description() << ".";
   QSerialPortInfo port(descriptor.device().toString());
-  this->setPort(port);
+  if (port.isNull()) {
+    // Not an enumerated port (e.g., the pseudo terminal of an emulated radio), open by path.
+    this->setPortName(descriptor.device().toString());
+  } else {
+    this->setPort(port);
+  }
   this->setBaudRate(115200);
 
   if (! this->open(QIODevice::ReadWrite)) {
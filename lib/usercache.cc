@@ -0,0 +1,321 @@
+#include "usercache.hh"
+#include <QHash>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QtEndian>
+#include <cstring>
+#include <algorithm>
+#include "logger.hh"
+
+#define USERCACHE_MAGIC       "QDMRUSR"
+#define USERCACHE_VERSION     1
+#define USERCACHE_HEADER_SIZE 0x0028
+/** Number of strings per user: callsign, name, surname, city, state, country and comment. */
+#define USERCACHE_NUM_STRINGS 7
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserCache::Builder
+ * ********************************************************************************************* */
+UserCache::Builder::Builder()
+  : _ids(), _strings(), _pool(1, '\0'), _slots(1024, 0), _distinct(0)
+{
+  // pass...
+}
+
+unsigned
+UserCache::Builder::count() const {
+  return _ids.size();
+}
+
+void
+UserCache::Builder::add(unsigned id, const QByteArray *strings) {
+  _ids.push_back(id);
+  for (unsigned i=0; i<USERCACHE_NUM_STRINGS; i++)
+    _strings.push_back(intern(strings[i]));
+}
+
+void
+UserCache::Builder::add(const UserDatabase::User &user) {
+  QByteArray strings[USERCACHE_NUM_STRINGS] = {
+    user.call.toUtf8(), user.name.toUtf8(), user.surname.toUtf8(), user.city.toUtf8(),
+    user.state.toUtf8(), user.country.toUtf8(), user.comment.toUtf8()
+  };
+  add(user.id, strings);
+}
+
+/** FNV-1a hash of the given string. */
+static inline uint32_t
+usercache_hash(const char *str, int len) {
+  uint32_t hash = 2166136261u;
+  for (int i=0; i<len; i++)
+    hash = (hash ^ uint8_t(str[i])) * 16777619u;
+  return hash;
+}
+
+uint32_t
+UserCache::Builder::intern(const QByteArray &str) {
+  // Strings are zero-terminated within the pool, hence they get truncated at the first zero.
+  int len = qstrnlen(str.constData(), str.size());
+  if (0 == len)
+    return 0;
+
+  size_t mask = _slots.size()-1;
+  for (size_t slot = usercache_hash(str.constData(), len) & mask; ; slot = (slot+1) & mask) {
+    uint32_t offset = _slots[slot];
+    if (0 == offset)
+      break;
+    const char *other = _pool.constData() + offset;
+    // Stops at the terminator of shorter strings, hence never reads past the end of the pool
+    if ((0 == strncmp(other, str.constData(), len)) && (0 == other[len]))
+      return offset;
+  }
+
+  // Not found -> append to pool, keep the table at most half full
+  uint32_t offset = _pool.size();
+  _pool.append(str.constData(), len).append('\0');
+  if ((2*(_distinct+1)) > _slots.size())
+    grow();
+  mask = _slots.size()-1;
+  size_t slot = usercache_hash(str.constData(), len) & mask;
+  while (0 != _slots[slot])
+    slot = (slot+1) & mask;
+  _slots[slot] = offset;
+  _distinct++;
+  return offset;
+}
+
+void
+UserCache::Builder::grow() {
+  std::vector<uint32_t> slots(2*_slots.size(), 0);
+  size_t mask = slots.size()-1;
+  for (size_t i=0; i<_slots.size(); i++) {
+    uint32_t offset = _slots[i];
+    if (0 == offset)
+      continue;
+    const char *str = _pool.constData() + offset;
+    size_t slot = usercache_hash(str, strlen(str)) & mask;
+    while (0 != slots[slot])
+      slot = (slot+1) & mask;
+    slots[slot] = offset;
+  }
+  _slots.swap(slots);
+}
+
+QByteArray
+UserCache::Builder::compile(qint64 sourceSize, qint64 sourceTime) const {
+  // Sort users w.r.t. their IDs
+  unsigned count = _ids.size();
+  std::vector<uint32_t> order(count);
+  for (unsigned i=0; i<count; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+    return _ids[a] < _ids[b];
+  });
+
+  QByteArray image(USERCACHE_HEADER_SIZE + 4*count*(1+USERCACHE_NUM_STRINGS), 0);
+  uchar *ptr = (uchar *)image.data();
+  uchar *ids = ptr + USERCACHE_HEADER_SIZE, *strings = ids + 4*count;
+  for (unsigned i=0; i<count; i++) {
+    qToLittleEndian<uint32_t>(_ids[order[i]], ids + 4*i);
+    for (unsigned j=0; j<USERCACHE_NUM_STRINGS; j++)
+      qToLittleEndian<uint32_t>(_strings[USERCACHE_NUM_STRINGS*order[i]+j],
+                                strings + 4*(USERCACHE_NUM_STRINGS*i+j));
+  }
+
+  // Assemble header
+  memcpy(ptr, USERCACHE_MAGIC, 8);
+  qToLittleEndian<uint32_t>(USERCACHE_VERSION, ptr+0x0008);
+  qToLittleEndian<uint32_t>(count, ptr+0x000c);
+  qToLittleEndian<qint64>(sourceSize, ptr+0x0010);
+  qToLittleEndian<qint64>(sourceTime, ptr+0x0018);
+  qToLittleEndian<uint32_t>(_pool.size(), ptr+0x0020);
+
+  logDebug() << "Compiled user cache with " << count << " entries and " << _distinct
+             << " distinct strings.";
+
+  return image.append(_pool);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserCache
+ * ********************************************************************************************* */
+UserCache::UserCache()
+  : _file(), _buffer(), _data(nullptr), _size(0), _count(0), _ids(nullptr), _strings(nullptr),
+    _pool(nullptr)
+{
+  // pass...
+}
+
+UserCache::~UserCache() {
+  close();
+}
+
+bool
+UserCache::isOpen() const {
+  return nullptr != _data;
+}
+
+unsigned
+UserCache::count() const {
+  return _count;
+}
+
+unsigned
+UserCache::id(unsigned idx) const {
+  return qFromLittleEndian<uint32_t>(_ids + 4*idx);
+}
+
+uint32_t
+UserCache::key(unsigned idx, Field field) const {
+  return qFromLittleEndian<uint32_t>(_strings + 4*(USERCACHE_NUM_STRINGS*idx + unsigned(field)));
+}
+
+QString
+UserCache::string(unsigned idx, Field field) const {
+  return QString::fromUtf8(_pool + key(idx, field));
+}
+
+UserDatabase::User
+UserCache::user(unsigned idx) const {
+  UserDatabase::User user;
+  user.id      = id(idx);
+  user.call    = string(idx, Call);
+  user.name    = string(idx, Name);
+  user.surname = string(idx, Surname);
+  user.city    = string(idx, City);
+  user.state   = string(idx, State);
+  user.country = string(idx, Country);
+  user.comment = string(idx, Comment);
+  return user;
+}
+
+bool
+UserCache::open(const QString &filename, qint64 sourceSize, qint64 sourceTime, const ErrorStack &err) {
+  close();
+
+  _file.setFileName(filename);
+  if (! _file.open(QIODevice::ReadOnly)) {
+    errMsg(err) << "Cannot open user cache '" << filename << "': " << _file.errorString() << ".";
+    return false;
+  }
+  _size = _file.size();
+  if ((USERCACHE_HEADER_SIZE > _size) ||
+      (nullptr == (_data = _file.map(0, _size, QFileDevice::MapPrivateOption)))) {
+    errMsg(err) << "Cannot map user cache '" << filename << "': " << _file.errorString() << ".";
+    close();
+    return false;
+  }
+
+  if ((qFromLittleEndian<qint64>(_data+0x0010) != sourceSize) ||
+      (qFromLittleEndian<qint64>(_data+0x0018) != sourceTime)) {
+    errMsg(err) << "User cache '" << filename << "' is outdated.";
+    close();
+    return false;
+  }
+
+  if (! verify(err)) {
+    errMsg(err) << "Invalid user cache '" << filename << "'.";
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+bool
+UserCache::assign(const QByteArray &image, const ErrorStack &err) {
+  close();
+  _buffer = image;
+  _data = (const uchar *)_buffer.constData();
+  _size = _buffer.size();
+  if (! verify(err)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void
+UserCache::close() {
+  if (_file.isOpen()) {
+    if (_data)
+      _file.unmap(const_cast<uchar *>(_data));
+    _file.close();
+  }
+  _buffer.clear();
+  _data = nullptr; _size = 0; _count = 0;
+  _ids = _strings = nullptr; _pool = nullptr;
+}
+
+bool
+UserCache::verify(const ErrorStack &err) {
+  if ((USERCACHE_HEADER_SIZE > _size) || (0 != memcmp(_data, USERCACHE_MAGIC, 8))) {
+    errMsg(err) << "Not a user cache.";
+    return false;
+  }
+  if (USERCACHE_VERSION != qFromLittleEndian<uint32_t>(_data+0x0008)) {
+    errMsg(err) << "Unsupported user cache version "
+                << qFromLittleEndian<uint32_t>(_data+0x0008) << ".";
+    return false;
+  }
+
+  qint64 count = qFromLittleEndian<uint32_t>(_data+0x000c);
+  qint64 poolSize = qFromLittleEndian<uint32_t>(_data+0x0020);
+  if ((0 == poolSize) ||
+      ((USERCACHE_HEADER_SIZE + 4*count*(1+USERCACHE_NUM_STRINGS) + poolSize) != _size)) {
+    errMsg(err) << "Size of user cache does not match its content.";
+    return false;
+  }
+
+  _count   = count;
+  _ids     = _data + USERCACHE_HEADER_SIZE;
+  _strings = _ids + 4*count;
+  _pool    = (const char *)(_strings + 4*count*USERCACHE_NUM_STRINGS);
+
+  // Verify that all strings are within the pool, this ensures that strings can be accessed without
+  // further checks.
+  if (0 != _pool[poolSize-1]) {
+    errMsg(err) << "String pool of user cache is not terminated.";
+    return false;
+  }
+  for (qint64 i=0; i<(count*USERCACHE_NUM_STRINGS); i++) {
+    if (qFromLittleEndian<uint32_t>(_strings + 4*i) >= poolSize) {
+      errMsg(err) << "String offset of user cache exceeds pool.";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+QByteArray
+UserCache::compile(const QVector<UserDatabase::User> &users, qint64 sourceSize, qint64 sourceTime) {
+  Builder builder;
+  foreach (const UserDatabase::User &user, users)
+    builder.add(user);
+  return builder.compile(sourceSize, sourceTime);
+}
+
+bool
+UserCache::write(const QString &filename, const QByteArray &image, const ErrorStack &err) {
+  QString path = QFileInfo(filename).absolutePath();
+  if ((! QDir().exists(path)) && (! QDir().mkpath(path))) {
+    errMsg(err) << "Cannot create path '" << path << "'.";
+    return false;
+  }
+
+  QSaveFile file(filename);
+  if (! file.open(QIODevice::WriteOnly)) {
+    errMsg(err) << "Cannot create user cache '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+  if ((image.size() != file.write(image)) || (! file.commit())) {
+    errMsg(err) << "Cannot write user cache '" << filename << "': " << file.errorString() << ".";
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,150 @@
+#ifndef USERCACHE_HH
+#define USERCACHE_HH
+
+#include <QFile>
+#include <QByteArray>
+#include <QVector>
+#include <vector>
+#include "userdatabase.hh"
+#include "errorstack.hh"
+
+/** Compiled binary representation of the user database.
+ *
+ * Parsing the JSON user database downloaded from radioid.net takes a considerable amount of time
+ * and memory. Hence it gets compiled once into a binary image, that gets stored on disk. On the
+ * next start, this image is mapped into memory and all user information is served directly from
+ * the mapping.
+ *
+ * The image consists of a header followed by the sorted ID column, the string offset column and
+ * the string pool. All integers are stored in little endian. The header contains the magic
+ * "QDMRUSR", the format version (V), the number of users (N), the size and modification time (in
+ * ms since epoch) of the source file the image was compiled from and the size of the pool (P).
+ *
+ * @code
+ * +---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+ * |            "QDMRUSR\0"        |       V       |       N       |
+ * +---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+ * |          source size          |          source time          |
+ * +---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
+ * |       P       |   reserved    |  N IDs ...
+ * +---+---+---+---+---+---+---+---+---+...
+ * @endcode
+ *
+ * For each user, the offset column holds the offsets of the callsign, name, surname, city, state,
+ * country and comment into the pool. The pool holds all distinct strings as zero-terminated
+ * UTF-8, starting with the empty string.
+ *
+ * @ingroup util */
+class UserCache
+{
+public:
+  /** The strings stored for each user. */
+  enum Field {
+    Call = 0, Name, Surname, City, State, Country, Comment
+  };
+
+  /** Assembles an image from users added one-by-one.
+   *
+   * The strings of the users are interned into the pool immediately, hence the memory required
+   * is close to the size of the final image. */
+  class Builder
+  {
+  public:
+    /** Empty constructor. */
+    Builder();
+
+    /** Returns the number of users added. */
+    unsigned count() const;
+    /** Adds a user with the given ID and the UTF-8 encoded callsign, name, surname, city, state,
+     * country and comment. */
+    void add(unsigned id, const QByteArray *strings);
+    /** Adds the given user. */
+    void add(const UserDatabase::User &user);
+
+    /** Assembles the image. The users get sorted by their ID. */
+    QByteArray compile(qint64 sourceSize, qint64 sourceTime) const;
+
+  protected:
+    /** Returns the offset of the given string in the pool. Adds the string if not present. */
+    uint32_t intern(const QByteArray &str);
+    /** Doubles the size of the hash table and re-inserts all strings. */
+    void grow();
+
+  protected:
+    /** The IDs of all users in the order they were added. */
+    std::vector<uint32_t> _ids;
+    /** The string offsets of all users in the order they were added. */
+    std::vector<uint32_t> _strings;
+    /** The pool of distinct strings. */
+    QByteArray _pool;
+    /** Open-addressing hash table of the offsets of all strings in the pool, 0 marks empty
+     * slots. The empty string at offset 0 is not stored. */
+    std::vector<uint32_t> _slots;
+    /** The number of distinct non-empty strings. */
+    unsigned _distinct;
+  };
+
+public:
+  /** Default constructor, constructs an empty cache. */
+  UserCache();
+  /** Destructor. */
+  ~UserCache();
+
+  /** Returns @c true if an image is open. */
+  bool isOpen() const;
+  /** Returns the number of users. */
+  unsigned count() const;
+  /** Returns the ID of the user with index @c idx. */
+  unsigned id(unsigned idx) const;
+  /** Returns the string @c field of the user with index @c idx. */
+  QString string(unsigned idx, Field field) const;
+  /** Returns the key of the string @c field of the user with index @c idx. As all strings are
+   * interned, two strings are equal if and only if their keys are equal. Hence the pool serves
+   * as a dictionary for countries, states and cities. The key of the empty string is 0. */
+  uint32_t key(unsigned idx, Field field) const;
+  /** Returns the user with index @c idx. */
+  UserDatabase::User user(unsigned idx) const;
+
+  /** Maps the specified cache file. If the file was not compiled from a source file of the given
+   * size and modification time, it is considered to be outdated.
+   * @returns @c false if the file cannot be mapped, is invalid or outdated. */
+  bool open(const QString &filename, qint64 sourceSize, qint64 sourceTime,
+            const ErrorStack &err=ErrorStack());
+  /** Serves the users from the given image in memory. */
+  bool assign(const QByteArray &image, const ErrorStack &err=ErrorStack());
+  /** Closes the image. */
+  void close();
+
+  /** Compiles the given users into an image. The users get sorted by their ID. */
+  static QByteArray compile(const QVector<UserDatabase::User> &users, qint64 sourceSize,
+                            qint64 sourceTime);
+  /** Writes the given image to the specified cache file. The file gets replaced atomically. */
+  static bool write(const QString &filename, const QByteArray &image,
+                    const ErrorStack &err=ErrorStack());
+
+protected:
+  /** Verifies the image at @c _data. */
+  bool verify(const ErrorStack &err);
+protected:
+  /** The cache file, kept open while it is mapped. */
+  QFile _file;
+  /** Holds the image, if it is not mapped. */
+  QByteArray _buffer;
+  /** Pointer to the image. */
+  const uchar *_data;
+  /** The size of the image. */
+  qint64 _size;
+  /** The number of users. */
+  unsigned _count;
+  /** Pointer to the ID column. */
+  const uchar *_ids;
+  /** Pointer to the string offset column. */
+  const uchar *_strings;
+  /** Pointer to the string pool. */
+  const char *_pool;
+
+private:
+  Q_DISABLE_COPY(UserCache)
+};
+
+#endif // USERCACHE_HH
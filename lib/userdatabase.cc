@@ -1,13 +1,77 @@
 #include "userdatabase.hh"
-#include <QJsonDocument>
-#include <QJsonArray>
+#include "usercache.hh"
+#include "userparser.hh"
+#include "userindex.hh"
 #include <QStandardPaths>
 #include <QFile>
+#include <QSaveFile>
 #include <QDir>
+#include <QFileInfo>
 #include <QNetworkReply>
+#include <QBitArray>
 #include <algorithm>
 #include "logger.hh"
-#include <cmath>
+#include <vector>
+#include <limits>
+
+
+/** Powers of ten up to 10^10, sufficient for all 32bit numbers. */
+static const uint64_t userdatabase_pow10[11] = {
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+  1000000000ull, 10000000000ull
+};
+
+/** Returns the smallest number of digits @c d with 10^d >= a. */
+static inline unsigned
+userdatabase_digits(uint32_t a) {
+  unsigned d = 0;
+  while (userdatabase_pow10[d] < a)
+    d++;
+  return d;
+}
+
+/** Returns the distance between the ID @c a with @c ad digits and the ID @c b with @c bd digits.
+ * That is, the difference between both numbers, once the shorter one is extended to the length
+ * of the longer one. */
+static inline unsigned
+userdatabase_distance(uint32_t a, unsigned ad, uint32_t b, unsigned bd) {
+  uint64_t x = a, y = b;
+  if (ad > bd)
+    y *= userdatabase_pow10[ad-bd];
+  else if (bd > ad)
+    x *= userdatabase_pow10[bd-ad];
+  return std::min((x > y) ? (x-y) : (y-x), uint64_t(std::numeric_limits<unsigned>::max()));
+}
+
+/** Precomputed prefixes to determine the minimum distance of many IDs to a set of prefixes. */
+class UserDatabasePrefixes
+{
+public:
+  /** Constructs the table for the given prefixes. */
+  explicit UserDatabasePrefixes(const QSet<unsigned> &ids)
+    : _ids(), _digits()
+  {
+    _ids.reserve(ids.size()); _digits.reserve(ids.size());
+    foreach (unsigned id, ids) {
+      _ids.push_back(id);
+      _digits.push_back(userdatabase_digits(id));
+    }
+  }
+
+  /** Returns the minimum distance of the given ID to any prefix. */
+  inline unsigned distance(uint32_t id) const {
+    unsigned digits = userdatabase_digits(id), min = std::numeric_limits<unsigned>::max();
+    for (size_t i=0; i<_ids.size(); i++)
+      min = std::min(min, userdatabase_distance(id, digits, _ids[i], _digits[i]));
+    return min;
+  }
+
+protected:
+  /** The prefixes. */
+  std::vector<uint32_t> _ids;
+  /** The number of digits of each prefix. */
+  std::vector<unsigned> _digits;
+};
 
 
 /* ********************************************************************************************* *
@@ -30,18 +94,87 @@ UserDatabase::User::User(const QJsonObject &obj)
 
 unsigned
 UserDatabase::User::distance(unsigned id) const {
-  // Fix number of digits
-  int a = this->id, b = id;
-  int ad = std::ceil(std::log10(a));
-  int bd = std::ceil(std::log10(b));
-  if (ad > bd)
-    b *= std::pow(10u, (ad-bd));
-  else if (bd > ad)
-    a *= std::pow(10u, (bd-ad));
-  // Distance is just the difference between these two numbers
-  // this ensures a small distance between two numbers with the same
-  // prefix.
-  return std::abs(a-b);
+  return distance(this->id, id);
+}
+
+unsigned
+UserDatabase::User::distance(unsigned ida, unsigned idb) {
+  // Fix number of digits, the distance is then just the difference between these two numbers.
+  // This ensures a small distance between two numbers with the same prefix.
+  return userdatabase_distance(ida, userdatabase_digits(ida), idb, userdatabase_digits(idb));
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserView
+ * ********************************************************************************************* */
+UserDatabase::UserView::UserView()
+  : _cache(nullptr), _index(0)
+{
+  // pass...
+}
+
+UserDatabase::UserView::UserView(const UserCache *cache, unsigned idx)
+  : _cache(cache), _index(idx)
+{
+  // pass...
+}
+
+bool
+UserDatabase::UserView::isValid() const {
+  return nullptr != _cache;
+}
+
+unsigned
+UserDatabase::UserView::id() const {
+  return _cache->id(_index);
+}
+
+QString
+UserDatabase::UserView::call() const {
+  return _cache->string(_index, UserCache::Call);
+}
+
+QString
+UserDatabase::UserView::name() const {
+  return _cache->string(_index, UserCache::Name);
+}
+
+QString
+UserDatabase::UserView::surname() const {
+  return _cache->string(_index, UserCache::Surname);
+}
+
+QString
+UserDatabase::UserView::city() const {
+  return _cache->string(_index, UserCache::City);
+}
+
+QString
+UserDatabase::UserView::state() const {
+  return _cache->string(_index, UserCache::State);
+}
+
+QString
+UserDatabase::UserView::country() const {
+  return _cache->string(_index, UserCache::Country);
+}
+
+QString
+UserDatabase::UserView::comment() const {
+  return _cache->string(_index, UserCache::Comment);
+}
+
+unsigned
+UserDatabase::UserView::distance(unsigned id) const {
+  return User::distance(this->id(), id);
+}
+
+UserDatabase::User
+UserDatabase::UserView::user() const {
+  if (nullptr == _cache)
+    return User();
+  return _cache->user(_index);
 }
 
 
@@ -49,7 +182,8 @@ UserDatabase::User::distance(unsigned id) const {
  * Implementation of UserDatabase
  * ********************************************************************************************* */
 UserDatabase::UserDatabase(unsigned updatePeriodDays, QObject *parent)
-  : QAbstractTableModel(parent), _user(), _network()
+  : QAbstractTableModel(parent), _cache(new UserCache()), _order(), _index(new UserIndex(_cache)),
+    _loader(nullptr), _loaderCache(), _pendingFile(), _pendingCache(), _download(nullptr), _network()
 {
   connect(&_network, SIGNAL(finished(QNetworkReply*)),
           this, SLOT(downloadFinished(QNetworkReply*)));
@@ -58,81 +192,120 @@ UserDatabase::UserDatabase(unsigned updatePeriodDays, QObject *parent)
     download();
 }
 
+UserDatabase::~UserDatabase() {
+  if (_loader)
+    _loader->wait();
+  delete _index;
+  delete _cache;
+}
+
 qint64
 UserDatabase::count() const {
-  return _user.size();
+  return _order.size();
 }
 
 bool
 UserDatabase::load() {
   QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-  return load(path+"/user.json");
+  QString cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  return load(path+"/user.json", cache+"/user.db");
 }
 
-const UserDatabase::User &
+UserDatabase::UserView
 UserDatabase::user(int idx) const {
-  return _user[idx];
+  return UserView(_cache, _order[idx]);
 }
 
 bool
 UserDatabase::load(const QString &filename) {
-  QFile file(filename);
-  if (! file.open(QIODevice::ReadOnly)) {
-    QString msg = QString("Cannot open user list '%1': %2").arg(filename).arg(file.errorString());
+  return load(filename, QString());
+}
+
+bool
+UserDatabase::load(const QString &filename, const QString &cachename) {
+  QFileInfo info(filename);
+  if (! info.exists()) {
+    QString msg = QString("Cannot open user list '%1': File does not exist.").arg(filename);
     logError() << msg;
     emit error(msg);
     return false;
   }
-  QByteArray data = file.readAll();
-  file.close();
 
-  QJsonDocument doc = QJsonDocument::fromJson(data);
-  if (! doc.isObject()) {
-    QString msg = "Failed to load user DB: JSON document is not an object!";
-    logError() << msg;
-    emit error(msg);
-    return false;
+  // Only one loader at a time, load the database once the running loader is finished
+  if (_loader) {
+    _pendingFile = filename;
+    _pendingCache = cachename;
+    return true;
   }
-  if (! doc.object().contains("users")) {
-    QString msg = "Failed to load user DB: JSON object does not contain 'users' item.";
-    logError() << msg;
-    emit error(msg);
-    return false;
+
+  ErrorStack err;
+  UserCache *cache = new UserCache();
+  if ((! cachename.isEmpty()) && cache->open(cachename, info.size(),
+                                             info.lastModified().toMSecsSinceEpoch(), err)) {
+    logDebug() << "Mapped user cache '" << cachename << "'.";
+    setCache(cache);
+    return true;
   }
-  if (! doc.object()["users"].isArray()) {
-    QString msg = "Failed to load user DB: 'users' item is not an array.";
+  delete cache;
+
+  if (! cachename.isEmpty())
+    logDebug() << "Cannot use user cache, compile it: " << err.format(" ");
+  _loader = new UserLoader(filename, this);
+  _loaderCache = cachename;
+  connect(_loader, SIGNAL(progress(int)), this, SIGNAL(loadProgress(int)));
+  connect(_loader, SIGNAL(finished()), this, SLOT(onLoaderFinished()));
+  _loader->start();
+  return true;
+}
+
+void
+UserDatabase::onLoaderFinished() {
+  UserLoader *loader = _loader;
+  _loader = nullptr;
+  loader->deleteLater();
+
+  UserCache *cache = new UserCache();
+  if (loader->isLoaded() && cache->assign(loader->image(), loader->errorStack())) {
+    setCache(cache);
+    // Store cache after the previous one has been released
+    ErrorStack err;
+    if ((! _loaderCache.isEmpty()) && (! UserCache::write(_loaderCache, loader->image(), err)))
+      logWarn() << "Cannot store user cache: " << err.format(" ");
+  } else {
+    delete cache;
+    QString msg = QString("Failed to load user DB: %1").arg(loader->errorStack().format(" "));
     logError() << msg;
     emit error(msg);
-    return false;
   }
 
-  beginResetModel();
-  _user.clear();
-
-  QJsonArray array = doc.object()["users"].toArray();
-  _user.reserve(array.size());
-  for (int i=0; i<array.size(); i++) {
-    User user(array.at(i).toObject());
-    if (user.isValid())
-      _user.append(user);
+  if (! _pendingFile.isEmpty()) {
+    QString filename = _pendingFile, cachename = _pendingCache;
+    _pendingFile.clear(); _pendingCache.clear();
+    load(filename, cachename);
   }
-  // Sort repeater w.r.t. their IDs
-  std::stable_sort(_user.begin(), _user.end(), [](const User &a, const User &b){ return a.id < b.id; });
-  // Done.
+}
+
+void
+UserDatabase::setCache(UserCache *cache) {
+  beginResetModel();
+  delete _index;
+  delete _cache;
+  _cache = cache;
+  _index = new UserIndex(_cache);
+  // Initially, users are ordered by their IDs
+  _order.resize(_cache->count());
+  for (int i=0; i<_order.size(); i++)
+    _order[i] = i;
   endResetModel();
 
-  logDebug() << "Loaded user database with " << _user.size() << " entries from " << filename << ".";
+  logDebug() << "Loaded user database with " << _order.size() << " entries.";
 
   emit loaded();
-  return true;
 }
 
 void
 UserDatabase::sortUsers(unsigned id) {
-  // Sort repeater w.r.t. distance to ID
-  std::stable_sort(_user.begin(), _user.end(), [id](const User &a, const User &b){
-    return a.distance(id) < b.distance(id);
-  });
+  sortUsers(QSet<unsigned>{id});
 }
 
 void
@@ -140,37 +313,62 @@ UserDatabase::sortUsers(const QSet<unsigned> &ids) {
   if (0 == ids.count())
     return;
 
-  // Sort repeater w.r.t. distance to each ID
-  std::stable_sort(_user.begin(), _user.end(), [ids](const User &a, const User &b){
-    QSet<unsigned>::const_iterator id=ids.begin();
-    unsigned min_a = a.distance(*id), min_b = b.distance(*id);
-    id++;
-    for (; id!=ids.end(); id++) {
-      min_a = std::min(min_a, a.distance(*id));
-      min_b = std::min(min_b, b.distance(*id));
-    }
-    return min_a < min_b;
+  // Compute the distance of each user once, indexed by its index within the cache
+  UserDatabasePrefixes prefixes(ids);
+  std::vector<unsigned> distances(_cache->count());
+  for (unsigned i=0; i<_cache->count(); i++)
+    distances[i] = prefixes.distance(_cache->id(i));
+
+  beginResetModel();
+  std::stable_sort(_order.begin(), _order.end(), [&distances](unsigned a, unsigned b){
+    return distances[a] < distances[b];
   });
+  endResetModel();
 }
 
-void
-UserDatabase::download() {
-  QUrl url("https://database.radioid.net/static/users.json");
-  QNetworkRequest request(url);
-  _network.get(request);
+QVector<UserDatabase::UserView>
+UserDatabase::select(const CallsignDB::Selection &selection, unsigned n) const {
+  // Evaluate filters
+  QBitArray matches;
+  if (selection.hasFilter()) {
+    matches = _index->match(selection);
+    logDebug() << matches.count(true) << " of " << _order.size() << " users match the filters.";
+  }
+
+  // Pairs of distance and position within the current order of all matching users. The position
+  // breaks ties, hence the selection matches the first n users once sorted by distance.
+  std::vector<std::pair<unsigned, unsigned>> keys;
+  keys.reserve(matches.isEmpty() ? _order.size() : matches.count(true));
+  UserDatabasePrefixes prefixes(selection.prefixes());
+  for (int i=0; i<_order.size(); i++) {
+    if ((! matches.isEmpty()) && (! matches.testBit(_order[i])))
+      continue;
+    unsigned distance = selection.prefixes().isEmpty() ? 0 : prefixes.distance(_cache->id(_order[i]));
+    keys.push_back(std::make_pair(distance, unsigned(i)));
+  }
+  n = std::min(n, unsigned(keys.size()));
+  if ((! selection.prefixes().isEmpty()) && (n < keys.size()))
+    std::nth_element(keys.begin(), keys.begin()+n, keys.end());
+
+  // The cache is sorted by ID, hence sorting the cache indices sorts the selection by ID.
+  std::vector<unsigned> indices(n);
+  for (unsigned i=0; i<n; i++)
+    indices[i] = _order[keys[i].second];
+  std::sort(indices.begin(), indices.end());
+
+  QVector<UserView> users;
+  users.reserve(n);
+  for (unsigned i=0; i<n; i++)
+    users.append(UserView(_cache, indices[i]));
+  return users;
 }
 
 void
-UserDatabase::downloadFinished(QNetworkReply *reply) {
-  if (reply->error()) {
-    QString msg = QString("Cannot download user database: %1").arg(reply->errorString());
-    logError() << msg;
-    emit error(msg);
+UserDatabase::download() {
+  if (_download)
     return;
-  }
 
   QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-  QFile file(path+"/user.json");
   QDir directory;
   if ((! directory.exists(path)) && (!directory.mkpath(path))) {
     QString msg = QString("Cannot create path '%1'.").arg(path);
@@ -178,19 +376,68 @@ UserDatabase::downloadFinished(QNetworkReply *reply) {
     emit error(msg);
     return;
   }
-  if (! file.open(QIODevice::WriteOnly)) {
+
+  // The download is streamed into a temporary file, that replaces the database once complete.
+  _download = new QSaveFile(path+"/user.json", this);
+  if (! _download->open(QIODevice::WriteOnly)) {
     QString msg = QString("Cannot save user database at '%1'.").arg(path+"/user.json");
     logError() << msg;
     emit error(msg);
+    delete _download;
+    _download = nullptr;
     return;
   }
 
-  file.write(reply->readAll());
-  file.flush();
-  file.close();
+  QUrl url("https://database.radioid.net/static/users.json");
+  QNetworkRequest request(url);
+  QNetworkReply *reply = _network.get(request);
+  connect(reply, SIGNAL(readyRead()), this, SLOT(onDownloadReadyRead()));
+  connect(reply, SIGNAL(downloadProgress(qint64,qint64)),
+          this, SLOT(onDownloadProgress(qint64,qint64)));
+}
 
-  load();
+void
+UserDatabase::onDownloadReadyRead() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+  if ((nullptr != reply) && (nullptr != _download))
+    _download->write(reply->readAll());
+}
+
+void
+UserDatabase::onDownloadProgress(qint64 received, qint64 total) {
+  if (0 < total)
+    emit downloadProgress(int((100*received)/total));
+}
+
+void
+UserDatabase::downloadFinished(QNetworkReply *reply) {
   reply->deleteLater();
+  QSaveFile *file = _download;
+  _download = nullptr;
+  if (nullptr == file)
+    return;
+
+  if (reply->error()) {
+    file->cancelWriting();
+    delete file;
+    QString msg = QString("Cannot download user database: %1").arg(reply->errorString());
+    logError() << msg;
+    emit error(msg);
+    return;
+  }
+
+  file->write(reply->readAll());
+  if (! file->commit()) {
+    QString msg = QString("Cannot save user database at '%1': %2")
+        .arg(file->fileName()).arg(file->errorString());
+    delete file;
+    logError() << msg;
+    emit error(msg);
+    return;
+  }
+  delete file;
+
+  load();
 }
 
 unsigned
@@ -205,7 +452,7 @@ UserDatabase::dbAge() const {
 int
 UserDatabase::rowCount(const QModelIndex &parent) const {
   Q_UNUSED(parent);
-  return _user.size();
+  return _order.size();
 }
 
 int
@@ -219,35 +466,37 @@ UserDatabase::data(const QModelIndex &index, int role) const {
   if ((Qt::EditRole != role) && ((Qt::DisplayRole != role)))
     return QVariant();
 
-  if (index.row() >= _user.size())
+  if (index.row() >= _order.size())
     return QVariant();
 
+  UserView user = this->user(index.row());
   if (0 == index.column()) {
     // Call
     if (Qt::DisplayRole == role) {
-      if (_user[index.row()].surname.isEmpty()) {
-        if (_user[index.row()].name.isEmpty()) {
-          return _user[index.row()].call;
+      QString name = user.name(), surname = user.surname();
+      if (surname.isEmpty()) {
+        if (name.isEmpty()) {
+          return user.call();
         } else {
           return tr("%1 (%2)")
-              .arg(_user[index.row()].call)
-              .arg(_user[index.row()].name);
+              .arg(user.call())
+              .arg(name);
         }
       } else {
         return tr("%1 (%2, %3)")
-            .arg(_user[index.row()].call)
-            .arg(_user[index.row()].name)
-            .arg(_user[index.row()].surname);
+            .arg(user.call())
+            .arg(name)
+            .arg(surname);
       }
     } else {
-      return _user[index.row()].call;
+      return user.call();
     }
   } else if (1 == index.column()) {
     // ID
-    return _user[index.row()].id;
+    return user.id();
   } else if (2 == index.column()) {
     // Country
-    return _user[index.column()].country;
+    return user.country();
   }
 
   return QVariant();
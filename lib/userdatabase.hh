@@ -4,11 +4,18 @@
 #include <QObject>
 #include <QVector>
 #include <QHash>
+#include <QSet>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
 #include <QGeoPositionInfoSource>
+#include "callsigndb.hh"
+
+class UserCache;
+class UserLoader;
+class UserIndex;
+class QSaveFile;
 
 /** Auto-updating DMR user database.
  *
@@ -18,6 +25,11 @@
  * to help assemble private call contacts and to assemble so-called CSV callsign databases, that
  * are programmable to some DMR radios to resolve the DMR ID to callsigns and names.
  *
+ * The downloaded JSON database gets compiled into a binary cache (see @c UserCache), that is
+ * mapped into memory on the next start. Hence the JSON database only gets parsed again, once it
+ * has been updated. Parsing happens in a separate thread (see @c UserLoader), the @c loaded
+ * signal gets emitted once it is finished.
+ *
  * @ingroup util */
 class UserDatabase : public QAbstractTableModel
 {
@@ -37,6 +49,8 @@ public:
 
     /** Returns the "distance" between this user and the given ID. */
     unsigned distance(unsigned id) const;
+    /** Returns the "distance" between the two given IDs. */
+    static unsigned distance(unsigned a, unsigned b);
 
 		/** The DMR ID of the user. */
 		unsigned id;
@@ -56,18 +70,66 @@ public:
     QString comment;
 	};
 
+  /** Lightweight read-only view of a user within the binary cache.
+   *
+   * In contrast to @c User, the view does not copy any strings. They are decoded from the cache
+   * on access. A view is only valid until the database gets reloaded. */
+  class UserView {
+  public:
+    /** Constructs an invalid view. */
+    UserView();
+    /** Constructs a view of the user with index @c idx within the given cache. */
+    UserView(const UserCache *cache, unsigned idx);
+
+    /** Returns @c true if the view refers to a user. */
+    bool isValid() const;
+    /** Returns the DMR ID of the user. */
+    unsigned id() const;
+    /** Returns the callsign of the user. */
+    QString call() const;
+    /** Returns the name of the user. */
+    QString name() const;
+    /** Returns the surname of the user. */
+    QString surname() const;
+    /** Returns the city of the user. */
+    QString city() const;
+    /** Returns the state of the user. */
+    QString state() const;
+    /** Returns the country of the user. */
+    QString country() const;
+    /** Returns the comment of the user. */
+    QString comment() const;
+    /** Returns the "distance" between this user and the given ID. */
+    unsigned distance(unsigned id) const;
+    /** Returns a copy of the user. */
+    User user() const;
+
+  protected:
+    /** The cache holding the user. */
+    const UserCache *_cache;
+    /** The index of the user within the cache. */
+    unsigned _index;
+  };
+
 public:
 	/** Constructs the user-database.
 	 * The constructor will download the current user database if it was not downloaded yet or
 	 * if the downloaded version is older than @c updatePeriodDays days. */
 	explicit UserDatabase(unsigned updatePeriodDays=30, QObject *parent=nullptr);
+  /** Destructor. */
+  virtual ~UserDatabase();
 
   /** Returns the number of users. */
   qint64 count() const;
 
-	/** Loads all entries from the downloaded user database. */
+	/** Loads all entries from the downloaded user database. If the binary cache is up-to-date, it
+	 * gets mapped. Otherwise, the cache gets compiled from the downloaded database in the
+	 * background.
+	 * @returns @c false if the database does not exist. */
 	bool load();
-	/** Loads all entries from the downloaded user database at the specified location. */
+	/** Loads all entries from the downloaded user database at the specified location in the
+	 * background.
+	 * @returns @c false if the database does not exist. */
 	bool load(const QString &filename);
 
   /** Sorts users with respect to the distance to the given ID. */
@@ -75,8 +137,15 @@ public:
   /** Sorts users with respect to the minimum distance to the given IDs. */
   void sortUsers(const QSet<unsigned> &ids);
 
-	/** Returns the user with index @c idx. */
-  const User &user(int idx) const;
+  /** Selects up to @c n users matching the filters of the given selection, that are closest to
+   * any of its prefixes. The users are sorted in ascending order of their IDs. If no prefixes are
+   * given, the first matching users are selected. In contrast to @c sortUsers, the order of the
+   * database remains unchanged. */
+  QVector<UserView> select(const CallsignDB::Selection &selection, unsigned n) const;
+
+	/** Returns a view of the user with index @c idx. The view is valid until the database gets
+	 * reloaded. */
+  UserView user(int idx) const;
 
 	/** Returns the age of the database in days. */
 	unsigned dbAge() const;
@@ -93,6 +162,10 @@ signals:
   void loaded();
   /** Gets emitted if the loading of the call-sign database fails. */
   void error(const QString &msg);
+  /** Gets emitted on progress of loading the JSON database. */
+  void loadProgress(int percent);
+  /** Gets emitted on progress of downloading the JSON database. */
+  void downloadProgress(int percent);
 
 public slots:
 	/** Starts the download of the user database. */
@@ -101,10 +174,38 @@ public slots:
 private slots:
 	/** Gets called whenever the download is complete. */
 	void downloadFinished(QNetworkReply *reply);
+  /** Writes the received part of the download to disk. */
+  void onDownloadReadyRead();
+  /** Gets called on download progress. */
+  void onDownloadProgress(qint64 received, qint64 total);
+  /** Gets called once the loader finished. */
+  void onLoaderFinished();
+
+protected:
+  /** Loads all entries from the specified user database. If @c cachename is not empty, the
+   * binary cache gets mapped if up-to-date or compiled and stored otherwise. */
+  bool load(const QString &filename, const QString &cachename);
+  /** Replaces the current users by the ones of the given cache. Takes the ownership. */
+  void setCache(UserCache *cache);
 
 private:
 	/** Holds all users sorted by their ID. */
-	QVector<User>         _user;
+	UserCache            *_cache;
+  /** Maps the index of a user to its index in the cache. Reordered by @c sortUsers. */
+  QVector<unsigned>     _order;
+  /** Index over the columns of the cache. It gets rebuilt whenever the cache is replaced and is
+   * never modified by @c select, hence @c select may be called concurrently. */
+  UserIndex            *_index;
+  /** The loader parsing the JSON database in the background or @c nullptr. */
+  UserLoader           *_loader;
+  /** The cache file, the result of the running loader is stored in. */
+  QString               _loaderCache;
+  /** The database to load once the running loader finished. */
+  QString               _pendingFile;
+  /** The cache file of the pending database. */
+  QString               _pendingCache;
+  /** The file, the running download is written to or @c nullptr. */
+  QSaveFile            *_download;
 	/** The network access used for downloading. */
 	QNetworkAccessManager _network;
 };
@@ -0,0 +1,120 @@
+#include "userindex.hh"
+#include "logger.hh"
+#include <limits>
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserIndex
+ * ********************************************************************************************* */
+UserIndex::UserIndex(const UserCache *cache)
+  : _cache(cache), _countries(), _states()
+{
+  for (unsigned i=0; i<_cache->count(); i++) {
+    add(_countries, i, UserCache::Country);
+    add(_states, i, UserCache::State);
+  }
+
+  logDebug() << "Indexed " << _cache->count() << " users with " << _countries.keys.size()
+             << " countries and " << _states.keys.size() << " states.";
+}
+
+void
+UserIndex::add(Column &column, unsigned idx, UserCache::Field field) {
+  // Empty strings are not indexed
+  uint32_t key = _cache->key(idx, field);
+  if (0 == key)
+    return;
+
+  QHash<uint32_t, std::vector<uint32_t>>::iterator postings = column.postings.find(key);
+  if (column.postings.end() == postings) {
+    // Only decode the string once for each distinct value
+    column.keys[_cache->string(idx, field).toLower()].push_back(key);
+    postings = column.postings.insert(key, std::vector<uint32_t>());
+  }
+  postings->push_back(idx);
+}
+
+unsigned
+UserIndex::lowerBound(unsigned id) const {
+  unsigned first = 0, count = _cache->count();
+  while (0 < count) {
+    unsigned step = count/2, mid = first + step;
+    if (_cache->id(mid) < id) {
+      first = mid+1; count -= step+1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+QBitArray
+UserIndex::match(const Column &column, const QStringList &values) const {
+  QBitArray result(_cache->count(), false);
+  foreach (QString value, values) {
+    QHash<QString, std::vector<uint32_t>>::const_iterator keys =
+        column.keys.constFind(value.trimmed().toLower());
+    if (column.keys.constEnd() == keys) {
+      logDebug() << "No user found in '" << value.trimmed() << "'.";
+      continue;
+    }
+    // Merge the postings of all spellings differing only in case
+    for (size_t k=0; k<keys->size(); k++) {
+      const std::vector<uint32_t> &postings = *column.postings.constFind(keys->at(k));
+      for (size_t i=0; i<postings.size(); i++)
+        result.setBit(postings[i]);
+    }
+  }
+  return result;
+}
+
+QBitArray
+UserIndex::match(const QList<CallsignDB::Selection::IDRange> &ranges) const {
+  QBitArray result(_cache->count(), false);
+  foreach (CallsignDB::Selection::IDRange range, ranges) {
+    unsigned first = lowerBound(range.first);
+    unsigned last = (std::numeric_limits<unsigned>::max() == range.second) ?
+          _cache->count() : lowerBound(range.second+1);
+    if (first < last)
+      result.fill(true, first, last);
+  }
+  return result;
+}
+
+QBitArray
+UserIndex::match(const QSet<unsigned> &ids) const {
+  QBitArray result(_cache->count(), false);
+  foreach (unsigned id, ids) {
+    // IDs are not unique, hence select all users with that ID
+    for (unsigned i=lowerBound(id); (i<_cache->count()) && (id == _cache->id(i)); i++)
+      result.setBit(i);
+  }
+  return result;
+}
+
+QBitArray
+UserIndex::match(const CallsignDB::Selection &selection) const {
+  QBitArray result(_cache->count(), true);
+  if (! selection.countries().isEmpty())
+    result &= match(_countries, selection.countries());
+  if (! selection.states().isEmpty())
+    result &= match(_states, selection.states());
+  if (! selection.idRanges().isEmpty())
+    result &= match(selection.idRanges());
+  if (! selection.heard().isEmpty())
+    result &= match(selection.heard());
+
+  // The callsign pattern is the only filter to be evaluated on the strings. Hence it gets applied
+  // to the remaining users only.
+  const QRegularExpression &pattern = selection.callsignPattern();
+  if (pattern.isValid() && (! pattern.pattern().isEmpty())) {
+    for (unsigned i=0; i<_cache->count(); i++) {
+      if (result.testBit(i) && (! pattern.match(_cache->string(i, UserCache::Call), 0,
+                                                 QRegularExpression::NormalMatch,
+                                                 QRegularExpression::AnchoredMatchOption).hasMatch()))
+        result.clearBit(i);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,61 @@
+#ifndef USERINDEX_HH
+#define USERINDEX_HH
+
+#include <QHash>
+#include <QBitArray>
+#include <vector>
+#include "usercache.hh"
+#include "callsigndb.hh"
+
+/** Index over the columns of a @c UserCache to evaluate the filters of a
+ * @c CallsignDB::Selection without scanning the strings of all users.
+ *
+ * For countries and states, the index holds a posting list of the users per distinct value. As
+ * all strings are interned within the cache, the values are identified by their keys (see
+ * @c UserCache::key). The ID column of the cache is sorted, hence ID ranges and heard IDs are
+ * resolved by binary search. Only the callsign pattern requires to look at the strings, but just
+ * for those users matching all other filters.
+ *
+ * @ingroup util */
+class UserIndex
+{
+public:
+  /** Builds the index for the given cache. The cache must remain open as long as the index is
+   * used. */
+  explicit UserIndex(const UserCache *cache);
+
+  /** Returns the set of users matching the filters of the given selection. Bit @c i refers to the
+   * user with index @c i within the cache. */
+  QBitArray match(const CallsignDB::Selection &selection) const;
+
+  /** Returns the index of the first user with an ID greater or equal to @c id. */
+  unsigned lowerBound(unsigned id) const;
+
+protected:
+  /** A dictionary of the values of a column and the posting lists of each value. */
+  struct Column {
+    /** Maps the lower case values to the keys of all spellings, that fold to it. */
+    QHash<QString, std::vector<uint32_t>> keys;
+    /** The sorted indices of the users for each key. */
+    QHash<uint32_t, std::vector<uint32_t>> postings;
+  };
+
+  /** Adds the given user to the column. */
+  void add(Column &column, unsigned idx, UserCache::Field field);
+  /** Returns the set of users with any of the given values in the column. */
+  QBitArray match(const Column &column, const QStringList &values) const;
+  /** Returns the set of users within any of the given ID ranges. */
+  QBitArray match(const QList<CallsignDB::Selection::IDRange> &ranges) const;
+  /** Returns the set of users with any of the given IDs. */
+  QBitArray match(const QSet<unsigned> &ids) const;
+
+protected:
+  /** The indexed cache. */
+  const UserCache *_cache;
+  /** The country column. */
+  Column _countries;
+  /** The state column. */
+  Column _states;
+};
+
+#endif // USERINDEX_HH
@@ -0,0 +1,423 @@
+#include "userparser.hh"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <cstring>
+#include <algorithm>
+#include "logger.hh"
+
+/** Size of the chunks read from the device. */
+#define USERPARSER_CHUNK_SIZE 0x10000
+/** Maximum nesting depth of skipped values. */
+#define USERPARSER_MAX_DEPTH  64
+/** Number of strings per user: callsign, name, surname, city, state, country and comment. */
+#define USERPARSER_NUM_STRINGS 7
+
+
+/** Keys of the strings of each user, in the order expected by @c UserCache::Builder::add. */
+static const char *userparser_keys[USERPARSER_NUM_STRINGS] = {
+  "callsign", "fname", "surname", "city", "state", "country", "remarks"
+};
+
+/** Appends the given unicode code point as UTF-8. */
+static void
+userparser_append_utf8(QByteArray &str, uint32_t c) {
+  if (0x80 > c) {
+    str.append(char(c));
+  } else if (0x800 > c) {
+    str.append(char(0xc0 | (c >> 6)));
+    str.append(char(0x80 | (c & 0x3f)));
+  } else if (0x10000 > c) {
+    str.append(char(0xe0 | (c >> 12)));
+    str.append(char(0x80 | ((c >> 6) & 0x3f)));
+    str.append(char(0x80 | (c & 0x3f)));
+  } else {
+    str.append(char(0xf0 | (c >> 18)));
+    str.append(char(0x80 | ((c >> 12) & 0x3f)));
+    str.append(char(0x80 | ((c >> 6) & 0x3f)));
+    str.append(char(0x80 | (c & 0x3f)));
+  }
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserParser
+ * ********************************************************************************************* */
+UserParser::UserParser(QIODevice *device, UserCache::Builder &builder, const Progress &progress)
+  : _device(device), _builder(builder), _progress(progress), _buffer(USERPARSER_CHUNK_SIZE, 0),
+    _pos(0), _len(0), _offset(0)
+{
+  // pass...
+}
+
+bool
+UserParser::refill() {
+  qint64 n = _device->read(_buffer.data(), _buffer.size());
+  if (0 >= n)
+    return false;
+  _pos = 0; _len = n;
+  _offset += n;
+  if (_progress)
+    _progress(_offset);
+  return true;
+}
+
+int
+UserParser::skipWhitespace() {
+  int c = peek();
+  while ((' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c)) {
+    _pos++; c = peek();
+  }
+  return c;
+}
+
+bool
+UserParser::expect(char c, const ErrorStack &err) {
+  int n = skipWhitespace();
+  if (c != n) {
+    if (0 > n)
+      errMsg(err) << "Unexpected end of document, expected '" << c << "'.";
+    else
+      errMsg(err) << "Unexpected char '" << QChar(n) << "' at " << (_offset-_len+_pos)
+                  << ", expected '" << c << "'.";
+    return false;
+  }
+  _pos++;
+  return true;
+}
+
+bool
+UserParser::parseString(QByteArray &str, const ErrorStack &err) {
+  str.clear();
+  if (! expect('"', err))
+    return false;
+
+  while (true) {
+    if ((_pos >= _len) && (! refill())) {
+      errMsg(err) << "Unexpected end of document within string.";
+      return false;
+    }
+    // Copy plain chars up to the next quote or escape at once
+    const char *begin = _buffer.constData() + _pos, *end = _buffer.constData() + _len, *ptr = begin;
+    while ((ptr < end) && ('"' != *ptr) && ('\\' != *ptr))
+      ptr++;
+    str.append(begin, ptr-begin);
+    _pos += (ptr-begin);
+    if (ptr == end)
+      continue;
+
+    if ('"' == get())
+      return true;
+
+    // Handle escape sequence
+    int c = get();
+    switch (c) {
+    case '"': case '\\': case '/': str.append(char(c)); break;
+    case 'b': str.append('\b'); break;
+    case 'f': str.append('\f'); break;
+    case 'n': str.append('\n'); break;
+    case 'r': str.append('\r'); break;
+    case 't': str.append('\t'); break;
+    case 'u': {
+      uint32_t code = 0;
+      for (int i=0; i<4; i++) {
+        int h = get();
+        if (('0' <= h) && ('9' >= h)) code = (code << 4) | (h - '0');
+        else if (('a' <= h) && ('f' >= h)) code = (code << 4) | (h - 'a' + 10);
+        else if (('A' <= h) && ('F' >= h)) code = (code << 4) | (h - 'A' + 10);
+        else {
+          errMsg(err) << "Invalid unicode escape sequence in string.";
+          return false;
+        }
+      }
+      // Combine surrogate pairs
+      if ((0xd800 <= code) && (0xdbff >= code) && ('\\' == peek())) {
+        _pos++;
+        if ('u' != get()) {
+          errMsg(err) << "Invalid surrogate pair in string.";
+          return false;
+        }
+        uint32_t low = 0;
+        for (int i=0; i<4; i++) {
+          int h = get();
+          if (('0' <= h) && ('9' >= h)) low = (low << 4) | (h - '0');
+          else if (('a' <= h) && ('f' >= h)) low = (low << 4) | (h - 'a' + 10);
+          else if (('A' <= h) && ('F' >= h)) low = (low << 4) | (h - 'A' + 10);
+          else {
+            errMsg(err) << "Invalid unicode escape sequence in string.";
+            return false;
+          }
+        }
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+      }
+      // Zero chars are dropped, as strings are zero-terminated within the cache
+      if (code)
+        userparser_append_utf8(str, code);
+    } break;
+    default:
+      errMsg(err) << "Invalid escape sequence in string.";
+      return false;
+    }
+  }
+}
+
+bool
+UserParser::parseNumber(qint64 &value, const ErrorStack &err) {
+  value = 0;
+  int c = skipWhitespace();
+  bool negative = ('-' == c);
+  if (negative) {
+    _pos++; c = peek();
+  }
+  if (('0' > c) || ('9' < c)) {
+    errMsg(err) << "Invalid number.";
+    return false;
+  }
+  for (; ('0' <= c) && ('9' >= c); _pos++, c = peek())
+    value = std::min(value*10 + (c - '0'), qint64(0xffffffff));
+  // Skip fraction and exponent
+  while (('.' == c) || ('e' == c) || ('E' == c) || ('+' == c) || ('-' == c) ||
+         (('0' <= c) && ('9' >= c))) {
+    _pos++; c = peek();
+  }
+  if (negative)
+    value = -value;
+  return true;
+}
+
+bool
+UserParser::skipValue(const ErrorStack &err, unsigned depth) {
+  if (USERPARSER_MAX_DEPTH < depth) {
+    errMsg(err) << "Document nested too deeply.";
+    return false;
+  }
+
+  int c = skipWhitespace();
+  if ('"' == c) {
+    QByteArray str;
+    return parseString(str, err);
+  } else if (('-' == c) || (('0' <= c) && ('9' >= c))) {
+    qint64 value;
+    return parseNumber(value, err);
+  } else if (('t' == c) || ('f' == c) || ('n' == c)) {
+    const char *literal = ('t' == c) ? "true" : (('f' == c) ? "false" : "null");
+    for (const char *l = literal; *l; l++) {
+      if (*l != get()) {
+        errMsg(err) << "Invalid literal, expected '" << literal << "'.";
+        return false;
+      }
+    }
+    return true;
+  } else if ('[' == c) {
+    _pos++;
+    if (']' == skipWhitespace()) {
+      _pos++; return true;
+    }
+    while (true) {
+      if (! skipValue(err, depth+1))
+        return false;
+      c = skipWhitespace(); _pos++;
+      if (']' == c)
+        return true;
+      if (',' != c) {
+        errMsg(err) << "Expected ',' or ']' in array.";
+        return false;
+      }
+    }
+  } else if ('{' == c) {
+    _pos++;
+    if ('}' == skipWhitespace()) {
+      _pos++; return true;
+    }
+    QByteArray key;
+    while (true) {
+      if ((! parseString(key, err)) || (! expect(':', err)) || (! skipValue(err, depth+1)))
+        return false;
+      c = skipWhitespace(); _pos++;
+      if ('}' == c)
+        return true;
+      if (',' != c) {
+        errMsg(err) << "Expected ',' or '}' in object.";
+        return false;
+      }
+    }
+  }
+
+  if (0 > c)
+    errMsg(err) << "Unexpected end of document.";
+  else
+    errMsg(err) << "Unexpected char '" << QChar(c) << "' at " << (_offset-_len+_pos) << ".";
+  return false;
+}
+
+bool
+UserParser::parseUser(const ErrorStack &err) {
+  qint64 id = 0;
+  QByteArray strings[USERPARSER_NUM_STRINGS];
+
+  if (! expect('{', err))
+    return false;
+  if ('}' == skipWhitespace()) {
+    _pos++; return true;
+  }
+
+  QByteArray key;
+  while (true) {
+    if ((! parseString(key, err)) || (! expect(':', err)))
+      return false;
+
+    int c = skipWhitespace(), field = -1;
+    for (int i=0; (0 > field) && (i<USERPARSER_NUM_STRINGS); i++) {
+      if (key == userparser_keys[i])
+        field = i;
+    }
+    if ((0 <= field) && ('"' == c)) {
+      if (! parseString(strings[field], err))
+        return false;
+    } else if (("id" == key) && (('-' == c) || (('0' <= c) && ('9' >= c)))) {
+      if (! parseNumber(id, err))
+        return false;
+    } else if (! skipValue(err, 1)) {
+      return false;
+    }
+
+    c = skipWhitespace(); _pos++;
+    if ('}' == c)
+      break;
+    if (',' != c) {
+      errMsg(err) << "Expected ',' or '}' in user object.";
+      return false;
+    }
+  }
+
+  // Skip invalid users
+  if (0 < id)
+    _builder.add(id, strings);
+  return true;
+}
+
+bool
+UserParser::parseUsers(const ErrorStack &err) {
+  if ('[' != skipWhitespace()) {
+    errMsg(err) << "'users' item is not an array.";
+    return false;
+  }
+  _pos++;
+
+  if (']' == skipWhitespace()) {
+    _pos++; return true;
+  }
+  while (true) {
+    int c = skipWhitespace();
+    if ('{' == c) {
+      if (! parseUser(err))
+        return false;
+    } else if (! skipValue(err, 1)) {
+      return false;
+    }
+    c = skipWhitespace(); _pos++;
+    if (']' == c)
+      return true;
+    if (',' != c) {
+      errMsg(err) << "Expected ',' or ']' in users array.";
+      return false;
+    }
+  }
+}
+
+bool
+UserParser::parse(const ErrorStack &err) {
+  if ('{' != skipWhitespace()) {
+    errMsg(err) << "JSON document is not an object.";
+    return false;
+  }
+  _pos++;
+
+  bool found = false;
+  if ('}' != skipWhitespace()) {
+    QByteArray key;
+    while (true) {
+      if ((! parseString(key, err)) || (! expect(':', err)))
+        return false;
+      if ("users" == key) {
+        if (! parseUsers(err))
+          return false;
+        found = true;
+      } else if (! skipValue(err)) {
+        return false;
+      }
+      int c = skipWhitespace(); _pos++;
+      if ('}' == c)
+        break;
+      if (',' != c) {
+        errMsg(err) << "Expected ',' or '}' in JSON object.";
+        return false;
+      }
+    }
+  }
+
+  if (! found) {
+    errMsg(err) << "JSON object does not contain 'users' item.";
+    return false;
+  }
+
+  return true;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserLoader
+ * ********************************************************************************************* */
+UserLoader::UserLoader(const QString &filename, QObject *parent)
+  : QThread(parent), _filename(filename), _loaded(false), _image(), _errorStack()
+{
+  // pass...
+}
+
+const QString &
+UserLoader::filename() const {
+  return _filename;
+}
+
+bool
+UserLoader::isLoaded() const {
+  return _loaded;
+}
+
+const QByteArray &
+UserLoader::image() const {
+  return _image;
+}
+
+const ErrorStack &
+UserLoader::errorStack() const {
+  return _errorStack;
+}
+
+void
+UserLoader::run() {
+  QFile file(_filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errMsg(_errorStack) << "Cannot open user list '" << _filename << "': "
+                        << file.errorString() << ".";
+    return;
+  }
+
+  QFileInfo info(file);
+  qint64 size = info.size(), time = info.lastModified().toMSecsSinceEpoch();
+  int percent = -1;
+  UserCache::Builder builder;
+  UserParser parser(&file, builder, [this, size, &percent](qint64 position) {
+    int p = (0 < size) ? int((100*position)/size) : 100;
+    if (p != percent)
+      emit progress(percent = p);
+  });
+
+  if (! parser.parse(_errorStack)) {
+    errMsg(_errorStack) << "Failed to load user DB '" << _filename << "'.";
+    return;
+  }
+
+  _image = builder.compile(size, time);
+  _loaded = true;
+}
@@ -0,0 +1,119 @@
+#ifndef USERPARSER_HH
+#define USERPARSER_HH
+
+#include <QIODevice>
+#include <QThread>
+#include <functional>
+#include "usercache.hh"
+#include "errorstack.hh"
+
+/** Streaming parser of the JSON user database as provided by radioid.net.
+ *
+ * In contrast to @c QJsonDocument, the parser never holds the complete document in memory.
+ * Instead, it reads the device in chunks and adds each entry of the "users" array directly to a
+ * @c UserCache::Builder. All other items of the document are skipped.
+ *
+ * @ingroup util */
+class UserParser
+{
+public:
+  /** Gets called whenever a new chunk is read, with the number of bytes read so far. */
+  typedef std::function<void(qint64 position)> Progress;
+
+public:
+  /** Constructs a parser reading from the given device into the given builder. */
+  UserParser(QIODevice *device, UserCache::Builder &builder, const Progress &progress=Progress());
+
+  /** Parses the document.
+   * @returns @c false on error. */
+  bool parse(const ErrorStack &err=ErrorStack());
+
+protected:
+  /** Returns the next char without consuming it or -1 at the end of the document. */
+  inline int peek() {
+    if ((_pos >= _len) && (! refill()))
+      return -1;
+    return uint8_t(_buffer[_pos]);
+  }
+  /** Returns and consumes the next char or -1 at the end of the document. */
+  inline int get() {
+    int c = peek();
+    if (0 <= c)
+      _pos++;
+    return c;
+  }
+  /** Reads the next chunk from the device. */
+  bool refill();
+  /** Skips any whitespace and returns the next char without consuming it. */
+  int skipWhitespace();
+  /** Consumes the given char after optional whitespace. */
+  bool expect(char c, const ErrorStack &err);
+
+  /** Parses a string into UTF-8. */
+  bool parseString(QByteArray &str, const ErrorStack &err);
+  /** Parses an unsigned integer number. Fractions and exponents are ignored. */
+  bool parseNumber(qint64 &value, const ErrorStack &err);
+  /** Skips any value. */
+  bool skipValue(const ErrorStack &err, unsigned depth=0);
+  /** Parses the array of users. */
+  bool parseUsers(const ErrorStack &err);
+  /** Parses a single user object and adds it to the builder. */
+  bool parseUser(const ErrorStack &err);
+
+protected:
+  /** The device to read from. */
+  QIODevice *_device;
+  /** The builder, the parsed users are added to. */
+  UserCache::Builder &_builder;
+  /** The progress callback. */
+  Progress _progress;
+  /** The current chunk. */
+  QByteArray _buffer;
+  /** The position within the current chunk. */
+  int _pos;
+  /** The length of the current chunk. */
+  int _len;
+  /** The number of bytes read so far. */
+  qint64 _offset;
+};
+
+
+/** Parses the JSON user database in a separate thread and compiles it into a cache image.
+ *
+ * @ingroup util */
+class UserLoader: public QThread
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a loader for the specified JSON user database. */
+  explicit UserLoader(const QString &filename, QObject *parent=nullptr);
+
+  /** Returns the filename of the JSON user database. */
+  const QString &filename() const;
+  /** Returns @c true if the database was loaded successfully. */
+  bool isLoaded() const;
+  /** Returns the compiled image. */
+  const QByteArray &image() const;
+  /** Returns the error messages, if loading failed. */
+  const ErrorStack &errorStack() const;
+
+signals:
+  /** Gets emitted on loading progress. */
+  void progress(int percent);
+
+protected:
+  void run();
+
+protected:
+  /** The filename of the JSON user database. */
+  QString _filename;
+  /** If @c true, the database was loaded successfully. */
+  bool _loaded;
+  /** The compiled image. */
+  QByteArray _image;
+  /** The error messages. */
+  ErrorStack _errorStack;
+};
+
+#endif // USERPARSER_HH
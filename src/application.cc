@@ -6,6 +6,7 @@
 #include "logger.hh"
 #include "radio.hh"
 #include "codeplug.hh"
+#include "codeplugsession.hh"
 #include "config.h"
 #include "settings.hh"
 #include "radiolimits.hh"
@@ -40,7 +41,8 @@
 
 
 Application::Application(int &argc, char *argv[])
-  : QApplication(argc, argv), _config(nullptr), _mainWindow(nullptr), _repeater(nullptr),
+  : QApplication(argc, argv), _config(nullptr), _codeplugSession(nullptr), _mainWindow(nullptr),
+    _repeater(nullptr),
     _lastDevice()
 {
   setApplicationName("qdmr");
@@ -62,6 +64,7 @@ Application::Application(int &argc, char *argv[])
   _users      = new UserDatabase(30, this);
   _talkgroups = new TalkGroupDatabase(30, this);
   _config = new Config(this);
+  _codeplugSession = new CodeplugSession(_config, this);
 
   if (argc>1) {
     QFileInfo info(argv[1]);
@@ -577,6 +580,8 @@ Application::uploadCodeplug() {
   connect(radio, SIGNAL(uploadError(Radio *)), this, SLOT(onCodeplugUploadError(Radio *)));
   connect(radio, SIGNAL(uploadComplete(Radio *)), this, SLOT(onCodeplugUploaded(Radio *)));
 
+  radio->setCodeplugSession(_codeplugSession);
+
   ErrorStack err;
   if (radio->startUpload(_config, false, settings.codePlugFlags(), err)) {
      _mainWindow->statusBar()->showMessage(tr("Upload ..."));
@@ -613,9 +618,11 @@ Application::uploadCallsignDB() {
     return;
   }
 
-  // Sort call-sign DB w.r.t. the current DMR ID in _config
-  // this is part of the "auto-selection" of calls-signs for upload
+  // Select call-signs w.r.t. the current DMR ID in _config
+  // this is part of the "auto-selection" of calls-signs for upload. The selection does not reorder
+  // the user database shown in the GUI.
   Settings settings;
+  CallsignDB::Selection css;
   if (settings.selectUsingUserDMRID()) {
     if (nullptr == _config->radioIDs()->defaultId()) {
       QMessageBox::critical(nullptr, tr("Cannot write call-sign DB."),
@@ -624,21 +631,53 @@ Application::uploadCallsignDB() {
       radio->deleteLater();
       return;
     }
-    // Sort w.r.t users DMR ID
+    // Select w.r.t users DMR ID
     unsigned id = _config->radioIDs()->defaultId()->number();
-    logDebug() << "Sort call-signs closest to ID=" << id << ".";
-    _users->sortUsers(id);
+    logDebug() << "Select call-signs closest to ID=" << id << ".";
+    css.setPrefixes(QSet<unsigned>{id});
   } else {
-    // sort w.r.t. chosen prefixes
+    // select w.r.t. chosen prefixes
     QSet<unsigned> ids=settings.callSignDBPrefixes(); QStringList prefs;
     foreach (unsigned pref, ids)
       prefs.append(QString::number(pref));
-    logDebug() << "Sort call-signs closest to IDs={" << prefs.join(", ") << "}.";
-    _users->sortUsers(ids);
+    logDebug() << "Select call-signs closest to IDs={" << prefs.join(", ") << "}.";
+    css.setPrefixes(ids);
+  }
+
+  // Assemble filters for callsign DB encoding
+  css.setCountries(settings.callSignDBCountries());
+  css.setStates(settings.callSignDBStates());
+  QList<CallsignDB::Selection::IDRange> ranges;
+  ErrorStack rangeErr;
+  if (! CallsignDB::Selection::parseIDRanges(settings.callSignDBIDRanges(), ranges, rangeErr)) {
+    ErrorMessageView(rangeErr).show();
+    radio->deleteLater();
+    return;
+  }
+  css.setIDRanges(ranges);
+  if (! settings.callSignDBPattern().isEmpty()) {
+    QRegularExpression pattern(settings.callSignDBPattern(), QRegularExpression::CaseInsensitiveOption);
+    if (! pattern.isValid()) {
+      QMessageBox::critical(nullptr, tr("Cannot write call-sign DB."),
+                            tr("Invalid call-sign pattern '%1': %2")
+                            .arg(settings.callSignDBPattern()).arg(pattern.errorString()));
+      radio->deleteLater();
+      return;
+    }
+    css.setCallsignPattern(pattern);
+  }
+  if (! settings.callSignDBHeardList().isEmpty()) {
+    QSet<unsigned> heard;
+    ErrorStack heardErr;
+    if (! CallsignDB::Selection::readHeard(settings.callSignDBHeardList(), heard, heardErr)) {
+      ErrorMessageView(heardErr).show();
+      radio->deleteLater();
+      return;
+    }
+    css.setHeard(heard);
   }
 
   // Assemble flags for callsign DB encoding
-  CallsignDB::Selection css;
   if (settings.limitCallSignDBEntries()) {
     logDebug() << "Limit callsign DB entries to " << settings.maxCallSignDBEntries() << ".";
     css.setCountLimit(settings.maxCallSignDBEntries());
@@ -13,6 +13,7 @@ class QMainWindow;
 class RepeaterBookList;
 class UserDatabase;
 class TalkGroupDatabase;
+class CodeplugSession;
 class RadioIDListView;
 class GeneralSettingsView;
 class ContactListView;
@@ -80,6 +81,7 @@ private slots:
 
 protected:
   Config *_config;
+  CodeplugSession *_codeplugSession;
   QMainWindow *_mainWindow;
 
   GeneralSettingsView *_generalSettings;
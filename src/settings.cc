@@ -160,6 +160,51 @@ Settings::setCallSignDBPrefixes(const QSet<unsigned> &prefixes) {
   endArray();
 }
 
+QStringList
+Settings::callSignDBCountries() const {
+  return value("callSignDBCountries", QStringList()).toStringList();
+}
+void
+Settings::setCallSignDBCountries(const QStringList &countries) {
+  setValue("callSignDBCountries", countries);
+}
+
+QStringList
+Settings::callSignDBStates() const {
+  return value("callSignDBStates", QStringList()).toStringList();
+}
+void
+Settings::setCallSignDBStates(const QStringList &states) {
+  setValue("callSignDBStates", states);
+}
+
+QString
+Settings::callSignDBIDRanges() const {
+  return value("callSignDBIDRanges", "").toString();
+}
+void
+Settings::setCallSignDBIDRanges(const QString &ranges) {
+  setValue("callSignDBIDRanges", ranges);
+}
+
+QString
+Settings::callSignDBPattern() const {
+  return value("callSignDBPattern", "").toString();
+}
+void
+Settings::setCallSignDBPattern(const QString &pattern) {
+  setValue("callSignDBPattern", pattern);
+}
+
+QString
+Settings::callSignDBHeardList() const {
+  return value("callSignDBHeardList", "").toString();
+}
+void
+Settings::setCallSignDBHeardList(const QString &filename) {
+  setValue("callSignDBHeardList", filename);
+}
+
 bool
 Settings::ignoreVerificationWarning() const {
   return value("ignoreVerificationWarning", true).toBool();
@@ -318,6 +363,11 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     prefs_text.append(QString::number(prefix));
   }
   Ui::SettingsDialog::prefixes->setText(prefs_text.join(", "));
+  Ui::SettingsDialog::dbCountries->setText(settings.callSignDBCountries().join(", "));
+  Ui::SettingsDialog::dbStates->setText(settings.callSignDBStates().join(", "));
+  Ui::SettingsDialog::dbIDRanges->setText(settings.callSignDBIDRanges());
+  Ui::SettingsDialog::dbCallPattern->setText(settings.callSignDBPattern());
+  Ui::SettingsDialog::dbHeardList->setText(settings.callSignDBHeardList());
 
   Ui::SettingsDialog::commercialFeatures->setChecked(settings.showCommercialFeatures());
   Ui::SettingsDialog::showExtensions->setChecked(settings.showExtensions());
@@ -396,6 +446,22 @@ SettingsDialog::accept() {
   }
   settings.setCallSignDBPrefixes(prefs);
 
+  QStringList countries;
+  foreach (QString country, dbCountries->text().split(",")) {
+    if (! country.trimmed().isEmpty())
+      countries.append(country.trimmed());
+  }
+  settings.setCallSignDBCountries(countries);
+  QStringList states;
+  foreach (QString state, dbStates->text().split(",")) {
+    if (! state.trimmed().isEmpty())
+      states.append(state.trimmed());
+  }
+  settings.setCallSignDBStates(states);
+  settings.setCallSignDBIDRanges(dbIDRanges->text().simplified());
+  settings.setCallSignDBPattern(dbCallPattern->text().trimmed());
+  settings.setCallSignDBHeardList(dbHeardList->text().trimmed());
+
   settings.setShowCommercialFeatures(commercialFeatures->isChecked());
   settings.setShowExtensions(showExtensions->isChecked());
 
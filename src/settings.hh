@@ -52,6 +52,16 @@ public:
   void setSelectUsingUserDMRID(bool enable);
   QSet<unsigned> callSignDBPrefixes();
   void setCallSignDBPrefixes(const QSet<unsigned> &prefixes);
+  QStringList callSignDBCountries() const;
+  void setCallSignDBCountries(const QStringList &countries);
+  QStringList callSignDBStates() const;
+  void setCallSignDBStates(const QStringList &states);
+  QString callSignDBIDRanges() const;
+  void setCallSignDBIDRanges(const QString &ranges);
+  QString callSignDBPattern() const;
+  void setCallSignDBPattern(const QString &pattern);
+  QString callSignDBHeardList() const;
+  void setCallSignDBHeardList(const QString &filename);
 
   bool ignoreVerificationWarning() const;
   void setIgnoreVerificationWarning(bool ignore);
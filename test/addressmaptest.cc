@@ -0,0 +1,66 @@
+#include "addressmaptest.hh"
+#include "addressmap.hh"
+#include <QTest>
+
+AddressMapTest::AddressMapTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+AddressMapTest::testFind() {
+  AddressMap map;
+  QCOMPARE(map.find(0x0000), -1);
+
+  QVERIFY(map.add(0x0100, 0x10));
+  QVERIFY(map.add(0x0200, 0x10));
+  QVERIFY(map.add(0x0000, 0x10));
+  QCOMPARE(map.find(0x0105), 0);
+  QCOMPARE(map.find(0x020f), 1);
+  QCOMPARE(map.find(0x0005), 2);
+  QCOMPARE(map.find(0x0110), -1);
+  QCOMPARE(map.find(0xffffffff), -1);
+
+  // Overlapping regions are rejected
+  QVERIFY(map.overlaps(0x01f0, 0x11));
+  QVERIFY(! map.overlaps(0x01f0, 0x10));
+  QVERIFY(! map.add(0x0108, 0x10));
+  QCOMPARE(map.size(), size_t(3));
+}
+
+void
+AddressMapTest::testInsertRemove() {
+  AddressMap map;
+  map.add(0x0000, 0x10, 0);
+  map.add(0x0020, 0x10, 1);
+  // Inserting shifts all following indices
+  map.add(0x0010, 0x10, 1);
+  QCOMPARE(map.find(0x0000), 0);
+  QCOMPARE(map.find(0x0010), 1);
+  QCOMPARE(map.find(0x0020), 2);
+
+  // Removing shifts all following indices
+  QVERIFY(map.rem(0x0000, 0));
+  QCOMPARE(map.find(0x0000), -1);
+  QCOMPARE(map.find(0x0010), 0);
+  QCOMPARE(map.find(0x0020), 1);
+  QVERIFY(! map.rem(0x0000, 0));
+}
+
+void
+AddressMapTest::testBuild() {
+  std::vector<AddressMap::Region> regions;
+  regions.push_back(AddressMap::Region(0x0300, 0x010));
+  regions.push_back(AddressMap::Region(0x0100, 0x100));
+  regions.push_back(AddressMap::Region(0x0180, 0x010)); // overlaps previous
+  regions.push_back(AddressMap::Region(0x0000, 0x010));
+
+  AddressMap map;
+  QVERIFY(! map.build(regions));
+  QCOMPARE(map.size(), size_t(3));
+  QCOMPARE(map.find(0x0305), 0);
+  QCOMPARE(map.find(0x0185), 1);
+  QCOMPARE(map.find(0x0005), 3);
+}
+
+QTEST_GUILESS_MAIN(AddressMapTest)
@@ -0,0 +1,19 @@
+#ifndef ADDRESSMAPTEST_HH
+#define ADDRESSMAPTEST_HH
+
+#include <QObject>
+
+class AddressMapTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit AddressMapTest(QObject *parent = nullptr);
+
+private slots:
+  void testFind();
+  void testInsertRemove();
+  void testBuild();
+};
+
+#endif // ADDRESSMAPTEST_HH
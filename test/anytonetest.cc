@@ -0,0 +1,78 @@
+#include "anytonetest.hh"
+#include "d868uv_codeplug.hh"
+#include "d878uv_codeplug.hh"
+#include "dfufilecompare.hh"
+#include <QTest>
+
+// Exceeds the number of channels and contacts encoded per task, hence the parallel encoding
+// splits the channels and contacts into several ranges.
+#define NUM_OBJECTS 1200
+
+AnytoneTest::AnytoneTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+AnytoneTest::initTestCase() {
+  // Read simple configuration file
+  QString errMessage;
+  QVERIFY(_config.readCSV("://testconfig.conf", errMessage));
+
+  // Add many channels and contacts
+  DigitalChannel *channel = _config.channelList()->channel(0)->as<DigitalChannel>();
+  QVERIFY(nullptr != channel);
+  for (int i=_config.channelList()->count(); i<NUM_OBJECTS; i++) {
+    DigitalChannel *copy = new DigitalChannel(*channel);
+    copy->setName(QString("CH %1").arg(i));
+    QVERIFY(0 <= _config.channelList()->add(copy));
+  }
+  for (int i=_config.contacts()->digitalCount(); i<NUM_OBJECTS; i++) {
+    QVERIFY(0 <= _config.contacts()->add(
+              new DigitalContact(DigitalContact::PrivateCall, QString("CALL %1").arg(i), 2620000+i)));
+  }
+}
+
+void
+AnytoneTest::cleanupTestCase() {
+  // clear config
+  _config.clear();
+}
+
+void
+AnytoneTest::encode(AnytoneCodeplug &codeplug, const Codeplug::Flags &flags) {
+  codeplug.allocateUpdated();
+  codeplug.setBitmaps(&_config);
+  codeplug.allocateForEncoding();
+  QVERIFY(codeplug.encode(&_config, flags));
+}
+
+void
+AnytoneTest::testD868UVParallelEncode() {
+  Codeplug::Flags flags;
+  D868UVCodeplug serial;
+  encode(serial, flags);
+
+  flags.parallelEncode = true;
+  D868UVCodeplug parallel;
+  encode(parallel, flags);
+
+  // Compare all elements
+  compareDFUFiles(parallel, serial);
+}
+
+void
+AnytoneTest::testD878UVParallelEncode() {
+  Codeplug::Flags flags;
+  D878UVCodeplug serial;
+  encode(serial, flags);
+
+  flags.parallelEncode = true;
+  D878UVCodeplug parallel;
+  encode(parallel, flags);
+
+  // Compare all elements
+  compareDFUFiles(parallel, serial);
+}
+
+QTEST_GUILESS_MAIN(AnytoneTest)
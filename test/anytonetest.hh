@@ -0,0 +1,32 @@
+#ifndef ANYTONETEST_HH
+#define ANYTONETEST_HH
+
+#include "config.hh"
+#include "anytone_codeplug.hh"
+
+#include <QObject>
+
+
+class AnytoneTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit AnytoneTest(QObject *parent = nullptr);
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void testD868UVParallelEncode();
+  void testD878UVParallelEncode();
+
+protected:
+  /** Encodes the config into the given codeplug. */
+  void encode(AnytoneCodeplug &codeplug, const Codeplug::Flags &flags);
+
+protected:
+  Config _config;
+};
+
+#endif // ANYTONETEST_HH
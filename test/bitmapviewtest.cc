@@ -0,0 +1,70 @@
+#include "bitmapviewtest.hh"
+#include "bitmapview.hh"
+#include <QTest>
+#include <cstring>
+
+BitmapViewTest::BitmapViewTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+BitmapViewTest::testSetRange() {
+  uint8_t data[32]; memset(data, 0xaa, sizeof(data));
+  BitmapView bitmap(data, 250);
+  bitmap.clear();
+  QCOMPARE(bitmap.count(), 0u);
+  // Bits beyond the bitmap are left untouched
+  QCOMPARE(data[31], uint8_t(0xa8));
+
+  bitmap.setRange(3, 70);
+  QCOMPARE(bitmap.count(), 70u);
+  QCOMPARE(data[0], uint8_t(0xf8));
+  QCOMPARE(data[8], uint8_t(0xff));
+  QCOMPARE(data[9], uint8_t(0x01));
+  QVERIFY(! bitmap.isSet(2));
+  QVERIFY(bitmap.isSet(72));
+  QVERIFY(! bitmap.isSet(73));
+
+  // Ranges are clipped to the size of the bitmap
+  bitmap.setRange(200, 100);
+  QCOMPARE(bitmap.count(), 120u);
+  QCOMPARE(data[31], uint8_t(0xab));
+}
+
+void
+BitmapViewTest::testIterate() {
+  uint8_t data[128]; memset(data, 0x00, sizeof(data));
+  BitmapView bitmap(data, 1000);
+  QCOMPARE(bitmap.first(), 1000u);
+
+  QList<unsigned> expected = { 0, 7, 8, 63, 64, 65, 500, 999 };
+  foreach (unsigned i, expected)
+    bitmap.set(i);
+  QList<unsigned> indices;
+  for (unsigned i=bitmap.first(); i<bitmap.size(); i=bitmap.next(i+1))
+    indices.append(i);
+  QCOMPARE(indices, expected);
+  QCOMPARE(bitmap.count(), unsigned(expected.size()));
+  QCOMPARE(bitmap.next(501), 999u);
+
+  bitmap.set(63, false);
+  QCOMPARE(bitmap.next(9), 64u);
+}
+
+void
+BitmapViewTest::testInverted() {
+  uint8_t data[16]; memset(data, 0xff, sizeof(data));
+  BitmapView bitmap(data, 100, true);
+  QCOMPARE(bitmap.count(), 0u);
+  QCOMPARE(bitmap.first(), 100u);
+
+  bitmap.setRange(0, 10);
+  QCOMPARE(data[0], uint8_t(0x00));
+  QCOMPARE(data[1], uint8_t(0xfc));
+  QCOMPARE(bitmap.count(), 10u);
+  QCOMPARE(bitmap.next(5), 5u);
+  QCOMPARE(bitmap.next(10), 100u);
+}
+
+QTEST_GUILESS_MAIN(BitmapViewTest)
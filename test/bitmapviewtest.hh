@@ -0,0 +1,19 @@
+#ifndef BITMAPVIEWTEST_HH
+#define BITMAPVIEWTEST_HH
+
+#include <QObject>
+
+class BitmapViewTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit BitmapViewTest(QObject *parent = nullptr);
+
+private slots:
+  void testSetRange();
+  void testIterate();
+  void testInverted();
+};
+
+#endif // BITMAPVIEWTEST_HH
@@ -0,0 +1,101 @@
+#include "codeplugsessiontest.hh"
+#include "codeplugsession.hh"
+#include "d868uv_codeplug.hh"
+#include "config.hh"
+#include "dfufilecompare.hh"
+#include <QTest>
+
+CodeplugSessionTest::CodeplugSessionTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+CodeplugSessionTest::allocate(D868UVCodeplug &codeplug, Config *config) {
+  codeplug.allocateUpdated();
+  codeplug.setBitmaps(config);
+  codeplug.allocateForEncoding();
+}
+
+void
+CodeplugSessionTest::compare(D868UVCodeplug &codeplug, Config *config) {
+  D868UVCodeplug reference;
+  allocate(reference, config);
+  QVERIFY(reference.encode(config));
+
+  compareDFUFiles(codeplug, reference);
+}
+
+void
+CodeplugSessionTest::testIncremental() {
+  Config config;
+  QString errMessage;
+  QVERIFY(config.readCSV("://testconfig.conf", errMessage));
+
+  D868UVCodeplug codeplug;
+  allocate(codeplug, &config);
+  CodeplugSession session(&config);
+  QVERIFY(session.encode(&codeplug, Codeplug::Flags(), false));
+  QVERIFY(! session.wasPartial());
+  QVERIFY(session.isRetained());
+  QVERIFY(session.modified().isEmpty());
+
+  // Modify a channel and a contact, the latter twice
+  config.channelList()->channel(1)->setName("Modified");
+  config.contacts()->digitalContact(0)->setName("Other");
+  config.contacts()->digitalContact(0)->setNumber(1234);
+  QCOMPARE(session.modified().count(), 2);
+
+  QVERIFY(session.encode(&codeplug, Codeplug::Flags(), true));
+  // Only the modified objects were updated, not the complete codeplug
+  QVERIFY(session.wasPartial());
+  QVERIFY(session.isRetained());
+  QVERIFY(session.modified().isEmpty());
+  compare(codeplug, &config);
+}
+
+void
+CodeplugSessionTest::testMoved() {
+  Config config;
+  QString errMessage;
+  QVERIFY(config.readCSV("://testconfig.conf", errMessage));
+
+  D868UVCodeplug codeplug;
+  allocate(codeplug, &config);
+  CodeplugSession session(&config);
+  QVERIFY(session.encode(&codeplug, Codeplug::Flags(), false));
+
+  // Moving channels changes their indices without notification, hence the complete codeplug must
+  // be encoded.
+  config.channelList()->channel(0)->setName("Modified");
+  QVERIFY(config.channelList()->moveDown(0));
+  QVERIFY(session.encode(&codeplug, Codeplug::Flags(), true));
+  QVERIFY(! session.wasPartial());
+  QVERIFY(session.isRetained());
+  compare(codeplug, &config);
+}
+
+void
+CodeplugSessionTest::testInvalidate() {
+  Config config;
+  QString errMessage;
+  QVERIFY(config.readCSV("://testconfig.conf", errMessage));
+
+  D868UVCodeplug codeplug;
+  allocate(codeplug, &config);
+  CodeplugSession session(&config);
+  QVERIFY(session.encode(&codeplug, Codeplug::Flags(), false));
+  QVERIFY(session.isRetained());
+
+  // Removing an object discards the previous encoding
+  QVERIFY(config.zones()->del(config.zones()->get(0)));
+  QVERIFY(! session.isRetained());
+
+  // Modifying the settings discards the previous encoding too
+  QVERIFY(session.encode(&codeplug, Codeplug::Flags(), true));
+  QVERIFY(session.isRetained());
+  config.settings()->setSquelch(5);
+  QVERIFY(! session.isRetained());
+}
+
+QTEST_GUILESS_MAIN(CodeplugSessionTest)
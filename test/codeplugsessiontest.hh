@@ -0,0 +1,28 @@
+#ifndef CODEPLUGSESSIONTEST_HH
+#define CODEPLUGSESSIONTEST_HH
+
+#include <QObject>
+
+class D868UVCodeplug;
+class Config;
+
+class CodeplugSessionTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit CodeplugSessionTest(QObject *parent = nullptr);
+
+private slots:
+  void testIncremental();
+  void testMoved();
+  void testInvalidate();
+
+protected:
+  /** Allocates all elements of the codeplug for encoding the given config. */
+  void allocate(D868UVCodeplug &codeplug, Config *config);
+  /** Compares the codeplug with a complete encoding of the given config. */
+  void compare(D868UVCodeplug &codeplug, Config *config);
+};
+
+#endif // CODEPLUGSESSIONTEST_HH
@@ -15,4 +15,43 @@ CRC32Test::testCRC32() {
   QCOMPARE(crc.get(), 0x414FA339U^0xFFFFFFFF);
 }
 
+void
+CRC32Test::testBlockUpdate() {
+  QByteArray data(0x1000, 0);
+  for (int i=0; i<data.size(); i++)
+    data[i] = char((i*131) ^ (i>>3));
+
+  // Compare block-wise update with byte-wise one for all alignments and several lengths
+  for (int offset=0; offset<16; offset++) {
+    for (int len=0; len<(data.size()-offset); len += (len<300) ? 1 : 97) {
+      const uint8_t *ptr = (const uint8_t *)data.constData()+offset;
+      CRC32 block, bytewise;
+      block.update(ptr, len);
+      for (int i=0; i<len; i++)
+        bytewise.update(ptr[i]);
+      QCOMPARE(block.get(), bytewise.get());
+    }
+  }
+}
+
+void
+CRC32Test::benchmarkBytewise() {
+  QByteArray data(0x400000, char(0x5a));
+  const uint8_t *ptr = (const uint8_t *)data.constData();
+  QBENCHMARK {
+    CRC32 crc;
+    for (int i=0; i<data.size(); i++)
+      crc.update(ptr[i]);
+  }
+}
+
+void
+CRC32Test::benchmarkBlock() {
+  QByteArray data(0x400000, char(0x5a));
+  QBENCHMARK {
+    CRC32 crc;
+    crc.update(data);
+  }
+}
+
 QTEST_GUILESS_MAIN(CRC32Test)
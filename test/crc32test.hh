@@ -12,6 +12,9 @@ public:
 
 private slots:
   void testCRC32();
+  void testBlockUpdate();
+  void benchmarkBytewise();
+  void benchmarkBlock();
 };
 
 #endif // CRC32TEST_H
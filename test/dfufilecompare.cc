@@ -0,0 +1,17 @@
+#include "dfufilecompare.hh"
+#include <QTest>
+#include <cstring>
+
+void
+compareDFUFiles(const DFUFile &actual, const DFUFile &expected) {
+  QCOMPARE(actual.numImages(), expected.numImages());
+  for (int i=0; i<expected.numImages(); i++) {
+    QCOMPARE(actual.image(i).numElements(), expected.image(i).numElements());
+    for (int j=0; j<expected.image(i).numElements(); j++) {
+      const DFUFile::Element &a = expected.image(i).element(j), &b = actual.image(i).element(j);
+      QCOMPARE(b.address(), a.address());
+      QCOMPARE(b.memSize(), a.memSize());
+      QVERIFY(0 == memcmp(b.data(), a.data(), a.memSize()));
+    }
+  }
+}
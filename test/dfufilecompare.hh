@@ -0,0 +1,11 @@
+#ifndef DFUFILECOMPARE_HH
+#define DFUFILECOMPARE_HH
+
+#include "dfufile.hh"
+
+/** Compares all elements of the given DFU files, image by image. Any difference is reported as a
+ * failure of the current test. Hence, check @c QTest::currentTestFailed() if the calling test
+ * must not continue. */
+void compareDFUFiles(const DFUFile &actual, const DFUFile &expected);
+
+#endif // DFUFILECOMPARE_HH
@@ -0,0 +1,125 @@
+#include "dfufiletest.hh"
+#include "dfufile.hh"
+#include <QTest>
+#include <QTemporaryFile>
+
+DFUFileTest::DFUFileTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+DFUFileTest::testAddressing() {
+  DFUFile::Image image;
+  // Large element spanning several pages, followed by small elements sharing a page
+  image.addElement(0x00800000, 0x2000);
+  image.addElement(0x00802000, 0x0020);
+  image.addElement(0x00802040, 0x0020);
+  image.addElement(0x00900010, 0x1ff0);
+
+  QCOMPARE(image.data(0x00800000), image.element(0).data());
+  QCOMPARE(image.data(0x00801234), image.element(0).data()+0x1234);
+  QCOMPARE(image.data(0x00802010), image.element(1).data()+0x10);
+  QCOMPARE(image.data(0x00802040), image.element(2).data());
+  QCOMPARE(image.data(0x00901000), image.element(3).data()+0x0ff0);
+  QVERIFY(nullptr == image.data(0x00802020));
+  QVERIFY(nullptr == image.data(0x00900000));
+  QVERIFY(nullptr == image.data(0x00902000));
+
+  // Pointers remain valid when adding elements
+  unsigned char *ptr = image.data(0x00800100);
+  for (int i=0; i<256; i++)
+    image.addElement(0x01000000+i*0x100, 0x40);
+  QCOMPARE(image.data(0x00800100), ptr);
+
+  // Addressing remains valid after sorting
+  image.addElement(0x00000000, 0x10);
+  image.sort();
+  QCOMPARE(image.data(0x00801234), ptr+0x1134);
+  // Shared pages are resolved by the address map, which must be consistent after sorting
+  QCOMPARE(image.element(0).address(), 0x00000000U);
+  QCOMPARE(image.data(0x00802010), image.element(2).data()+0x10);
+  QCOMPARE(image.data(0x00802040), image.element(3).data());
+  QCOMPARE(image.data(0x01000010), image.element(5).data()+0x10);
+  QVERIFY(nullptr == image.data(0x00802020));
+}
+
+void
+DFUFileTest::testCopyOnWrite() {
+  DFUFile::Image image;
+  image.addElement(0x1000, 0x100);
+  memset(image.data(0x1000), 0x11, 0x100);
+
+  DFUFile::Image copy(image);
+  const DFUFile::Image &ccopy = copy;
+  QCOMPARE(ccopy.data(0x1000), ((const DFUFile::Image &)image).data(0x1000));
+
+  // Modification detaches the copy
+  memset(copy.data(0x1000), 0x22, 0x100);
+  QCOMPARE(int(image.data(0x1000)[0x80]), 0x11);
+  QCOMPARE(int(copy.data(0x1000)[0x80]), 0x22);
+
+  // Adding elements to the copy does not affect the original
+  copy.addElement(0x2000, 0x100);
+  QCOMPARE(copy.numElements(), 2);
+  QCOMPARE(image.numElements(), 1);
+  QVERIFY(nullptr == image.data(0x2000));
+}
+
+void
+DFUFileTest::testReadWrite() {
+  DFUFile file;
+  file.addImage("Test image");
+  file.image(0).addElement(0x0000, 0x40);
+  file.image(0).addElement(0x4000, 0x3000);
+  for (int i=0; i<0x40; i++)
+    file.data(0x0000)[i] = i;
+  for (int i=0; i<0x3000; i++)
+    file.data(0x4000)[i] = i*7;
+
+  QTemporaryFile tmp;
+  QVERIFY(tmp.open());
+  ErrorStack err;
+  QVERIFY2(file.write(tmp, err), err.format().toLocal8Bit().constData());
+  tmp.seek(0);
+
+  DFUFile read;
+  QVERIFY2(read.read(tmp, err), err.format().toLocal8Bit().constData());
+  QCOMPARE(read.numImages(), 1);
+  QCOMPARE(read.image(0).numElements(), 2);
+  QCOMPARE(read.image(0).element(1).address(), 0x4000U);
+  QCOMPARE(read.image(0).element(1).memSize(), 0x3000U);
+  QCOMPARE(0, memcmp(read.data(0x0000), file.data(0x0000), 0x40));
+  QCOMPARE(0, memcmp(read.data(0x4000), file.data(0x4000), 0x3000));
+}
+
+void
+DFUFileTest::testMappedReadWrite() {
+  DFUFile file;
+  file.addImage("Test image");
+  file.image(0).addElement(0x1000, 0x2000);
+  memset(file.data(0x1000), 0x11, 0x2000);
+
+  QTemporaryFile tmp;
+  QVERIFY(tmp.open());
+  tmp.close();
+  ErrorStack err;
+  QVERIFY2(file.write(tmp.fileName(), err), err.format().toLocal8Bit().constData());
+
+  // Modifying a file read does not modify the file itself
+  DFUFile mapped;
+  QVERIFY2(mapped.read(tmp.fileName(), err), err.format().toLocal8Bit().constData());
+  memset(mapped.data(0x1800), 0x22, 0x100);
+  DFUFile check;
+  QVERIFY2(check.read(tmp.fileName(), err), err.format().toLocal8Bit().constData());
+  QCOMPARE(int(check.data(0x1800)[0]), 0x11);
+
+  // Writing back to the file read from
+  QVERIFY2(mapped.write(tmp.fileName(), err), err.format().toLocal8Bit().constData());
+  QCOMPARE(int(mapped.data(0x1000)[0]), 0x11);
+  QVERIFY2(check.read(tmp.fileName(), err), err.format().toLocal8Bit().constData());
+  QCOMPARE(int(check.data(0x1800)[0]), 0x22);
+  QCOMPARE(int(check.data(0x1900)[0]), 0x11);
+}
+
+QTEST_GUILESS_MAIN(DFUFileTest)
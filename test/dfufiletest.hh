@@ -0,0 +1,20 @@
+#ifndef DFUFILETEST_HH
+#define DFUFILETEST_HH
+
+#include <QObject>
+
+class DFUFileTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit DFUFileTest(QObject *parent = nullptr);
+
+private slots:
+  void testAddressing();
+  void testCopyOnWrite();
+  void testReadWrite();
+  void testMappedReadWrite();
+};
+
+#endif // DFUFILETEST_HH
@@ -0,0 +1,295 @@
+#include "emulatortest.hh"
+#include "anytone_emulator.hh"
+#include "anytone_interface.hh"
+#include "opengd77_emulator.hh"
+#include "opengd77_interface.hh"
+#include "tyt_emulator.hh"
+#include "tyt_interface.hh"
+#include "uv390.hh"
+#include "config.hh"
+#include "radioddity_emulator.hh"
+#include "radioddity_interface.hh"
+#include "rd5r.hh"
+#include "dfufilecompare.hh"
+#include <cstring>
+#include <algorithm>
+#include <QTest>
+
+static QByteArray
+pattern(int size, int seed=0) {
+  QByteArray data(size, 0);
+  for (int i=0; i<size; i++)
+    data[i] = char((i*7+seed) & 0xff);
+  return data;
+}
+
+EmulatorTest::EmulatorTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+EmulatorTest::testAnytone() {
+  AnytoneEmulator emulator("D878UV");
+  QVERIFY(emulator.isOpen());
+  QVERIFY(USBDeviceDescriptor::detect().size() >= 1);
+  QVERIFY(emulator.descriptor().isValid());
+
+  QByteArray image = pattern(0x100);
+  emulator.write(0, 0x02fa0000, (const uint8_t *)image.constData(), image.size());
+
+  ErrorStack err;
+  AnytoneInterface dev(emulator.descriptor(), err);
+  QVERIFY2(dev.isOpen(), err.format().toLocal8Bit().constData());
+  QCOMPARE(dev.identifier().id(), RadioInfo::D878UV);
+
+  QByteArray data(0x100, 0);
+  QVERIFY(dev.read_start(0, 0x02fa0000, err));
+  QVERIFY2(dev.read(0, 0x02fa0000, (uint8_t *)data.data(), data.size(), err),
+           err.format().toLocal8Bit().constData());
+  QCOMPARE(data, image);
+
+  QByteArray update = pattern(0x40, 3);
+  QVERIFY(dev.write_start(0, 0x02fa0040, err));
+  QVERIFY(dev.write(0, 0x02fa0040, (uint8_t *)update.data(), update.size(), err));
+  QByteArray written(0x40, 0);
+  emulator.read(0, 0x02fa0040, (uint8_t *)written.data(), written.size());
+  QCOMPARE(written, update);
+
+  dev.reboot();
+  QVERIFY(! emulator.inProgramMode());
+}
+
+void
+EmulatorTest::testAnytonePipelining() {
+  AnytoneEmulator emulator("D878UV");
+  // The latency ensures, that further requests are sent before the first response is due.
+  emulator.setLatency(5000);
+
+  ErrorStack err;
+  AnytoneInterface dev(emulator.descriptor(), err);
+  QVERIFY2(dev.isOpen(), err.format().toLocal8Bit().constData());
+
+  QByteArray data(0x200, 0);
+
+  dev.setReadWindow(1);
+  emulator.resetMaxPending();
+  QVERIFY(dev.read(0, 0, (uint8_t *)data.data(), data.size(), err));
+  QCOMPARE(emulator.maxPending(), 1u);
+
+  dev.setReadWindow(8);
+  emulator.resetMaxPending();
+  QVERIFY(dev.read(0, 0, (uint8_t *)data.data(), data.size(), err));
+  QVERIFY(1 < emulator.maxPending());
+  QVERIFY(8 >= emulator.maxPending());
+  QCOMPARE(data, QByteArray(0x200, char(0xff)));
+
+  QByteArray content = pattern(0x200, 3);
+  dev.setWriteWindow(1);
+  emulator.resetMaxPending();
+  QVERIFY(dev.write(0, 0x1000, (uint8_t *)content.data(), content.size(), err));
+  QCOMPARE(emulator.maxPending(), 1u);
+
+  dev.setWriteWindow(8);
+  emulator.resetMaxPending();
+  QVERIFY(dev.write(0, 0x2000, (uint8_t *)content.data(), content.size(), err));
+  QVERIFY(1 < emulator.maxPending());
+  QVERIFY(8 >= emulator.maxPending());
+  emulator.read(0, 0x1000, (uint8_t *)data.data(), data.size());
+  QCOMPARE(data, content);
+  emulator.read(0, 0x2000, (uint8_t *)data.data(), data.size());
+  QCOMPARE(data, content);
+}
+
+void
+EmulatorTest::testOpenGD77() {
+  OpenGD77Emulator emulator;
+  // Force the interface to reduce its chunk size
+  emulator.setMaxChunkSize(128);
+  QByteArray eeprom = pattern(0x400), flash = pattern(0x2000, 5);
+  emulator.write(OpenGD77Interface::EEPROM, 0x0080, (const uint8_t *)eeprom.constData(), eeprom.size());
+
+  ErrorStack err;
+  OpenGD77Interface dev(emulator.descriptor(), err);
+  QVERIFY2(dev.isOpen(), err.format().toLocal8Bit().constData());
+
+  QByteArray data(eeprom.size(), 0);
+  QVERIFY(dev.read_start(OpenGD77Interface::EEPROM, 0x0080, err));
+  QVERIFY2(dev.read(OpenGD77Interface::EEPROM, 0x0080, (uint8_t *)data.data(), data.size(), err),
+           err.format().toLocal8Bit().constData());
+  QVERIFY(dev.read_finish(err));
+  QCOMPARE(data, eeprom);
+  // The chunk size grows from the minimum until rejected once, but is never tried again
+  QCOMPARE(dev.metrics().counter(TransferMetrics::Read).retries, 1u);
+
+  // Write across a flash sector boundary
+  QVERIFY(dev.write_start(OpenGD77Interface::FLASH, 0x1f000, err));
+  QVERIFY2(dev.write(OpenGD77Interface::FLASH, 0x1f000, (uint8_t *)flash.data(), flash.size(), err),
+           err.format().toLocal8Bit().constData());
+  QVERIFY(dev.write_start(OpenGD77Interface::EEPROM, 0, err));
+  QByteArray written(flash.size(), 0);
+  emulator.read(OpenGD77Interface::FLASH, 0x1f000, (uint8_t *)written.data(), written.size());
+  QCOMPARE(written, flash);
+  QCOMPARE(dev.metrics().counter(TransferMetrics::Write).retries, 1u);
+}
+
+void
+EmulatorTest::testTyT() {
+  TyTEmulator emulator("MD-UV390");
+
+  ErrorStack err;
+  TyTInterface dev(emulator.descriptor(), err);
+  QVERIFY2(dev.isOpen(), err.format().toLocal8Bit().constData());
+  QCOMPARE(dev.identifier().id(), RadioInfo::UV390);
+
+  // Writing without erasing can only clear bits
+  QByteArray data = pattern(0x400), zeros(0x400, 0);
+  emulator.write(0, 0x10000, (const uint8_t *)zeros.constData(), zeros.size());
+  QVERIFY(dev.write(0, 0x10000, (uint8_t *)data.data(), data.size(), err));
+  QByteArray read(0x400, 0xff);
+  QVERIFY(dev.read(0, 0x10000, (uint8_t *)read.data(), read.size(), err));
+  QCOMPARE(read, zeros);
+
+  // After erasing, the data is written correctly
+  QVERIFY(dev.erase(0x10000, 0x400, nullptr, nullptr, err));
+  QCOMPARE(emulator.erasedSectors(), 1U);
+  QVERIFY(dev.write(0, 0x10000, (uint8_t *)data.data(), data.size(), err));
+  QVERIFY(dev.read(0, 0x10000, (uint8_t *)read.data(), read.size(), err));
+  QCOMPARE(read, data);
+}
+
+void
+EmulatorTest::testTyTUpload() {
+  Config config;
+  QString errMessage;
+  QVERIFY(config.readCSV("://testconfig.conf", errMessage));
+
+  TyTEmulator emulator("MD-UV390");
+  // Fill the memory with zeros, hence any block written into a sector not erased before gets
+  // corrupted.
+  emulator.fill(0, 0, 0x200000, 0x00);
+
+  ErrorStack err;
+  UV390 radio(new TyTInterface(emulator.descriptor(), err));
+  Codeplug::Flags flags;
+  flags.updateCodePlug = false;
+  QVERIFY2(radio.startUpload(&config, true, flags, err), err.format().toLocal8Bit().constData());
+
+  // Read back the image and compare all elements. At least one element spans several sectors.
+  bool multiSector = false;
+  const DFUFile::Image &image = radio.codeplug().image(0);
+  for (int i=0; i<image.numElements(); i++) {
+    const DFUFile::Element &el = image.element(i);
+    multiSector |= (el.memSize() > 0x10000);
+    QByteArray written(el.memSize(), 0);
+    emulator.read(0, el.address(), (uint8_t *)written.data(), written.size());
+    QVERIFY2(0 == memcmp(written.constData(), el.data(), el.memSize()),
+             QString("Element at 0x%1 differs.").arg(el.address(), 0, 16).toLocal8Bit().constData());
+  }
+  QVERIFY(multiSector);
+}
+
+void
+EmulatorTest::testRadioddity() {
+  RadioddityEmulator emulator("BF-5R");
+  QByteArray image = pattern(0x100);
+  emulator.write(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0x1000,
+                 (const uint8_t *)image.constData(), image.size());
+
+  ErrorStack err;
+  RadioddityInterface dev(emulator.descriptor(), err);
+  QVERIFY2(dev.isOpen(), err.format().toLocal8Bit().constData());
+  QCOMPARE(dev.identifier().id(), RadioInfo::RD5R);
+
+  QByteArray data(image.size(), 0);
+  QVERIFY(dev.read_start(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0x1000, err));
+  QVERIFY2(dev.read(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0x1000, (uint8_t *)data.data(),
+                    data.size(), err), err.format().toLocal8Bit().constData());
+  QCOMPARE(data, image);
+
+  QByteArray update = pattern(0x40, 9);
+  QVERIFY(dev.write_start(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0x0100, err));
+  QVERIFY(dev.write(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0x0100, (uint8_t *)update.data(),
+                    update.size(), err));
+  QByteArray written(update.size(), 0);
+  emulator.read(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0x0100, (uint8_t *)written.data(),
+                written.size());
+  QCOMPARE(written, update);
+}
+
+void
+EmulatorTest::testRadioddityPipelining() {
+  RadioddityEmulator emulator("BF-5R");
+  // Every block of the pattern differs, hence any reordering shifts data into the wrong block
+  QByteArray image = pattern(0x100);
+  emulator.write(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0x1000,
+                 (const uint8_t *)image.constData(), image.size());
+
+  ErrorStack err;
+  RadioddityInterface dev(emulator.descriptor(), err);
+  QVERIFY2(dev.isOpen(), err.format().toLocal8Bit().constData());
+  dev.setWindow(4);
+
+  QByteArray data(image.size(), 0);
+  QVERIFY(dev.read_start(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0x1000, err));
+  QVERIFY2(dev.read(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0x1000, (uint8_t *)data.data(),
+                    data.size(), err), err.format().toLocal8Bit().constData());
+  QCOMPARE(dev.maxInFlight(), 4u);
+  QCOMPARE(data, image);
+
+  QByteArray update = pattern(0x100, 5);
+  QVERIFY(dev.write_start(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0x0100, err));
+  QVERIFY(dev.write(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0x0100, (uint8_t *)update.data(),
+                    update.size(), err));
+  QCOMPARE(dev.maxInFlight(), 4u);
+  QByteArray written(update.size(), 0);
+  emulator.read(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0x0100, (uint8_t *)written.data(),
+                written.size());
+  QCOMPARE(written, update);
+
+  // No batch fell back to single block transfers
+  QCOMPARE(dev.metrics().counter(TransferMetrics::Read).retries, 0u);
+  QCOMPARE(dev.metrics().counter(TransferMetrics::Write).retries, 0u);
+}
+
+void
+EmulatorTest::testRadioddityUpload() {
+  Config config;
+  QString errMessage;
+  QVERIFY(config.readCSV("://testconfig.conf", errMessage));
+
+  RadioddityEmulator emulator("BF-5R");
+  emulator.fill(RadioddityInterface::MEMBANK_CODEPLUG_LOWER, 0, 0x10000, 0x00);
+  emulator.fill(RadioddityInterface::MEMBANK_CODEPLUG_UPPER, 0, 0x10000, 0x00);
+
+  ErrorStack err;
+  RD5R radio(new RadioddityInterface(emulator.descriptor(), err));
+  Codeplug::Flags flags;
+  flags.updateCodePlug = false;
+  QVERIFY2(radio.startUpload(&config, true, flags, err), err.format().toLocal8Bit().constData());
+
+  // Compare all elements with the memory banks. At least one element crosses the bank boundary.
+  bool crossing = false;
+  const DFUFile::Image &image = radio.codeplug().image(0);
+  for (int i=0; i<image.numElements(); i++) {
+    const DFUFile::Element &el = image.element(i);
+    crossing |= ((el.address() < 0x10000) && ((el.address()+el.memSize()) > 0x10000));
+    QByteArray written(el.memSize(), 0);
+    for (uint32_t addr=el.address(); addr<(el.address()+el.memSize()); addr+=0x20) {
+      RadioddityInterface::MemoryBank bank = (0x10000 > addr) ?
+            RadioddityInterface::MEMBANK_CODEPLUG_LOWER : RadioddityInterface::MEMBANK_CODEPLUG_UPPER;
+      emulator.read(bank, addr % 0x10000, (uint8_t *)written.data()+(addr-el.address()),
+                    std::min(0x20u, el.address()+el.memSize()-addr));
+    }
+    QVERIFY2(0 == memcmp(written.constData(), el.data(), el.memSize()),
+             QString("Element at 0x%1 differs.").arg(el.address(), 0, 16).toLocal8Bit().constData());
+  }
+  QVERIFY(crossing);
+
+  // Download the image again
+  RD5R other(new RadioddityInterface(emulator.descriptor(), err));
+  QVERIFY2(other.startDownload(true, err), err.format().toLocal8Bit().constData());
+  compareDFUFiles(other.codeplug(), radio.codeplug());
+}
+
+QTEST_GUILESS_MAIN(EmulatorTest)
@@ -0,0 +1,24 @@
+#ifndef EMULATORTEST_HH
+#define EMULATORTEST_HH
+
+#include <QObject>
+
+class EmulatorTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit EmulatorTest(QObject *parent = nullptr);
+
+private slots:
+  void testAnytone();
+  void testAnytonePipelining();
+  void testOpenGD77();
+  void testTyT();
+  void testTyTUpload();
+  void testRadioddity();
+  void testRadioddityPipelining();
+  void testRadioddityUpload();
+};
+
+#endif // EMULATORTEST_HH
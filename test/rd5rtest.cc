@@ -1,8 +1,10 @@
 #include "rd5rtest.hh"
 #include "config.hh"
 #include <QTest>
+#include "dfufilecompare.hh"
 #include "utils.hh"
 #include <QDebug>
+#include <cstring>
 
 RD5RTest::RD5RTest(QObject *parent) : QObject(parent)
 {
@@ -488,4 +490,18 @@ RD5RTest::testDecode() {
   QCOMPARE(decoded.gpsSystems()->count(), 0);
 }
 
+void
+RD5RTest::testParallelEncode() {
+  // Encode config again in parallel
+  Codeplug::Flags flags;
+  flags.parallelEncode = true;
+  RD5RCodeplug codeplug;
+  QVERIFY(codeplug.encode(&_config, flags));
+  // Timestamps may differ
+  memcpy(codeplug.data(0x000088), _codeplug.data(0x000088), 6);
+
+  // Compare all elements
+  compareDFUFiles(codeplug, _codeplug);
+}
+
 QTEST_GUILESS_MAIN(RD5RTest)
@@ -29,6 +29,7 @@ private slots:
   void testZones();
   void testScanLists();
   void testDecode();
+  void testParallelEncode();
 
 protected:
   Config _config;
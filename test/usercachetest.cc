@@ -0,0 +1,176 @@
+#include "usercachetest.hh"
+#include "usercache.hh"
+#include "userparser.hh"
+#include "userindex.hh"
+#include <QTest>
+#include <QBuffer>
+
+UserCacheTest::UserCacheTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+UserCacheTest::testCompile() {
+  QVector<UserDatabase::User> users(2);
+  users[0].id = 2621370; users[0].call = "DM3MAT"; users[0].name = "Hannes";
+  users[0].city = "Berlin"; users[0].country = "Germany";
+  users[1].id = 2621371; users[1].call = "DL1ABC"; users[1].name = "Jörg";
+  users[1].city = "Berlin"; users[1].country = "Germany"; users[1].comment = "DMR";
+
+  UserCache cache;
+  QVERIFY(cache.assign(UserCache::compile(users, 1234, 5678)));
+  QCOMPARE(cache.count(), 2u);
+  QCOMPARE(cache.id(1), 2621371u);
+
+  UserDatabase::User user = cache.user(1);
+  QCOMPARE(user.call, QString("DL1ABC"));
+  QCOMPARE(user.name, QString("Jörg"));
+  QCOMPARE(user.surname, QString());
+  QCOMPARE(user.city, QString("Berlin"));
+  QCOMPARE(user.state, QString());
+  QCOMPARE(user.country, QString("Germany"));
+  QCOMPARE(user.comment, QString("DMR"));
+}
+
+void
+UserCacheTest::testView() {
+  QVector<UserDatabase::User> users(2);
+  users[0].id = 2621371; users[0].call = "DL1ABC"; users[0].city = "Berlin";
+  users[0].country = "Germany";
+  users[1].id = 2621370; users[1].call = "DM3MAT"; users[1].city = "Berlin";
+  users[1].country = "Germany";
+
+  UserCache cache;
+  QVERIFY(cache.assign(UserCache::compile(users, 1234, 5678)));
+
+  UserDatabase::UserView view(&cache, 0);
+  QVERIFY(view.isValid());
+  QCOMPARE(view.id(), 2621370u);
+  QCOMPARE(view.call(), QString("DM3MAT"));
+  QCOMPARE(view.country(), QString("Germany"));
+  QCOMPARE(view.user().city, QString("Berlin"));
+  QVERIFY(! UserDatabase::UserView().isValid());
+
+  // Interned strings share their key
+  QCOMPARE(cache.key(0, UserCache::City), cache.key(1, UserCache::City));
+  QVERIFY(cache.key(0, UserCache::Call) != cache.key(1, UserCache::Call));
+  QCOMPARE(cache.key(0, UserCache::State), 0u);
+}
+
+void
+UserCacheTest::testInvalid() {
+  QVector<UserDatabase::User> users(1);
+  users[0].id = 2621370; users[0].call = "DM3MAT";
+  QByteArray image = UserCache::compile(users, 1234, 5678);
+
+  UserCache cache;
+  // Truncated image
+  QVERIFY(! cache.assign(image.left(image.size()-1)));
+  QVERIFY(! cache.isOpen());
+  // String offset exceeds pool
+  QByteArray corrupted = image;
+  corrupted[0x002c+3] = 0x7f;
+  QVERIFY(! cache.assign(corrupted));
+}
+
+void
+UserCacheTest::testDistance() {
+  QCOMPARE(UserDatabase::User::distance(2621370, 2621370), 0u);
+  QCOMPARE(UserDatabase::User::distance(2621370, 2621371), 1u);
+  // Prefixes get extended to the length of the ID
+  QCOMPARE(UserDatabase::User::distance(2621370, 262), 1370u);
+  QCOMPARE(UserDatabase::User::distance(262, 2621370), 1370u);
+  QCOMPARE(UserDatabase::User::distance(2621370, 263), 8630u);
+}
+
+void
+UserCacheTest::testFilter() {
+  QVector<UserDatabase::User> users(5);
+  users[0].id = 2621370; users[0].call = "DM3MAT"; users[0].state = "Berlin";
+  users[0].country = "Germany";
+  users[1].id = 2621371; users[1].call = "DL1ABC"; users[1].state = "Bayern";
+  users[1].country = "Germany";
+  users[2].id = 2341234; users[2].call = "G4XYZ"; users[2].country = "United Kingdom";
+  users[3].id = 3101234; users[3].call = "K1ABC"; users[3].state = "Maine";
+  users[3].country = "United States";
+  users[4].id = 2621372; users[4].call = "DL2XYZ"; users[4].state = "bayern";
+  users[4].country = "GERMANY";
+
+  UserCache cache;
+  QVERIFY(cache.assign(UserCache::compile(users, 1234, 5678)));
+  UserIndex index(&cache);
+  // Cache is sorted by ID: G4XYZ, DM3MAT, DL1ABC, DL2XYZ, K1ABC
+  QCOMPARE(index.lowerBound(2621371), 2u);
+
+  CallsignDB::Selection selection;
+  QCOMPARE(index.match(selection).count(true), 5);
+
+  // Spellings differing only in case are matched both
+  selection.setCountries(QStringList() << "germany" << "United Kingdom");
+  QBitArray match = index.match(selection);
+  QCOMPARE(match.count(true), 4);
+  QVERIFY(! match.testBit(4));
+
+  selection.setStates(QStringList() << "Bayern");
+  match = index.match(selection);
+  QCOMPARE(match.count(true), 2);
+  QVERIFY(match.testBit(2) && match.testBit(3));
+
+  selection = CallsignDB::Selection();
+  QList<CallsignDB::Selection::IDRange> ranges;
+  QVERIFY(CallsignDB::Selection::parseIDRanges("2620000-2629999, 3101234", ranges));
+  QVERIFY(! CallsignDB::Selection::parseIDRanges("26x", ranges));
+  selection.setIDRanges(ranges);
+  QCOMPARE(index.match(selection).count(true), 4);
+
+  selection.setCallsignPattern(QRegularExpression("DL1|K"));
+  match = index.match(selection);
+  QCOMPARE(match.count(true), 2);
+  QVERIFY(match.testBit(2) && match.testBit(4));
+
+  selection = CallsignDB::Selection();
+  selection.setHeard(QSet<unsigned>{2341234, 1234567});
+  match = index.match(selection);
+  QCOMPARE(match.count(true), 1);
+  QVERIFY(match.testBit(0));
+}
+
+void
+UserCacheTest::testParse() {
+  QByteArray json(
+        "{\"count\": 3, \"users\": [\n"
+        "  {\"id\": 2621371, \"callsign\": \"DL1ABC\", \"fname\": \"J\\u00f6rg\", "
+        "   \"city\": \"Berlin\", \"country\": \"Germany\", \"extra\": [1, {\"a\": null}]},\n"
+        "  42,\n"
+        "  {\"id\": 2621370, \"callsign\": \"DM3MAT\", \"remarks\": \"\\\"DMR\\\"\", "
+        "   \"state\": null},\n"
+        "  {\"callsign\": \"NOID\"}\n"
+        "]}");
+  QBuffer buffer(&json);
+  QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+  UserCache::Builder builder;
+  UserParser parser(&buffer, builder);
+  QVERIFY(parser.parse());
+  QCOMPARE(builder.count(), 2u);
+
+  UserCache cache;
+  QVERIFY(cache.assign(builder.compile(0, 0)));
+  QCOMPARE(cache.count(), 2u);
+  QCOMPARE(cache.id(0), 2621370u);
+  QCOMPARE(cache.user(0).call, QString("DM3MAT"));
+  QCOMPARE(cache.user(0).comment, QString("\"DMR\""));
+  QCOMPARE(cache.user(0).state, QString());
+  QCOMPARE(cache.user(1).name, QString("Jörg"));
+  QCOMPARE(cache.user(1).country, QString("Germany"));
+
+  // Missing users
+  QByteArray invalid("{\"count\": 0}");
+  QBuffer invalidBuffer(&invalid);
+  QVERIFY(invalidBuffer.open(QIODevice::ReadOnly));
+  UserParser invalidParser(&invalidBuffer, builder);
+  QVERIFY(! invalidParser.parse());
+}
+
+QTEST_GUILESS_MAIN(UserCacheTest)
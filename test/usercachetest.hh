@@ -0,0 +1,22 @@
+#ifndef USERCACHETEST_HH
+#define USERCACHETEST_HH
+
+#include <QObject>
+
+class UserCacheTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit UserCacheTest(QObject *parent = nullptr);
+
+private slots:
+  void testCompile();
+  void testView();
+  void testInvalid();
+  void testDistance();
+  void testFilter();
+  void testParse();
+};
+
+#endif // USERCACHETEST_HH
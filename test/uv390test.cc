@@ -1,8 +1,10 @@
 #include "uv390test.hh"
 #include "config.hh"
 #include <QTest>
+#include "dfufilecompare.hh"
 #include "utils.hh"
 #include <QDebug>
+#include <cstring>
 
 UV390Test::UV390Test(QObject *parent) : QObject(parent)
 {
@@ -521,4 +523,18 @@ UV390Test::testDecode() {
   }
 }
 
+void
+UV390Test::testParallelEncode() {
+  // Encode config again in parallel
+  Codeplug::Flags flags;
+  flags.parallelEncode = true;
+  UV390Codeplug codeplug;
+  QVERIFY(codeplug.encode(&_config, flags));
+  // Timestamps may differ
+  memcpy(codeplug.data(0x002000), _codeplug.data(0x002000), 12);
+
+  // Compare all elements
+  compareDFUFiles(codeplug, _codeplug);
+}
+
 QTEST_GUILESS_MAIN(UV390Test)